@@ -1,5 +1,7 @@
 #include "aggregate_function.h"
 
+#include <type_traits>
+
 namespace shdb
 {
 
@@ -14,80 +16,175 @@ enum SimpleAggregateFunctionType
     avg
 };
 
-template <SimpleAggregateFunctionType AggregateFunctionType>
+/// Aggregate of one int64 or uint64 argument, result has argument type. Nulls are skipped,
+/// result is null if there were no other values. Sum wraps around on overflow, avg is rounded toward zero
+/// and keeps its sum in 128 bits, so it is exact while the sum of values fits there.
+template <SimpleAggregateFunctionType AggregateFunctionType, class T>
 class SimpleAggregateFunction : public IAggregateFunction
 {
 public:
     explicit SimpleAggregateFunction(const std::vector<Type> & argument_types_)
-        : IAggregateFunction(argument_types_), result_type(Type::int64)
+        : IAggregateFunction(argument_types_), result_type(argument_types_.front())
     {
-        throw std::runtime_error("Not implemented");
     }
 
     Type getResultType() override { return result_type; }
 
-    size_t getStateSize() override { throw std::runtime_error("Not implemented"); }
+    size_t getStateSize() override { return sizeof(State); }
+
+    void create(AggregateDataPtr place) override { new (place) State; }
+
+    void destroy(AggregateDataPtr place) override { getState(place).~State(); }
 
-    void create(AggregateDataPtr place) override
+    void add(AggregateDataPtr place, Row arguments) override
     {
-        (void)(place);
-        throw std::runtime_error("Not implemented");
+        if (std::holds_alternative<Null>(arguments.front()))
+            return;
+        addValue(getState(place), std::get<T>(arguments.front()));
     }
 
-    void destroy(AggregateDataPtr place) override
+    void addBatch(const AggregateDataPtr * places, size_t place_offset, const std::vector<ColumnVector> & arguments, size_t size) override
     {
-        (void)(place);
-        throw std::runtime_error("Not implemented");
+        const auto & argument = arguments.front();
+        const auto & values = argument.getValues<T>();
+        if (!argument.hasNulls())
+        {
+            for (size_t row = 0; row < size; ++row)
+                addValue(getState(places[row] + place_offset), values[row]);
+            return;
+        }
+        for (size_t row = 0; row < size; ++row)
+            if (!argument.isNull(row))
+                addValue(getState(places[row] + place_offset), values[row]);
     }
 
-    void add(AggregateDataPtr place, Row arguments) override
+    void merge(AggregateDataPtr place, AggregateDataPtr rhs) override
     {
-        (void)(place);
-        (void)(arguments);
-        throw std::runtime_error("Not implemented");
+        auto & state = getState(place);
+        const auto & rhs_state = getState(rhs);
+        if (rhs_state.count == 0)
+            return;
+        if constexpr (AggregateFunctionType == avg)
+        {
+            state.value += rhs_state.value;
+            state.count += rhs_state.count;
+        }
+        else
+        {
+            addValue(state, rhs_state.value);
+            state.count += rhs_state.count - 1;
+        }
     }
 
     Value getResult(AggregateDataPtr place) override
     {
-        (void)(place);
-        throw std::runtime_error("Not implemented");
+        const auto & state = getState(place);
+        if (state.count == 0)
+            return Null{};
+        if constexpr (AggregateFunctionType == avg)
+            return static_cast<T>(state.value / static_cast<StateValue>(state.count));
+        else
+            return state.value;
     }
 
 private:
+    using WideValue = std::conditional_t<std::is_signed_v<T>, __int128, unsigned __int128>;
+    using StateValue = std::conditional_t<AggregateFunctionType == avg, WideValue, T>;
+
+    struct State
+    {
+        StateValue value{};
+        uint64_t count = 0;
+    };
+
+    static State & getState(AggregateDataPtr place) { return *reinterpret_cast<State *>(place); }
+
+    static void addValue(State & state, T value)
+    {
+        if constexpr (AggregateFunctionType == min)
+            state.value = state.count == 0 ? value : std::min(state.value, value);
+        else if constexpr (AggregateFunctionType == max)
+            state.value = state.count == 0 ? value : std::max(state.value, value);
+        else if constexpr (AggregateFunctionType == sum)
+            state.value = static_cast<T>(static_cast<uint64_t>(state.value) + static_cast<uint64_t>(value));
+        else
+            state.value += value;
+        ++state.count;
+    }
+
     Type result_type;
 };
 
+template <SimpleAggregateFunctionType AggregateFunctionType>
+AggregateFunctionCreateCallback createSimpleAggregateFunction(const std::string & name)
+{
+    return [name](const Types & argument_types) -> AggregateFunctionPtr
+    {
+        if (argument_types.size() != 1)
+            throw std::runtime_error("Aggregate function " + name + " expects one argument");
+        switch (argument_types.front())
+        {
+            case Type::int64:
+                return std::make_shared<SimpleAggregateFunction<AggregateFunctionType, int64_t>>(argument_types);
+            case Type::uint64:
+                return std::make_shared<SimpleAggregateFunction<AggregateFunctionType, uint64_t>>(argument_types);
+            default:
+                throw std::runtime_error("Aggregate function " + name + " expects int64 or uint64 argument");
+        }
+    };
+}
+
+}
+
+void IAggregateFunction::addBatch(
+    const AggregateDataPtr * places, size_t place_offset, const std::vector<ColumnVector> & arguments, size_t size)
+{
+    for (size_t row = 0; row < size; ++row)
+    {
+        Row row_arguments;
+        row_arguments.reserve(arguments.size());
+        for (const auto & argument : arguments)
+            row_arguments.push_back(argument.getValue(row));
+        add(places[row] + place_offset, std::move(row_arguments));
+    }
 }
 
 AggregateFunctionPtr
 AggregateFunctionFactory::getAggregateFunctionOrNull(const std::string & aggregate_function_name, const Types & argument_types)
 {
-    (void)(aggregate_function_name);
-    (void)(argument_types);
-    throw std::runtime_error("Not implemented");
+    auto it = aggregate_function_name_to_create_callback.find(aggregate_function_name);
+    if (it == aggregate_function_name_to_create_callback.end())
+        return nullptr;
+    return it->second(argument_types);
 }
 
 AggregateFunctionPtr
 AggregateFunctionFactory::getAggregateFunctionOrThrow(const std::string & aggregate_function_name, const Types & argument_types)
 {
-    (void)(aggregate_function_name);
-    (void)(argument_types);
-    throw std::runtime_error("Not implemented");
+    auto aggregate_function = getAggregateFunctionOrNull(aggregate_function_name, argument_types);
+    if (!aggregate_function)
+        throw std::runtime_error("Unknown aggregate function " + aggregate_function_name);
+    return aggregate_function;
+}
+
+bool AggregateFunctionFactory::hasAggregateFunction(const std::string & aggregate_function_name) const
+{
+    return aggregate_function_name_to_create_callback.contains(aggregate_function_name);
 }
 
 void AggregateFunctionFactory::registerAggregateFunction(
     const std::string & aggregate_function_name, AggregateFunctionCreateCallback create_callback)
 {
-    (void)(aggregate_function_name);
-    (void)(create_callback);
-    throw std::runtime_error("Not implemented");
+    if (!aggregate_function_name_to_create_callback.emplace(aggregate_function_name, std::move(create_callback)).second)
+        throw std::runtime_error("Aggregate function " + aggregate_function_name + " is already registered");
 }
 
 void registerAggregateFunctions(AggregateFunctionFactory & aggregate_function_factory)
 {
-    (void)(aggregate_function_factory);
-    return;
-    throw std::runtime_error("Not implemented");
+    aggregate_function_factory.registerAggregateFunction("min", createSimpleAggregateFunction<min>("min"));
+    aggregate_function_factory.registerAggregateFunction("max", createSimpleAggregateFunction<max>("max"));
+    aggregate_function_factory.registerAggregateFunction("sum", createSimpleAggregateFunction<sum>("sum"));
+    aggregate_function_factory.registerAggregateFunction("avg", createSimpleAggregateFunction<avg>("avg"));
 }
 
 }
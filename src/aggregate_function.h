@@ -25,6 +25,13 @@ public:
 
     virtual void add(AggregateDataPtr place, Row arguments) = 0;
 
+    /// Adds size rows, arguments have a value per row and state of row i is at places[i] + place_offset.
+    /// Default implementation calls add for every row.
+    virtual void addBatch(const AggregateDataPtr * places, size_t place_offset, const std::vector<ColumnVector> & arguments, size_t size);
+
+    /// Adds values aggregated into rhs state to place state, rhs is not changed
+    virtual void merge(AggregateDataPtr place, AggregateDataPtr rhs) = 0;
+
     virtual Value getResult(AggregateDataPtr place) = 0;
 
     const Types arguments_types;
@@ -41,6 +48,9 @@ public:
 
     AggregateFunctionPtr getAggregateFunctionOrThrow(const std::string & aggregate_function_name, const Types & argument_types);
 
+    /// Tells aggregate function calls from other functions before argument types are known
+    bool hasAggregateFunction(const std::string & aggregate_function_name) const;
+
     void registerAggregateFunction(const std::string & aggregate_function_name, AggregateFunctionCreateCallback create_callback);
 
 private:
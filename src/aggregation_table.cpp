@@ -0,0 +1,218 @@
+#include "aggregation_table.h"
+
+#include <cstring>
+#include <string_view>
+
+namespace shdb
+{
+
+namespace
+{
+
+constexpr size_t initial_cell_count = 64;
+
+template <class T>
+void appendBytes(std::string & buffer, const T & value)
+{
+    buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <class T>
+T readBytes(const char *& data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    return value;
+}
+
+}
+
+AggregationTable::AggregationTable(Types key_types_, std::vector<AggregateFunctionPtr> aggregate_functions_)
+    : key_types(std::move(key_types_)), aggregate_functions(std::move(aggregate_functions_)), cells(initial_cell_count)
+{
+    for (const auto & aggregate_function : aggregate_functions)
+    {
+        state_offsets.push_back(states_size);
+        states_size += (aggregate_function->getStateSize() + Arena::Alignment - 1) / Arena::Alignment * Arena::Alignment;
+    }
+}
+
+AggregationTable::~AggregationTable()
+{
+    for (const auto & group : groups)
+        for (size_t index = 0; index < aggregate_functions.size(); ++index)
+            aggregate_functions[index]->destroy(group.states + state_offsets[index]);
+}
+
+/// Null flag byte per column, then fixed size value or length prefixed string
+void serializeKey(const std::vector<ColumnVector> & keys, size_t row, std::string & buffer)
+{
+    for (const auto & key : keys)
+    {
+        if (key.isNull(row))
+        {
+            buffer.push_back(0);
+            continue;
+        }
+        buffer.push_back(1);
+        switch (key.getType())
+        {
+            case Type::boolean:
+                buffer.push_back(static_cast<char>(key.getBooleans()[row]));
+                break;
+            case Type::uint64:
+                appendBytes(buffer, key.getUInt64s()[row]);
+                break;
+            case Type::int64:
+                appendBytes(buffer, key.getInt64s()[row]);
+                break;
+            case Type::varchar:
+            case Type::string: {
+                const auto & value = key.getStrings()[row];
+                appendBytes(buffer, static_cast<uint32_t>(value.size()));
+                buffer.append(value);
+                break;
+            }
+        }
+    }
+}
+
+void AggregationTable::findGroups(const std::vector<ColumnVector> & keys, size_t size, AggregateDataPtr * places)
+{
+    for (size_t row = 0; row < size; ++row)
+    {
+        key_buffer.clear();
+        serializeKey(keys, row, key_buffer);
+        places[row] = findOrCreateGroup(key_buffer, hashKey(key_buffer));
+    }
+}
+
+AggregateDataPtr AggregationTable::findOrCreateGroup(std::string_view key, size_t hash)
+{
+    size_t mask = cells.size() - 1;
+    for (size_t index = hash & mask;; index = (index + 1) & mask)
+    {
+        auto & cell = cells[index];
+        if (cell.group == 0)
+            break;
+        if (cell.hash != hash)
+            continue;
+        const auto & group = groups[cell.group - 1];
+        if (std::string_view(group.key, group.key_size) == key)
+            return group.states;
+    }
+
+    if ((groups.size() + 1) * 2 > cells.size())
+        grow();
+
+    Group group{arena.insert(key.data(), key.size()), key.size(), hash, arena.alloc(states_size)};
+    for (size_t index = 0; index < aggregate_functions.size(); ++index)
+        aggregate_functions[index]->create(group.states + state_offsets[index]);
+    groups.push_back(group);
+
+    mask = cells.size() - 1;
+    size_t index = hash & mask;
+    while (cells[index].group != 0)
+        index = (index + 1) & mask;
+    cells[index] = Cell{hash, static_cast<uint32_t>(groups.size())};
+    return group.states;
+}
+
+void AggregationTable::merge(const AggregationTable & other)
+{
+    for (const auto & group : other.groups)
+    {
+        auto states = findOrCreateGroup(std::string_view(group.key, group.key_size), group.hash);
+        for (size_t index = 0; index < aggregate_functions.size(); ++index)
+            aggregate_functions[index]->merge(states + state_offsets[index], group.states + state_offsets[index]);
+    }
+}
+
+void AggregationTable::grow()
+{
+    std::vector<Cell> old_cells(cells.size() * 2);
+    std::swap(cells, old_cells);
+    size_t mask = cells.size() - 1;
+    for (const auto & cell : old_cells)
+    {
+        if (cell.group == 0)
+            continue;
+        size_t index = cell.hash & mask;
+        while (cells[index].group != 0)
+            index = (index + 1) & mask;
+        cells[index] = cell;
+    }
+}
+
+void AggregationTable::getResults(size_t begin, size_t end, ColumnBatch & batch) const
+{
+    for (size_t index = begin; index < end; ++index)
+    {
+        const auto & group = groups[index];
+        decodeKey(group, batch);
+        for (size_t function = 0; function < aggregate_functions.size(); ++function)
+            batch.getColumn(key_types.size() + function).append(aggregate_functions[function]->getResult(group.states + state_offsets[function]));
+    }
+}
+
+void AggregationTable::decodeKey(const Group & group, ColumnBatch & batch) const
+{
+    const char * data = group.key;
+    for (size_t index = 0; index < key_types.size(); ++index)
+    {
+        auto & column = batch.getColumn(index);
+        if (*data++ == 0)
+        {
+            column.appendNull();
+            continue;
+        }
+        switch (key_types[index])
+        {
+            case Type::boolean:
+                column.getBooleans().push_back(static_cast<uint8_t>(*data++));
+                break;
+            case Type::uint64:
+                column.getUInt64s().push_back(readBytes<uint64_t>(data));
+                break;
+            case Type::int64:
+                column.getInt64s().push_back(readBytes<int64_t>(data));
+                break;
+            case Type::varchar:
+            case Type::string: {
+                auto size = readBytes<uint32_t>(data);
+                column.getStrings().emplace_back(data, size);
+                data += size;
+                break;
+            }
+        }
+    }
+}
+
+PartitionedAggregationTable::PartitionedAggregationTable(
+    const Types & key_types, const std::vector<AggregateFunctionPtr> & aggregate_functions)
+{
+    for (size_t index = 0; index < PartitionCount; ++index)
+        partitions.push_back(std::make_unique<AggregationTable>(key_types, aggregate_functions));
+}
+
+void PartitionedAggregationTable::findGroups(const std::vector<ColumnVector> & keys, size_t size, AggregateDataPtr * places)
+{
+    for (size_t row = 0; row < size; ++row)
+    {
+        key_buffer.clear();
+        serializeKey(keys, row, key_buffer);
+        auto hash = hashKey(key_buffer);
+        places[row] = partitions[getPartitionIndex(hash)]->findOrCreateGroup(key_buffer, hash);
+    }
+}
+
+size_t PartitionedAggregationTable::getGroupCount() const
+{
+    size_t count = 0;
+    for (const auto & partition : partitions)
+        count += partition->getGroupCount();
+    return count;
+}
+
+}
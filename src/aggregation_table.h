@@ -0,0 +1,112 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "aggregate_function.h"
+#include "arena.h"
+#include "column_batch.h"
+
+namespace shdb
+{
+
+/// Appends key values of row to buffer, equal keys give equal bytes
+void serializeKey(const std::vector<ColumnVector> & keys, size_t row, std::string & buffer);
+
+inline size_t hashKey(std::string_view key)
+{
+    return std::hash<std::string_view>()(key);
+}
+
+/// Groups of hash aggregation keyed by serialized key values. Keys and aggregate states of all groups are kept in arena,
+/// open addressing table holds only hashes and group numbers, so a new group does not allocate on heap by itself.
+/// Groups are numbered in order they were first seen.
+class AggregationTable
+{
+public:
+    AggregationTable(Types key_types, std::vector<AggregateFunctionPtr> aggregate_functions);
+
+    AggregationTable(const AggregationTable &) = delete;
+    AggregationTable & operator=(const AggregationTable &) = delete;
+
+    ~AggregationTable();
+
+    /// Finds or creates group of each of size rows, keys have a value per row. States of row group are stored to places[row],
+    /// state of aggregate function i is at places[row] + getStateOffset(i).
+    void findGroups(const std::vector<ColumnVector> & keys, size_t size, AggregateDataPtr * places);
+
+    /// States of group with serialized key, hash must be hashKey(key)
+    AggregateDataPtr findOrCreateGroup(std::string_view key, size_t hash);
+
+    /// Merges states of every group of other table with the same aggregate functions into group with equal key, other is not changed
+    void merge(const AggregationTable & other);
+
+    size_t getStateOffset(size_t aggregate_function) const { return state_offsets[aggregate_function]; }
+
+    size_t getGroupCount() const { return groups.size(); }
+
+    /// Appends key values followed by aggregate results of groups [begin, end) to columns of batch
+    void getResults(size_t begin, size_t end, ColumnBatch & batch) const;
+
+private:
+    struct Group
+    {
+        const char * key;
+        size_t key_size;
+        size_t hash;
+        AggregateDataPtr states;
+    };
+
+    struct Cell
+    {
+        size_t hash = 0;
+        /// Group number plus one, zero marks empty cell
+        uint32_t group = 0;
+    };
+
+    void grow();
+
+    void decodeKey(const Group & group, ColumnBatch & batch) const;
+
+    Types key_types;
+    std::vector<AggregateFunctionPtr> aggregate_functions;
+    std::vector<size_t> state_offsets;
+    size_t states_size = 0;
+
+    Arena arena;
+    std::vector<Group> groups;
+    std::vector<Cell> cells;
+    std::string key_buffer;
+};
+
+/// Groups split into partitions by high bits of key hash, so the same key always goes to partition with the same number.
+/// Partitions of tables filled by different threads are merged independently of each other.
+class PartitionedAggregationTable
+{
+public:
+    static constexpr size_t PartitionBits = 6;
+    static constexpr size_t PartitionCount = size_t(1) << PartitionBits;
+
+    PartitionedAggregationTable(const Types & key_types, const std::vector<AggregateFunctionPtr> & aggregate_functions);
+
+    /// Same as AggregationTable::findGroups, states of aggregate functions have the same offsets in all partitions
+    void findGroups(const std::vector<ColumnVector> & keys, size_t size, AggregateDataPtr * places);
+
+    size_t getStateOffset(size_t aggregate_function) const { return partitions.front()->getStateOffset(aggregate_function); }
+
+    AggregationTable & getPartition(size_t index) { return *partitions[index]; }
+
+    const AggregationTable & getPartition(size_t index) const { return *partitions[index]; }
+
+    size_t getGroupCount() const;
+
+private:
+    static size_t getPartitionIndex(size_t hash) { return hash >> (sizeof(size_t) * 8 - PartitionBits); }
+
+    std::vector<std::unique_ptr<AggregationTable>> partitions;
+    std::string key_buffer;
+};
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace shdb
+{
+
+/// Bump allocator for many small objects that live as long as the arena.
+/// Memory is taken in chunks of growing size and released all at once, objects are never freed one by one.
+class Arena
+{
+public:
+    static constexpr size_t Alignment = alignof(std::max_align_t);
+
+    explicit Arena(size_t initial_chunk_size_ = 4096) : next_chunk_size(initial_chunk_size_) { }
+
+    Arena(const Arena &) = delete;
+    Arena & operator=(const Arena &) = delete;
+
+    /// Returned memory is aligned for any scalar type and stays valid until arena is destroyed
+    char * alloc(size_t size)
+    {
+        size = (size + Alignment - 1) / Alignment * Alignment;
+        if (size > static_cast<size_t>(end - position))
+            addChunk(size);
+        char * result = position;
+        position += size;
+        return result;
+    }
+
+    /// Copies data into arena
+    char * insert(const char * data, size_t size)
+    {
+        char * result = alloc(size);
+        std::copy(data, data + size, result);
+        return result;
+    }
+
+    size_t getAllocatedBytes() const { return allocated_bytes; }
+
+private:
+    void addChunk(size_t min_size)
+    {
+        size_t size = std::max(next_chunk_size, min_size);
+        chunks.emplace_back(new char[size]);
+        position = chunks.back().get();
+        end = position + size;
+        allocated_bytes += size;
+        next_chunk_size = std::min(size * 2, max_chunk_size);
+    }
+
+    static constexpr size_t max_chunk_size = 64 << 20;
+
+    std::vector<std::unique_ptr<char[]>> chunks;
+    char * position = nullptr;
+    char * end = nullptr;
+    size_t next_chunk_size;
+    size_t allocated_bytes = 0;
+};
+
+}
@@ -18,6 +18,21 @@ ASTPtr newNumberLiteral(int64_t value)
     return std::make_shared<ASTLiteral>(value);
 }
 
+ASTPtr newBooleanLiteral(bool value)
+{
+    return std::make_shared<ASTLiteral>(value);
+}
+
+ASTPtr newUnsignedNumberLiteral(uint64_t value)
+{
+    return std::make_shared<ASTLiteral>(value);
+}
+
+ASTPtr newParameter()
+{
+    return std::make_shared<ASTParameter>();
+}
+
 ASTPtr newBinaryOperator(BinaryOperatorCode operator_code, ASTPtr lhs, ASTPtr rhs)
 {
     return std::make_shared<ASTBinaryOperator>(operator_code, std::move(lhs), std::move(rhs));
@@ -55,14 +70,19 @@ ASTPtr newSelectQuery(
         std::move(list), std::move(from), std::move(where), std::move(group_by), std::move(having), std::move(order));
 }
 
-ASTPtr newInsertQuery(std::string table, ASTListPtr values)
+ASTPtr newInsertQuery(std::string table, ASTListPtr rows)
 {
-    return std::make_shared<ASTInsertQuery>(std::move(table), std::move(values));
+    return std::make_shared<ASTInsertQuery>(std::move(table), std::move(rows), nullptr);
 }
 
-ASTPtr newCreateQuery(std::string table, Schema schema)
+ASTPtr newInsertSelectQuery(std::string table, ASTPtr select)
 {
-    return std::make_shared<ASTCreateQuery>(std::move(table), std::move(schema));
+    return std::make_shared<ASTInsertQuery>(std::move(table), nullptr, std::move(select));
+}
+
+ASTPtr newCreateQuery(std::string table, Schema schema, TableLayout layout)
+{
+    return std::make_shared<ASTCreateQuery>(std::move(table), std::move(schema), layout);
 }
 
 ASTPtr newDropQuery(std::string table)
@@ -70,6 +90,11 @@ ASTPtr newDropQuery(std::string table)
     return std::make_shared<ASTDropQuery>(std::move(table));
 }
 
+ASTPtr newCopyQuery(std::string table, std::string path, std::string delimiter, bool header)
+{
+    return std::make_shared<ASTCopyQuery>(std::move(table), std::move(path), std::move(delimiter), header);
+}
+
 std::string toString(const IAST & ast)
 {
     switch (ast.type)
@@ -84,8 +109,14 @@ std::string toString(const IAST & ast)
                     return std::to_string(literal.integer_value);
                 case ASTLiteralType::string:
                     return std::string("\"") + literal.string_value + "\"";
+                case ASTLiteralType::boolean:
+                    return literal.boolean_value ? "true" : "false";
+                case ASTLiteralType::unsigned_number:
+                    return std::to_string(literal.unsigned_value);
             }
         }
+        case ASTType::parameter:
+            return "?";
         case ASTType::binaryOperator: {
             auto binary_operator = static_cast<const ASTBinaryOperator &>(ast);
             auto get_op = [&]() -> std::string
@@ -184,7 +215,14 @@ std::string toString(const IAST & ast)
         }
         case ASTType::insertQuery: {
             auto insert_query = static_cast<const ASTInsertQuery &>(ast);
-            return "INSERT " + insert_query.table + " VALUES (" + toString(insert_query.getValuesList()) + ")";
+            if (insert_query.getSelect())
+                return "INSERT " + insert_query.table + " " + toString(*insert_query.getSelect());
+
+            std::string result = "INSERT " + insert_query.table + " VALUES ";
+            const auto & rows = insert_query.getRowsList().getChildren();
+            for (size_t i = 0; i < rows.size(); ++i)
+                result += (i == 0 ? "(" : ", (") + toString(*rows[i]) + ")";
+            return result;
         }
         case ASTType::createQuery: {
             auto create_query = static_cast<const ASTCreateQuery &>(ast);
@@ -216,12 +254,24 @@ std::string toString(const IAST & ast)
             auto result = "CREATE TABLE " + create_query.table + " (" + col_to_string(schema[0]);
             for (size_t index = 1; index < schema.size(); ++index)
                 result += ", " + col_to_string(schema[index]);
-            return result + ")";
+            result += ")";
+            if (create_query.layout != TableLayout::row)
+                result += " LAYOUT " + toString(create_query.layout);
+            return result;
         }
         case ASTType::dropQuery: {
             auto drop_query = static_cast<const ASTDropQuery &>(ast);
             return "DROP TABLE " + drop_query.table;
         }
+        case ASTType::copyQuery: {
+            auto copy_query = static_cast<const ASTCopyQuery &>(ast);
+            auto result = "COPY " + copy_query.table + " FROM '" + copy_query.path + "'";
+            if (!copy_query.delimiter.empty())
+                result += " DELIMITER '" + copy_query.delimiter + "'";
+            if (copy_query.header)
+                result += " HEADER";
+            return result;
+        }
     }
 
     return {};
@@ -22,6 +22,8 @@ enum class ASTType
     insertQuery,
     createQuery,
     dropQuery,
+    copyQuery,
+    parameter,
 };
 
 class IAST;
@@ -41,6 +43,9 @@ public:
 
     const ASTs & getChildren() const { return children; }
 
+    /// Used by rewriting passes, node must not be shared with trees that should not see the change
+    void setChild(size_t index, ASTPtr child) { children[index] = std::move(child); }
+
     const ASTType type;
 
 protected:
@@ -57,7 +62,11 @@ public:
 enum class ASTLiteralType
 {
     number,
-    string
+    string,
+    /// Only produced by constant folding and parameter binding, query text has no boolean literals
+    boolean,
+    /// Only produced by parameter binding, numbers in query text are int64
+    unsigned_number,
 };
 
 class ASTLiteral : public IAST
@@ -72,9 +81,28 @@ public:
     {
     }
 
+    explicit ASTLiteral(bool literal_value) : IAST(ASTType::literal), literal_type(ASTLiteralType::boolean), boolean_value(literal_value)
+    {
+    }
+
+    explicit ASTLiteral(uint64_t literal_value)
+        : IAST(ASTType::literal), literal_type(ASTLiteralType::unsigned_number), unsigned_value(literal_value)
+    {
+    }
+
     const ASTLiteralType literal_type;
     const int64_t integer_value{};
     const std::string string_value{};
+    const bool boolean_value{};
+    const uint64_t unsigned_value{};
+};
+
+/// Placeholder of prepared statement, replaced by bound value before execution.
+/// Parameters are numbered in order of traversal, which is their order in query text.
+class ASTParameter : public IAST
+{
+public:
+    ASTParameter() : IAST(ASTType::parameter) { }
 };
 
 enum class BinaryOperatorCode
@@ -240,21 +268,27 @@ using ASTSelectQueryPtr = std::shared_ptr<ASTSelectQuery>;
 class ASTInsertQuery : public IAST
 {
 public:
-    ASTInsertQuery(std::string table_, ASTListPtr values) : IAST(ASTType::insertQuery), table(std::move(table_))
+    /// Either list of value tuples or select query rows are read from is given
+    ASTInsertQuery(std::string table_, ASTListPtr rows, ASTPtr select) : IAST(ASTType::insertQuery), table(std::move(table_))
     {
         children.resize(children_size);
-        children[values_child_index] = std::move(values);
+        children[rows_child_index] = std::move(rows);
+        children[select_child_index] = std::move(select);
     }
 
-    const ASTPtr & getValues() { return children[values_child_index]; }
+    const ASTPtr & getRows() { return children[rows_child_index]; }
+
+    /// Every child is a list of values of one row
+    const ASTList & getRowsList() { return static_cast<const ASTList &>(*children[rows_child_index]); }
 
-    const ASTList & getValuesList() { return static_cast<const ASTList &>(*children[values_child_index]); }
+    const ASTPtr & getSelect() { return children[select_child_index]; }
 
     const std::string table;
 
 private:
-    static constexpr size_t values_child_index = 0;
-    static constexpr size_t children_size = values_child_index + 1;
+    static constexpr size_t rows_child_index = 0;
+    static constexpr size_t select_child_index = 1;
+    static constexpr size_t children_size = select_child_index + 1;
 };
 
 using ASTInsertQueryPtr = std::shared_ptr<ASTInsertQuery>;
@@ -262,13 +296,14 @@ using ASTInsertQueryPtr = std::shared_ptr<ASTInsertQuery>;
 class ASTCreateQuery : public IAST
 {
 public:
-    ASTCreateQuery(std::string table_, Schema schema_)
-        : IAST(ASTType::createQuery), table(std::move(table_)), schema(std::make_shared<Schema>(std::move(schema_)))
+    ASTCreateQuery(std::string table_, Schema schema_, TableLayout layout_ = TableLayout::row)
+        : IAST(ASTType::createQuery), table(std::move(table_)), schema(std::make_shared<Schema>(std::move(schema_))), layout(layout_)
     {
     }
 
     const std::string table;
     const std::shared_ptr<Schema> schema;
+    const TableLayout layout;
 };
 
 using ASTCreateQueryPtr = std::shared_ptr<ASTCreateQuery>;
@@ -283,12 +318,35 @@ public:
 
 using ASTDropQueryPtr = std::shared_ptr<ASTDropQuery>;
 
+class ASTCopyQuery : public IAST
+{
+public:
+    ASTCopyQuery(std::string table_, std::string path_, std::string delimiter_, bool header_)
+        : IAST(ASTType::copyQuery), table(std::move(table_)), path(std::move(path_)), delimiter(std::move(delimiter_)), header(header_)
+    {
+    }
+
+    const std::string table;
+    const std::string path;
+    /// Empty if delimiter is chosen by file extension
+    const std::string delimiter;
+    const bool header;
+};
+
+using ASTCopyQueryPtr = std::shared_ptr<ASTCopyQuery>;
+
 ASTPtr newIdentifier(std::string value);
 
 ASTPtr newStringLiteral(std::string value);
 
 ASTPtr newNumberLiteral(int64_t value);
 
+ASTPtr newBooleanLiteral(bool value);
+
+ASTPtr newUnsignedNumberLiteral(uint64_t value);
+
+ASTPtr newParameter();
+
 ASTPtr newBinaryOperator(BinaryOperatorCode operator_code, ASTPtr lhs, ASTPtr rhs);
 
 ASTPtr newUnaryOperator(UnaryOperatorCode operator_code, ASTPtr operand);
@@ -303,12 +361,16 @@ ASTPtr newOrder(ASTPtr expr, bool desc);
 
 ASTPtr newSelectQuery(ASTListPtr list, std::vector<std::string> from, ASTPtr where, ASTListPtr group_by, ASTPtr having, ASTListPtr order);
 
-ASTPtr newInsertQuery(std::string table, ASTListPtr values);
+ASTPtr newInsertQuery(std::string table, ASTListPtr rows);
+
+ASTPtr newInsertSelectQuery(std::string table, ASTPtr select);
 
-ASTPtr newCreateQuery(std::string table, Schema schema);
+ASTPtr newCreateQuery(std::string table, Schema schema, TableLayout layout = TableLayout::row);
 
 ASTPtr newDropQuery(std::string table);
 
+ASTPtr newCopyQuery(std::string table, std::string path, std::string delimiter, bool header);
+
 std::string toString(const IAST & ast);
 
 std::ostream & operator<<(std::ostream & stream, const IAST & ast);
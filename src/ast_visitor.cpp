@@ -1,5 +1,8 @@
 #include "ast_visitor.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace shdb
 {
 
@@ -13,20 +16,263 @@ public:
 
     void visitImpl(const ASTPtr & node)
     {
-        (void)(node);
-        throw std::runtime_error("Not implemented");
+        if (!isAggregateFunction(node))
+            return;
+        if (inside_aggregate_function)
+            throw std::runtime_error("Aggregate function " + node->getName() + " is inside another aggregate function");
+        inside_aggregate_function = true;
+
+        auto name = node->getName();
+        if (std::find(names.begin(), names.end(), name) == names.end())
+        {
+            names.push_back(std::move(name));
+            aggregate_functions.push_back(node);
+        }
+    }
+
+    void leaveImpl(const ASTPtr & node)
+    {
+        if (isAggregateFunction(node))
+            inside_aggregate_function = false;
     }
 
     AggregateFunctionFactory & factory;
+    ASTs aggregate_functions;
+
+private:
+    bool isAggregateFunction(const ASTPtr & node) const
+    {
+        return node->type == ASTType::function && factory.hasAggregateFunction(static_cast<const ASTFunction &>(*node).name);
+    }
+
+    std::vector<std::string> names;
+    bool inside_aggregate_function = false;
+};
+
+class CollectIdentifiersVisitor : public ASTVisitor<CollectIdentifiersVisitor>
+{
+public:
+    void visitImpl(const ASTPtr & node)
+    {
+        if (node->type == ASTType::identifier)
+            identifiers.insert(static_cast<const ASTIdentifier &>(*node).name);
+    }
+
+    std::unordered_set<std::string> identifiers;
 };
 
+bool isBooleanLiteral(const ASTPtr & node)
+{
+    return node->type == ASTType::literal && static_cast<const ASTLiteral &>(*node).literal_type == ASTLiteralType::boolean;
+}
+
+bool isNumberLiteral(const ASTPtr & node)
+{
+    return node->type == ASTType::literal && static_cast<const ASTLiteral &>(*node).literal_type == ASTLiteralType::number;
+}
+
+/// Value of every row is boolean, so it can replace x AND true without changing the result type
+bool isBooleanExpression(const ASTPtr & node)
+{
+    if (isBooleanLiteral(node))
+        return true;
+    if (node->type == ASTType::unaryOperator)
+        return static_cast<const ASTUnaryOperator &>(*node).operator_code == UnaryOperatorCode::lnot;
+    if (node->type != ASTType::binaryOperator)
+        return false;
+    switch (static_cast<const ASTBinaryOperator &>(*node).operator_code)
+    {
+        case BinaryOperatorCode::plus:
+        case BinaryOperatorCode::minus:
+        case BinaryOperatorCode::mul:
+        case BinaryOperatorCode::div:
+            return false;
+        default:
+            return true;
+    }
+}
+
+bool containsParameter(const ASTPtr & node)
+{
+    if (node->type == ASTType::parameter)
+        return true;
+    for (const auto & child : node->getChildren())
+        if (child && containsParameter(child))
+            return true;
+    return false;
+}
+
+Value getLiteralValue(const ASTLiteral & literal)
+{
+    switch (literal.literal_type)
+    {
+        case ASTLiteralType::number:
+            return literal.integer_value;
+        case ASTLiteralType::string:
+            return literal.string_value;
+        case ASTLiteralType::boolean:
+            return literal.boolean_value;
+        case ASTLiteralType::unsigned_number:
+            return literal.unsigned_value;
+    }
+    throw std::runtime_error("Unknown literal type");
+}
+
+/// Children of node are folded when it is left, so every node is folded after its operands
+class ConstantFoldingVisitor : public ASTVisitor<ConstantFoldingVisitor>
+{
+public:
+    void visitImpl(const ASTPtr & node) { (void)(node); }
+
+    void leaveImpl(const ASTPtr & node)
+    {
+        const auto & children = node->getChildren();
+        for (size_t index = 0; index < children.size(); ++index)
+        {
+            if (!children[index])
+                continue;
+            auto folded = fold(children[index]);
+            if (folded != children[index])
+                node->setChild(index, std::move(folded));
+        }
+    }
+
+    /// Node with folded operands, or node itself if nothing can be folded
+    static ASTPtr fold(const ASTPtr & node)
+    {
+        if (node->type == ASTType::unaryOperator)
+            return foldUnary(node, static_cast<const ASTUnaryOperator &>(*node));
+        if (node->type == ASTType::binaryOperator)
+            return foldBinary(node, static_cast<const ASTBinaryOperator &>(*node));
+        return node;
+    }
+
+private:
+    static ASTPtr foldUnary(const ASTPtr & node, const ASTUnaryOperator & unary_operator)
+    {
+        const auto & operand = unary_operator.getOperand();
+        if (unary_operator.operator_code == UnaryOperatorCode::uminus)
+        {
+            if (isNumberLiteral(operand))
+                return newNumberLiteral(
+                    static_cast<int64_t>(-static_cast<uint64_t>(static_cast<const ASTLiteral &>(*operand).integer_value)));
+            return node;
+        }
+
+        if (isBooleanLiteral(operand))
+            return newBooleanLiteral(!static_cast<const ASTLiteral &>(*operand).boolean_value);
+        if (operand->type == ASTType::unaryOperator)
+        {
+            const auto & inner = static_cast<const ASTUnaryOperator &>(*operand);
+            if (inner.operator_code == UnaryOperatorCode::lnot && isBooleanExpression(inner.getOperand()))
+                return inner.getOperand();
+        }
+        return node;
+    }
+
+    static ASTPtr foldBinary(const ASTPtr & node, const ASTBinaryOperator & binary_operator)
+    {
+        const auto & lhs = binary_operator.getLHS();
+        const auto & rhs = binary_operator.getRHS();
+        auto code = binary_operator.operator_code;
+
+        if (code == BinaryOperatorCode::land || code == BinaryOperatorCode::lor)
+            return foldLogical(node, code, lhs, rhs);
+
+        if (lhs->type != ASTType::literal || rhs->type != ASTType::literal)
+            return node;
+        const auto & lhs_literal = static_cast<const ASTLiteral &>(*lhs);
+        const auto & rhs_literal = static_cast<const ASTLiteral &>(*rhs);
+
+        /// Equality is defined for values of any types, like in evaluation
+        if (code == BinaryOperatorCode::eq || code == BinaryOperatorCode::ne)
+            return newBooleanLiteral((getLiteralValue(lhs_literal) == getLiteralValue(rhs_literal)) == (code == BinaryOperatorCode::eq));
+
+        /// Other operators are defined for int64 only, errors are left to evaluation
+        if (!isNumberLiteral(lhs) || !isNumberLiteral(rhs))
+            return node;
+        auto lhs_value = lhs_literal.integer_value;
+        auto rhs_value = rhs_literal.integer_value;
+        auto lhs_unsigned = static_cast<uint64_t>(lhs_value);
+        auto rhs_unsigned = static_cast<uint64_t>(rhs_value);
+        switch (code)
+        {
+            case BinaryOperatorCode::plus:
+                return newNumberLiteral(static_cast<int64_t>(lhs_unsigned + rhs_unsigned));
+            case BinaryOperatorCode::minus:
+                return newNumberLiteral(static_cast<int64_t>(lhs_unsigned - rhs_unsigned));
+            case BinaryOperatorCode::mul:
+                return newNumberLiteral(static_cast<int64_t>(lhs_unsigned * rhs_unsigned));
+            case BinaryOperatorCode::div:
+                if (rhs_value == 0 || (rhs_value == -1 && lhs_value == std::numeric_limits<int64_t>::min()))
+                    return node;
+                return newNumberLiteral(lhs_value / rhs_value);
+            case BinaryOperatorCode::lt:
+                return newBooleanLiteral(lhs_value < rhs_value);
+            case BinaryOperatorCode::le:
+                return newBooleanLiteral(lhs_value <= rhs_value);
+            case BinaryOperatorCode::gt:
+                return newBooleanLiteral(lhs_value > rhs_value);
+            case BinaryOperatorCode::ge:
+                return newBooleanLiteral(lhs_value >= rhs_value);
+            default:
+                return node;
+        }
+    }
+
+    static ASTPtr foldLogical(const ASTPtr & node, BinaryOperatorCode code, const ASTPtr & lhs, const ASTPtr & rhs)
+    {
+        bool is_and = code == BinaryOperatorCode::land;
+        const ASTPtr * constant = nullptr;
+        const ASTPtr * other = nullptr;
+        if (isBooleanLiteral(lhs))
+        {
+            constant = &lhs;
+            other = &rhs;
+        }
+        else if (isBooleanLiteral(rhs))
+        {
+            constant = &rhs;
+            other = &lhs;
+        }
+        if (!constant || !isBooleanExpression(*other))
+            return node;
+
+        /// x AND true and x OR false are x, x AND false and x OR true do not depend on x
+        bool value = static_cast<const ASTLiteral &>(**constant).boolean_value;
+        if (value == is_and)
+            return *other;
+        if (containsParameter(*other))
+            return node;
+        return newBooleanLiteral(value);
+    }
+};
+
+}
+
+std::unordered_set<std::string> collectIdentifiers(const ASTs & expressions)
+{
+    CollectIdentifiersVisitor visitor;
+    for (const auto & expression : expressions)
+        if (expression)
+            visitor.visit(expression);
+    return std::move(visitor.identifiers);
 }
 
 ASTs collectAggregateFunctions(const ASTs & expressions, AggregateFunctionFactory & factory)
 {
-    (void)(expressions);
-    (void)(factory);
-    throw std::runtime_error("Not implemented");
+    CollectAggregateFunctionsVisitor visitor(factory);
+    for (const auto & expression : expressions)
+        if (expression)
+            visitor.visit(expression);
+    return std::move(visitor.aggregate_functions);
+}
+
+ASTPtr foldConstants(const ASTPtr & query)
+{
+    ConstantFoldingVisitor visitor;
+    visitor.visit(query);
+    return ConstantFoldingVisitor::fold(query);
 }
 
 }
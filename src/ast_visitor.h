@@ -3,6 +3,8 @@
 #include "aggregate_function.h"
 #include "expression.h"
 
+#include <unordered_set>
+
 namespace shdb
 {
 
@@ -17,10 +19,14 @@ public:
         return true;
     }
 
+    /// Called after children of node are visited
+    void leaveImpl(const ASTPtr & node) { (void)(node); }
+
     void visit(const ASTPtr & query_tree_node)
     {
         getDerived().visitImpl(query_tree_node);
         visitChildren(query_tree_node);
+        getDerived().leaveImpl(query_tree_node);
     }
 
 private:
@@ -42,6 +48,15 @@ private:
     }
 };
 
+/// Names of columns read by expressions
+std::unordered_set<std::string> collectIdentifiers(const ASTs & expressions);
+
+/// Distinct aggregate function calls of expressions in order of appearance, calls are compared by text
 ASTs collectAggregateFunctions(const ASTs & expressions, AggregateFunctionFactory & factory);
 
+/// Replaces constant subexpressions with literals and simplifies boolean identities like x AND true, false OR x and !!x.
+/// Nodes are changed in place and the result may be another node, so query must not share nodes with trees that
+/// are not folded. Placeholders are never removed, parameters of folded query are the same as of the original one.
+ASTPtr foldConstants(const ASTPtr & query);
+
 }
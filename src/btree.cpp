@@ -7,7 +7,7 @@ namespace shdb
 {
 
 BTree::BTree(const IndexMetadata & metadata_, Store & store_, std::optional<size_t> page_max_keys_size)
-    : IIndex(metadata_), metadata_page(nullptr)
+    : IIndex(metadata_)
 {
     if (!page_max_keys_size)
     {
@@ -67,13 +67,12 @@ void BTree::insert(const IndexKey & index_key, const RowId & row_id)
     int key = metadata_page.getRootPageIndex();
     auto page = index_table.getPage(key);
     while (!page->isLeafPage()) {
-        auto node = shdb::BTreeInternalPage(page);
-        path.push_back({node, key});
-        key = node.lookup(index_key);
+        path.push_back({shdb::BTreeInternalPage(std::move(page)), key});
+        key = path.back().first.lookup(index_key);
         page = index_table.getPage(key);
     }
     assert(page->isLeafPage());
-    auto node = shdb::BTreeLeafPage(page);
+    auto node = shdb::BTreeLeafPage(std::move(page));
     if (node.insert(index_key, row_id)) {
         return;
     }
@@ -93,7 +92,7 @@ void BTree::insert(const IndexKey & index_key, const RowId & row_id)
     }
     auto t = need_insert(divKey, key, second_leaf_page.second);
     while (!path.empty()) {
-        auto node2 = path.back();
+        auto node2 = std::move(path.back());
         path.pop_back();
         auto pos = node2.first.lookupWithIndex(t.key);
         if (node2.first.insertEntry(pos.second + 1, t.key, t.right)) {
@@ -119,14 +118,13 @@ bool BTree::remove(const IndexKey & index_key, const RowId &)
     int key = metadata_page.getRootPageIndex();
     auto page = index_table.getPage(key);
     while (!page->isLeafPage()) {
-        auto node = shdb::BTreeInternalPage(page);
-        path.push_back({node, key});
-        auto pr = node.lookupWithIndex(index_key);
+        path.push_back({shdb::BTreeInternalPage(std::move(page)), key});
+        auto pr = path.back().first.lookupWithIndex(index_key);
         key = pr.first;
         idxs.push_back(pr.second);
         page = index_table.getPage(key);
     }
-    auto node = shdb::BTreeLeafPage(page);
+    auto node = shdb::BTreeLeafPage(std::move(page));
     node.remove(index_key);
     if (node.getSize() != 0) {
         return true;
@@ -134,7 +132,7 @@ bool BTree::remove(const IndexKey & index_key, const RowId &)
     return true;
     int toRemoveKey = key;
     while (!path.empty()) {
-        auto node = path.back().first;
+        auto node = std::move(path.back().first);
         path.pop_back();
         int sz = node.getSize();
         for (int j = idxs.back(); j + 1 < sz; ++j) {
@@ -170,11 +168,10 @@ void BTree::lookup(const IndexKey & index_key, std::vector<RowId> & result)
 //
     while (!page->isLeafPage()) {
         assert(page->isInternalPage());
-        auto node = shdb::BTreeInternalPage(page);
-        auto child_page_id = node.lookup(index_key);
+        auto child_page_id = shdb::BTreeInternalPage(std::move(page)).lookup(index_key);
         page = index_table.getPage(child_page_id);
     }
-    auto node = shdb::BTreeLeafPage(page);
+    auto node = shdb::BTreeLeafPage(std::move(page));
     auto ans = node.lookup(index_key);
     if (ans.has_value()) {
         result.push_back(ans.value());
@@ -200,7 +197,7 @@ public:
         std::optional<Row> max_key,
         bool include_max_key_ = false)
         : index_table(index_table_)
-        , leaf_page(leaf_page_)
+        , leaf_page(std::move(leaf_page_))
         , leaf_page_offset(leaf_page_offset_)
         , max_key(std::move(max_key))
         , include_max_key(include_max_key_){};
@@ -249,17 +246,17 @@ void BTree::dump(std::ostream & stream)
                 break;
             }
             case BTreePageType::metadata: {
-                auto metadata_page = BTreeMetadataPage(page);
+                auto metadata_page = BTreeMetadataPage(std::move(page));
                 metadata_page.dump(stream);
                 break;
             }
             case BTreePageType::internal: {
-                auto internal_page = BTreeInternalPage(page);
+                auto internal_page = BTreeInternalPage(std::move(page));
                 internal_page.dump(stream);
                 break;
             }
             case BTreePageType::leaf: {
-                auto leaf_page = BTreeLeafPage(page);
+                auto leaf_page = BTreeLeafPage(std::move(page));
                 leaf_page.dump(stream);
                 break;
             }
@@ -25,9 +25,13 @@ class BTreeIndexTable
 public:
     BTreeIndexTable() = default;
 
-    explicit BTreeIndexTable(std::shared_ptr<IIndexTable> table_) : table(std::move(table_)) { }
+    explicit BTreeIndexTable(std::shared_ptr<IIndexTable> table_) { setIndexTable(std::move(table_)); }
 
-    void setIndexTable(std::shared_ptr<IIndexTable> index_table) { table = std::move(index_table); }
+    void setIndexTable(std::shared_ptr<IIndexTable> index_table)
+    {
+        table = std::move(index_table);
+        page_provider = static_cast<const BTreePageProvider *>(table->getPageProvider().get());
+    }
 
     PageIndex getPageCount() { return table->getPageCount(); }
 
@@ -37,7 +41,7 @@ public:
         auto raw_page = getPage(page_index);
         raw_page->setPageType(BTreePageType::metadata);
 
-        return {BTreeMetadataPage(raw_page), page_index};
+        return {BTreeMetadataPage(std::move(raw_page)), page_index};
     }
 
     BTreeMetadataPage getMetadataPage(PageIndex page_index) { return BTreeMetadataPage(getPage(page_index)); }
@@ -48,7 +52,7 @@ public:
         auto raw_page = getPage(page_index);
         raw_page->setPageType(BTreePageType::leaf);
 
-        return {BTreeLeafPage(raw_page), page_index};
+        return {BTreeLeafPage(std::move(raw_page)), page_index};
     }
 
     BTreeLeafPage getLeafPage(PageIndex page_index) { return BTreeLeafPage(getPage(page_index)); }
@@ -59,17 +63,18 @@ public:
         auto raw_page = getPage(page_index);
         raw_page->setPageType(BTreePageType::internal);
 
-        return {BTreeInternalPage(raw_page), page_index};
+        return {BTreeInternalPage(std::move(raw_page)), page_index};
     }
 
     BTreeInternalPage getInternalPage(PageIndex page_index) { return BTreeInternalPage(getPage(page_index)); }
 
-    inline BTreePagePtr getPage(PageIndex page_index) { return std::static_pointer_cast<BTreePage>(table->getPage(page_index)); }
+    inline BTreePagePtr getPage(PageIndex page_index) { return page_provider->getPage(table->getPage(page_index)); }
 
 private:
     inline PageIndex allocatePage() { return table->allocatePage(); }
 
     std::shared_ptr<IIndexTable> table;
+    const BTreePageProvider * page_provider = nullptr;
 };
 
 class BTree : public IIndex
@@ -131,7 +136,7 @@ public:
         while (!stack.empty()) {
             auto page = indexTable->getPage(stack.back());
             if (page->isLeafPage()) {
-                auto node = shdb::BTreeLeafPage(page);
+                auto node = shdb::BTreeLeafPage(std::move(page));
                 if (node.getSize() == cnt.back()) {
                     stack.pop_back();
                     cnt.pop_back();
@@ -146,7 +151,7 @@ public:
                 auto value = node.getValue(index);
                 return std::optional<std::pair<IndexKey, RowId>>({key, value});
             } else if (page->isInternalPage()) {
-                auto node = shdb::BTreeInternalPage(page);
+                auto node = shdb::BTreeInternalPage(std::move(page));
                 if (node.getSize() == cnt.back()) {
                     stack.pop_back();
                     cnt.pop_back();
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <utility>
 
 #include "bufferpool.h"
 #include "comparator.h"
@@ -25,22 +26,21 @@ enum BTreePageType : uint32_t
 
 std::string toString(BTreePageType page_type);
 
-class BTreePage : public IPage
+class BTreePage
 {
 public:
-    explicit BTreePage(
-        std::shared_ptr<Frame> frame_, std::shared_ptr<Marshal> marshal_, uint32_t key_size_in_bytes_, uint32_t max_page_size_)
-        : frame(std::move(frame_)), marshal(std::move(marshal_)), key_size_in_bytes(key_size_in_bytes_), max_page_size(max_page_size_)
+    BTreePage() = default;
+
+    BTreePage(FrameView frame_, const Marshal * marshal_, uint32_t key_size_in_bytes_, uint32_t max_page_size_)
+        : key_size_in_bytes(key_size_in_bytes_), max_page_size(max_page_size_), frame(frame_), marshal(marshal_)
     {
     }
 
     static constexpr size_t HeaderOffset = sizeof(BTreePageType);
 
-    const std::shared_ptr<Frame> & getFrame() const { return frame; }
-
-    std::shared_ptr<Frame> & getFrame() { return frame; }
+    const FrameView & getFrame() const { return frame; }
 
-    const std::shared_ptr<Marshal> & getMarshal() const { return marshal; }
+    const Marshal * getMarshal() const { return marshal; }
 
     BTreePageType getPageType() const { return getValue<BTreePageType>(0); }
 
@@ -61,13 +61,14 @@ public:
     template <typename T>
     const T * getPtrValue(size_t index, size_t bytes_offset = 0) const
     {
-        return reinterpret_cast<T *>(frame->getData() + bytes_offset) + index;
+        return reinterpret_cast<const T *>(frame.getData() + bytes_offset) + index;
     }
 
+    /// Mutable accessors mark underlying frame dirty
     template <typename T>
-    T * getPtrValue(size_t index, size_t bytes_offset = 0)
+    T * getMutablePtrValue(size_t index, size_t bytes_offset = 0)
     {
-        return reinterpret_cast<T *>(frame->getData() + bytes_offset) + index;
+        return reinterpret_cast<T *>(frame.getMutableData() + bytes_offset) + index;
     }
 
     template <typename T>
@@ -77,27 +78,45 @@ public:
     }
 
     template <typename T>
-    T & getValue(size_t index, size_t bytes_offset = 0)
+    T & getMutableValue(size_t index, size_t bytes_offset = 0)
     {
-        return *getPtrValue<T>(index, bytes_offset);
+        return *getMutablePtrValue<T>(index, bytes_offset);
     }
 
     template <typename T>
     void setValue(size_t index, const T & value, size_t bytes_offset = 0)
     {
-        getValue<T>(index, bytes_offset) = value;
+        getMutableValue<T>(index, bytes_offset) = value;
+    }
+
+    uint32_t key_size_in_bytes = 0;
+    uint32_t max_page_size = 0;
+
+private:
+    FrameView frame;
+    const Marshal * marshal = nullptr;
+};
+
+using BTreePagePtr = PageGuard<BTreePage>;
+
+class BTreePageProvider : public IPageProvider
+{
+public:
+    BTreePageProvider(std::shared_ptr<Marshal> marshal_, uint32_t key_size_in_bytes_, uint32_t max_page_size_)
+        : key_size_in_bytes(key_size_in_bytes_), max_page_size(max_page_size_), marshal(std::move(marshal_))
+    {
     }
 
+    BTreePagePtr getPage(Frame frame) const { return BTreePagePtr(std::move(frame), marshal.get(), key_size_in_bytes, max_page_size); }
+
     const uint32_t key_size_in_bytes;
+
     const uint32_t max_page_size;
 
 private:
-    std::shared_ptr<Frame> frame;
     std::shared_ptr<Marshal> marshal;
 };
 
-using BTreePagePtr = std::shared_ptr<BTreePage>;
-
 /** BTreeMetadataPage, first page in BTree index.
   * Contains necessary metadata information for btree index startup.
   *
@@ -109,6 +128,8 @@ using BTreePagePtr = std::shared_ptr<BTreePage>;
 class BTreeMetadataPage
 {
 public:
+    BTreeMetadataPage() = default;
+
     explicit BTreeMetadataPage(BTreePagePtr page) : page(std::move(page)) { }
 
     static_assert(sizeof(PageIndex) == sizeof(uint32_t));
@@ -207,7 +228,7 @@ public:
 
     void setSize(uint32_t size) { page->setValue(CurrentSizeHeaderIndex, size, BTreePage::HeaderOffset); }
 
-    void increaseSize(uint32_t amount) { page->getValue<uint32_t>(CurrentSizeHeaderIndex, BTreePage::HeaderOffset) += amount; }
+    void increaseSize(uint32_t amount) { page->getMutableValue<uint32_t>(CurrentSizeHeaderIndex, BTreePage::HeaderOffset) += amount; }
 
     Row getKey(size_t index) const
     {
@@ -329,9 +350,16 @@ public:
     }
 
 private:
-    inline uint8_t * getEntryStartOffset(size_t index) const
+    inline const uint8_t * getEntryStartOffset(size_t index) const
     {
-        uint8_t * key_ptr = page->getPtrValue<uint8_t>(0, HeaderOffset);
+        const uint8_t * key_ptr = std::as_const(*page).getPtrValue<uint8_t>(0, HeaderOffset);
+        size_t key_offset = getEntrySize() * index;
+        return key_ptr + key_offset;
+    }
+
+    inline uint8_t * getMutableEntryStartOffset(size_t index)
+    {
+        uint8_t * key_ptr = page->getMutablePtrValue<uint8_t>(0, HeaderOffset);
         size_t key_offset = getEntrySize() * index;
         return key_ptr + key_offset;
     }
@@ -342,7 +370,7 @@ private:
 
     BTreePageItem loadEntry(size_t index) const {
         BTreePageItem item;
-        uint8_t* data = getEntryStartOffset(index);
+        const uint8_t* data = getEntryStartOffset(index);
         if (index != 0)
             item.key = page->getMarshal()->deserializeRow(data);
         item.value = *(data + page->key_size_in_bytes);
@@ -350,7 +378,7 @@ private:
     }
 
     void saveEntry(size_t index, BTreePageItem item) {
-        uint8_t* data = getEntryStartOffset(index);
+        uint8_t* data = getMutableEntryStartOffset(index);
         if (index != 0)
             page->getMarshal()->serializeRow(data, item.key);
         *(data + page->key_size_in_bytes) = item.value;
@@ -398,7 +426,7 @@ public:
 
     void setSize(uint32_t size) { page->setValue(PageSizeHeaderIndex, size, BTreePage::HeaderOffset); }
 
-    void increaseSize(uint32_t amount) { page->getValue<uint32_t>(PageSizeHeaderIndex, BTreePage::HeaderOffset) += amount; }
+    void increaseSize(uint32_t amount) { page->getMutableValue<uint32_t>(PageSizeHeaderIndex, BTreePage::HeaderOffset) += amount; }
 
     PageIndex getPreviousPageIndex() const { return page->getValue<PageIndex>(PreviousPageIdHeaderIndex, BTreePage::HeaderOffset); }
 
@@ -413,14 +441,14 @@ public:
 
     Row getKey(size_t index) const
     {
-        uint8_t* data = getEntryStartOffset(index);
+        const uint8_t* data = getEntryStartOffset(index);
         return page->getMarshal()->deserializeRow(data);
     }
 
     RowId getValue(size_t index) const
     {
         RowId value;
-        uint8_t* data = getEntryStartOffset(index);
+        const uint8_t* data = getEntryStartOffset(index);
         memcpy(&value, data + page->key_size_in_bytes, sizeof(RowId));
         return value;
     }
@@ -549,9 +577,16 @@ public:
     }
 
 private:
-    inline uint8_t * getEntryStartOffset(size_t index) const
+    inline const uint8_t * getEntryStartOffset(size_t index) const
+    {
+        const uint8_t * key_ptr = std::as_const(*page).getPtrValue<uint8_t>(0, HeaderOffset);
+        size_t key_offset = getEntrySize() * index;
+        return key_ptr + key_offset;
+    }
+
+    inline uint8_t * getMutableEntryStartOffset(size_t index)
     {
-        uint8_t * key_ptr = page->getPtrValue<uint8_t>(0, HeaderOffset);
+        uint8_t * key_ptr = page->getMutablePtrValue<uint8_t>(0, HeaderOffset);
         size_t key_offset = getEntrySize() * index;
         return key_ptr + key_offset;
     }
@@ -562,20 +597,20 @@ private:
 
     BTreeLeafItem loadEntry(size_t index) const {
         BTreeLeafItem item;
-        uint8_t* data = getEntryStartOffset(index);
+        const uint8_t* data = getEntryStartOffset(index);
         item.key = page->getMarshal()->deserializeRow(data);
         memcpy(&item.value, data + page->key_size_in_bytes, sizeof(RowId));
         return item;
     }
 
     void saveEntry(size_t index, BTreeLeafItem item) {
-        uint8_t* data = getEntryStartOffset(index);
+        uint8_t* data = getMutableEntryStartOffset(index);
         page->getMarshal()->serializeRow(data, item.key);
         memcpy(data + page->key_size_in_bytes, &item.value, sizeof(RowId));
     }
 };
 
-std::shared_ptr<IPageProvider>
+std::shared_ptr<BTreePageProvider>
 createBTreePageProvider(std::shared_ptr<Marshal> marshal, uint32_t key_size_in_bytes, uint32_t max_page_size);
 
 }
@@ -2,99 +2,498 @@
 
 #include "malloc.h"
 
+#include <algorithm>
 #include <cassert>
+#include <exception>
+#include <tuple>
+#include <utility>
 
 namespace shdb
 {
 
-FramePool::FramePool(std::shared_ptr<Statistics> statistics_, FrameIndex frame_count)
+FramePool::FramePool(std::shared_ptr<Statistics> statistics_, FrameIndex frame_count, BufferPoolOptions options_)
     : frames(frame_count)
-    , cache(
+    , cache(createCache<PageId, FrameIndex>(
+          options_.cache_policy,
           [=]
           {
               std::vector<FrameIndex> free_frames(frame_count);
               FrameIndex index = 0;
               std::generate_n(free_frames.begin(), frame_count, [&] { return index++; });
               return free_frames;
-          }())
+          }()))
     , statistics(std::move(statistics_))
+    , options(options_)
 {
     data = reinterpret_cast<uint8_t *>(pvalloc(frame_count * PageSize));
     for (FrameIndex index = 0; index < frame_count; ++index)
         frames[index].data = data + index * PageSize;
+
+    if (options.flusher_clean_frames_target == 0)
+        options.flusher_clean_frames_target = std::max(frame_count / 4, 1);
+
+    page_io = createPageIO(options.page_io_backend, data, frame_count * PageSize);
+
+    /// Locking frames ahead of the victim in a tiny pool evicts the working set instead of them
+    if (options.enable_background_flusher && frame_count >= MinFlusherFrameCount)
+    {
+        flusher_page_io = createPageIO(options.page_io_backend, data, frame_count * PageSize);
+        flusher = std::thread([this] { runFlusher(); });
+    }
 }
 
 FramePool::~FramePool()
 {
-    for (auto & frame : frames)
-        dumpFrame(frame);
+    if (flusher.joinable())
+    {
+        {
+            std::lock_guard lock(mutex);
+            stop_flusher = true;
+        }
+        flusher_wakeup.notify_one();
+        flusher.join();
+    }
+
+    std::vector<PageIORequest> requests;
+    for (FrameIndex frame_index = 0; frame_index < static_cast<FrameIndex>(frames.size()); ++frame_index)
+    {
+        auto & frame = frames[frame_index];
+        if (frame.file && frame.dirty)
+            requests.push_back(makeRequest(frame_index, true /*write*/));
+    }
+    page_io->execute(requests);
+    statistics->page_written += requests.size();
+
+    page_io.reset();
+    flusher_page_io.reset();
+    idle_read_page_ios.clear();
     free(data);
 }
 
-void FramePool::dumpFrame(Frame & frame)
+PageIORequest FramePool::makeRequest(FrameIndex frame_index, bool write) const
 {
-    if (frame.file)
+    const auto & frame = frames[frame_index];
+    return PageIORequest{frame.file.get(), frame.page_index, frame.data, write, static_cast<uint64_t>(frame_index)};
+}
+
+void FramePool::dumpFrame(FrameIndex frame_index)
+{
+    auto & frame = frames[frame_index];
+    if (frame.file && frame.dirty)
     {
-        frame.file->writePage(frame.data, frame.page_index);
+        auto request = makeRequest(frame_index, true /*write*/);
+        page_io->execute({&request, 1});
+        frame.dirty = false;
         ++statistics->page_written;
     }
 }
 
-std::pair<FrameIndex, uint8_t *> FramePool::acquireFrame(std::shared_ptr<File> file, PageIndex page_index)
+void FramePool::waitLoaded(std::unique_lock<std::mutex> & lock, Frame & frame)
+{
+    load_finished.wait(lock, [&] { return !frame.loading; });
+}
+
+void FramePool::loadFrames(std::unique_lock<std::mutex> & lock, std::span<const PageIORequest> requests, std::span<const PageId> keys)
+{
+    /// Frames are locked and loading, so they are neither evicted nor returned to other threads while mutex is released
+    std::unique_ptr<IPageIO> read_page_io;
+    if (idle_read_page_ios.empty())
+    {
+        read_page_io = createPageIO(options.page_io_backend, data, frames.size() * PageSize);
+    }
+    else
+    {
+        read_page_io = std::move(idle_read_page_ios.back());
+        idle_read_page_ios.pop_back();
+    }
+
+    std::exception_ptr error;
+    lock.unlock();
+    try
+    {
+        read_page_io->execute(requests);
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    lock.lock();
+    idle_read_page_ios.push_back(std::move(read_page_io));
+
+    /// Frames of failed batch hold bytes of their previous pages, so their keys are unmapped and looked up anew
+    for (size_t index = 0; index < keys.size(); ++index)
+    {
+        auto & frame = frames[requests[index].tag];
+        frame.loading = false;
+        if (error)
+        {
+            cache->erase(keys[index]);
+            frame.file.reset();
+            frame.prefetched = false;
+        }
+        else
+        {
+            cache->unlock(keys[index]);
+        }
+    }
+    load_finished.notify_all();
+
+    if (error)
+        std::rethrow_exception(error);
+    statistics->page_read += requests.size();
+}
+
+void FramePool::runFlusher()
+{
+    size_t pages_per_round = options.flusher_max_pages_per_second == 0
+        ? static_cast<size_t>(options.flusher_clean_frames_target)
+        : std::max<size_t>(options.flusher_max_pages_per_second * FlusherInterval.count() / 1000, 1);
+
+    std::vector<FrameIndex> to_flush;
+    std::vector<PageIORequest> requests;
+    std::unique_lock lock(mutex);
+
+    while (true)
+    {
+        if (flusher_idle)
+            flusher_wakeup.wait(lock, [&] { return stop_flusher || flush_requested || !flusher_idle; });
+        /// Pages dirtied one after another are collected for a while, so flusher does not wake up on every modification
+        flusher_wakeup.wait_for(lock, FlusherInterval, [&] { return stop_flusher || flush_requested; });
+        if (stop_flusher)
+            break;
+        flush_requested = false;
+        flusher_idle = false;
+
+        /// Frames that replacement policy is going to evict next are written first, so misses find clean victims
+        to_flush.clear();
+        for (auto frame_index : cache->getEvictionCandidates(options.flusher_clean_frames_target))
+        {
+            auto & frame = frames[frame_index];
+            if (!frame.file || !frame.dirty || frame.flushing)
+                continue;
+
+            /// Locked frame is not chosen as victim, so its page is not read back from disk before the write lands
+            frame.dirty = false;
+            frame.flushing = true;
+            cache->lock(std::make_pair(frame.file->getFd(), frame.page_index));
+            to_flush.push_back(frame_index);
+            if (to_flush.size() == pages_per_round)
+                break;
+        }
+
+        if (to_flush.empty())
+        {
+            flusher_idle = true;
+            continue;
+        }
+
+        /// Modifications made while frame is written mark it dirty again
+        flushing_frame_count += to_flush.size();
+        requests.clear();
+        for (auto frame_index : to_flush)
+            requests.push_back(makeRequest(frame_index, true /*write*/));
+
+        lock.unlock();
+        flusher_page_io->execute(requests);
+        lock.lock();
+
+        for (auto frame_index : to_flush)
+        {
+            auto & frame = frames[frame_index];
+            frame.flushing = false;
+            if (frame.ref_count == 0)
+                cache->unlock(std::make_pair(frame.file->getFd(), frame.page_index));
+        }
+        flushing_frame_count -= to_flush.size();
+        statistics->page_written += to_flush.size();
+        statistics->page_flushed += to_flush.size();
+        flush_finished.notify_all();
+    }
+}
+
+FrameIndex FramePool::evictFrame(std::unique_lock<std::mutex> & lock, const PageId & key)
 {
+    /// Frames being written by flusher are locked in cache, their pages stay mapped until writes reach disk
+    flush_finished.wait(lock, [&] { return cache->getUnlockedCount() > 0 || flushing_frame_count == 0; });
+
+    FrameIndex frame_index = cache->put(key);
+    auto & frame = frames[frame_index];
+    assert(!frame.flushing);
+    if (frame.dirty && flusher.joinable())
+    {
+        flush_requested = true;
+        flusher_wakeup.notify_one();
+    }
+
+    /// Victim page is written without releasing the mutex, so nobody reads it from disk before write completes
+    try
+    {
+        dumpFrame(frame_index);
+    }
+    catch (...)
+    {
+        /// Victim keeps its page, unwritten modifications stay visible to lookups
+        cache->erase(key);
+        if (frame.file)
+        {
+            [[maybe_unused]] auto restored_frame_index = cache->put(std::make_pair(frame.file->getFd(), frame.page_index));
+            assert(restored_frame_index == frame_index);
+        }
+        throw;
+    }
+
+    /// Key is visible to other threads once mutex is released. Loading frame can not be evicted again,
+    /// and lookups of the key wait until its read completes.
+    cache->lock(key);
+    frame.loading = true;
+
+    /// Prefetched page was evicted before anyone used it, read-ahead for this file is too aggressive
+    if (frame.prefetched)
+    {
+        auto & state = getReadAheadStreams(frame.file->getFd())[frame.read_ahead_stream];
+        state.window = std::max<PageIndex>(state.window / 2, 1);
+        frame.prefetched = false;
+    }
+
+    return frame_index;
+}
+
+std::pair<FrameIndex, uint8_t *> FramePool::acquireFrame(const std::shared_ptr<File> & file, PageIndex page_index)
+{
+    std::unique_lock lock(mutex);
     FrameIndex frame_index;
+    std::optional<size_t> read_ahead_stream;
     auto key = std::make_pair(file->getFd(), page_index);
-    if (auto [found, index] = cache.find(key); found)
+    auto [found, index] = cache->peek(key);
+    while (found && frames[index].loading)
+    {
+        /// Frame may be evicted again once read-ahead unlocks it, so the key is looked up anew
+        waitLoaded(lock, frames[index]);
+        std::tie(found, index) = cache->peek(key);
+    }
+
+    if (found)
     {
         frame_index = index;
-        assert(frames[frame_index].page_index == page_index);
-        assert(frames[frame_index].file->getFd() == file->getFd());
+        auto & frame = frames[frame_index];
+        assert(frame.page_index == page_index);
+        assert(frame.file->getFd() == file->getFd());
+        if (frame.prefetched)
+        {
+            /// First use of prefetched page is its first reference, policy must not see scanned pages as used twice
+            frame.prefetched = false;
+            ++statistics->readahead_hit;
+            if (onReadAheadHit(key, frame.read_ahead_stream))
+                read_ahead_stream = frame.read_ahead_stream;
+        }
+        else
+        {
+            cache->find(key);
+        }
     }
     else
     {
-        frame_index = cache.put(key);
+        frame_index = evictFrame(lock, key);
         auto & frame = frames[frame_index];
-        dumpFrame(frame);
-        frame.file = std::move(file);
+        frame.file = file;
         frame.page_index = page_index;
-        frame.file->readPage(frame.data, frame.page_index);
-        ++statistics->page_read;
+        auto request = makeRequest(frame_index, false /*write*/);
+        loadFrames(lock, {&request, 1}, {&key, 1});
+        read_ahead_stream = onMiss(key);
     }
     ++frames[frame_index].ref_count;
     if (frames[frame_index].ref_count == 1)
-        cache.lock(key);
+        cache->lock(key);
     ++statistics->page_accessed;
+
+    /// Requested frame is pinned, so read-ahead cannot evict it
+    if (read_ahead_stream)
+        readAhead(lock, file, *read_ahead_stream, page_index + 1);
+
     return {frame_index, frames[frame_index].data};
 }
 
+std::vector<FramePool::ReadAheadState> & FramePool::getReadAheadStreams(int fd)
+{
+    auto & streams = read_ahead_states[fd];
+    if (streams.empty())
+        streams.resize(MaxReadAheadStreams);
+    return streams;
+}
+
+std::optional<size_t> FramePool::onMiss(const PageId & key)
+{
+    if (getMaxReadAheadWindow() == 0)
+        return std::nullopt;
+
+    auto & streams = getReadAheadStreams(key.first);
+    auto stream = std::find_if(
+        streams.begin(), streams.end(), [&](const auto & state) { return state.last_page != InvalidPageIndex && key.second == state.last_page + 1; });
+    bool sequential = stream != streams.end();
+    if (!sequential)
+    {
+        /// Miss starts a new reader, it is sequential once the next page misses as well
+        stream = std::min_element(
+            streams.begin(), streams.end(), [](const auto & lhs, const auto & rhs) { return lhs.last_used < rhs.last_used; });
+        *stream = ReadAheadState{};
+    }
+    stream->last_page = key.second;
+    stream->last_used = ++read_ahead_clock;
+    if (!sequential)
+        return std::nullopt;
+    return stream - streams.begin();
+}
+
+bool FramePool::onReadAheadHit(const PageId & key, size_t stream)
+{
+    auto & state = getReadAheadStreams(key.first)[stream];
+    state.last_page = key.second;
+    state.last_used = ++read_ahead_clock;
+    state.window = std::min<PageIndex>(state.window * 2, getMaxReadAheadWindow());
+
+    /// Reader reached the end of prefetched range, continue with the next one
+    return key.second == state.prefetched_until;
+}
+
+PageIndex FramePool::getMaxReadAheadWindow() const
+{
+    /// Prefetching into a tiny pool evicts the working set it is supposed to serve, read-ahead gets at most
+    /// a quarter of the pool and stays off if that does not fit the initial window
+    auto pool_share = static_cast<PageIndex>(frames.size()) / 4;
+    if (pool_share < ReadAheadState{}.window)
+        return 0;
+    return std::min<PageIndex>(options.max_read_ahead_pages, pool_share);
+}
+
+void FramePool::readAhead(std::unique_lock<std::mutex> & lock, const std::shared_ptr<File> & file, size_t stream, PageIndex from_page_index)
+{
+    auto & state = getReadAheadStreams(file->getFd())[stream];
+    state.window = std::clamp<PageIndex>(state.window, 1, getMaxReadAheadWindow());
+    PageIndex to_page_index = std::min<PageIndex>(from_page_index + state.window, file->getPageCount());
+    if (to_page_index > from_page_index)
+        state.prefetched_until = to_page_index - 1;
+
+    /// Prefetched frames stay locked and loading until their reads complete, so batch cannot evict its own pages
+    /// and concurrent lookups do not see frames mapped earlier in the batch before they are read
+    std::vector<PageIORequest> requests;
+    std::vector<PageId> keys;
+    for (PageIndex page_index = from_page_index; page_index < to_page_index && cache->getUnlockedCount() > 0; ++page_index)
+    {
+        auto key = std::make_pair(file->getFd(), page_index);
+        if (cache->contains(key))
+            continue;
+
+        FrameIndex frame_index;
+        try
+        {
+            frame_index = evictFrame(lock, key);
+        }
+        catch (const std::exception &)
+        {
+            /// Victim could not be written back, pages mapped so far are still read
+            break;
+        }
+        auto & frame = frames[frame_index];
+        frame.file = file;
+        frame.page_index = page_index;
+        frame.prefetched = true;
+        frame.read_ahead_stream = stream;
+        requests.push_back(makeRequest(frame_index, false /*write*/));
+        keys.push_back(key);
+    }
+
+    if (requests.empty())
+        return;
+
+    /// Prefetch is speculative, pages that failed to load are read again on demand and report errors there
+    try
+    {
+        loadFrames(lock, requests, keys);
+    }
+    catch (const std::exception &)
+    {
+        return;
+    }
+    statistics->page_prefetched += requests.size();
+}
+
 void FramePool::releaseFrame(FrameIndex frame_index)
 {
+    std::lock_guard lock(mutex);
     auto & frame = frames[frame_index];
     --frame.ref_count;
-    if (frame.ref_count == 0)
-        cache.unlock(std::make_pair(frame.file->getFd(), frame.page_index));
+    if (frame.ref_count == 0 && !frame.flushing)
+        cache->unlock(std::make_pair(frame.file->getFd(), frame.page_index));
+}
+
+void FramePool::markDirty(FrameIndex frame_index)
+{
+    frames[frame_index].dirty.store(true, std::memory_order_relaxed);
+
+    /// Idle flusher is woken up once, later modifications only check the flag.
+    /// Wakeup taken under the mutex is not lost between flusher setting the flag and starting to wait.
+    if (flusher_idle.load(std::memory_order_relaxed) && flusher.joinable() && flusher_idle.exchange(false))
+    {
+        std::lock_guard lock(mutex);
+        flusher_wakeup.notify_one();
+    }
 }
 
-Frame::Frame(std::shared_ptr<FramePool> frame_pool, FrameIndex frame_index, uint8_t * data)
-    : frame_pool(std::move(frame_pool)), frame_index(frame_index), data(data)
+FrameView::FrameView(FramePool * frame_pool, FrameIndex frame_index, uint8_t * data)
+    : frame_pool(frame_pool), frame_index(frame_index), data(data)
 {
 }
 
+uint8_t * FrameView::getMutableData() const
+{
+    if (frame_pool)
+        frame_pool->markDirty(frame_index);
+    return data;
+}
+
+Frame::Frame(FramePool * frame_pool, FrameIndex frame_index, uint8_t * data)
+    : frame_pool(frame_pool), frame_index(frame_index), view(frame_pool, frame_index, data)
+{
+}
+
+Frame::Frame(Frame && other) noexcept
+    : frame_pool(std::exchange(other.frame_pool, nullptr)), frame_index(other.frame_index), view(std::exchange(other.view, {}))
+{
+}
+
+Frame & Frame::operator=(Frame && other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        frame_pool = std::exchange(other.frame_pool, nullptr);
+        frame_index = other.frame_index;
+        view = std::exchange(other.view, {});
+    }
+    return *this;
+}
+
 Frame::~Frame()
+{
+    release();
+}
+
+void Frame::release()
 {
     if (frame_pool)
         frame_pool->releaseFrame(frame_index);
+    frame_pool = nullptr;
 }
 
-BufferPool::BufferPool(std::shared_ptr<Statistics> statistics, FrameIndex frame_count)
-    : frame_pool(std::make_shared<FramePool>(std::move(statistics), frame_count))
+BufferPool::BufferPool(std::shared_ptr<Statistics> statistics, FrameIndex frame_count, BufferPoolOptions options)
+    : frame_pool(std::make_shared<FramePool>(std::move(statistics), frame_count, options))
 {
 }
 
-std::shared_ptr<Frame> BufferPool::getPage(std::shared_ptr<File> file, PageIndex page_index)
+Frame BufferPool::getPage(const std::shared_ptr<File> & file, PageIndex page_index)
 {
     auto [frame_index, data] = frame_pool->acquireFrame(file, page_index);
-    return std::make_shared<Frame>(frame_pool, frame_index, data);
+    return Frame(frame_pool.get(), frame_index, data);
 }
 
 }
@@ -1,10 +1,19 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "cache.h"
 #include "file.h"
 #include "page.h"
+#include "page_io.h"
 #include "statistics.h"
 
 namespace shdb
@@ -12,19 +21,46 @@ namespace shdb
 
 using FrameIndex = int;
 
+struct BufferPoolOptions
+{
+    /// Clean dirty frames in background before replacement policy chooses them as victims.
+    /// Flusher thread sleeps until a frame is dirtied and wakes up each FlusherInterval only while it finds work.
+    /// Frames being written can not be evicted, so pools under 16 frames never start the flusher.
+    bool enable_background_flusher = true;
+
+    /// How many frames ahead of the victim pointer flusher tries to keep clean, 0 means a quarter of the pool
+    FrameIndex flusher_clean_frames_target = 0;
+
+    /// Upper bound on background page writes per second, 0 means unlimited
+    size_t flusher_max_pages_per_second = 4096;
+
+    /// Page reads and writes backend, falls back to synchronous I/O if io_uring is unavailable
+    PageIOBackend page_io_backend = PageIOBackend::sync;
+
+    /// Upper bound on pages prefetched at once after sequential misses are detected, 0 disables read-ahead.
+    /// Read-ahead never takes more than a quarter of the pool and is off in pools under 16 frames.
+    PageIndex max_read_ahead_pages = 32;
+
+    /// Replacement policy, 2Q and ARC keep frequently used pages resident during large scans
+    CachePolicy cache_policy = CachePolicy::clock;
+};
+
 class FramePool
 {
 public:
-    FramePool(std::shared_ptr<Statistics> statistics, FrameIndex frame_count);
+    FramePool(std::shared_ptr<Statistics> statistics, FrameIndex frame_count, BufferPoolOptions options = {});
 
     ~FramePool();
 
     FramePool(const FramePool & other) = delete;
 
-    std::pair<FrameIndex, uint8_t *> acquireFrame(std::shared_ptr<File> file, PageIndex page_index);
+    std::pair<FrameIndex, uint8_t *> acquireFrame(const std::shared_ptr<File> & file, PageIndex page_index);
 
     void releaseFrame(FrameIndex frame_index);
 
+    /// Mark frame as modified, only dirty frames are written back on eviction. Caller must keep frame pinned.
+    void markDirty(FrameIndex frame_index);
+
 private:
     struct Frame
     {
@@ -32,42 +68,147 @@ private:
         std::shared_ptr<File> file;
         PageIndex page_index = 0;
         size_t ref_count = 0;
+        /// Set by pin holders without taking the mutex, cleared under the mutex only for unpinned frames
+        std::atomic<bool> dirty = false;
+        /// Flusher is writing the page, frame stays locked in cache until write completes
+        bool flushing = false;
+        /// Frame is mapped to its page in cache, but page read has not completed yet. Frame stays locked in cache meanwhile.
+        bool loading = false;
+        bool prefetched = false;
+        /// Read-ahead stream of file that prefetched the page
+        size_t read_ahead_stream = 0;
+    };
+
+    /// Sequential access detection for a single reader of file. Several scans of one file, like slices of a parallel
+    /// scan, interleave their misses, so each of them continues its own stream.
+    struct ReadAheadState
+    {
+        PageIndex last_page = InvalidPageIndex;
+        PageIndex prefetched_until = InvalidPageIndex;
+        PageIndex window = 4;
+        /// Stream that was not used for longest is taken by a new reader
+        uint64_t last_used = 0;
     };
 
-    void dumpFrame(Frame & frame);
+    static constexpr size_t MaxReadAheadStreams = 64;
+
+    PageIORequest makeRequest(FrameIndex frame_index, bool write) const;
+
+    void dumpFrame(FrameIndex frame_index);
+
+    /// Maps key to a victim frame that is locked in cache and marked loading, caller reads page with loadFrames.
+    /// If victim can not be written back, key is not mapped and victim keeps its page.
+    FrameIndex evictFrame(std::unique_lock<std::mutex> & lock, const PageId & key);
+
+    /// Reads pages into frames returned by evictFrame and unlocks them in cache, mutex is released during I/O.
+    /// On failure keys are unmapped and the error is rethrown.
+    void loadFrames(std::unique_lock<std::mutex> & lock, std::span<const PageIORequest> requests, std::span<const PageId> keys);
+
+    /// Streams of file, created once so references to them stay valid
+    std::vector<ReadAheadState> & getReadAheadStreams(int fd);
+
+    /// Returns stream that continues with read-ahead after the missed page
+    std::optional<size_t> onMiss(const PageId & key);
+
+    bool onReadAheadHit(const PageId & key, size_t stream);
+
+    PageIndex getMaxReadAheadWindow() const;
+
+    void readAhead(std::unique_lock<std::mutex> & lock, const std::shared_ptr<File> & file, size_t stream, PageIndex from_page_index);
+
+    void waitLoaded(std::unique_lock<std::mutex> & lock, Frame & frame);
+
+    void runFlusher();
+
+    static constexpr std::chrono::milliseconds FlusherInterval{10};
+    static constexpr FrameIndex MinFlusherFrameCount = 16;
 
     uint8_t * data;
     std::vector<Frame> frames;
-    ClockCache<PageId, FrameIndex> cache;
+    std::unique_ptr<ICache<PageId, FrameIndex>> cache;
     std::shared_ptr<Statistics> statistics;
+    BufferPoolOptions options;
+    /// Writes back victims under the mutex
+    std::unique_ptr<IPageIO> page_io;
+    /// Backends are not thread safe, each read outside the mutex takes one of these or creates a new one
+    std::vector<std::unique_ptr<IPageIO>> idle_read_page_ios;
+    std::unordered_map<int, std::vector<ReadAheadState>> read_ahead_states;
+    uint64_t read_ahead_clock = 0;
+
+    std::mutex mutex;
+    std::condition_variable flusher_wakeup;
+    std::condition_variable flush_finished;
+    std::condition_variable load_finished;
+    bool flush_requested = false;
+    size_t flushing_frame_count = 0;
+    bool stop_flusher = false;
+    /// Flusher found no dirty eviction candidates and waits for markDirty without timeout
+    std::atomic<bool> flusher_idle = true;
+    std::unique_ptr<IPageIO> flusher_page_io;
+    std::thread flusher;
+};
+
+/// Non-owning access to bytes of a pinned frame, valid while the frame stays pinned
+class FrameView
+{
+public:
+    FrameView() = default;
+
+    FrameView(FramePool * frame_pool, FrameIndex frame_index, uint8_t * data);
+
+    const uint8_t * getData() const { return data; }
+
+    /// Returns frame data for modification and marks frame dirty
+    uint8_t * getMutableData() const;
+
+private:
+    FramePool * frame_pool = nullptr;
+    FrameIndex frame_index = 0;
+    uint8_t * data = nullptr;
 };
 
+/// Move-only pin of a frame, frame can not be evicted until pin is destroyed.
+/// Pin does not own the pool, pages must not outlive the buffer pool they were taken from.
 class Frame
 {
 public:
-    Frame(std::shared_ptr<FramePool> frame_pool, FrameIndex frame_index, uint8_t * data);
+    Frame() = default;
+
+    Frame(FramePool * frame_pool, FrameIndex frame_index, uint8_t * data);
+
+    Frame(const Frame & other) = delete;
+
+    Frame & operator=(const Frame & other) = delete;
+
+    Frame(Frame && other) noexcept;
+
+    Frame & operator=(Frame && other) noexcept;
 
     ~Frame();
 
-    const uint8_t * getData() const { return data; }
+    const FrameView & getView() const { return view; }
+
+    const uint8_t * getData() const { return view.getData(); }
 
-    uint8_t * getData() { return data; }
+    /// Returns frame data for modification and marks frame dirty
+    uint8_t * getMutableData() { return view.getMutableData(); }
 
 private:
-    std::shared_ptr<FramePool> frame_pool;
-    size_t frame_index;
-    uint8_t * data;
+    void release();
+
+    FramePool * frame_pool = nullptr;
+    FrameIndex frame_index = 0;
+    FrameView view;
 };
 
 class BufferPool
 {
 public:
-    BufferPool(std::shared_ptr<Statistics> statistics, FrameIndex frame_count);
+    BufferPool(std::shared_ptr<Statistics> statistics, FrameIndex frame_count, BufferPoolOptions options = {});
 
-    std::shared_ptr<Frame> getPage(std::shared_ptr<File> file, PageIndex page_index);
+    Frame getPage(const std::shared_ptr<File> & file, PageIndex page_index);
 
 private:
-    friend class Frame;
     std::shared_ptr<FramePool> frame_pool;
 };
 
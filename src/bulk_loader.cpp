@@ -0,0 +1,323 @@
+#include "bulk_loader.h"
+
+#include <charconv>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+namespace shdb
+{
+
+namespace
+{
+
+/// Bytes of file every thread parses in one round
+constexpr size_t ChunkSize = 4 << 20;
+
+struct BuiltPages
+{
+    std::vector<uint8_t> data;
+    size_t page_count = 0;
+    size_t row_count = 0;
+};
+
+class RecordParser
+{
+public:
+    RecordParser(const Schema & schema, char delimiter) : schema(schema), delimiter(delimiter) { }
+
+    /// Parses record starting at begin into row, returns position after it. Blank lines give empty rows.
+    const char * parse(const char * begin, const char * end, Row & row)
+    {
+        row.clear();
+        const char * pos = begin;
+        if (pos != end && (*pos == '\n' || *pos == '\r'))
+            return skipLineBreak(pos, end);
+
+        while (true)
+        {
+            if (pos != end && *pos == '"')
+            {
+                pos = parseQuoted(pos + 1, end);
+                addValue(unquoted, true, row);
+            }
+            else
+            {
+                const char * field_end = pos;
+                while (field_end != end && *field_end != delimiter && *field_end != '\n' && *field_end != '\r')
+                    ++field_end;
+                addValue(std::string_view(pos, field_end - pos), false, row);
+                pos = field_end;
+            }
+
+            if (pos == end || *pos == '\n' || *pos == '\r')
+                break;
+            if (*pos != delimiter)
+                throw std::runtime_error("Unexpected characters after quoted field");
+            ++pos;
+        }
+
+        if (row.size() != schema.size())
+            throw std::runtime_error(
+                "Record has " + std::to_string(row.size()) + " fields, table has " + std::to_string(schema.size()) + " columns");
+        return skipLineBreak(pos, end);
+    }
+
+private:
+    static const char * skipLineBreak(const char * pos, const char * end)
+    {
+        if (pos != end && *pos == '\r')
+            ++pos;
+        if (pos != end && *pos == '\n')
+            ++pos;
+        return pos;
+    }
+
+    /// Unescapes quoted field into buffer, returns position after closing quote
+    const char * parseQuoted(const char * pos, const char * end)
+    {
+        unquoted.clear();
+        while (true)
+        {
+            if (pos == end)
+                throw std::runtime_error("Unterminated quoted field");
+            if (*pos != '"')
+            {
+                unquoted.push_back(*pos++);
+                continue;
+            }
+            if (pos + 1 != end && pos[1] == '"')
+            {
+                unquoted.push_back('"');
+                pos += 2;
+                continue;
+            }
+            return pos + 1;
+        }
+    }
+
+    template <class T>
+    static T parseNumber(std::string_view field, const ColumnSchema & column)
+    {
+        T result{};
+        auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), result);
+        if (error != std::errc() || end != field.data() + field.size())
+            throw std::runtime_error("Invalid value \"" + std::string(field) + "\" of column " + column.name);
+        return result;
+    }
+
+    void addValue(std::string_view field, bool quoted, Row & row)
+    {
+        if (row.size() >= schema.size())
+        {
+            row.emplace_back(Null{});
+            return;
+        }
+
+        const auto & column = schema[row.size()];
+        if (field.empty() && !quoted)
+        {
+            row.emplace_back(Null{});
+            return;
+        }
+
+        switch (column.type)
+        {
+            case Type::boolean:
+                if (field == "true" || field == "t" || field == "1")
+                    row.emplace_back(true);
+                else if (field == "false" || field == "f" || field == "0")
+                    row.emplace_back(false);
+                else
+                    throw std::runtime_error("Invalid value \"" + std::string(field) + "\" of column " + column.name);
+                return;
+            case Type::uint64:
+                row.emplace_back(parseNumber<uint64_t>(field, column));
+                return;
+            case Type::int64:
+                row.emplace_back(parseNumber<int64_t>(field, column));
+                return;
+            case Type::varchar:
+                if (field.size() > column.length)
+                    throw std::runtime_error("Value of column " + column.name + " is longer than " + std::to_string(column.length));
+                row.emplace_back(std::string(field));
+                return;
+            case Type::string:
+                row.emplace_back(std::string(field));
+                return;
+        }
+    }
+
+    const Schema & schema;
+    char delimiter;
+    std::string unquoted;
+};
+
+/// Positions after first record end at or after every target and after the last complete record.
+/// Line breaks inside quoted fields do not end records. Quotes are tracked per field like RecordParser does,
+/// only a quote at field start opens a quoted field and doubled quote inside it is an escaped quote.
+std::vector<size_t> findRecordEnds(std::string_view data, char delimiter, const std::vector<size_t> & targets, bool complete)
+{
+    std::vector<size_t> ends;
+    size_t last_end = 0;
+    bool in_quotes = false;
+    bool field_start = true;
+    for (size_t pos = 0; pos < data.size(); ++pos)
+    {
+        char c = data[pos];
+        if (in_quotes)
+        {
+            if (c == '"' && pos + 1 < data.size() && data[pos + 1] == '"')
+                ++pos;
+            else if (c == '"')
+                in_quotes = false;
+            continue;
+        }
+
+        if (c == '"' && field_start)
+        {
+            in_quotes = true;
+            field_start = false;
+            continue;
+        }
+
+        field_start = c == delimiter || c == '\n';
+        if (c == '\n')
+        {
+            last_end = pos + 1;
+            while (ends.size() < targets.size() && targets[ends.size()] <= pos)
+                ends.push_back(last_end);
+        }
+    }
+    if (complete)
+        last_end = data.size();
+    while (ends.size() < targets.size())
+        ends.push_back(last_end);
+    for (auto & end : ends)
+        end = std::min(end, last_end);
+    ends.push_back(last_end);
+    return ends;
+}
+
+BuiltPages buildPages(const ITablePageProvider & provider, const Schema & schema, char delimiter, std::string_view records)
+{
+    BuiltPages pages;
+    RecordParser parser(schema, delimiter);
+    Row row;
+    FrameView frame;
+    const char * pos = records.data();
+    const char * end = records.data() + records.size();
+    while (pos != end)
+    {
+        pos = parser.parse(pos, end, row);
+        if (row.empty())
+            continue;
+
+        if (pages.page_count == 0 || !provider.insertRow(frame, row).first)
+        {
+            pages.data.resize(pages.data.size() + PageSize);
+            frame = FrameView(nullptr, 0, pages.data.data() + pages.page_count * PageSize);
+            ++pages.page_count;
+            if (!provider.insertRow(frame, row).first)
+                throw std::runtime_error("Row does not fit into an empty page");
+        }
+        ++pages.row_count;
+    }
+    return pages;
+}
+
+}
+
+char getDefaultDelimiter(const std::filesystem::path & path)
+{
+    return path.extension() == ".tsv" ? '\t' : ',';
+}
+
+size_t copyFromFile(ITable & table, const Schema & schema, const std::filesystem::path & path, const CopyOptions & options)
+{
+    std::ifstream input(path, std::ios::binary);
+    if (!input)
+        throw std::runtime_error("Unable to open file " + path.string());
+
+    size_t thread_count = options.threads != 0 ? options.threads : std::max(1U, std::thread::hardware_concurrency());
+    const auto & provider = table.getPageProvider();
+    bool skip_header = options.header;
+    size_t row_count = 0;
+    std::string buffer;
+
+    while (true)
+    {
+        auto carried = buffer.size();
+        buffer.resize(carried + thread_count * ChunkSize);
+        input.read(buffer.data() + carried, thread_count * ChunkSize);
+        buffer.resize(carried + input.gcount());
+        bool complete = input.eof();
+
+        std::vector<size_t> targets;
+        for (size_t index = 1; index < thread_count; ++index)
+            targets.push_back(buffer.size() * index / thread_count);
+        auto ends = findRecordEnds(buffer, options.delimiter, targets, complete);
+
+        size_t begin = 0;
+        if (skip_header && ends.back() != 0)
+        {
+            begin = findRecordEnds(buffer, options.delimiter, {0}, complete)[0];
+            skip_header = false;
+        }
+
+        std::vector<BuiltPages> built(ends.size());
+        std::vector<std::exception_ptr> errors(ends.size());
+        std::vector<std::thread> threads;
+        for (size_t index = 0; index < ends.size(); ++index)
+        {
+            auto segment_begin = std::max(begin, index == 0 ? 0 : ends[index - 1]);
+            auto segment_end = std::max(segment_begin, ends[index]);
+            auto records = std::string_view(buffer).substr(segment_begin, segment_end - segment_begin);
+            if (records.empty())
+                continue;
+            threads.emplace_back(
+                [&, index, records]
+                {
+                    try
+                    {
+                        built[index] = buildPages(provider, schema, options.delimiter, records);
+                    }
+                    catch (...)
+                    {
+                        errors[index] = std::current_exception();
+                    }
+                });
+        }
+        for (auto & thread : threads)
+            thread.join();
+        for (const auto & error : errors)
+        {
+            if (!error)
+                continue;
+            try
+            {
+                std::rethrow_exception(error);
+            }
+            catch (const std::exception & exception)
+            {
+                throw std::runtime_error(
+                    std::string(exception.what()) + ", " + std::to_string(row_count) + " rows were loaded before the error");
+            }
+        }
+
+        for (const auto & pages : built)
+        {
+            table.appendPages(pages.data.data(), pages.page_count);
+            row_count += pages.row_count;
+        }
+
+        buffer.erase(0, ends.back());
+        if (complete)
+            break;
+    }
+
+    return row_count;
+}
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <filesystem>
+
+#include "schema.h"
+#include "table.h"
+
+namespace shdb
+{
+
+struct CopyOptions
+{
+    char delimiter = ',';
+    /// First record holds column names and is skipped
+    bool header = false;
+    /// Parsing threads, hardware concurrency if zero
+    size_t threads = 0;
+};
+
+/// Delimiter of a file by its extension, tab for .tsv and comma otherwise
+char getDefaultDelimiter(const std::filesystem::path & path);
+
+/// Appends records of a delimited text file to table, returns number of loaded rows.
+/// Chunks of file are parsed by several threads into pages built in memory, pages are appended to table file
+/// with large sequential writes. Unquoted empty fields are nulls, quoted fields may contain delimiters,
+/// line breaks and doubled quotes.
+/// Load is not atomic, file is processed in rounds of threads * 4MiB and every round is appended once all of its
+/// records are parsed. On error rows of earlier rounds stay in table, exception message tells how many there are.
+size_t copyFromFile(ITable & table, const Schema & schema, const std::filesystem::path & path, const CopyOptions & options = {});
+
+}
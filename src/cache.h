@@ -1,61 +1,156 @@
 #pragma once
 
+#include <algorithm>
+#include <iterator>
 #include <vector>
-#include <map>
+#include <memory>
+#include <stdexcept>
 #include <cassert>
 
+#include "page_table.h"
+
 namespace shdb
 {
 
+enum class CachePolicy
+{
+    clock,
+    two_queue,
+    arc,
+};
+
+/// Replacement policy over a fixed set of frames. Locked frames are never chosen as victims.
+template <class PageId, class FrameIndex>
+class ICache
+{
+public:
+    virtual ~ICache() = default;
+
+    /// Maps page to a frame, evicting a victim if needed
+    virtual FrameIndex put(const PageId& pageId) = 0;
+
+    /// Looks up page and records an access on hit
+    virtual std::pair<bool, FrameIndex> find(const PageId& pageId) = 0;
+
+    /// Looks up page without recording an access
+    virtual std::pair<bool, FrameIndex> peek(const PageId& pageId) const = 0;
+
+    virtual bool contains(const PageId& pageId) const = 0;
+
+    /// Unmaps page, its frame is the one next put returns
+    virtual void erase(const PageId& pageId) = 0;
+
+    virtual void lock(const PageId& pageId) = 0;
+
+    virtual void unlock(const PageId& pageId) = 0;
+
+    virtual size_t getUnlockedCount() const = 0;
+
+    /// Returns up to count unlocked frames in order policy is going to evict them
+    virtual std::vector<FrameIndex> getEvictionCandidates(size_t count) const = 0;
+};
+
 template <class PageId, class FrameIndex>
-class ClockCache
+class ClockCache : public ICache<PageId, FrameIndex>
 {
 public:
-    explicit ClockCache(std::vector<FrameIndex> frame_index): frames(std::move(frame_index)) {
+    explicit ClockCache(std::vector<FrameIndex> frame_index): frames(std::move(frame_index)), map(frames.size()) {
         size = frames.size();
         isLocked.assign(frames.size(), false);
         isRead.assign(frames.size(), false);
         itemToPageId.resize(frames.size());
     }
 
-    FrameIndex put(const PageId& pageId) {
-        while (true) {
+    FrameIndex put(const PageId& pageId) override {
+        /// Two sweeps clear every reference bit, so finding no victim after them means all frames are pinned
+        for (size_t step = 0;; ++step) {
+            if (step > 2 * size) {
+                throw std::runtime_error("All frames are pinned");
+            }
             if (isRead[ptr]) {
                 isRead[ptr] = false;
                 moveNext();
             } else if (isLocked[ptr]) {
                 moveNext();
             } else {
-                map.erase(itemToPageId[ptr]);
+                if (auto* slot = map.find(itemToPageId[ptr]); slot && *slot == ptr) {
+                    map.erase(itemToPageId[ptr]);
+                }
                 itemToPageId[ptr] = pageId;
-                map[pageId] = ptr;
-                return frames[ptr];
+                map.insertOrAssign(pageId, ptr);
+                FrameIndex result = frames[ptr];
+                moveNext();
+                return result;
             }
         }
     }
 
-    std::pair<bool, FrameIndex> find(const PageId& pageId) {
-        auto it = map.find(pageId);
-        if (it == map.end()) {
+    std::pair<bool, FrameIndex> find(const PageId& pageId) override {
+        auto* slot = map.find(pageId);
+        if (!slot) {
+            return {false, 0};
+        }
+        isRead[*slot] = true;
+        return {true, frames[*slot]};
+    }
+
+    std::pair<bool, FrameIndex> peek(const PageId& pageId) const override {
+        const auto* slot = map.find(pageId);
+        if (!slot) {
             return {false, 0};
         }
-        FrameIndex index = it->second;
-        isRead[index] = true;
-        return {true, index};
+        return {true, frames[*slot]};
     }
 
-    void lock(const PageId& pageId) {
-        assert(map.find(pageId) != map.end());
-        FrameIndex index = map[pageId];
-        isLocked[index] = true;
+    bool contains(const PageId& pageId) const override {
+        return map.contains(pageId);
     }
 
-    void unlock(const PageId& pageId) {
-        assert(map.find(pageId) != map.end());
-        FrameIndex index = map[pageId];
-        isLocked[index] = false;
+    void erase(const PageId& pageId) override {
+        assert(map.contains(pageId));
+        int index = *map.find(pageId);
         map.erase(pageId);
+        if (isLocked[index]) {
+            isLocked[index] = false;
+            --lockedCount;
+        }
+        isRead[index] = false;
+        ptr = index;
+    }
+
+    void lock(const PageId& pageId) override {
+        assert(map.contains(pageId));
+        int index = *map.find(pageId);
+        if (!isLocked[index]) {
+            isLocked[index] = true;
+            ++lockedCount;
+        }
+    }
+
+    size_t getUnlockedCount() const override {
+        return size - lockedCount;
+    }
+
+    /// Returns up to count frames in order clock hand is going to evict them, without moving the hand
+    std::vector<FrameIndex> getEvictionCandidates(size_t count) const override {
+        std::vector<FrameIndex> result;
+        size_t position = ptr;
+        for (size_t step = 0; step < size && result.size() < count; ++step) {
+            if (!isLocked[position] && !isRead[position]) {
+                result.push_back(frames[position]);
+            }
+            position = position + 1 == size ? 0 : position + 1;
+        }
+        return result;
+    }
 
+    void unlock(const PageId& pageId) override {
+        assert(map.contains(pageId));
+        int index = *map.find(pageId);
+        if (isLocked[index]) {
+            isLocked[index] = false;
+            --lockedCount;
+        }
     }
 
 private:
@@ -67,13 +162,452 @@ private:
     }
 
     std::vector<FrameIndex> frames;
+    PageTable<PageId, int> map;
     std::vector<bool> isLocked;
     std::vector<bool> isRead;
     std::vector<PageId> itemToPageId;
-    std::map<PageId, FrameIndex> map;
     size_t size = 0;
+    size_t lockedCount = 0;
     int ptr = 0;
 };
 
+/// Doubly linked lists threaded through a fixed set of nodes by index. Every node is in at most one list,
+/// moving a node between lists only relinks indices and never allocates.
+class IndexLists
+{
+public:
+    static constexpr size_t None = static_cast<size_t>(-1);
+
+    IndexLists(size_t nodeCount, size_t listCount): nodes(nodeCount), lists(listCount) {
+    }
+
+    /// Moves node to the back of list, detaching it from its current list first
+    void pushBack(size_t node, size_t list) {
+        detach(node);
+        auto& entry = lists[list];
+        nodes[node] = Node{entry.tail, None, list};
+        if (entry.tail != None) {
+            nodes[entry.tail].next = node;
+        } else {
+            entry.head = node;
+        }
+        entry.tail = node;
+        ++entry.size;
+    }
+
+    void detach(size_t node) {
+        auto& current = nodes[node];
+        if (current.list == None) {
+            return;
+        }
+        auto& entry = lists[current.list];
+        (current.prev != None ? nodes[current.prev].next : entry.head) = current.next;
+        (current.next != None ? nodes[current.next].prev : entry.tail) = current.prev;
+        --entry.size;
+        current = Node{};
+    }
+
+    size_t front(size_t list) const {
+        return lists[list].head;
+    }
+
+    size_t next(size_t node) const {
+        return nodes[node].next;
+    }
+
+    size_t getList(size_t node) const {
+        return nodes[node].list;
+    }
+
+    size_t size(size_t list) const {
+        return lists[list].size;
+    }
+
+private:
+    struct Node
+    {
+        size_t prev = None;
+        size_t next = None;
+        size_t list = None;
+    };
+
+    struct List
+    {
+        size_t head = None;
+        size_t tail = None;
+        size_t size = 0;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<List> lists;
+};
+
+/// Frames resident in a set of recency lists, shared bookkeeping of 2Q and ARC
+template <class PageId, class FrameIndex>
+class ListCacheBase : public ICache<PageId, FrameIndex>
+{
+public:
+    explicit ListCacheBase(std::vector<FrameIndex> frame_index, size_t listCount): frames(std::move(frame_index)), map(frames.size()), lists(frames.size(), listCount) {
+        slots.resize(frames.size());
+        for (size_t slot = 0; slot < frames.size(); ++slot) {
+            freeSlots.push_back(slot);
+        }
+    }
+
+    std::pair<bool, FrameIndex> peek(const PageId& pageId) const override {
+        const auto* slot = map.find(pageId);
+        if (!slot) {
+            return {false, 0};
+        }
+        return {true, frames[*slot]};
+    }
+
+    bool contains(const PageId& pageId) const override {
+        return map.contains(pageId);
+    }
+
+    void erase(const PageId& pageId) override {
+        assert(map.contains(pageId));
+        size_t slot = *map.find(pageId);
+        map.erase(pageId);
+        lists.detach(slot);
+        if (slots[slot].isLocked) {
+            slots[slot].isLocked = false;
+            --lockedCount;
+        }
+        freeSlots.push_back(slot);
+    }
+
+    void lock(const PageId& pageId) override {
+        assert(map.contains(pageId));
+        auto& slot = slots[*map.find(pageId)];
+        if (!slot.isLocked) {
+            slot.isLocked = true;
+            ++lockedCount;
+        }
+    }
+
+    void unlock(const PageId& pageId) override {
+        assert(map.contains(pageId));
+        auto& slot = slots[*map.find(pageId)];
+        if (slot.isLocked) {
+            slot.isLocked = false;
+            --lockedCount;
+        }
+    }
+
+    size_t getUnlockedCount() const override {
+        return frames.size() - lockedCount;
+    }
+
+protected:
+    static constexpr size_t NoList = IndexLists::None;
+
+    struct Slot
+    {
+        PageId pageId{};
+        bool isLocked = false;
+    };
+
+    /// Moves slot to the most recently used end of list
+    void pushBack(size_t slot, size_t list) {
+        lists.pushBack(slot, list);
+    }
+
+    size_t getList(size_t slot) const {
+        return lists.getList(slot);
+    }
+
+    /// Least recently used unlocked slot of list, NoList if every slot is locked
+    size_t findVictim(size_t list) const {
+        for (auto slot = lists.front(list); slot != IndexLists::None; slot = lists.next(slot)) {
+            if (!slots[slot].isLocked) {
+                return slot;
+            }
+        }
+        return NoList;
+    }
+
+    void appendCandidates(size_t list, size_t count, std::vector<FrameIndex>& result) const {
+        for (auto slot = lists.front(list); slot != IndexLists::None && result.size() < count; slot = lists.next(slot)) {
+            if (!slots[slot].isLocked) {
+                result.push_back(frames[slot]);
+            }
+        }
+    }
+
+    /// Takes a never used slot or evicts victim, returns evicted page through victimPageId
+    size_t assign(const PageId& pageId, size_t victim, bool& evicted, PageId& victimPageId) {
+        size_t slot;
+        evicted = false;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            if (victim == NoList) {
+                throw std::runtime_error("All frames are pinned");
+            }
+            slot = victim;
+            evicted = true;
+            victimPageId = slots[slot].pageId;
+            map.erase(victimPageId);
+            lists.detach(slot);
+        }
+        slots[slot].pageId = pageId;
+        map.insertOrAssign(pageId, slot);
+        return slot;
+    }
+
+    bool hasFreeSlots() const {
+        return !freeSlots.empty();
+    }
+
+    size_t listSize(size_t list) const {
+        return lists.size(list);
+    }
+
+    std::vector<FrameIndex> frames;
+    PageTable<PageId, size_t> map;
+    std::vector<Slot> slots;
+    IndexLists lists;
+    std::vector<size_t> freeSlots;
+    size_t lockedCount = 0;
+};
+
+/// Bounded FIFO of recently evicted pages, remembers history of non resident pages.
+/// Entries live in preallocated nodes, so pushing and erasing pages does not allocate.
+template <class PageId>
+class GhostList
+{
+public:
+    /// Ghost may exceed limit by one page between push and truncate
+    explicit GhostList(size_t limit): map(limit + 1), pageIds(limit + 1), queue(limit + 1, 1) {
+        for (size_t node = 0; node < limit + 1; ++node) {
+            freeNodes.push_back(node);
+        }
+    }
+
+    bool contains(const PageId& pageId) const {
+        return map.contains(pageId);
+    }
+
+    void push(const PageId& pageId) {
+        erase(pageId);
+        if (freeNodes.empty()) {
+            popOldest();
+        }
+        size_t node = freeNodes.back();
+        freeNodes.pop_back();
+        pageIds[node] = pageId;
+        queue.pushBack(node, 0);
+        map.insertOrAssign(pageId, node);
+    }
+
+    void erase(const PageId& pageId) {
+        if (auto* node = map.find(pageId)) {
+            release(*node);
+            map.erase(pageId);
+        }
+    }
+
+    void popOldest() {
+        if (size_t node = queue.front(0); node != IndexLists::None) {
+            map.erase(pageIds[node]);
+            release(node);
+        }
+    }
+
+    void truncate(size_t limit) {
+        while (size() > limit) {
+            popOldest();
+        }
+    }
+
+    size_t size() const {
+        return queue.size(0);
+    }
+
+private:
+    void release(size_t node) {
+        queue.detach(node);
+        freeNodes.push_back(node);
+    }
+
+    PageTable<PageId, size_t> map;
+    std::vector<PageId> pageIds;
+    IndexLists queue;
+    std::vector<size_t> freeNodes;
+};
+
+/// 2Q: pages seen once live in FIFO A1in and are remembered in ghost A1out after eviction,
+/// only pages referenced again after leaving A1in are promoted to LRU Am, so one large scan
+/// cycles through A1in without touching hot pages.
+template <class PageId, class FrameIndex>
+class TwoQueueCache : public ListCacheBase<PageId, FrameIndex>
+{
+    using Base = ListCacheBase<PageId, FrameIndex>;
+
+public:
+    explicit TwoQueueCache(std::vector<FrameIndex> frame_index)
+        : Base(std::move(frame_index), 2)
+        , inCapacity(std::max<size_t>(this->frames.size() / 4, 1))
+        , outCapacity(std::max<size_t>(this->frames.size() / 2, 1))
+        , out(outCapacity) {
+    }
+
+    FrameIndex put(const PageId& pageId) override {
+        bool evicted;
+        PageId victimPageId;
+        auto victim = chooseVictim();
+        bool fromIn = victim != Base::NoList && this->getList(victim) == In;
+        size_t slot = this->assign(pageId, victim, evicted, victimPageId);
+        if (evicted && fromIn) {
+            out.push(victimPageId);
+            out.truncate(outCapacity);
+        }
+
+        if (out.contains(pageId)) {
+            out.erase(pageId);
+            this->pushBack(slot, Main);
+        } else {
+            this->pushBack(slot, In);
+        }
+        return this->frames[slot];
+    }
+
+    std::pair<bool, FrameIndex> find(const PageId& pageId) override {
+        auto* slot = this->map.find(pageId);
+        if (!slot) {
+            return {false, 0};
+        }
+        /// Correlated references to a page in A1in do not make it hot
+        if (this->getList(*slot) == Main) {
+            this->pushBack(*slot, Main);
+        }
+        return {true, this->frames[*slot]};
+    }
+
+    std::vector<FrameIndex> getEvictionCandidates(size_t count) const override {
+        std::vector<FrameIndex> result;
+        bool inFirst = this->listSize(In) > inCapacity;
+        this->appendCandidates(inFirst ? In : Main, count, result);
+        this->appendCandidates(inFirst ? Main : In, count, result);
+        return result;
+    }
+
+private:
+    static constexpr size_t In = 0;
+    static constexpr size_t Main = 1;
+
+    size_t chooseVictim() const {
+        if (this->hasFreeSlots()) {
+            return Base::NoList;
+        }
+        size_t preferred = this->listSize(In) > inCapacity ? In : Main;
+        auto victim = this->findVictim(preferred);
+        return victim != Base::NoList ? victim : this->findVictim(preferred == In ? Main : In);
+    }
+
+    size_t inCapacity = 0;
+    size_t outCapacity = 0;
+    GhostList<PageId> out;
+};
+
+/// ARC: recency list T1 and frequency list T2 with ghost lists B1 and B2, hits in ghosts move
+/// target size of T1 towards the part of the workload that is currently missing.
+template <class PageId, class FrameIndex>
+class ArcCache : public ListCacheBase<PageId, FrameIndex>
+{
+    using Base = ListCacheBase<PageId, FrameIndex>;
+
+public:
+    explicit ArcCache(std::vector<FrameIndex> frame_index)
+        : Base(std::move(frame_index), 2)
+        , capacity(this->frames.size())
+        , recentGhost(capacity)
+        , frequentGhost(2 * capacity) {
+    }
+
+    FrameIndex put(const PageId& pageId) override {
+        bool inRecentGhost = recentGhost.contains(pageId);
+        bool inFrequentGhost = frequentGhost.contains(pageId);
+
+        if (inRecentGhost) {
+            target = std::min(capacity, target + std::max<size_t>(frequentGhost.size() / recentGhost.size(), 1));
+            recentGhost.erase(pageId);
+        } else if (inFrequentGhost) {
+            target -= std::min(target, std::max<size_t>(recentGhost.size() / frequentGhost.size(), 1));
+            frequentGhost.erase(pageId);
+        }
+
+        bool evicted;
+        PageId victimPageId;
+        auto victim = chooseVictim(inFrequentGhost);
+        bool fromRecent = victim != Base::NoList && this->getList(victim) == Recent;
+        size_t slot = this->assign(pageId, victim, evicted, victimPageId);
+        if (evicted) {
+            (fromRecent ? recentGhost : frequentGhost).push(victimPageId);
+        }
+
+        this->pushBack(slot, inRecentGhost || inFrequentGhost ? Frequent : Recent);
+
+        /// |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c
+        recentGhost.truncate(capacity - std::min(capacity, this->listSize(Recent)));
+        frequentGhost.truncate(2 * capacity - std::min(2 * capacity, this->listSize(Recent) + this->listSize(Frequent) + recentGhost.size()));
+        return this->frames[slot];
+    }
+
+    std::pair<bool, FrameIndex> find(const PageId& pageId) override {
+        auto* slot = this->map.find(pageId);
+        if (!slot) {
+            return {false, 0};
+        }
+        this->pushBack(*slot, Frequent);
+        return {true, this->frames[*slot]};
+    }
+
+    std::vector<FrameIndex> getEvictionCandidates(size_t count) const override {
+        std::vector<FrameIndex> result;
+        bool recentFirst = this->listSize(Recent) > 0 && this->listSize(Recent) >= target;
+        this->appendCandidates(recentFirst ? Recent : Frequent, count, result);
+        this->appendCandidates(recentFirst ? Frequent : Recent, count, result);
+        return result;
+    }
+
+private:
+    static constexpr size_t Recent = 0;
+    static constexpr size_t Frequent = 1;
+
+    size_t chooseVictim(bool inFrequentGhost) const {
+        if (this->hasFreeSlots()) {
+            return Base::NoList;
+        }
+        size_t recentSize = this->listSize(Recent);
+        bool fromRecent = recentSize > 0 && (recentSize > target || (inFrequentGhost && recentSize == target));
+        size_t preferred = fromRecent ? Recent : Frequent;
+        auto victim = this->findVictim(preferred);
+        return victim != Base::NoList ? victim : this->findVictim(preferred == Recent ? Frequent : Recent);
+    }
+
+    size_t capacity = 0;
+    size_t target = 0;
+    GhostList<PageId> recentGhost;
+    GhostList<PageId> frequentGhost;
+};
+
+template <class PageId, class FrameIndex>
+std::unique_ptr<ICache<PageId, FrameIndex>> createCache(CachePolicy policy, std::vector<FrameIndex> frame_index)
+{
+    switch (policy)
+    {
+        case CachePolicy::clock:
+            return std::make_unique<ClockCache<PageId, FrameIndex>>(std::move(frame_index));
+        case CachePolicy::two_queue:
+            return std::make_unique<TwoQueueCache<PageId, FrameIndex>>(std::move(frame_index));
+        case CachePolicy::arc:
+            return std::make_unique<ArcCache<PageId, FrameIndex>>(std::move(frame_index));
+    }
+    throw std::runtime_error("Unknown cache policy");
 }
 
+}
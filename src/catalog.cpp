@@ -1,8 +1,148 @@
 #include "catalog.h"
 
+#include <algorithm>
+
+#include "flexible.h"
+#include "scan.h"
+
 namespace shdb
 {
 
-// Your code goes here.
+namespace
+{
+
+const std::filesystem::path catalog_table_name = "__catalog";
+
+std::shared_ptr<Schema> getCatalogSchema()
+{
+    return std::make_shared<Schema>(Schema{
+        {"relation", Type::string},
+        {"position", Type::uint64},
+        {"name", Type::string},
+        {"type", Type::uint64},
+        {"length", Type::uint64},
+        {"layout", Type::uint64}});
+}
+
+Type decodeType(uint64_t value)
+{
+    if (value > static_cast<uint64_t>(Type::string))
+        throw std::runtime_error("Invalid column type in catalog");
+    return static_cast<Type>(value);
+}
+
+TableLayout decodeLayout(uint64_t value)
+{
+    if (value > static_cast<uint64_t>(TableLayout::pax))
+        throw std::runtime_error("Invalid table layout in catalog");
+    return static_cast<TableLayout>(value);
+}
+
+/// Old versions kept schema of every relation in a <name>_schema table next to it and had no system table.
+/// Such a directory would otherwise open with an empty catalog and look like it has no tables.
+void checkNoLegacySchemaTables(Store & store)
+{
+    static const std::string suffix = "_schema";
+    for (const auto & table_name : store.getTableNames())
+    {
+        if (!table_name.ends_with(suffix))
+            continue;
+        auto relation = table_name.substr(0, table_name.size() - suffix.size());
+        if (!relation.empty() && store.checkTableExists(relation))
+            throw std::runtime_error(
+                "Unsupported database format: table " + relation + " has schema table " + table_name
+                + " of a version without system catalog, database must be recreated");
+    }
+}
+
+}
+
+Catalog::Catalog(std::shared_ptr<Store> store_) : store(std::move(store_))
+{
+    if (!store->checkTableExists(catalog_table_name))
+        checkNoLegacySchemaTables(*store);
+    table = store->createOrOpenTable(catalog_table_name, createFlexiblePageProvider(getCatalogSchema()));
+    load();
+}
+
+void Catalog::load()
+{
+    std::unordered_map<std::string, std::vector<std::pair<uint64_t, ColumnSchema>>> columns;
+    auto scan = Scan(table);
+    for (auto it = scan.begin(), end = scan.end(); it != end; ++it)
+    {
+        auto row = it.getRowView();
+        auto relation = std::string(row.getString(0));
+        auto & entry = entries[relation];
+        entry.layout = decodeLayout(row.getUInt64(5));
+        entry.row_ids.push_back(it.getRowId());
+        columns[relation].emplace_back(
+            row.getUInt64(1), ColumnSchema{std::string(row.getString(2)), decodeType(row.getUInt64(3)), static_cast<uint32_t>(row.getUInt64(4))});
+    }
+
+    /// Scan order follows free space map, not insertion order
+    for (auto & [relation, relation_columns] : columns)
+    {
+        std::sort(relation_columns.begin(), relation_columns.end(), [](const auto & lhs, const auto & rhs) { return lhs.first < rhs.first; });
+        auto schema = std::make_shared<Schema>();
+        for (auto & [position, column] : relation_columns)
+            schema->push_back(std::move(column));
+        entries[relation].schema = std::move(schema);
+    }
+}
+
+void Catalog::saveTableSchema(const std::filesystem::path & name, std::shared_ptr<Schema> schema, TableLayout layout)
+{
+    forgetTableSchema(name);
+
+    Rows rows;
+    for (size_t index = 0; index < schema->size(); ++index)
+    {
+        const auto & column = (*schema)[index];
+        rows.push_back(Row{
+            std::string(name),
+            static_cast<uint64_t>(index),
+            column.name,
+            static_cast<uint64_t>(column.type),
+            static_cast<uint64_t>(column.length),
+            static_cast<uint64_t>(layout)});
+    }
+
+    auto & entry = entries[name];
+    entry.schema = std::make_shared<Schema>(*schema);
+    entry.layout = layout;
+    entry.row_ids = table->insertRows(rows);
+}
+
+std::shared_ptr<Schema> Catalog::findTableSchema(const std::filesystem::path & name)
+{
+    const auto * entry = findEntry(name);
+    if (!entry)
+        return nullptr;
+    return std::make_shared<Schema>(*entry->schema);
+}
+
+TableLayout Catalog::findTableLayout(const std::filesystem::path & name)
+{
+    const auto * entry = findEntry(name);
+    return entry ? entry->layout : TableLayout::row;
+}
+
+void Catalog::forgetTableSchema(const std::filesystem::path & name)
+{
+    auto it = entries.find(name);
+    if (it != entries.end())
+    {
+        for (auto row_id : it->second.row_ids)
+            table->deleteRow(row_id);
+        entries.erase(it);
+    }
+}
+
+const Catalog::Entry * Catalog::findEntry(const std::string & name)
+{
+    auto it = entries.find(name);
+    return it == entries.end() ? nullptr : &it->second;
+}
 
 }
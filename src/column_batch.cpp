@@ -0,0 +1,294 @@
+#include "column_batch.h"
+
+#include <numeric>
+#include <stdexcept>
+
+namespace shdb
+{
+
+namespace
+{
+
+template <class T>
+int compareValues(const T & lhs, const T & rhs)
+{
+    return lhs < rhs ? -1 : (rhs < lhs ? 1 : 0);
+}
+
+template <class T>
+void gatherValues(std::vector<T> & destination, const std::vector<T> & source, const std::vector<uint32_t> & rows)
+{
+    destination.reserve(destination.size() + rows.size());
+    for (auto row : rows)
+        destination.push_back(source[row]);
+}
+
+}
+
+size_t ColumnVector::size() const
+{
+    switch (type)
+    {
+        case Type::boolean:
+            return booleans.size();
+        case Type::uint64:
+            return uint64s.size();
+        case Type::int64:
+            return int64s.size();
+        case Type::varchar:
+        case Type::string:
+            return strings.size();
+    }
+    throw std::runtime_error("Unknown column type");
+}
+
+void ColumnVector::clear()
+{
+    has_nulls = false;
+    nulls.clear();
+    booleans.clear();
+    uint64s.clear();
+    int64s.clear();
+    strings.clear();
+}
+
+void ColumnVector::reserve(size_t capacity)
+{
+    switch (type)
+    {
+        case Type::boolean:
+            booleans.reserve(capacity);
+            break;
+        case Type::uint64:
+            uint64s.reserve(capacity);
+            break;
+        case Type::int64:
+            int64s.reserve(capacity);
+            break;
+        case Type::varchar:
+        case Type::string:
+            strings.reserve(capacity);
+            break;
+    }
+}
+
+void ColumnVector::setNull(size_t row)
+{
+    if (nulls.size() <= row / 64)
+        nulls.resize(row / 64 + 1);
+    nulls[row / 64] |= uint64_t(1) << (row % 64);
+    has_nulls = true;
+}
+
+Value ColumnVector::getValue(size_t row) const
+{
+    if (isNull(row))
+        return Null{};
+
+    switch (type)
+    {
+        case Type::boolean:
+            return static_cast<bool>(booleans[row]);
+        case Type::uint64:
+            return uint64s[row];
+        case Type::int64:
+            return int64s[row];
+        case Type::varchar:
+        case Type::string:
+            return strings[row];
+    }
+    throw std::runtime_error("Unknown column type");
+}
+
+void ColumnVector::append(const Value & value)
+{
+    if (std::holds_alternative<Null>(value))
+    {
+        appendNull();
+        return;
+    }
+
+    switch (type)
+    {
+        case Type::boolean:
+            booleans.push_back(std::get<bool>(value));
+            break;
+        case Type::uint64:
+            uint64s.push_back(std::get<uint64_t>(value));
+            break;
+        case Type::int64:
+            int64s.push_back(std::get<int64_t>(value));
+            break;
+        case Type::varchar:
+        case Type::string:
+            strings.push_back(std::get<std::string>(value));
+            break;
+    }
+}
+
+void ColumnVector::appendNull()
+{
+    switch (type)
+    {
+        case Type::boolean:
+            booleans.push_back(0);
+            break;
+        case Type::uint64:
+            uint64s.push_back(0);
+            break;
+        case Type::int64:
+            int64s.push_back(0);
+            break;
+        case Type::varchar:
+        case Type::string:
+            strings.emplace_back();
+            break;
+    }
+    setNull(size() - 1);
+}
+
+void ColumnVector::append(const RowView & row_view, size_t column)
+{
+    if (row_view.isNull(column))
+    {
+        appendNull();
+        return;
+    }
+
+    switch (type)
+    {
+        case Type::boolean:
+            booleans.push_back(row_view.getBool(column));
+            break;
+        case Type::uint64:
+            uint64s.push_back(row_view.getUInt64(column));
+            break;
+        case Type::int64:
+            int64s.push_back(row_view.getInt64(column));
+            break;
+        case Type::varchar:
+        case Type::string:
+            strings.emplace_back(row_view.getString(column));
+            break;
+    }
+}
+
+void ColumnVector::appendFrom(const ColumnVector & source, size_t row)
+{
+    if (source.isNull(row))
+    {
+        appendNull();
+        return;
+    }
+
+    switch (type)
+    {
+        case Type::boolean:
+            booleans.push_back(source.booleans[row]);
+            break;
+        case Type::uint64:
+            uint64s.push_back(source.uint64s[row]);
+            break;
+        case Type::int64:
+            int64s.push_back(source.int64s[row]);
+            break;
+        case Type::varchar:
+        case Type::string:
+            strings.push_back(source.strings[row]);
+            break;
+    }
+}
+
+void ColumnVector::gather(const ColumnVector & source, const std::vector<uint32_t> & rows)
+{
+    auto offset = size();
+    switch (type)
+    {
+        case Type::boolean:
+            gatherValues(booleans, source.booleans, rows);
+            break;
+        case Type::uint64:
+            gatherValues(uint64s, source.uint64s, rows);
+            break;
+        case Type::int64:
+            gatherValues(int64s, source.int64s, rows);
+            break;
+        case Type::varchar:
+        case Type::string:
+            gatherValues(strings, source.strings, rows);
+            break;
+    }
+
+    if (source.has_nulls)
+        for (size_t index = 0; index < rows.size(); ++index)
+            if (source.isNull(rows[index]))
+                setNull(offset + index);
+}
+
+int ColumnVector::compare(size_t lhs_row, const ColumnVector & rhs, size_t rhs_row) const
+{
+    bool lhs_null = isNull(lhs_row);
+    bool rhs_null = rhs.isNull(rhs_row);
+    if (lhs_null || rhs_null)
+        return compareValues(!lhs_null, !rhs_null);
+
+    switch (type)
+    {
+        case Type::boolean:
+            return compareValues(booleans[lhs_row], rhs.booleans[rhs_row]);
+        case Type::uint64:
+            return compareValues(uint64s[lhs_row], rhs.uint64s[rhs_row]);
+        case Type::int64:
+            return compareValues(int64s[lhs_row], rhs.int64s[rhs_row]);
+        case Type::varchar:
+        case Type::string:
+            return compareValues(strings[lhs_row], rhs.strings[rhs_row]);
+    }
+    throw std::runtime_error("Unknown column type");
+}
+
+void ColumnBatch::reset(const std::shared_ptr<Schema> & schema)
+{
+    size_t column_count = schema ? schema->size() : 0;
+    columns.resize(column_count);
+    for (size_t index = 0; index < column_count; ++index)
+    {
+        if (columns[index].getType() != (*schema)[index].type)
+            columns[index] = ColumnVector((*schema)[index].type);
+        columns[index].clear();
+    }
+    selection.clear();
+    row_count = 0;
+}
+
+Row ColumnBatch::getRow(size_t row) const
+{
+    Row result;
+    result.reserve(columns.size());
+    for (const auto & column : columns)
+        result.push_back(column.getValue(row));
+    return result;
+}
+
+void ColumnBatch::appendRow(const Row & row)
+{
+    for (size_t index = 0; index < columns.size(); ++index)
+        columns[index].append(row[index]);
+    addRows(1);
+}
+
+void ColumnBatch::addRows(size_t count)
+{
+    selection.resize(selection.size() + count);
+    std::iota(selection.end() - count, selection.end(), static_cast<uint32_t>(row_count));
+    row_count += count;
+}
+
+void ColumnBatch::appendSelected(const ColumnBatch & other)
+{
+    for (size_t index = 0; index < columns.size(); ++index)
+        columns[index].gather(other.columns[index], other.selection);
+    addRows(other.size());
+}
+
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <string_view>
+#include <type_traits>
+
+#include "row.h"
+#include "row_view.h"
+#include "schema.h"
+
+namespace shdb
+{
+
+/// Values of one column stored in a typed array, only the array of column type is used.
+/// Null rows keep a default value in the array and are marked in null bitmap.
+class ColumnVector
+{
+public:
+    ColumnVector() = default;
+
+    explicit ColumnVector(Type type) : type(type) { }
+
+    Type getType() const { return type; }
+
+    size_t size() const;
+
+    bool empty() const { return size() == 0; }
+
+    void clear();
+
+    void reserve(size_t capacity);
+
+    bool hasNulls() const { return has_nulls; }
+
+    bool isNull(size_t row) const { return has_nulls && (nulls[row / 64] >> (row % 64)) & 1; }
+
+    /// Row must already be present in data array
+    void setNull(size_t row);
+
+    std::vector<uint8_t> & getBooleans() { return booleans; }
+    const std::vector<uint8_t> & getBooleans() const { return booleans; }
+
+    std::vector<uint64_t> & getUInt64s() { return uint64s; }
+    const std::vector<uint64_t> & getUInt64s() const { return uint64s; }
+
+    std::vector<int64_t> & getInt64s() { return int64s; }
+    const std::vector<int64_t> & getInt64s() const { return int64s; }
+
+    /// Used by both varchar and string columns
+    std::vector<std::string> & getStrings() { return strings; }
+    const std::vector<std::string> & getStrings() const { return strings; }
+
+    /// Array by element type, uint8_t for booleans and std::string for both string types
+    template <class T>
+    std::vector<T> & getValues()
+    {
+        if constexpr (std::is_same_v<T, uint8_t>)
+            return booleans;
+        else if constexpr (std::is_same_v<T, uint64_t>)
+            return uint64s;
+        else if constexpr (std::is_same_v<T, int64_t>)
+            return int64s;
+        else
+            return strings;
+    }
+
+    template <class T>
+    const std::vector<T> & getValues() const
+    {
+        return const_cast<ColumnVector *>(this)->getValues<T>();
+    }
+
+    Value getValue(size_t row) const;
+
+    void append(const Value & value);
+
+    void appendNull();
+
+    /// Decodes column of serialized row without going through Value
+    void append(const RowView & row_view, size_t column);
+
+    /// Appends single row of column of the same type
+    void appendFrom(const ColumnVector & source, size_t row);
+
+    /// Appends rows of column of the same type in given order
+    void gather(const ColumnVector & source, const std::vector<uint32_t> & rows);
+
+    /// Orders values the way comparison of Value does, null is less than any other value
+    int compare(size_t lhs_row, const ColumnVector & rhs, size_t rhs_row) const;
+
+private:
+    Type type = Type::int64;
+    bool has_nulls = false;
+    std::vector<uint64_t> nulls;
+    std::vector<uint8_t> booleans;
+    std::vector<uint64_t> uint64s;
+    std::vector<int64_t> int64s;
+    std::vector<std::string> strings;
+};
+
+/// Rows of a batch stored column by column. Selection lists rows that are part of the batch in ascending order,
+/// so filters drop rows by replacing selection without moving column values.
+class ColumnBatch
+{
+public:
+    /// Producers stop filling batch once it has at least this many rows
+    static constexpr size_t DefaultSize = 2048;
+
+    ColumnBatch() = default;
+
+    explicit ColumnBatch(const std::shared_ptr<Schema> & schema) { reset(schema); }
+
+    /// Drops all rows and makes columns match schema, null schema has no columns
+    void reset(const std::shared_ptr<Schema> & schema);
+
+    size_t getColumnCount() const { return columns.size(); }
+
+    ColumnVector & getColumn(size_t index) { return columns[index]; }
+
+    const ColumnVector & getColumn(size_t index) const { return columns[index]; }
+
+    /// Rows stored in columns, selected or not
+    size_t getRowCount() const { return row_count; }
+
+    const std::vector<uint32_t> & getSelection() const { return selection; }
+
+    void setSelection(std::vector<uint32_t> selection_) { selection = std::move(selection_); }
+
+    /// Number of selected rows
+    size_t size() const { return selection.size(); }
+
+    bool empty() const { return selection.empty(); }
+
+    /// Every stored row is selected, so selected values of a column are its whole array
+    bool isSelectionDense() const { return selection.size() == row_count; }
+
+    Row getRow(size_t row) const;
+
+    /// Appends and selects row
+    void appendRow(const Row & row);
+
+    /// Counts and selects count rows whose values were appended to every column directly
+    void addRows(size_t count);
+
+    /// Appends and selects selected rows of batch with the same columns
+    void appendSelected(const ColumnBatch & other);
+
+private:
+    std::vector<ColumnVector> columns;
+    std::vector<uint32_t> selection;
+    size_t row_count = 0;
+};
+
+}
@@ -0,0 +1,138 @@
+#include "column_encoding.h"
+
+#include <bit>
+#include <cstring>
+
+namespace shdb
+{
+
+namespace
+{
+
+constexpr uint64_t SignBit = uint64_t(1) << 63;
+
+uint64_t loadWord(const uint8_t * data, size_t word_index)
+{
+    uint64_t word = 0;
+    memcpy(&word, data + word_index * sizeof(uint64_t), sizeof(word));
+    return word;
+}
+
+void storeWord(uint8_t * data, size_t word_index, uint64_t word)
+{
+    memcpy(data + word_index * sizeof(uint64_t), &word, sizeof(word));
+}
+
+uint64_t getMask(uint8_t bit_width)
+{
+    return bit_width == 64 ? ~uint64_t(0) : (uint64_t(1) << bit_width) - 1;
+}
+
+}
+
+uint64_t toKey(Type type, const Value & value)
+{
+    switch (type)
+    {
+        case Type::boolean:
+            return std::get<bool>(value);
+        case Type::uint64:
+            return std::get<uint64_t>(value);
+        case Type::int64:
+            return static_cast<uint64_t>(std::get<int64_t>(value)) ^ SignBit;
+        case Type::varchar:
+        case Type::string:
+            break;
+    }
+    return 0;
+}
+
+int64_t keyToInt64(uint64_t key)
+{
+    return static_cast<int64_t>(key ^ SignBit);
+}
+
+uint8_t getBitWidth(uint64_t max_value)
+{
+    return static_cast<uint8_t>(std::bit_width(max_value));
+}
+
+size_t getPackedSize(size_t count, uint8_t bit_width)
+{
+    return (count * bit_width + 63) / 64 * sizeof(uint64_t);
+}
+
+uint64_t readBits(const uint8_t * data, size_t index, uint8_t bit_width)
+{
+    if (bit_width == 0)
+        return 0;
+
+    size_t bit = index * bit_width;
+    size_t word_index = bit / 64;
+    size_t shift = bit % 64;
+    uint64_t result = loadWord(data, word_index) >> shift;
+    if (shift + bit_width > 64)
+        result |= loadWord(data, word_index + 1) << (64 - shift);
+    return result & getMask(bit_width);
+}
+
+void writeBits(uint8_t * data, size_t index, uint8_t bit_width, uint64_t value)
+{
+    if (bit_width == 0)
+        return;
+
+    size_t bit = index * bit_width;
+    size_t word_index = bit / 64;
+    size_t shift = bit % 64;
+    uint64_t mask = getMask(bit_width);
+    value &= mask;
+
+    auto word = loadWord(data, word_index);
+    word = (word & ~(mask << shift)) | (value << shift);
+    storeWord(data, word_index, word);
+    if (shift + bit_width > 64)
+    {
+        auto high = loadWord(data, word_index + 1);
+        auto high_mask = mask >> (64 - shift);
+        high = (high & ~high_mask) | (value >> (64 - shift));
+        storeWord(data, word_index + 1, high);
+    }
+}
+
+MinipageHeader readMinipageHeader(const uint8_t * data)
+{
+    MinipageHeader header;
+    memcpy(&header, data, sizeof(header));
+    return header;
+}
+
+void writeMinipageHeader(uint8_t * data, const MinipageHeader & header)
+{
+    memcpy(data, &header, sizeof(header));
+}
+
+uint64_t readKey(const uint8_t * page_data, const MinipageHeader & header, RowIndex row_index)
+{
+    return header.base + readBits(page_data + header.offset, row_index, header.bit_width);
+}
+
+uint64_t readCode(const uint8_t * page_data, const MinipageHeader & header, RowIndex row_index)
+{
+    if (header.encoding == ColumnEncoding::dictionary)
+        return readBits(page_data + header.offset, row_index, header.bit_width);
+    return row_index;
+}
+
+std::string_view readDictionaryValue(const uint8_t * page_data, const MinipageHeader & header, size_t length, uint64_t code)
+{
+    auto offset = header.encoding == ColumnEncoding::dictionary ? header.base : header.offset;
+    const auto * value = reinterpret_cast<const char *>(page_data + offset + code * length);
+    return std::string_view(value, strnlen(value, length));
+}
+
+std::string_view readString(const uint8_t * page_data, const MinipageHeader & header, size_t length, RowIndex row_index)
+{
+    return readDictionaryValue(page_data, header, length, readCode(page_data, header, row_index));
+}
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "row.h"
+#include "schema.h"
+
+namespace shdb
+{
+
+/// Encoding of a column minipage of a columnar page, chosen per page from its values
+enum class ColumnEncoding : uint8_t
+{
+    /// Offsets of keys from the page minimum packed into bit_width bits, zero width for constant columns
+    frame_of_reference,
+    /// Codes of bit_width bits index array of distinct varchar values stored in the page
+    dictionary,
+    /// Full width varchar values
+    plain,
+};
+
+/// Descriptor of a column minipage, stored in page header
+struct MinipageHeader
+{
+    /// Frame of reference minimum, or offset of dictionary values
+    uint64_t base = 0;
+    /// Offset of packed codes or plain values
+    uint32_t offset = 0;
+    uint16_t dictionary_size = 0;
+    uint16_t dictionary_capacity = 0;
+    ColumnEncoding encoding = ColumnEncoding::frame_of_reference;
+    uint8_t bit_width = 0;
+    uint8_t reserved[6] = {};
+};
+
+static_assert(sizeof(MinipageHeader) == 24);
+
+/// Integer and boolean values are packed as unsigned keys that preserve order of values
+uint64_t toKey(Type type, const Value & value);
+
+int64_t keyToInt64(uint64_t key);
+
+/// Bits needed to store values from 0 to max_value
+uint8_t getBitWidth(uint64_t max_value);
+
+/// Bytes taken by count packed values, rounded up to whole words
+size_t getPackedSize(size_t count, uint8_t bit_width);
+
+uint64_t readBits(const uint8_t * data, size_t index, uint8_t bit_width);
+
+void writeBits(uint8_t * data, size_t index, uint8_t bit_width, uint64_t value);
+
+MinipageHeader readMinipageHeader(const uint8_t * data);
+
+void writeMinipageHeader(uint8_t * data, const MinipageHeader & header);
+
+/// Key of row in frame of reference minipage
+uint64_t readKey(const uint8_t * page_data, const MinipageHeader & header, RowIndex row_index);
+
+/// Dictionary code of row, or row index itself for plain minipages
+uint64_t readCode(const uint8_t * page_data, const MinipageHeader & header, RowIndex row_index);
+
+/// Dictionary value or plain value of varchar column of given length
+std::string_view readDictionaryValue(const uint8_t * page_data, const MinipageHeader & header, size_t length, uint64_t code);
+
+std::string_view readString(const uint8_t * page_data, const MinipageHeader & header, size_t length, RowIndex row_index);
+
+}
@@ -0,0 +1,534 @@
+#include "compiled_expression.h"
+
+#include <functional>
+#include <optional>
+
+namespace shdb
+{
+
+namespace
+{
+
+/// Column arrays store booleans as bytes
+template <class T>
+using StorageType = std::conditional_t<std::is_same_v<T, bool>, uint8_t, T>;
+
+template <class T>
+T readValue(const RowView & input_row, size_t index)
+{
+    if constexpr (std::is_same_v<T, bool>)
+        return input_row.getBool(index);
+    else if constexpr (std::is_same_v<T, uint64_t>)
+        return input_row.getUInt64(index);
+    else if constexpr (std::is_same_v<T, int64_t>)
+        return input_row.getInt64(index);
+    else
+        return std::string(input_row.getString(index));
+}
+
+/// Node with result of C++ type T. Only column reads can be null, other nodes reject null operands like generic nodes do.
+template <class T>
+class TypedExpression : public IExpression
+{
+public:
+    virtual T evaluateTyped(const Row & input_row) = 0;
+
+    virtual T evaluateTyped(const RowView & input_row) = 0;
+
+    virtual std::optional<T> evaluateNullable(const Row & input_row) { return evaluateTyped(input_row); }
+
+    virtual std::optional<T> evaluateNullable(const RowView & input_row) { return evaluateTyped(input_row); }
+
+    Value evaluate(const Row & input_row) override { return toValue(evaluateNullable(input_row)); }
+
+    Value evaluate(const RowView & input_row) override { return toValue(evaluateNullable(input_row)); }
+
+    using IExpression::evaluate;
+
+private:
+    static Value toValue(std::optional<T> value)
+    {
+        if (!value)
+            return Null{};
+        return std::move(*value);
+    }
+};
+
+template <class T>
+using TypedExpressionPtr = std::shared_ptr<TypedExpression<T>>;
+
+template <class T>
+class ColumnExpression : public TypedExpression<T>
+{
+public:
+    ColumnExpression(size_t index_, Type type_) : index(index_), type(type_) { }
+
+    Type getResultType() override { return type; }
+
+    T evaluateTyped(const Row & input_row) override { return getOrThrow(evaluateNullable(input_row)); }
+
+    T evaluateTyped(const RowView & input_row) override { return getOrThrow(evaluateNullable(input_row)); }
+
+    std::optional<T> evaluateNullable(const Row & input_row) override
+    {
+        const auto & value = input_row[index];
+        if (std::holds_alternative<Null>(value))
+            return std::nullopt;
+        return std::get<T>(value);
+    }
+
+    std::optional<T> evaluateNullable(const RowView & input_row) override
+    {
+        if (input_row.isNull(index))
+            return std::nullopt;
+        return readValue<T>(input_row, index);
+    }
+
+    void evaluate(const ColumnBatch & input, const std::vector<uint32_t> & selection, ColumnVector & output) override
+    {
+        output.gather(input.getColumn(index), selection);
+    }
+
+    using TypedExpression<T>::evaluate;
+
+    size_t getIndex() const { return index; }
+
+private:
+    static T getOrThrow(std::optional<T> value)
+    {
+        if (!value)
+            throw std::runtime_error("Null operand");
+        return std::move(*value);
+    }
+
+    size_t index;
+    Type type;
+};
+
+template <class T>
+class ConstantExpression : public TypedExpression<T>
+{
+public:
+    ConstantExpression(T value_, Type type_) : value(std::move(value_)), type(type_) { }
+
+    Type getResultType() override { return type; }
+
+    T evaluateTyped(const Row &) override { return value; }
+
+    T evaluateTyped(const RowView &) override { return value; }
+
+    void evaluate(const ColumnBatch &, const std::vector<uint32_t> & selection, ColumnVector & output) override
+    {
+        auto & values = output.getValues<StorageType<T>>();
+        values.resize(values.size() + selection.size(), value);
+    }
+
+    using TypedExpression<T>::evaluate;
+
+    const T & getValue() const { return value; }
+
+private:
+    T value;
+    Type type;
+};
+
+/// Evaluates operand over batch into storage, throws on nulls
+template <class T>
+const std::vector<StorageType<T>> & evaluateOperand(IExpression & operand, const ColumnBatch & input, const std::vector<uint32_t> & selection, ColumnVector & storage)
+{
+    operand.evaluate(input, selection, storage);
+    if (storage.hasNulls())
+        throw std::runtime_error("Null operand");
+    return storage.getValues<StorageType<T>>();
+}
+
+template <class Operation>
+class ArithmeticExpression : public TypedExpression<int64_t>
+{
+public:
+    ArithmeticExpression(TypedExpressionPtr<int64_t> lhs_, TypedExpressionPtr<int64_t> rhs_) : lhs(std::move(lhs_)), rhs(std::move(rhs_)) { }
+
+    Type getResultType() override { return Type::int64; }
+
+    int64_t evaluateTyped(const Row & input_row) override { return Operation()(lhs->evaluateTyped(input_row), rhs->evaluateTyped(input_row)); }
+
+    int64_t evaluateTyped(const RowView & input_row) override
+    {
+        return Operation()(lhs->evaluateTyped(input_row), rhs->evaluateTyped(input_row));
+    }
+
+    void evaluate(const ColumnBatch & input, const std::vector<uint32_t> & selection, ColumnVector & output) override
+    {
+        ColumnVector lhs_storage(Type::int64);
+        ColumnVector rhs_storage(Type::int64);
+        const auto & lhs_values = evaluateOperand<int64_t>(*lhs, input, selection, lhs_storage);
+        const auto & rhs_values = evaluateOperand<int64_t>(*rhs, input, selection, rhs_storage);
+
+        auto & values = output.getInt64s();
+        auto offset = values.size();
+        values.resize(offset + lhs_values.size());
+        for (size_t row = 0; row < lhs_values.size(); ++row)
+            values[offset + row] = Operation()(lhs_values[row], rhs_values[row]);
+    }
+
+    using TypedExpression<int64_t>::evaluate;
+
+private:
+    TypedExpressionPtr<int64_t> lhs;
+    TypedExpressionPtr<int64_t> rhs;
+};
+
+class NegateExpression : public TypedExpression<int64_t>
+{
+public:
+    explicit NegateExpression(TypedExpressionPtr<int64_t> operand_) : operand(std::move(operand_)) { }
+
+    Type getResultType() override { return Type::int64; }
+
+    int64_t evaluateTyped(const Row & input_row) override { return -operand->evaluateTyped(input_row); }
+
+    int64_t evaluateTyped(const RowView & input_row) override { return -operand->evaluateTyped(input_row); }
+
+    void evaluate(const ColumnBatch & input, const std::vector<uint32_t> & selection, ColumnVector & output) override
+    {
+        ColumnVector storage(Type::int64);
+        for (auto value : evaluateOperand<int64_t>(*operand, input, selection, storage))
+            output.getInt64s().push_back(-value);
+    }
+
+    using TypedExpression<int64_t>::evaluate;
+
+private:
+    TypedExpressionPtr<int64_t> operand;
+};
+
+/// Equality of nullable operands follows Value, null equals only null. Ordering rejects nulls.
+template <class T, CompareOperation operation>
+class CompareExpression : public TypedExpression<bool>
+{
+public:
+    static constexpr bool is_equality = operation == CompareOperation::eq || operation == CompareOperation::ne;
+
+    CompareExpression(TypedExpressionPtr<T> lhs_, TypedExpressionPtr<T> rhs_) : lhs(std::move(lhs_)), rhs(std::move(rhs_)) { }
+
+    Type getResultType() override { return Type::boolean; }
+
+    bool evaluateTyped(const Row & input_row) override { return evaluateImpl(input_row); }
+
+    bool evaluateTyped(const RowView & input_row) override { return evaluateImpl(input_row); }
+
+    template <class Input>
+    bool evaluateImpl(const Input & input_row)
+    {
+        if constexpr (is_equality)
+            return compareValues<operation>(lhs->evaluateNullable(input_row), rhs->evaluateNullable(input_row));
+        else
+            return compareValues<operation>(lhs->evaluateTyped(input_row), rhs->evaluateTyped(input_row));
+    }
+
+    void evaluate(const ColumnBatch & input, const std::vector<uint32_t> & selection, ColumnVector & output) override
+    {
+        ColumnVector lhs_storage(lhs->getResultType());
+        ColumnVector rhs_storage(rhs->getResultType());
+        lhs->evaluate(input, selection, lhs_storage);
+        rhs->evaluate(input, selection, rhs_storage);
+
+        auto & values = output.getBooleans();
+        if (lhs_storage.hasNulls() || rhs_storage.hasNulls())
+        {
+            if constexpr (!is_equality)
+                throw std::runtime_error("Null operand");
+            for (size_t row = 0; row < lhs_storage.size(); ++row)
+            {
+                bool lhs_null = lhs_storage.isNull(row);
+                bool rhs_null = rhs_storage.isNull(row);
+                bool equal = lhs_null || rhs_null ? lhs_null == rhs_null
+                                                  : lhs_storage.getValues<StorageType<T>>()[row] == rhs_storage.getValues<StorageType<T>>()[row];
+                values.push_back(equal == (operation == CompareOperation::eq));
+            }
+            return;
+        }
+
+        const auto & lhs_values = lhs_storage.getValues<StorageType<T>>();
+        const auto & rhs_values = rhs_storage.getValues<StorageType<T>>();
+        auto offset = values.size();
+        values.resize(offset + lhs_values.size());
+        for (size_t row = 0; row < lhs_values.size(); ++row)
+            values[offset + row] = compareValues<operation>(lhs_values[row], rhs_values[row]);
+    }
+
+    using TypedExpression<bool>::evaluate;
+
+    void evaluateFilter(const ColumnBatch & input, const std::vector<uint32_t> & selection, SelectionBitmap & output) override
+    {
+        if constexpr (!std::is_same_v<T, std::string>)
+            if (!selection.empty() && compareWithKernel(input, selection, output))
+                return;
+        IExpression::evaluateFilter(input, selection, output);
+    }
+
+private:
+    /// Kernels run over operands without nulls, columns of batch with every row selected are read in place
+    bool compareWithKernel(const ColumnBatch & input, const std::vector<uint32_t> & selection, SelectionBitmap & output)
+    {
+        auto * lhs_constant = dynamic_cast<ConstantExpression<T> *>(lhs.get());
+        auto * rhs_constant = dynamic_cast<ConstantExpression<T> *>(rhs.get());
+        if (lhs_constant && rhs_constant)
+            return false;
+
+        ColumnVector lhs_storage(lhs->getResultType());
+        ColumnVector rhs_storage(rhs->getResultType());
+        const StorageType<T> * lhs_values = nullptr;
+        const StorageType<T> * rhs_values = nullptr;
+        if (!lhs_constant && !getValues(*lhs, input, selection, lhs_storage, lhs_values))
+            return false;
+        if (!rhs_constant && !getValues(*rhs, input, selection, rhs_storage, rhs_values))
+            return false;
+
+        output.assign(getBitmapWordCount(selection.size()), 0);
+        if (rhs_constant)
+            compareWithConstant(operation, lhs_values, selection.size(), rhs_constant->getValue(), output.data());
+        else if (lhs_constant)
+            compareWithConstant(swapOperands(operation), rhs_values, selection.size(), lhs_constant->getValue(), output.data());
+        else
+            compareColumns(operation, lhs_values, rhs_values, selection.size(), output.data());
+        return true;
+    }
+
+    static bool getValues(TypedExpression<T> & operand, const ColumnBatch & input, const std::vector<uint32_t> & selection, ColumnVector & storage, const StorageType<T> *& values)
+    {
+        const ColumnVector * column = &storage;
+        auto * column_expression = dynamic_cast<ColumnExpression<T> *>(&operand);
+        if (column_expression && selection.size() == input.getRowCount())
+            column = &input.getColumn(column_expression->getIndex());
+        else
+            operand.evaluate(input, selection, storage);
+
+        if (column->hasNulls())
+            return false;
+        values = column->getValues<StorageType<T>>().data();
+        return true;
+    }
+
+    TypedExpressionPtr<T> lhs;
+    TypedExpressionPtr<T> rhs;
+};
+
+template <bool is_and>
+class LogicalExpression : public TypedExpression<bool>
+{
+public:
+    LogicalExpression(TypedExpressionPtr<bool> lhs_, TypedExpressionPtr<bool> rhs_) : lhs(std::move(lhs_)), rhs(std::move(rhs_)) { }
+
+    Type getResultType() override { return Type::boolean; }
+
+    bool evaluateTyped(const Row & input_row) override { return evaluateImpl(input_row); }
+
+    bool evaluateTyped(const RowView & input_row) override { return evaluateImpl(input_row); }
+
+    template <class Input>
+    bool evaluateImpl(const Input & input_row)
+    {
+        if constexpr (is_and)
+            return lhs->evaluateTyped(input_row) && rhs->evaluateTyped(input_row);
+        else
+            return lhs->evaluateTyped(input_row) || rhs->evaluateTyped(input_row);
+    }
+
+    void evaluate(const ColumnBatch & input, const std::vector<uint32_t> & selection, ColumnVector & output) override { evaluateLogical(is_and, *lhs, *rhs, input, selection, output); }
+
+    using TypedExpression<bool>::evaluate;
+
+    void evaluateFilter(const ColumnBatch & input, const std::vector<uint32_t> & selection, SelectionBitmap & output) override
+    {
+        evaluateLogicalFilter(is_and, *lhs, *rhs, input, selection, output);
+    }
+
+private:
+    TypedExpressionPtr<bool> lhs;
+    TypedExpressionPtr<bool> rhs;
+};
+
+class NotExpression : public TypedExpression<bool>
+{
+public:
+    explicit NotExpression(TypedExpressionPtr<bool> operand_) : operand(std::move(operand_)) { }
+
+    Type getResultType() override { return Type::boolean; }
+
+    bool evaluateTyped(const Row & input_row) override { return !operand->evaluateTyped(input_row); }
+
+    bool evaluateTyped(const RowView & input_row) override { return !operand->evaluateTyped(input_row); }
+
+    void evaluate(const ColumnBatch & input, const std::vector<uint32_t> & selection, ColumnVector & output) override
+    {
+        ColumnVector storage(Type::boolean);
+        for (auto value : evaluateOperand<bool>(*operand, input, selection, storage))
+            output.getBooleans().push_back(!value);
+    }
+
+    using TypedExpression<bool>::evaluate;
+
+    void evaluateFilter(const ColumnBatch & input, const std::vector<uint32_t> & selection, SelectionBitmap & output) override
+    {
+        operand->evaluateFilter(input, selection, output);
+        notBitmap(output.data(), selection.size());
+    }
+
+private:
+    TypedExpressionPtr<bool> operand;
+};
+
+template <class T>
+TypedExpressionPtr<T> asTyped(const ExpressionPtr & expression)
+{
+    return std::dynamic_pointer_cast<TypedExpression<T>>(expression);
+}
+
+bool isString(Type type)
+{
+    return type == Type::varchar || type == Type::string;
+}
+
+template <class T>
+ExpressionPtr compileCompare(BinaryOperatorCode operator_code, const ExpressionPtr & lhs, const ExpressionPtr & rhs)
+{
+    auto typed_lhs = asTyped<T>(lhs);
+    auto typed_rhs = asTyped<T>(rhs);
+    switch (operator_code)
+    {
+        case BinaryOperatorCode::eq:
+            return std::make_shared<CompareExpression<T, CompareOperation::eq>>(typed_lhs, typed_rhs);
+        case BinaryOperatorCode::ne:
+            return std::make_shared<CompareExpression<T, CompareOperation::ne>>(typed_lhs, typed_rhs);
+        case BinaryOperatorCode::lt:
+            return std::make_shared<CompareExpression<T, CompareOperation::lt>>(typed_lhs, typed_rhs);
+        case BinaryOperatorCode::le:
+            return std::make_shared<CompareExpression<T, CompareOperation::le>>(typed_lhs, typed_rhs);
+        case BinaryOperatorCode::gt:
+            return std::make_shared<CompareExpression<T, CompareOperation::gt>>(typed_lhs, typed_rhs);
+        case BinaryOperatorCode::ge:
+            return std::make_shared<CompareExpression<T, CompareOperation::ge>>(typed_lhs, typed_rhs);
+        default:
+            return nullptr;
+    }
+}
+
+ExpressionPtr compileBinaryOperator(BinaryOperatorCode operator_code, const ExpressionPtr & lhs, const ExpressionPtr & rhs)
+{
+    auto lhs_type = lhs->getResultType();
+    auto rhs_type = rhs->getResultType();
+    bool both_int64 = lhs_type == Type::int64 && rhs_type == Type::int64;
+    switch (operator_code)
+    {
+        case BinaryOperatorCode::plus:
+            return both_int64 ? std::make_shared<ArithmeticExpression<std::plus<int64_t>>>(asTyped<int64_t>(lhs), asTyped<int64_t>(rhs)) : nullptr;
+        case BinaryOperatorCode::minus:
+            return both_int64 ? std::make_shared<ArithmeticExpression<std::minus<int64_t>>>(asTyped<int64_t>(lhs), asTyped<int64_t>(rhs)) : nullptr;
+        case BinaryOperatorCode::mul:
+            return both_int64 ? std::make_shared<ArithmeticExpression<std::multiplies<int64_t>>>(asTyped<int64_t>(lhs), asTyped<int64_t>(rhs))
+                              : nullptr;
+        case BinaryOperatorCode::div:
+            return both_int64 ? std::make_shared<ArithmeticExpression<std::divides<int64_t>>>(asTyped<int64_t>(lhs), asTyped<int64_t>(rhs))
+                              : nullptr;
+        case BinaryOperatorCode::land:
+        case BinaryOperatorCode::lor:
+            if (lhs_type != Type::boolean || rhs_type != Type::boolean)
+                return nullptr;
+            if (operator_code == BinaryOperatorCode::land)
+                return std::make_shared<LogicalExpression<true>>(asTyped<bool>(lhs), asTyped<bool>(rhs));
+            return std::make_shared<LogicalExpression<false>>(asTyped<bool>(lhs), asTyped<bool>(rhs));
+        case BinaryOperatorCode::lt:
+        case BinaryOperatorCode::le:
+        case BinaryOperatorCode::gt:
+        case BinaryOperatorCode::ge:
+            return both_int64 ? compileCompare<int64_t>(operator_code, lhs, rhs) : nullptr;
+        case BinaryOperatorCode::eq:
+        case BinaryOperatorCode::ne:
+            if (isString(lhs_type) && isString(rhs_type))
+                return compileCompare<std::string>(operator_code, lhs, rhs);
+            if (lhs_type != rhs_type)
+                return nullptr;
+            switch (lhs_type)
+            {
+                case Type::boolean:
+                    return compileCompare<bool>(operator_code, lhs, rhs);
+                case Type::uint64:
+                    return compileCompare<uint64_t>(operator_code, lhs, rhs);
+                case Type::int64:
+                    return compileCompare<int64_t>(operator_code, lhs, rhs);
+                default:
+                    return nullptr;
+            }
+    }
+    return nullptr;
+}
+
+ExpressionPtr compileIdentifier(const std::string & name, const std::shared_ptr<SchemaAccessor> & input_schema_accessor)
+{
+    auto index = input_schema_accessor->getColumnIndexOrThrow(name);
+    auto type = input_schema_accessor->getColumnOrThrow(name).type;
+    switch (type)
+    {
+        case Type::boolean:
+            return std::make_shared<ColumnExpression<bool>>(index, type);
+        case Type::uint64:
+            return std::make_shared<ColumnExpression<uint64_t>>(index, type);
+        case Type::int64:
+            return std::make_shared<ColumnExpression<int64_t>>(index, type);
+        case Type::varchar:
+        case Type::string:
+            return std::make_shared<ColumnExpression<std::string>>(index, type);
+    }
+    return nullptr;
+}
+
+}
+
+ExpressionPtr compileExpression(const ASTPtr & ast, const std::shared_ptr<SchemaAccessor> & input_schema_accessor)
+{
+    switch (ast->type)
+    {
+        case ASTType::identifier:
+            return compileIdentifier(std::static_pointer_cast<const ASTIdentifier>(ast)->getName(), input_schema_accessor);
+        case ASTType::literal: {
+            const auto literal = std::static_pointer_cast<const ASTLiteral>(ast);
+            switch (literal->literal_type)
+            {
+                case ASTLiteralType::number:
+                    return std::make_shared<ConstantExpression<int64_t>>(literal->integer_value, Type::int64);
+                case ASTLiteralType::string:
+                    return std::make_shared<ConstantExpression<std::string>>(literal->string_value, Type::string);
+                case ASTLiteralType::boolean:
+                    return std::make_shared<ConstantExpression<bool>>(literal->boolean_value, Type::boolean);
+                case ASTLiteralType::unsigned_number:
+                    return std::make_shared<ConstantExpression<uint64_t>>(literal->unsigned_value, Type::uint64);
+            }
+            return nullptr;
+        }
+        case ASTType::binaryOperator: {
+            auto binary_operator = std::static_pointer_cast<const ASTBinaryOperator>(ast);
+            auto lhs = compileExpression(binary_operator->getLHS(), input_schema_accessor);
+            auto rhs = compileExpression(binary_operator->getRHS(), input_schema_accessor);
+            if (!lhs || !rhs)
+                return nullptr;
+            return compileBinaryOperator(binary_operator->operator_code, lhs, rhs);
+        }
+        case ASTType::unaryOperator: {
+            auto unary_operator = std::static_pointer_cast<const ASTUnaryOperator>(ast);
+            auto operand = compileExpression(unary_operator->getOperand(), input_schema_accessor);
+            if (!operand)
+                return nullptr;
+            if (unary_operator->operator_code == UnaryOperatorCode::lnot)
+                return operand->getResultType() == Type::boolean ? std::make_shared<NotExpression>(asTyped<bool>(operand)) : nullptr;
+            return operand->getResultType() == Type::int64 ? std::make_shared<NegateExpression>(asTyped<int64_t>(operand)) : nullptr;
+        }
+        case ASTType::parameter:
+            throw std::runtime_error("Query parameter is not bound");
+        default:
+            /// Other nodes (lists, clauses) are not expressions, caller falls back to interpreted nodes
+            return nullptr;
+    }
+}
+
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "expression.h"
+
+namespace shdb
+{
+
+/// Resolves operand types once and builds nodes specialized for them, nodes read columns and pass values as C++ types
+/// without constructing Value. Returns nullptr when types do not fit typed nodes, such expression is built from generic nodes.
+ExpressionPtr compileExpression(const ASTPtr & expression, const std::shared_ptr<SchemaAccessor> & input_schema_accessor);
+
+}
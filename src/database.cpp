@@ -5,31 +5,56 @@
 
 #include "fixed.h"
 #include "flexible.h"
+#include "pax.h"
 
 namespace shdb
 {
 
-Database::Database(const std::filesystem::path & path, FrameIndex frame_count) : statistics(std::make_shared<Statistics>())
+Database::Database(const std::filesystem::path & path, FrameIndex frame_count, BufferPoolOptions buffer_pool_options)
+    : statistics(std::make_shared<Statistics>())
 {
-    store = std::make_shared<Store>(path, frame_count, statistics);
+    store = std::make_shared<Store>(path, frame_count, statistics, buffer_pool_options);
     catalog = std::make_shared<Catalog>(store);
     registerIndexes(*this);
 }
 
-std::shared_ptr<ITable> Database::createTable(const std::string & name, std::shared_ptr<Schema> schema)
+std::shared_ptr<ITable> Database::createTable(const std::string & name, std::shared_ptr<Schema> schema, TableLayout layout)
 {
-    catalog->saveTableSchema(name, schema);
-    auto provider = createPageProvider(std::move(schema));
-    return store->createAndOpenTable(name, std::move(provider));
+    /// Provider is created first, so unsupported schemas are rejected before anything is saved.
+    /// Catalog entry is written only once table file is created, existing table keeps its schema.
+    auto provider = createPageProvider(schema, layout);
+    ++catalog_version;
+    auto table = store->createAndOpenTable(name, std::move(provider));
+    try
+    {
+        catalog->saveTableSchema(name, schema, layout);
+    }
+    catch (...)
+    {
+        table.reset();
+        store->removeTable(name);
+        throw;
+    }
+    open_tables[name] = OpenTable{std::move(schema), table};
+    return table;
 }
 
 std::shared_ptr<ITable> Database::getTable(const std::string & name, std::shared_ptr<Schema> schema)
 {
+    /// Handle opened with a different schema is replaced, pages are interpreted with the schema caller gives
+    auto it = open_tables.find(name);
+    if (it != open_tables.end() && (!schema || *schema == *it->second.schema))
+        return it->second.table;
+
     if (!schema)
         schema = catalog->findTableSchema(name);
+    if (!schema)
+        throw std::runtime_error("Table " + name + " does not exist");
 
-    auto provider = createPageProvider(std::move(schema));
-    return store->openTable(name, std::move(provider));
+    auto provider = createPageProvider(schema, catalog->findTableLayout(name));
+    auto table = store->openTable(name, std::move(provider));
+    open_tables[name] = OpenTable{std::move(schema), table};
+    return table;
 }
 
 bool Database::checkTableExists(const std::string & name)
@@ -39,10 +64,22 @@ bool Database::checkTableExists(const std::string & name)
 
 void Database::dropTable(const std::string & name)
 {
+    ++catalog_version;
+    open_tables.erase(name);
     catalog->forgetTableSchema(name);
     store->removeTable(name);
 }
 
+size_t Database::copyFromFile(const std::string & name, const std::filesystem::path & path, const CopyOptions & options)
+{
+    auto schema = catalog->findTableSchema(name);
+    if (!schema || !checkTableExists(name))
+        throw std::runtime_error("Table " + name + " does not exist");
+
+    auto table = getTable(name, schema);
+    return shdb::copyFromFile(*table, *schema, path, options);
+}
+
 void Database::registerIndex(
     const std::string & index_type, IndexCreateCallback index_create_callback, IndexDropCallback index_drop_callback)
 {
@@ -56,6 +93,7 @@ Database::createIndex(const std::string & index_name, std::shared_ptr<Schema> ke
         throw std::runtime_error("Invalid empty index key schema");
 
 
+    ++catalog_version;
     std::shared_ptr<Schema> index_schema = std::make_shared<Schema>(*key_schema);
     index_schema->push_back(ColumnSchema{index_type, Type::uint64, 0});
     catalog->saveTableSchema(index_name, index_schema);
@@ -66,11 +104,16 @@ Database::createIndex(const std::string & index_name, std::shared_ptr<Schema> ke
     if (callbacks_it == index_type_to_callbacks.end())
         throw std::runtime_error("No index implementation registered for index type " + index_type);
 
-    return callbacks_it->second.first(metadata, *store);
+    auto index = callbacks_it->second.first(metadata, *store);
+    open_indexes[index_name] = index;
+    return index;
 }
 
 std::shared_ptr<IIndex> Database::getIndex(const std::string & index_name)
 {
+    if (auto it = open_indexes.find(index_name); it != open_indexes.end())
+        return it->second;
+
     auto index_schema = catalog->findTableSchema(index_name);
     if (!index_schema)
         throw std::runtime_error("No index exists with name " + index_name);
@@ -83,7 +126,9 @@ std::shared_ptr<IIndex> Database::getIndex(const std::string & index_name)
     if (callbacks_it == index_type_to_callbacks.end())
         throw std::runtime_error("No index implementation registered for index type " + index_type);
 
-    return callbacks_it->second.first(metadata, *store);
+    auto index = callbacks_it->second.first(metadata, *store);
+    open_indexes.emplace(index_name, index);
+    return index;
 }
 
 void Database::dropIndex(const std::string & index_name)
@@ -92,6 +137,8 @@ void Database::dropIndex(const std::string & index_name)
     if (!index_schema)
         throw std::runtime_error("No index exists with name " + index_name);
 
+    ++catalog_version;
+    open_indexes.erase(index_name);
     catalog->forgetTableSchema(index_name);
 
     std::string index_type = index_schema->back().name;
@@ -115,8 +162,11 @@ std::shared_ptr<Schema> Database::findTableSchema(const std::filesystem::path &
     return catalog->findTableSchema(name);
 }
 
-std::shared_ptr<IPageProvider> Database::createPageProvider(std::shared_ptr<Schema> schema)
+std::shared_ptr<ITablePageProvider> Database::createPageProvider(std::shared_ptr<Schema> schema, TableLayout layout)
 {
+    if (layout == TableLayout::pax)
+        return createPaxPageProvider(std::move(schema));
+
     for (const auto & column : *schema)
         if (column.type == Type::string)
             return createFlexiblePageProvider(std::move(schema));
@@ -124,12 +174,12 @@ std::shared_ptr<IPageProvider> Database::createPageProvider(std::shared_ptr<Sche
     return createFixedPageProvider(std::move(schema));
 }
 
-std::shared_ptr<Database> connect(const std::filesystem::path & path, FrameIndex frame_count)
+std::shared_ptr<Database> connect(const std::filesystem::path & path, FrameIndex frame_count, BufferPoolOptions buffer_pool_options)
 {
     if (!std::filesystem::exists(path))
         std::filesystem::create_directories(path);
 
-    return std::make_shared<Database>(path, frame_count);
+    return std::make_shared<Database>(path, frame_count, buffer_pool_options);
 }
 
 }
@@ -2,6 +2,7 @@
 
 #include <filesystem>
 
+#include "bulk_loader.h"
 #include "catalog.h"
 #include "index.h"
 #include "schema.h"
@@ -15,9 +16,10 @@ namespace shdb
 class Database
 {
 public:
-    Database(const std::filesystem::path & path, FrameIndex frame_count);
+    Database(const std::filesystem::path & path, FrameIndex frame_count, BufferPoolOptions buffer_pool_options = {});
 
-    std::shared_ptr<ITable> createTable(const std::string & table_name, std::shared_ptr<Schema> schema);
+    std::shared_ptr<ITable>
+    createTable(const std::string & table_name, std::shared_ptr<Schema> schema, TableLayout layout = TableLayout::row);
 
     std::shared_ptr<ITable> getTable(const std::string & name, std::shared_ptr<Schema> schema = nullptr);
 
@@ -25,6 +27,9 @@ public:
 
     void dropTable(const std::string & name);
 
+    /// Bulk loads delimited text file into existing table, returns number of loaded rows
+    size_t copyFromFile(const std::string & name, const std::filesystem::path & path, const CopyOptions & options = {});
+
     using IndexCreateCallback = std::function<std::shared_ptr<IIndex>(const IndexMetadata &, Store &)>;
 
     using IndexDropCallback = std::function<void(const IndexMetadata &, Store & store)>;
@@ -43,15 +48,32 @@ public:
 
     std::shared_ptr<Store> getStore() const { return store; }
 
+    /// Changed whenever tables or indexes are created or dropped, plans built with an older version are stale
+    uint64_t getCatalogVersion() const { return catalog_version; }
+
 private:
-    std::shared_ptr<IPageProvider> createPageProvider(std::shared_ptr<Schema> schema);
+    /// Open handle with the schema it interprets pages with
+    struct OpenTable
+    {
+        std::shared_ptr<Schema> schema;
+        std::shared_ptr<ITable> table;
+    };
+
+    std::shared_ptr<ITablePageProvider> createPageProvider(std::shared_ptr<Schema> schema, TableLayout layout);
 
     std::shared_ptr<Statistics> statistics;
     std::shared_ptr<Store> store;
     std::shared_ptr<Catalog> catalog;
     std::unordered_map<std::string, std::pair<IndexCreateCallback, IndexDropCallback>> index_type_to_callbacks;
+
+    /// Handles are reused across statements, so per-table state such as free space map stays in memory.
+    /// Entries are removed when tables and indexes are dropped.
+    std::unordered_map<std::string, OpenTable> open_tables;
+    std::unordered_map<std::string, std::shared_ptr<IIndex>> open_indexes;
+    uint64_t catalog_version = 0;
 };
 
-std::shared_ptr<Database> connect(const std::filesystem::path & path, FrameIndex frame_count);
+std::shared_ptr<Database>
+connect(const std::filesystem::path & path, FrameIndex frame_count, BufferPoolOptions buffer_pool_options = {});
 
 }
@@ -1,13 +1,40 @@
 #include "executor.h"
+#include "aggregation_table.h"
 #include "scan.h"
 #include "comparator.h"
 
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
 namespace shdb
 {
 
 namespace
 {
 
+/// Returns rows of batches one at a time, executors working on batches implement next with it
+class BatchRowReader
+{
+public:
+    std::optional<Row> next(IExecutor & executor)
+    {
+        while (position == batch.size()) {
+            if (!executor.nextBatch(batch)) {
+                return std::optional<Row>();
+            }
+            position = 0;
+        }
+        return batch.getRow(batch.getSelection()[position++]);
+    }
+
+private:
+    ColumnBatch batch;
+    size_t position = 0;
+};
+
 class ReadFromRowsExecutor : public IExecutor
 {
 public:
@@ -24,6 +51,14 @@ public:
         }
     }
 
+    bool nextBatch(ColumnBatch & batch) override {
+        batch.reset(rows_schema);
+        for (; idx < rows.size() && batch.size() < ColumnBatch::DefaultSize; ++idx) {
+            batch.appendRow(rows[idx]);
+        }
+        return !batch.empty();
+    }
+
     std::shared_ptr<Schema> getOutputSchema() override {
         return rows_schema;
     }
@@ -37,50 +72,157 @@ private:
 class ReadFromTableExecutor : public IExecutor
 {
 public:
-    explicit ReadFromTableExecutor(std::shared_ptr<ITable> table_, std::shared_ptr<Schema> table_schema_)
-        : table(std::move(table_)), table_schema(std::move(table_schema_)), scan(table), it(scan.begin())
+    ReadFromTableExecutor(
+        std::shared_ptr<ITable> table_,
+        std::shared_ptr<Schema> table_schema_,
+        std::optional<ColumnPredicate> predicate_,
+        std::optional<std::vector<size_t>> columns_,
+        TableSlice slice_)
+        : table(std::move(table_))
+        , table_schema(std::move(table_schema_))
+        , predicate(std::move(predicate_))
+        , output_schema(table_schema)
+        , slice(slice_)
     {
+        if (columns_) {
+            columns = std::move(*columns_);
+            output_schema = std::make_shared<Schema>();
+            for (auto column : columns) {
+                output_schema->push_back((*table_schema)[column]);
+            }
+        } else {
+            columns.resize(table_schema->size());
+            std::iota(columns.begin(), columns.end(), 0);
+        }
     }
 
     std::optional<Row> next() override {
-        while (true)
-        {
-            if (it == scan.end())
-            {
-                return std::optional<Row>();
+        auto row_view = nextRowView();
+        if (!row_view.has_value()) {
+            return std::optional<Row>();
+        }
+        if (output_schema == table_schema) {
+            return row_view->materialize();
+        }
+        Row row;
+        row.reserve(columns.size());
+        for (auto column : columns) {
+            row.push_back(row_view->getValue(column));
+        }
+        return row;
+    }
+
+    /// Views are rows of table, consumers of projected output read materialized rows
+    bool hasRowViews() override {
+        return output_schema == table_schema;
+    }
+
+    std::optional<RowView> nextRowView() override {
+        /// Position is moved lazily, so nothing is pinned before the first call
+        /// and previously returned view stays valid until this call
+        if (started) {
+            ++position;
+        }
+        started = true;
+
+        while (position >= batch.size()) {
+            batch = PageBatch();
+            auto end_page_index = getEndPageIndex();
+            if (next_page_index >= end_page_index) {
+                return std::optional<RowView>();
             }
-            else if (!it.getRow().empty())
-            {
-                auto row = it.getRow();
-                ++it;
-                return row;
-            } else {
-                ++it;
+            batch = predicate ? table->readPage(next_page_index++, *predicate) : table->readPage(next_page_index++);
+            position = 0;
+        }
+        return batch.getRowView(position);
+    }
+
+    /// Whole pages are decoded column by column, so every column is read with a single type dispatch per page.
+    /// Columns that are not in output are not decoded at all.
+    bool nextBatch(ColumnBatch & output) override {
+        output.reset(output_schema);
+        auto end_page_index = getEndPageIndex();
+        while (output.size() < ColumnBatch::DefaultSize && next_page_index < end_page_index) {
+            auto page = predicate ? table->readPage(next_page_index++, *predicate) : table->readPage(next_page_index++);
+            for (size_t column = 0; column < columns.size(); ++column) {
+                auto & column_vector = output.getColumn(column);
+                for (size_t row = 0; row < page.size(); ++row) {
+                    column_vector.append(page.getRowView(row), columns[column]);
+                }
             }
+            output.addRows(page.size());
         }
+        return !output.empty();
     }
 
     std::shared_ptr<Schema> getOutputSchema() override {
-        return table_schema;
+        return output_schema;
     }
 
 private:
+    /// Whole table is read up to its current end, slices are fixed at the first read
+    PageIndex getEndPageIndex() {
+        if (slice.count == 1) {
+            return table->getPageCount();
+        }
+        if (!end_page_index) {
+            auto page_count = table->getPageCount();
+            next_page_index = page_count * slice.index / slice.count;
+            end_page_index = page_count * (slice.index + 1) / slice.count;
+        }
+        return *end_page_index;
+    }
+
     std::shared_ptr<ITable> table;
     std::shared_ptr<Schema> table_schema;
-    Scan scan;
-    ScanIterator it;
+    std::optional<ColumnPredicate> predicate;
+    std::vector<size_t> columns;
+    std::shared_ptr<Schema> output_schema;
+    TableSlice slice;
+    std::optional<PageIndex> end_page_index;
+    PageBatch batch;
+    PageIndex next_page_index = 0;
+    size_t position = 0;
+    bool started = false;
 };
 
 class ExpressionsExecutor : public IExecutor
 {
 public:
     explicit ExpressionsExecutor(ExecutorPtr input_executor_, Expressions expressions_)
-        : input_executor(std::move(input_executor_)), expressions(std::move(expressions_))
+        : input_executor(std::move(input_executor_)), expressions(std::move(expressions_)), output_schema(std::make_shared<Schema>())
     {
+        for (const auto & expression : expressions) {
+            output_schema->push_back(expression->getResultType());
+        }
     }
 
     std::optional<Row> next() override {
-        auto input = input_executor->next();
+        if (input_executor->hasRowViews()) {
+            return evaluate(input_executor->nextRowView());
+        }
+        return evaluate(input_executor->next());
+    }
+
+    bool nextBatch(ColumnBatch & batch) override {
+        if (!input_executor->nextBatch(input_batch)) {
+            return false;
+        }
+        batch.reset(output_schema);
+        for (size_t index = 0; index < expressions.size(); ++index) {
+            expressions[index]->evaluate(input_batch, batch.getColumn(index));
+        }
+        batch.addRows(input_batch.size());
+        return true;
+    }
+
+    std::shared_ptr<Schema> getOutputSchema() override {
+        return output_schema;
+    }
+
+private:
+    template <class Input>
+    std::optional<Row> evaluate(const std::optional<Input> & input) {
         if (!input.has_value()) {
             return std::optional<Row>();
         }
@@ -91,17 +233,10 @@ public:
         return row;
     }
 
-    std::shared_ptr<Schema> getOutputSchema() override {
-        auto schema = std::make_shared<Schema>();
-        for (const auto & expression : expressions) {
-            schema->push_back(expression->getResultType());
-        }
-        return schema;
-    }
-
-private:
     ExecutorPtr input_executor;
     Expressions expressions;
+    std::shared_ptr<Schema> output_schema;
+    ColumnBatch input_batch;
 };
 
 class FilterExecutor : public IExecutor
@@ -113,6 +248,14 @@ public:
     }
 
     std::optional<Row> next() override {
+        if (input_executor->hasRowViews()) {
+            auto row_view = nextRowView();
+            if (!row_view.has_value()) {
+                return std::optional<Row>();
+            }
+            return row_view->materialize();
+        }
+
         std::optional<Row> row;
         while ((row = input_executor->next()).has_value()) {
             if (std::get<bool>(filter_expression->evaluate(row.value()))) {
@@ -122,6 +265,35 @@ public:
         return row;
     }
 
+    bool hasRowViews() override {
+        return input_executor->hasRowViews();
+    }
+
+    std::optional<RowView> nextRowView() override {
+        std::optional<RowView> row_view;
+        while ((row_view = input_executor->nextRowView()).has_value()) {
+            if (std::get<bool>(filter_expression->evaluate(row_view.value()))) {
+                return row_view;
+            }
+        }
+        return row_view;
+    }
+
+    /// Rows are dropped by narrowing selection, column values stay in place
+    bool nextBatch(ColumnBatch & batch) override {
+        while (input_executor->nextBatch(batch)) {
+            filter_expression->evaluateFilter(batch, matches);
+
+            std::vector<uint32_t> selection;
+            selectFromBitmap(matches.data(), batch.getSelection(), selection);
+            if (!selection.empty()) {
+                batch.setSelection(std::move(selection));
+                return true;
+            }
+        }
+        return false;
+    }
+
     std::shared_ptr<Schema> getOutputSchema() override {
         return input_executor->getOutputSchema();
     }
@@ -129,6 +301,7 @@ public:
 private:
     ExecutorPtr input_executor;
     ExpressionPtr filter_expression;
+    SelectionBitmap matches;
 };
 
 class SortExecutor : public IExecutor
@@ -137,33 +310,29 @@ public:
     explicit SortExecutor(ExecutorPtr input_executor_, SortExpressions sort_expressions_)
         : input_executor(std::move(input_executor_)), sort_expressions(std::move(sort_expressions_))
     {
-        std::optional<Row> row;
-        while ((row = input_executor->next()).has_value()) {
-            rows.push_back(std::move(row.value()));
-        }
-        std::sort(rows.begin(), rows.end(), [&](const Row& lhs, const Row& rhs) {
-            for (auto & sort_expression : sort_expressions) {
-                auto lhs_val = sort_expression.expression->evaluate(lhs);
-                auto rhs_val = sort_expression.expression->evaluate(rhs);
-                if (lhs_val == rhs_val) {
-                    continue;
-                }
-                if (!sort_expression.desc) {
-                    return compareValue(lhs_val, rhs_val) == -1;
-                } else {
-                    return compareValue(lhs_val, rhs_val) == 1;
-                }
-            }
-            return false;
-        });
     }
 
     std::optional<Row> next() override {
-        if (idx < rows.size()) {
-            return rows[idx++];
-        } else {
-            return std::optional<Row>();
+        return reader.next(*this);
+    }
+
+    bool nextBatch(ColumnBatch & batch) override {
+        if (!sorted) {
+            sort();
         }
+        if (position == order.size()) {
+            return false;
+        }
+
+        size_t count = std::min(ColumnBatch::DefaultSize, order.size() - position);
+        std::vector<uint32_t> slice(order.begin() + position, order.begin() + position + count);
+        batch.reset(input_executor->getOutputSchema());
+        for (size_t column = 0; column < batch.getColumnCount(); ++column) {
+            batch.getColumn(column).gather(rows.getColumn(column), slice);
+        }
+        batch.addRows(count);
+        position += count;
+        return true;
     }
 
     std::shared_ptr<Schema> getOutputSchema() override {
@@ -171,12 +340,47 @@ public:
     }
 
 private:
+    /// Sort keys are evaluated once per row, then only row numbers are permuted
+    void sort() {
+        sorted = true;
+        rows.reset(input_executor->getOutputSchema());
+        ColumnBatch input_batch;
+        while (input_executor->nextBatch(input_batch)) {
+            rows.appendSelected(input_batch);
+        }
+
+        std::vector<ColumnVector> keys;
+        keys.reserve(sort_expressions.size());
+        for (auto & sort_expression : sort_expressions) {
+            keys.emplace_back(sort_expression.expression->getResultType());
+            sort_expression.expression->evaluate(rows, keys.back());
+        }
+
+        order.resize(rows.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+            for (size_t index = 0; index < keys.size(); ++index) {
+                int result = keys[index].compare(lhs, keys[index], rhs);
+                if (result == 0) {
+                    continue;
+                }
+                return sort_expressions[index].desc ? result > 0 : result < 0;
+            }
+            return false;
+        });
+    }
+
     ExecutorPtr input_executor;
     SortExpressions sort_expressions;
-    std::vector<Row> rows;
-    size_t idx = 0;
+    ColumnBatch rows;
+    std::vector<uint32_t> order;
+    size_t position = 0;
+    bool sorted = false;
+    BatchRowReader reader;
 };
 
+/// Hash join on columns present in both inputs, left input is the build side.
+/// For every right row all matching left rows are returned in the order they were read.
 class JoinExecutor : public IExecutor
 {
 public:
@@ -184,68 +388,58 @@ public:
         : left_input_executor(std::move(left_input_executor_)), right_input_executor(std::move(right_input_executor_))
     {
         out_schema = std::make_shared<Schema>();
-        key_schema = std::make_shared<Schema>();
-        for (const auto& item : *left_input_executor->getOutputSchema()) {
+        const auto & left_schema = *left_input_executor->getOutputSchema();
+        const auto & right_schema = *right_input_executor->getOutputSchema();
+        for (const auto& item : left_schema) {
             out_schema->push_back(item);
         }
-        for (const auto& item : *right_input_executor->getOutputSchema()) {
-            if (std::find((*out_schema).begin(), (*out_schema).end(), item) != (*out_schema).end()) {
-                key_schema->push_back(item);
+        for (size_t i = 0; i < right_schema.size(); ++i) {
+            auto it = std::find(left_schema.begin(), left_schema.end(), right_schema[i]);
+            if (it != left_schema.end()) {
+                left_key_columns.push_back(it - left_schema.begin());
+                right_key_columns.push_back(i);
             } else {
-                out_schema->push_back(item);
-            }
-        }
-        std::optional<Row> item;
-        while ((item = left_input_executor->next()).has_value()) {
-            Row key;
-            for (size_t i = 0; i < item->size(); ++i) {
-                ColumnSchema citem = (*(left_input_executor->getOutputSchema()))[i];
-                if (std::find((*key_schema).begin(), (*key_schema).end(), citem) != (*key_schema).end()) {
-                    key.push_back((*item)[i]);
-                }
+                out_schema->push_back(right_schema[i]);
+                right_output_columns.push_back(i);
             }
-            storage[key].push_back(item.value());
         }
     }
 
     std::optional<Row> next() override {
-        if (last_row.has_value()) {
-            if (storage[saved_key].size() < idx) {
-                Row value = storage[saved_key][idx++];
-                for (size_t i = 0; i < last_row->size(); ++i) {
-                    ColumnSchema citem = (*(right_input_executor->getOutputSchema()))[i];
-                    if (std::find((*key_schema).begin(), (*key_schema).end(), citem) == (*key_schema).end()) {
-                        value.push_back((*last_row)[i]);
-                    }
-                }
-                return value;
-            }
+        return reader.next(*this);
+    }
+
+    bool nextBatch(ColumnBatch & batch) override {
+        if (!built) {
+            build();
         }
-        last_row.reset();
-        std::optional<Row> item;
-        while ((item = right_input_executor->next()).has_value()) {
-            Row key;
-            for (size_t i = 0; i < item->size(); ++i) {
-                ColumnSchema citem = (*(right_input_executor->getOutputSchema()))[i];
-                if (std::find((*key_schema).begin(), (*key_schema).end(), citem) != (*key_schema).end()) {
-                    key.push_back((*item)[i]);
-                }
+
+        size_t left_column_count = left_rows.getColumnCount();
+        batch.reset(out_schema);
+        while (batch.empty()) {
+            if (!right_input_executor->nextBatch(right_batch)) {
+                return false;
             }
-            if (storage.contains(key) && !storage[key].empty()) {
-                Row value = storage[key][0];
-                idx = 1;
-                saved_key = key;
-                for (size_t i = 0; i < item->size(); ++i) {
-                    ColumnSchema citem = (*(right_input_executor->getOutputSchema()))[i];
-                    if (std::find((*key_schema).begin(), (*key_schema).end(), citem) == (*key_schema).end()) {
-                        value.push_back((*item)[i]);
+
+            size_t count = 0;
+            for (auto row : right_batch.getSelection()) {
+                auto it = storage.find(makeKey(right_batch, right_key_columns, row));
+                if (it == storage.end()) {
+                    continue;
+                }
+                for (auto left_row : it->second) {
+                    for (size_t i = 0; i < left_column_count; ++i) {
+                        batch.getColumn(i).appendFrom(left_rows.getColumn(i), left_row);
+                    }
+                    for (size_t i = 0; i < right_output_columns.size(); ++i) {
+                        batch.getColumn(left_column_count + i).appendFrom(right_batch.getColumn(right_output_columns[i]), row);
                     }
                 }
-                last_row = item;
-                return value;
+                count += it->second.size();
             }
+            batch.addRows(count);
         }
-        return std::optional<Row>();
+        return true;
     }
 
     std::shared_ptr<Schema> getOutputSchema() override {
@@ -253,36 +447,255 @@ public:
     }
 
 private:
+    static Row makeKey(const ColumnBatch & batch, const std::vector<size_t> & key_columns, size_t row) {
+        Row key;
+        key.reserve(key_columns.size());
+        for (auto column : key_columns) {
+            key.push_back(batch.getColumn(column).getValue(row));
+        }
+        return key;
+    }
+
+    void build() {
+        built = true;
+        left_rows.reset(left_input_executor->getOutputSchema());
+        ColumnBatch input_batch;
+        while (left_input_executor->nextBatch(input_batch)) {
+            left_rows.appendSelected(input_batch);
+        }
+        for (uint32_t row = 0; row < left_rows.getRowCount(); ++row) {
+            storage[makeKey(left_rows, left_key_columns, row)].push_back(row);
+        }
+    }
+
     ExecutorPtr left_input_executor;
     ExecutorPtr right_input_executor;
-    std::unordered_map<Row, std::vector<Row>> storage;
-    std::shared_ptr<Schema> key_schema;
     std::shared_ptr<Schema> out_schema;
-    std::optional<Row> last_row;
-    Row saved_key;
-    size_t idx;
-
+    std::vector<size_t> left_key_columns;
+    std::vector<size_t> right_key_columns;
+    std::vector<size_t> right_output_columns;
+    ColumnBatch left_rows;
+    ColumnBatch right_batch;
+    std::unordered_map<Row, std::vector<uint32_t>> storage;
+    bool built = false;
+    BatchRowReader reader;
 };
 
+/// Runs job(index) for every index below count on its own thread, the first exception is rethrown after all jobs finish
+template <class Job>
+void runInParallel(size_t count, Job job)
+{
+    if (count == 1) {
+        job(0);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(count);
+    std::vector<std::thread> threads;
+    for (size_t index = 0; index < count; ++index) {
+        threads.emplace_back([&, index] {
+            try {
+                job(index);
+            } catch (...) {
+                errors[index] = std::current_exception();
+            }
+        });
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    for (const auto & error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+/// Two phase hash aggregation, whole input is consumed on the first call. Threads take input batches one at a time
+/// and aggregate them into own tables partitioned by key hash, then partitions with the same number are merged in parallel.
+/// Input executor is pulled under a lock, so scaling is bounded by how fast it produces batches, only key and argument
+/// evaluation and aggregation run in parallel. Inputs shorter than ParallelMinBatches never start threads.
+/// Output has key columns followed by aggregate columns. Without keys there is exactly one group even for empty input.
 class GroupByExecutor : public IExecutor
 {
 public:
-    explicit GroupByExecutor(ExecutorPtr input_executor_, GroupByKeys group_by_keys_, GroupByExpressions group_by_expressions_)
-        : input_executor(std::move(input_executor_))
+    /// Single input is shared by threads, otherwise every input has its own thread
+    explicit GroupByExecutor(
+        std::vector<ExecutorPtr> inputs_, GroupByKeys group_by_keys_, GroupByExpressions group_by_expressions_, size_t threads)
+        : inputs(std::move(inputs_))
         , group_by_keys(std::move(group_by_keys_))
         , group_by_expressions(std::move(group_by_expressions_))
+        , output_schema(std::make_shared<Schema>())
+        , thread_count(inputs.size() > 1 ? inputs.size() : threads != 0 ? threads : std::max(1U, std::thread::hardware_concurrency()))
     {
-        throw std::runtime_error("Not implemented");
+        for (const auto & key : group_by_keys) {
+            key_types.push_back(key.expression->getResultType());
+            output_schema->emplace_back(key.expression_column_name, key_types.back());
+        }
+        for (const auto & expression : group_by_expressions) {
+            aggregate_functions.push_back(expression.aggregate_function);
+            output_schema->emplace_back(expression.aggregate_function_column_name, expression.aggregate_function->getResultType());
+        }
+    }
+
+    std::optional<Row> next() override {
+        return reader.next(*this);
     }
 
-    std::optional<Row> next() override { throw std::runtime_error("Not implemented"); }
+    bool nextBatch(ColumnBatch & batch) override {
+        if (!result) {
+            aggregate();
+        }
+
+        batch.reset(output_schema);
+        size_t count = 0;
+        while (count < ColumnBatch::DefaultSize && partition < PartitionedAggregationTable::PartitionCount) {
+            const auto & table = result->getPartition(partition);
+            size_t size = std::min(ColumnBatch::DefaultSize - count, table.getGroupCount() - position);
+            table.getResults(position, position + size, batch);
+            count += size;
+            position += size;
+            if (position == table.getGroupCount()) {
+                ++partition;
+                position = 0;
+            }
+        }
+        batch.addRows(count);
+        return count != 0;
+    }
 
-    std::shared_ptr<Schema> getOutputSchema() override { throw std::runtime_error("Not implemented"); }
+    std::shared_ptr<Schema> getOutputSchema() override {
+        return output_schema;
+    }
 
 private:
-    ExecutorPtr input_executor;
+    /// Batches aggregated on the calling thread before other threads are started
+    static constexpr size_t ParallelMinBatches = 8;
+
+    /// State of one thread in the first phase
+    struct Worker
+    {
+        std::unique_ptr<PartitionedAggregationTable> table;
+        ColumnBatch input_batch;
+        std::vector<ColumnVector> key_columns;
+        std::vector<std::vector<ColumnVector>> argument_columns;
+        std::vector<AggregateDataPtr> places;
+    };
+
+    void initWorker(Worker & worker) {
+        worker.table = std::make_unique<PartitionedAggregationTable>(key_types, aggregate_functions);
+        for (auto type : key_types) {
+            worker.key_columns.emplace_back(type);
+        }
+        for (const auto & expression : group_by_expressions) {
+            auto & columns = worker.argument_columns.emplace_back();
+            for (const auto & argument : expression.arguments) {
+                columns.emplace_back(argument->getResultType());
+            }
+        }
+    }
+
+    void aggregate() {
+        std::vector<Worker> workers(thread_count);
+        initWorker(workers.front());
+
+        /// Small inputs are aggregated without threads, starting them and merging their tables costs more than it saves
+        std::atomic<bool> failed = false;
+        if (!consume(workers.front(), getInput(0), ParallelMinBatches, failed)) {
+            workers.resize(1);
+            for (size_t index = 1; index < inputs.size(); ++index) {
+                consume(workers.front(), *inputs[index], std::numeric_limits<size_t>::max(), failed);
+            }
+        } else if (thread_count == 1) {
+            consume(workers.front(), getInput(0), std::numeric_limits<size_t>::max(), failed);
+        } else {
+            for (size_t index = 1; index < thread_count; ++index) {
+                initWorker(workers[index]);
+            }
+            runInParallel(thread_count, [&](size_t index) {
+                try {
+                    consume(workers[index], getInput(index), std::numeric_limits<size_t>::max(), failed);
+                } catch (...) {
+                    failed = true;
+                    throw;
+                }
+            });
+        }
+
+        /// States of other workers are merged into tables of the first one, each partition by a single thread
+        if (workers.size() > 1) {
+            std::atomic<size_t> next_partition = 0;
+            runInParallel(std::min(thread_count, PartitionedAggregationTable::PartitionCount), [&](size_t) {
+                size_t partition_index;
+                while ((partition_index = next_partition++) < PartitionedAggregationTable::PartitionCount) {
+                    auto & partition = workers.front().table->getPartition(partition_index);
+                    for (size_t index = 1; index < workers.size(); ++index) {
+                        partition.merge(workers[index].table->getPartition(partition_index));
+                    }
+                }
+            });
+        }
+        result = std::move(workers.front().table);
+
+        if (group_by_keys.empty() && result->getGroupCount() == 0) {
+            auto & worker = workers.front();
+            worker.places.resize(1);
+            result->findGroups(worker.key_columns, 1, worker.places.data());
+        }
+    }
+
+    IExecutor & getInput(size_t worker_index) {
+        return *inputs[inputs.size() == 1 ? 0 : worker_index];
+    }
+
+    /// Aggregates up to max_batches input batches, returns false once input is exhausted or another worker failed.
+    /// Expressions and aggregate functions keep no state of their own, so threads evaluate them concurrently,
+    /// only pulling the next batch from a shared input is serialized.
+    bool consume(Worker & worker, IExecutor & input, size_t max_batches, const std::atomic<bool> & failed) {
+        for (size_t batch = 0; batch < max_batches; ++batch) {
+            {
+                std::unique_lock lock(input_mutex, std::defer_lock);
+                if (inputs.size() == 1) {
+                    lock.lock();
+                }
+                if (failed || !input.nextBatch(worker.input_batch)) {
+                    return false;
+                }
+            }
+
+            size_t size = worker.input_batch.size();
+            for (size_t index = 0; index < group_by_keys.size(); ++index) {
+                worker.key_columns[index].clear();
+                group_by_keys[index].expression->evaluate(worker.input_batch, worker.key_columns[index]);
+            }
+            worker.places.resize(size);
+            worker.table->findGroups(worker.key_columns, size, worker.places.data());
+
+            for (size_t index = 0; index < group_by_expressions.size(); ++index) {
+                const auto & expression = group_by_expressions[index];
+                auto & columns = worker.argument_columns[index];
+                for (size_t argument = 0; argument < columns.size(); ++argument) {
+                    columns[argument].clear();
+                    expression.arguments[argument]->evaluate(worker.input_batch, columns[argument]);
+                }
+                expression.aggregate_function->addBatch(worker.places.data(), worker.table->getStateOffset(index), columns, size);
+            }
+        }
+        return true;
+    }
+
+    std::vector<ExecutorPtr> inputs;
     GroupByKeys group_by_keys;
     GroupByExpressions group_by_expressions;
+    std::shared_ptr<Schema> output_schema;
+    Types key_types;
+    std::vector<AggregateFunctionPtr> aggregate_functions;
+    size_t thread_count;
+    std::mutex input_mutex;
+    std::unique_ptr<PartitionedAggregationTable> result;
+    size_t partition = 0;
+    size_t position = 0;
+    BatchRowReader reader;
 };
 
 }
@@ -292,9 +705,14 @@ ExecutorPtr createReadFromRowsExecutor(Rows rows, std::shared_ptr<Schema> rows_s
     return std::make_unique<ReadFromRowsExecutor>(rows, rows_schema);
 }
 
-ExecutorPtr createReadFromTableExecutor(std::shared_ptr<ITable> table, std::shared_ptr<Schema> table_schema)
+ExecutorPtr createReadFromTableExecutor(
+    std::shared_ptr<ITable> table,
+    std::shared_ptr<Schema> table_schema,
+    std::optional<ColumnPredicate> predicate,
+    std::optional<std::vector<size_t>> columns,
+    TableSlice slice)
 {
-    return std::make_unique<ReadFromTableExecutor>(table, table_schema);
+    return std::make_unique<ReadFromTableExecutor>(table, table_schema, std::move(predicate), std::move(columns), slice);
 }
 
 ExecutorPtr createExpressionsExecutor(ExecutorPtr input_executor, Expressions expressions)
@@ -317,20 +735,37 @@ ExecutorPtr createJoinExecutor(ExecutorPtr left_input_executor, ExecutorPtr righ
     return std::make_unique<JoinExecutor>(std::move(left_input_executor), std::move(right_input_executor));
 }
 
-ExecutorPtr createGroupByExecutor(ExecutorPtr input_executor, GroupByKeys group_by_keys, GroupByExpressions group_by_expressions)
+ExecutorPtr
+createGroupByExecutor(ExecutorPtr input_executor, GroupByKeys group_by_keys, GroupByExpressions group_by_expressions, size_t threads)
+{
+    std::vector<ExecutorPtr> inputs;
+    inputs.push_back(std::move(input_executor));
+    return std::make_unique<GroupByExecutor>(std::move(inputs), std::move(group_by_keys), std::move(group_by_expressions), threads);
+}
+
+ExecutorPtr createGroupByExecutor(std::vector<ExecutorPtr> inputs, GroupByKeys group_by_keys, GroupByExpressions group_by_expressions)
+{
+    return std::make_unique<GroupByExecutor>(std::move(inputs), std::move(group_by_keys), std::move(group_by_expressions), 0);
+}
+
+bool IExecutor::nextBatch(ColumnBatch & batch)
 {
-    (void)(input_executor);
-    (void)(group_by_keys);
-    (void)(group_by_expressions);
-    throw std::runtime_error("Not implemented");
+    batch.reset(getOutputSchema());
+    std::optional<Row> row;
+    while (batch.size() < ColumnBatch::DefaultSize && (row = next()).has_value()) {
+        batch.appendRow(*row);
+    }
+    return !batch.empty();
 }
 
 RowSet rexecute(ExecutorPtr executor)
 {
     RowSet ans(executor->getOutputSchema());
-    std::optional<Row> t;
-    while ((t = executor->next()).has_value()) {
-        ans.addRow(t.value());
+    ColumnBatch batch;
+    while (executor->nextBatch(batch)) {
+        for (auto row : batch.getSelection()) {
+            ans.addRow(batch.getRow(row));
+        }
     }
     return ans;
 }
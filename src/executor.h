@@ -15,6 +15,18 @@ public:
 
     virtual std::optional<Row> next() = 0;
 
+    /// Refills batch with the next rows, returns false once input is exhausted. Returned batches are never empty.
+    /// Default implementation collects rows returned by next, so row at a time executors feed batch consumers.
+    /// Consumer uses either next or nextBatch of an executor, not both.
+    virtual bool nextBatch(ColumnBatch & batch);
+
+    /// Executors reading table pages can return rows as views over pinned page bytes,
+    /// so consumers decode only columns they read and materialize only rows they keep
+    virtual bool hasRowViews() { return false; }
+
+    /// Next row as view, valid until the following call
+    virtual std::optional<RowView> nextRowView() { throw std::runtime_error("Row views are not supported"); }
+
     virtual std::shared_ptr<Schema> getOutputSchema() = 0;
 };
 
@@ -22,7 +34,21 @@ using ExecutorPtr = std::unique_ptr<IExecutor>;
 
 ExecutorPtr createReadFromRowsExecutor(Rows rows, std::shared_ptr<Schema> rows_schema);
 
-ExecutorPtr createReadFromTableExecutor(std::shared_ptr<ITable> table, std::shared_ptr<Schema> table_schema);
+/// One of count equal ranges of table pages, ranges are computed when the scan reads the first page
+struct TableSlice
+{
+    size_t index = 0;
+    size_t count = 1;
+};
+
+/// Only rows matching predicate are read if it is given. If columns are given, output has only these columns of table
+/// in the same order and batches decode only them, predicate still refers to columns of table.
+ExecutorPtr createReadFromTableExecutor(
+    std::shared_ptr<ITable> table,
+    std::shared_ptr<Schema> table_schema,
+    std::optional<ColumnPredicate> predicate = std::nullopt,
+    std::optional<std::vector<size_t>> columns = std::nullopt,
+    TableSlice slice = {});
 
 ExecutorPtr createExpressionsExecutor(ExecutorPtr input_executor, Expressions expressions);
 
@@ -57,7 +83,14 @@ struct GroupByKey
 
 using GroupByKeys = std::vector<GroupByKey>;
 
-ExecutorPtr createGroupByExecutor(ExecutorPtr input_executor, GroupByKeys group_by_keys, GroupByExpressions group_by_expressions);
+/// Input batches are aggregated by threads in parallel, hardware concurrency if zero. Small inputs use one thread.
+/// Expressions and aggregate functions are called from several threads at once.
+ExecutorPtr
+createGroupByExecutor(ExecutorPtr input_executor, GroupByKeys group_by_keys, GroupByExpressions group_by_expressions, size_t threads = 0);
+
+/// Every input is read and aggregated by its own thread, inputs must have the same schema.
+/// If the first input turns out small, all of them are read by the calling thread.
+ExecutorPtr createGroupByExecutor(std::vector<ExecutorPtr> inputs, GroupByKeys group_by_keys, GroupByExpressions group_by_expressions);
 
 RowSet rexecute(ExecutorPtr executor);
 
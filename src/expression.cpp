@@ -1,9 +1,82 @@
 #include "expression.h"
+#include "compiled_expression.h"
+#include <functional>
 #include <variant>
 
 namespace shdb
 {
 
+void IExpression::evaluateFilter(const ColumnBatch & input, const std::vector<uint32_t> & selection, SelectionBitmap & output)
+{
+    if (getResultType() != Type::boolean)
+        throw std::runtime_error("Filter expression must be boolean");
+
+    ColumnVector result(Type::boolean);
+    evaluate(input, selection, result);
+    if (result.hasNulls())
+        throw std::runtime_error("Filter expression evaluated to null");
+
+    output.assign(getBitmapWordCount(selection.size()), 0);
+    bitmapFromBooleans(result.getBooleans().data(), selection.size(), output.data());
+}
+
+void evaluateLogical(bool is_and, IExpression & lhs, IExpression & rhs, const ColumnBatch & input, const std::vector<uint32_t> & selection, ColumnVector & output)
+{
+    ColumnVector lhs_values(Type::boolean);
+    lhs.evaluate(input, selection, lhs_values);
+    if (lhs_values.hasNulls())
+        throw std::runtime_error("Null operand of binary operator");
+
+    const auto & lhs_booleans = lhs_values.getBooleans();
+    std::vector<uint32_t> undecided;
+    for (size_t row = 0; row < lhs_booleans.size(); ++row)
+        if (static_cast<bool>(lhs_booleans[row]) == is_and)
+            undecided.push_back(selection[row]);
+
+    ColumnVector rhs_values(Type::boolean);
+    if (!undecided.empty())
+        rhs.evaluate(input, undecided, rhs_values);
+    if (rhs_values.hasNulls())
+        throw std::runtime_error("Null operand of binary operator");
+
+    auto & values = output.getBooleans();
+    size_t rhs_row = 0;
+    for (auto value : lhs_booleans)
+        values.push_back(static_cast<bool>(value) == is_and ? rhs_values.getBooleans()[rhs_row++] : value);
+}
+
+void evaluateLogicalFilter(bool is_and, IExpression & lhs, IExpression & rhs, const ColumnBatch & input, const std::vector<uint32_t> & selection, SelectionBitmap & output)
+{
+    auto size = selection.size();
+    lhs.evaluateFilter(input, selection, output);
+
+    /// For OR undecided rows are the ones lhs dropped
+    SelectionBitmap undecided_bitmap = output;
+    if (!is_and)
+        notBitmap(undecided_bitmap.data(), size);
+    std::vector<uint32_t> undecided;
+    selectFromBitmap(undecided_bitmap.data(), selection, undecided);
+    if (undecided.empty())
+        return;
+
+    SelectionBitmap rhs_bitmap;
+    if (undecided.size() == size)
+    {
+        rhs.evaluateFilter(input, selection, rhs_bitmap);
+    }
+    else
+    {
+        rhs.evaluateFilter(input, undecided, rhs_bitmap);
+        depositBitmap(undecided_bitmap.data(), rhs_bitmap.data(), size);
+        rhs_bitmap = std::move(undecided_bitmap);
+    }
+
+    if (is_and)
+        andBitmaps(output.data(), rhs_bitmap.data(), size);
+    else
+        orBitmaps(output.data(), rhs_bitmap.data(), size);
+}
+
 namespace
 {
 
@@ -25,6 +98,16 @@ public:
         return input_row[idx];
     }
 
+    Value evaluate(const RowView & input_row) override
+    {
+        return input_row.getValue(idx);
+    }
+
+    void evaluate(const ColumnBatch & input, const std::vector<uint32_t> & selection, ColumnVector & output) override
+    {
+        output.gather(input.getColumn(idx), selection);
+    }
+
 private:
     Type identifier_type;
     size_t idx;
@@ -39,6 +122,32 @@ public:
 
     Value evaluate(const Row &) override { return value; }
 
+    Value evaluate(const RowView &) override { return value; }
+
+    void evaluate(const ColumnBatch &, const std::vector<uint32_t> & selection, ColumnVector & output) override
+    {
+        output.getInt64s().resize(output.size() + selection.size(), std::get<int64_t>(value));
+    }
+
+    Value value;
+};
+
+class UnsignedNumberConstantExpression : public IExpression
+{
+public:
+    explicit UnsignedNumberConstantExpression(uint64_t value_) : value(value_) { }
+
+    Type getResultType() override { return Type::uint64; }
+
+    Value evaluate(const Row &) override { return value; }
+
+    Value evaluate(const RowView &) override { return value; }
+
+    void evaluate(const ColumnBatch &, const std::vector<uint32_t> & selection, ColumnVector & output) override
+    {
+        output.getUInt64s().resize(output.size() + selection.size(), std::get<uint64_t>(value));
+    }
+
     Value value;
 };
 
@@ -51,6 +160,32 @@ public:
 
     Value evaluate(const Row &) override { return value; }
 
+    Value evaluate(const RowView &) override { return value; }
+
+    void evaluate(const ColumnBatch &, const std::vector<uint32_t> & selection, ColumnVector & output) override
+    {
+        output.getStrings().resize(output.size() + selection.size(), std::get<std::string>(value));
+    }
+
+    Value value;
+};
+
+class BooleanConstantExpression : public IExpression
+{
+public:
+    explicit BooleanConstantExpression(bool value_) : value(value_) { }
+
+    Type getResultType() override { return Type::boolean; }
+
+    Value evaluate(const Row &) override { return value; }
+
+    Value evaluate(const RowView &) override { return value; }
+
+    void evaluate(const ColumnBatch &, const std::vector<uint32_t> & selection, ColumnVector & output) override
+    {
+        output.getBooleans().resize(output.size() + selection.size(), std::get<bool>(value));
+    }
+
     Value value;
 };
 
@@ -88,7 +223,12 @@ public:
         throw std::runtime_error("???");
     }
 
-    Value evaluate(const Row & input_row) override
+    Value evaluate(const Row & input_row) override { return evaluateImpl(input_row); }
+
+    Value evaluate(const RowView & input_row) override { return evaluateImpl(input_row); }
+
+    template <class Input>
+    Value evaluateImpl(const Input & input_row)
     {
         switch (binary_operator_code)
         {
@@ -121,6 +261,106 @@ public:
         throw std::runtime_error("??");
     }
 
+    void evaluate(const ColumnBatch & input, const std::vector<uint32_t> & selection, ColumnVector & output) override
+    {
+        if (binary_operator_code == BinaryOperatorCode::land || binary_operator_code == BinaryOperatorCode::lor)
+            return evaluateLogical(binary_operator_code == BinaryOperatorCode::land, *lhs_expression, *rhs_expression, input, selection, output);
+
+        ColumnVector lhs(lhs_type);
+        ColumnVector rhs(rhs_type);
+        lhs_expression->evaluate(input, selection, lhs);
+        rhs_expression->evaluate(input, selection, rhs);
+
+        switch (binary_operator_code)
+        {
+            case BinaryOperatorCode::plus:
+                return applyInt64(lhs, rhs, output.getInt64s(), std::plus<int64_t>());
+            case BinaryOperatorCode::minus:
+                return applyInt64(lhs, rhs, output.getInt64s(), std::minus<int64_t>());
+            case BinaryOperatorCode::mul:
+                return applyInt64(lhs, rhs, output.getInt64s(), std::multiplies<int64_t>());
+            case BinaryOperatorCode::div:
+                return applyInt64(lhs, rhs, output.getInt64s(), std::divides<int64_t>());
+            case BinaryOperatorCode::land:
+            case BinaryOperatorCode::lor:
+                break;
+            case BinaryOperatorCode::eq:
+                return applyEquality(lhs, rhs, output.getBooleans(), true);
+            case BinaryOperatorCode::ne:
+                return applyEquality(lhs, rhs, output.getBooleans(), false);
+            case BinaryOperatorCode::lt:
+                return applyInt64(lhs, rhs, output.getBooleans(), std::less<int64_t>());
+            case BinaryOperatorCode::le:
+                return applyInt64(lhs, rhs, output.getBooleans(), std::less_equal<int64_t>());
+            case BinaryOperatorCode::gt:
+                return applyInt64(lhs, rhs, output.getBooleans(), std::greater<int64_t>());
+            case BinaryOperatorCode::ge:
+                return applyInt64(lhs, rhs, output.getBooleans(), std::greater_equal<int64_t>());
+        }
+        throw std::runtime_error("??");
+    }
+
+    void evaluateFilter(const ColumnBatch & input, const std::vector<uint32_t> & selection, SelectionBitmap & output) override
+    {
+        if (binary_operator_code == BinaryOperatorCode::land || binary_operator_code == BinaryOperatorCode::lor)
+            return evaluateLogicalFilter(binary_operator_code == BinaryOperatorCode::land, *lhs_expression, *rhs_expression, input, selection, output);
+        IExpression::evaluateFilter(input, selection, output);
+    }
+
+    /// Operands must have the same type, null operands are rejected like in row evaluation
+    template <class T, class Result, class Operation>
+    static void apply(
+        const std::vector<T> & lhs_values,
+        const std::vector<T> & rhs_values,
+        const ColumnVector & lhs,
+        const ColumnVector & rhs,
+        std::vector<Result> & output,
+        Operation operation)
+    {
+        if (lhs.hasNulls() || rhs.hasNulls())
+            throw std::runtime_error("Null operand of binary operator");
+
+        auto offset = output.size();
+        output.resize(offset + lhs_values.size());
+        for (size_t row = 0; row < lhs_values.size(); ++row)
+            output[offset + row] = operation(lhs_values[row], rhs_values[row]);
+    }
+
+    template <class Result, class Operation>
+    static void applyInt64(const ColumnVector & lhs, const ColumnVector & rhs, std::vector<Result> & output, Operation operation)
+    {
+        if (lhs.getType() != Type::int64 || rhs.getType() != Type::int64)
+            throw std::runtime_error("Operands of arithmetic and ordering operators must be int64");
+        apply(lhs.getInt64s(), rhs.getInt64s(), lhs, rhs, output, operation);
+    }
+
+    /// Equality is defined for any operands, including nulls and values of different types
+    static void applyEquality(const ColumnVector & lhs, const ColumnVector & rhs, std::vector<uint8_t> & output, bool equal)
+    {
+        bool same_type = lhs.getType() == rhs.getType()
+            || ((lhs.getType() == Type::varchar || lhs.getType() == Type::string)
+                && (rhs.getType() == Type::varchar || rhs.getType() == Type::string));
+        if (same_type && !lhs.hasNulls() && !rhs.hasNulls())
+        {
+            switch (lhs.getType())
+            {
+                case Type::boolean:
+                    return apply(lhs.getBooleans(), rhs.getBooleans(), lhs, rhs, output, [&](auto l, auto r) { return (l == r) == equal; });
+                case Type::uint64:
+                    return apply(lhs.getUInt64s(), rhs.getUInt64s(), lhs, rhs, output, [&](auto l, auto r) { return (l == r) == equal; });
+                case Type::int64:
+                    return apply(lhs.getInt64s(), rhs.getInt64s(), lhs, rhs, output, [&](auto l, auto r) { return (l == r) == equal; });
+                case Type::varchar:
+                case Type::string:
+                    return apply(
+                        lhs.getStrings(), rhs.getStrings(), lhs, rhs, output, [&](const auto & l, const auto & r) { return (l == r) == equal; });
+            }
+        }
+
+        for (size_t row = 0; row < lhs.size(); ++row)
+            output.push_back((lhs.getValue(row) == rhs.getValue(row)) == equal);
+    }
+
     const BinaryOperatorCode binary_operator_code;
     ExpressionPtr lhs_expression;
     ExpressionPtr rhs_expression;
@@ -138,7 +378,12 @@ public:
 
     Type getResultType() override { return expression->getResultType(); }
 
-    Value evaluate(const Row & input_row) override
+    Value evaluate(const Row & input_row) override { return evaluateImpl(input_row); }
+
+    Value evaluate(const RowView & input_row) override { return evaluateImpl(input_row); }
+
+    template <class Input>
+    Value evaluateImpl(const Input & input_row)
     {
         if (unary_operator_code == UnaryOperatorCode::lnot) {
             return !std::get<bool>(expression->evaluate(input_row));
@@ -148,6 +393,31 @@ public:
         throw std::runtime_error("???");
     }
 
+    void evaluate(const ColumnBatch & input, const std::vector<uint32_t> & selection, ColumnVector & output) override
+    {
+        ColumnVector operand(expression_type);
+        expression->evaluate(input, selection, operand);
+        if (operand.hasNulls())
+            throw std::runtime_error("Null operand of unary operator");
+
+        if (unary_operator_code == UnaryOperatorCode::lnot) {
+            for (auto value : operand.getBooleans())
+                output.getBooleans().push_back(!value);
+        } else {
+            for (auto value : operand.getInt64s())
+                output.getInt64s().push_back(-value);
+        }
+    }
+
+    void evaluateFilter(const ColumnBatch & input, const std::vector<uint32_t> & selection, SelectionBitmap & output) override
+    {
+        if (unary_operator_code != UnaryOperatorCode::lnot)
+            return IExpression::evaluateFilter(input, selection, output);
+
+        expression->evaluateFilter(input, selection, output);
+        notBitmap(output.data(), selection.size());
+    }
+
     const UnaryOperatorCode unary_operator_code;
     ExpressionPtr expression;
     Type expression_type;
@@ -155,7 +425,14 @@ public:
 
 }
 
-ExpressionPtr buildExpression(const ASTPtr & ast, const std::shared_ptr<SchemaAccessor> & input_schema_accessor)
+namespace
+{
+
+using ExpressionBuilder = ExpressionPtr (*)(const ASTPtr &, const std::shared_ptr<SchemaAccessor> &);
+
+/// Operands are built by build_operand
+ExpressionPtr buildGenericExpression(
+    const ASTPtr & ast, const std::shared_ptr<SchemaAccessor> & input_schema_accessor, ExpressionBuilder build_operand)
 {
     switch (ast->type)
     {
@@ -171,20 +448,40 @@ ExpressionPtr buildExpression(const ASTPtr & ast, const std::shared_ptr<SchemaAc
                     return std::make_shared<NumberConstantExpression>(literal->integer_value);
                 case ASTLiteralType::string:
                     return std::make_shared<StringConstantExpression>(literal->string_value);
+                case ASTLiteralType::boolean:
+                    return std::make_shared<BooleanConstantExpression>(literal->boolean_value);
+                case ASTLiteralType::unsigned_number:
+                    return std::make_shared<UnsignedNumberConstantExpression>(literal->unsigned_value);
             }
         }
         case ASTType::binaryOperator: {
             auto binary_operator = std::static_pointer_cast<const ASTBinaryOperator>(ast);
-            return std::make_shared<BinaryOperatorExpression>(binary_operator->operator_code, buildExpression(binary_operator->getLHS(), input_schema_accessor), buildExpression(binary_operator->getRHS(), input_schema_accessor));
+            return std::make_shared<BinaryOperatorExpression>(binary_operator->operator_code, build_operand(binary_operator->getLHS(), input_schema_accessor), build_operand(binary_operator->getRHS(), input_schema_accessor));
         }
         case ASTType::unaryOperator: {
             auto unary_operator = std::static_pointer_cast<const ASTUnaryOperator>(ast);
-            return std::make_shared<UnaryOperatorExpression>(unary_operator->operator_code, buildExpression(unary_operator->getOperand(), input_schema_accessor));
+            return std::make_shared<UnaryOperatorExpression>(unary_operator->operator_code, build_operand(unary_operator->getOperand(), input_schema_accessor));
         }
+        case ASTType::parameter:
+            throw std::runtime_error("Query parameter is not bound");
     }
     throw std::runtime_error("???");
 }
 
+}
+
+ExpressionPtr buildExpression(const ASTPtr & ast, const std::shared_ptr<SchemaAccessor> & input_schema_accessor)
+{
+    if (auto expression = compileExpression(ast, input_schema_accessor))
+        return expression;
+    return buildGenericExpression(ast, input_schema_accessor, buildExpression);
+}
+
+ExpressionPtr buildInterpretedExpression(const ASTPtr & ast, const std::shared_ptr<SchemaAccessor> & input_schema_accessor)
+{
+    return buildGenericExpression(ast, input_schema_accessor, buildInterpretedExpression);
+}
+
 Expressions buildExpressions(const ASTs & expressions, const std::shared_ptr<SchemaAccessor> & input_schema_accessor)
 {
     Expressions exprs;
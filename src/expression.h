@@ -2,6 +2,9 @@
 
 #include "accessors.h"
 #include "ast.h"
+#include "column_batch.h"
+#include "filter_kernels.h"
+#include "row_view.h"
 
 namespace shdb
 {
@@ -14,13 +17,41 @@ public:
     virtual Type getResultType() = 0;
 
     virtual Value evaluate(const Row & input_row) = 0;
+
+    /// Evaluates over serialized row, decoding only columns expression reads
+    virtual Value evaluate(const RowView & input_row) = 0;
+
+    /// Evaluates over rows of batch listed in selection, output column of result type gets a value per listed row.
+    /// Selection is ascending and may be a subset of batch selection, so operands can skip rows without copying columns.
+    virtual void evaluate(const ColumnBatch & input, const std::vector<uint32_t> & selection, ColumnVector & output) = 0;
+
+    /// Evaluates over selected rows of batch
+    void evaluate(const ColumnBatch & input, ColumnVector & output) { evaluate(input, input.getSelection(), output); }
+
+    /// Evaluates boolean expression over rows listed in selection into bitmap with a bit per listed row.
+    /// Default implementation packs result of evaluate, comparisons and logical operators run typed kernels.
+    virtual void evaluateFilter(const ColumnBatch & input, const std::vector<uint32_t> & selection, SelectionBitmap & output);
+
+    void evaluateFilter(const ColumnBatch & input, SelectionBitmap & output) { evaluateFilter(input, input.getSelection(), output); }
 };
 
 using ExpressionPtr = std::shared_ptr<IExpression>;
 using Expressions = std::vector<ExpressionPtr>;
 
+/// AND and OR over batch short-circuit like row evaluation: rhs is evaluated only over rows where lhs does not decide
+/// the result, so rhs guarded by lhs (division by checked value, nulls rejected by lhs) does not fail on other rows
+void evaluateLogical(
+    bool is_and, IExpression & lhs, IExpression & rhs, const ColumnBatch & input, const std::vector<uint32_t> & selection, ColumnVector & output);
+
+void evaluateLogicalFilter(
+    bool is_and, IExpression & lhs, IExpression & rhs, const ColumnBatch & input, const std::vector<uint32_t> & selection, SelectionBitmap & output);
+
+/// Typed subtrees are compiled, generic nodes are used only where operand types are not known to fit
 ExpressionPtr buildExpression(const ASTPtr & expression, const std::shared_ptr<SchemaAccessor> & input_schema_accessor);
 
+/// Only generic nodes that dispatch on Value at run time, used as baseline for compiled expressions
+ExpressionPtr buildInterpretedExpression(const ASTPtr & expression, const std::shared_ptr<SchemaAccessor> & input_schema_accessor);
+
 Expressions buildExpressions(const ASTs & expressions, const std::shared_ptr<SchemaAccessor> & input_schema_accessor);
 
 }
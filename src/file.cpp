@@ -84,6 +84,18 @@ PageIndex File::allocPage()
     return page_index;
 }
 
+PageIndex File::allocPages(size_t count)
+{
+    PageIndex page_index = size / PageSize;
+    alloc(PageSize * count);
+    return page_index;
+}
+
+void File::writePages(const void * buf, PageIndex index, size_t count) const
+{
+    write(buf, PageSize * count, PageSize * index);
+}
+
 void File::sync()
 {
     fdatasync(fd);
@@ -94,7 +106,7 @@ void File::read(void * buf, size_t count, off_t offset) const
     safeSyscall(count, [=, this] { return pread(fd, buf, count, offset); });
 }
 
-void File::write(void * buf, size_t count, off_t offset) const
+void File::write(const void * buf, size_t count, off_t offset) const
 {
     safeSyscall(count, [=, this] { return pwrite(fd, buf, count, offset); });
 }
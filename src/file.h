@@ -26,12 +26,18 @@ public:
 
     PageIndex allocPage();
 
+    /// Allocates count pages at the end of file, returns index of the first one
+    PageIndex allocPages(size_t count);
+
+    /// Writes count consecutive pages with a single call, buffer must be aligned for direct I/O
+    void writePages(const void * buf, PageIndex index, size_t count) const;
+
     void sync();
 
 private:
     void read(void * buf, size_t count, off_t offset) const;
 
-    void write(void * buf, size_t count, off_t offset) const;
+    void write(const void * buf, size_t count, off_t offset) const;
 
     void alloc(off_t len);
 
@@ -0,0 +1,352 @@
+#include "filter_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__x86_64__)
+#    include <immintrin.h>
+#    define SHDB_X86_KERNELS 1
+#else
+#    define SHDB_X86_KERNELS 0
+#endif
+
+namespace shdb
+{
+
+namespace
+{
+
+/// Fills words starting from first_word, vector kernels use it for values that do not fill a whole word.
+/// Constant rhs points to a single value.
+template <CompareOperation operation, bool constant_rhs, class T>
+void compareScalar(const T * lhs, const T * rhs, size_t size, uint64_t * bitmap, size_t first_word)
+{
+    for (size_t word_index = first_word; word_index < getBitmapWordCount(size); ++word_index)
+    {
+        size_t begin = word_index * 64;
+        size_t end = std::min(size, begin + 64);
+        uint64_t word = 0;
+        for (size_t index = begin; index < end; ++index)
+            word |= uint64_t(compareValues<operation>(lhs[index], constant_rhs ? rhs[0] : rhs[index])) << (index - begin);
+        bitmap[word_index] = word;
+    }
+}
+
+#if SHDB_X86_KERNELS
+
+/// AVX2 compares only for equality and signed greater than, other operations swap operands or negate result
+template <CompareOperation operation>
+constexpr bool is_negated = operation == CompareOperation::ne || operation == CompareOperation::le || operation == CompareOperation::ge;
+
+template <CompareOperation operation>
+constexpr bool is_swapped = operation == CompareOperation::lt || operation == CompareOperation::ge;
+
+template <CompareOperation operation>
+constexpr bool is_equality = operation == CompareOperation::eq || operation == CompareOperation::ne;
+
+template <class T>
+__attribute__((target("avx2"))) inline __m256i broadcastAvx2(T value)
+{
+    if constexpr (sizeof(T) == 8)
+        return _mm256_set1_epi64x(static_cast<int64_t>(value));
+    else
+        return _mm256_set1_epi8(static_cast<char>(value));
+}
+
+/// One bit per lane, before negation
+template <CompareOperation operation, class T>
+__attribute__((target("avx2"))) inline uint32_t compareMaskAvx2(__m256i lhs, __m256i rhs)
+{
+    __m256i first = is_swapped<operation> ? rhs : lhs;
+    __m256i second = is_swapped<operation> ? lhs : rhs;
+
+    if constexpr (sizeof(T) == 8)
+    {
+        __m256i result;
+        if constexpr (is_equality<operation>)
+        {
+            result = _mm256_cmpeq_epi64(first, second);
+        }
+        else
+        {
+            if constexpr (std::is_unsigned_v<T>)
+            {
+                __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+                first = _mm256_xor_si256(first, sign);
+                second = _mm256_xor_si256(second, sign);
+            }
+            result = _mm256_cmpgt_epi64(first, second);
+        }
+        return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(result)));
+    }
+    else
+    {
+        __m256i result;
+        if constexpr (is_equality<operation>)
+        {
+            result = _mm256_cmpeq_epi8(first, second);
+        }
+        else
+        {
+            __m256i sign = _mm256_set1_epi8(static_cast<char>(0x80));
+            result = _mm256_cmpgt_epi8(_mm256_xor_si256(first, sign), _mm256_xor_si256(second, sign));
+        }
+        return static_cast<uint32_t>(_mm256_movemask_epi8(result));
+    }
+}
+
+template <CompareOperation operation, bool constant_rhs, class T>
+__attribute__((target("avx2"))) void compareAvx2(const T * lhs, const T * rhs, size_t size, uint64_t * bitmap)
+{
+    constexpr size_t lanes = sizeof(__m256i) / sizeof(T);
+    __m256i rhs_constant = constant_rhs ? broadcastAvx2(rhs[0]) : _mm256_setzero_si256();
+
+    size_t full_words = size / 64;
+    for (size_t word_index = 0; word_index < full_words; ++word_index)
+    {
+        uint64_t word = 0;
+        for (size_t lane = 0; lane < 64; lane += lanes)
+        {
+            size_t offset = word_index * 64 + lane;
+            __m256i lhs_values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + offset));
+            __m256i rhs_values = constant_rhs ? rhs_constant : _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + offset));
+            word |= uint64_t(compareMaskAvx2<operation, T>(lhs_values, rhs_values)) << lane;
+        }
+        bitmap[word_index] = is_negated<operation> ? ~word : word;
+    }
+    compareScalar<operation, constant_rhs>(lhs, rhs, size, bitmap, full_words);
+}
+
+template <CompareOperation operation>
+constexpr int avx512_predicate = operation == CompareOperation::eq ? _MM_CMPINT_EQ
+    : operation == CompareOperation::ne                            ? _MM_CMPINT_NE
+    : operation == CompareOperation::lt                            ? _MM_CMPINT_LT
+    : operation == CompareOperation::le                            ? _MM_CMPINT_LE
+    : operation == CompareOperation::gt                            ? _MM_CMPINT_NLE
+                                                                   : _MM_CMPINT_NLT;
+
+template <class T>
+__attribute__((target("avx512f,avx512bw"))) inline __m512i broadcastAvx512(T value)
+{
+    if constexpr (sizeof(T) == 8)
+        return _mm512_set1_epi64(static_cast<int64_t>(value));
+    else
+        return _mm512_set1_epi8(static_cast<char>(value));
+}
+
+template <CompareOperation operation, class T>
+__attribute__((target("avx512f,avx512bw"))) inline uint64_t compareMaskAvx512(__m512i lhs, __m512i rhs)
+{
+    if constexpr (std::is_same_v<T, int64_t>)
+        return _mm512_cmp_epi64_mask(lhs, rhs, avx512_predicate<operation>);
+    else if constexpr (std::is_same_v<T, uint64_t>)
+        return _mm512_cmp_epu64_mask(lhs, rhs, avx512_predicate<operation>);
+    else
+        return _mm512_cmp_epu8_mask(lhs, rhs, avx512_predicate<operation>);
+}
+
+template <CompareOperation operation, bool constant_rhs, class T>
+__attribute__((target("avx512f,avx512bw"))) void compareAvx512(const T * lhs, const T * rhs, size_t size, uint64_t * bitmap)
+{
+    constexpr size_t lanes = sizeof(__m512i) / sizeof(T);
+    __m512i rhs_constant = constant_rhs ? broadcastAvx512(rhs[0]) : _mm512_setzero_si512();
+
+    size_t full_words = size / 64;
+    for (size_t word_index = 0; word_index < full_words; ++word_index)
+    {
+        uint64_t word = 0;
+        for (size_t lane = 0; lane < 64; lane += lanes)
+        {
+            size_t offset = word_index * 64 + lane;
+            __m512i lhs_values = _mm512_loadu_si512(lhs + offset);
+            __m512i rhs_values = constant_rhs ? rhs_constant : _mm512_loadu_si512(rhs + offset);
+            word |= compareMaskAvx512<operation, T>(lhs_values, rhs_values) << lane;
+        }
+        bitmap[word_index] = word;
+    }
+    compareScalar<operation, constant_rhs>(lhs, rhs, size, bitmap, full_words);
+}
+
+#endif
+
+KernelSet detectKernelSet()
+{
+    if (isKernelSetSupported(KernelSet::avx512))
+        return KernelSet::avx512;
+    if (isKernelSetSupported(KernelSet::avx2))
+        return KernelSet::avx2;
+    return KernelSet::scalar;
+}
+
+std::atomic<KernelSet> & getKernelSetStorage()
+{
+    static std::atomic<KernelSet> kernel_set{detectKernelSet()};
+    return kernel_set;
+}
+
+template <CompareOperation operation, bool constant_rhs, class T>
+void compareWithKernelSet(const T * lhs, const T * rhs, size_t size, uint64_t * bitmap)
+{
+    switch (getKernelSet())
+    {
+#if SHDB_X86_KERNELS
+        case KernelSet::avx512:
+            return compareAvx512<operation, constant_rhs>(lhs, rhs, size, bitmap);
+        case KernelSet::avx2:
+            return compareAvx2<operation, constant_rhs>(lhs, rhs, size, bitmap);
+#endif
+        default:
+            return compareScalar<operation, constant_rhs>(lhs, rhs, size, bitmap, 0);
+    }
+}
+
+template <bool constant_rhs, class T>
+void compare(CompareOperation operation, const T * lhs, const T * rhs, size_t size, uint64_t * bitmap)
+{
+    switch (operation)
+    {
+        case CompareOperation::eq:
+            return compareWithKernelSet<CompareOperation::eq, constant_rhs>(lhs, rhs, size, bitmap);
+        case CompareOperation::ne:
+            return compareWithKernelSet<CompareOperation::ne, constant_rhs>(lhs, rhs, size, bitmap);
+        case CompareOperation::lt:
+            return compareWithKernelSet<CompareOperation::lt, constant_rhs>(lhs, rhs, size, bitmap);
+        case CompareOperation::le:
+            return compareWithKernelSet<CompareOperation::le, constant_rhs>(lhs, rhs, size, bitmap);
+        case CompareOperation::gt:
+            return compareWithKernelSet<CompareOperation::gt, constant_rhs>(lhs, rhs, size, bitmap);
+        case CompareOperation::ge:
+            return compareWithKernelSet<CompareOperation::ge, constant_rhs>(lhs, rhs, size, bitmap);
+    }
+    throw std::runtime_error("Unknown compare operation");
+}
+
+}
+
+KernelSet getKernelSet()
+{
+    return getKernelSetStorage().load(std::memory_order_relaxed);
+}
+
+bool isKernelSetSupported(KernelSet kernel_set)
+{
+    switch (kernel_set)
+    {
+        case KernelSet::scalar:
+            return true;
+#if SHDB_X86_KERNELS
+        case KernelSet::avx2:
+            return __builtin_cpu_supports("avx2");
+        case KernelSet::avx512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+        default:
+            return false;
+    }
+}
+
+void setKernelSet(KernelSet kernel_set)
+{
+    if (!isKernelSetSupported(kernel_set))
+        throw std::runtime_error("Kernel set is not supported by CPU");
+    getKernelSetStorage().store(kernel_set, std::memory_order_relaxed);
+}
+
+void compareWithConstant(CompareOperation operation, const int64_t * values, size_t size, int64_t constant, uint64_t * bitmap)
+{
+    compare<true>(operation, values, &constant, size, bitmap);
+}
+
+void compareWithConstant(CompareOperation operation, const uint64_t * values, size_t size, uint64_t constant, uint64_t * bitmap)
+{
+    compare<true>(operation, values, &constant, size, bitmap);
+}
+
+void compareWithConstant(CompareOperation operation, const uint8_t * values, size_t size, uint8_t constant, uint64_t * bitmap)
+{
+    compare<true>(operation, values, &constant, size, bitmap);
+}
+
+void compareColumns(CompareOperation operation, const int64_t * lhs, const int64_t * rhs, size_t size, uint64_t * bitmap)
+{
+    compare<false>(operation, lhs, rhs, size, bitmap);
+}
+
+void compareColumns(CompareOperation operation, const uint64_t * lhs, const uint64_t * rhs, size_t size, uint64_t * bitmap)
+{
+    compare<false>(operation, lhs, rhs, size, bitmap);
+}
+
+void compareColumns(CompareOperation operation, const uint8_t * lhs, const uint8_t * rhs, size_t size, uint64_t * bitmap)
+{
+    compare<false>(operation, lhs, rhs, size, bitmap);
+}
+
+CompareOperation swapOperands(CompareOperation operation)
+{
+    switch (operation)
+    {
+        case CompareOperation::eq:
+        case CompareOperation::ne:
+            return operation;
+        case CompareOperation::lt:
+            return CompareOperation::gt;
+        case CompareOperation::le:
+            return CompareOperation::ge;
+        case CompareOperation::gt:
+            return CompareOperation::lt;
+        case CompareOperation::ge:
+            return CompareOperation::le;
+    }
+    throw std::runtime_error("Unknown compare operation");
+}
+
+void andBitmaps(uint64_t * lhs, const uint64_t * rhs, size_t size)
+{
+    for (size_t word_index = 0; word_index < getBitmapWordCount(size); ++word_index)
+        lhs[word_index] &= rhs[word_index];
+}
+
+void orBitmaps(uint64_t * lhs, const uint64_t * rhs, size_t size)
+{
+    for (size_t word_index = 0; word_index < getBitmapWordCount(size); ++word_index)
+        lhs[word_index] |= rhs[word_index];
+}
+
+void notBitmap(uint64_t * bitmap, size_t size)
+{
+    for (size_t word_index = 0; word_index < getBitmapWordCount(size); ++word_index)
+        bitmap[word_index] = ~bitmap[word_index];
+    if (size % 64 != 0)
+        bitmap[size / 64] &= (uint64_t(1) << (size % 64)) - 1;
+}
+
+void depositBitmap(uint64_t * bitmap, const uint64_t * values, size_t size)
+{
+    size_t value_index = 0;
+    for (size_t word_index = 0; word_index < getBitmapWordCount(size); ++word_index)
+    {
+        for (auto word = bitmap[word_index]; word != 0; word &= word - 1, ++value_index)
+            if (!((values[value_index / 64] >> (value_index % 64)) & 1))
+                bitmap[word_index] &= ~(uint64_t(1) << std::countr_zero(word));
+    }
+}
+
+void bitmapFromBooleans(const uint8_t * values, size_t size, uint64_t * bitmap)
+{
+    compareWithConstant(CompareOperation::ne, values, size, 0, bitmap);
+}
+
+void selectFromBitmap(const uint64_t * bitmap, const std::vector<uint32_t> & selection, std::vector<uint32_t> & output)
+{
+    for (size_t word_index = 0; word_index < getBitmapWordCount(selection.size()); ++word_index)
+    {
+        for (auto word = bitmap[word_index]; word != 0; word &= word - 1)
+            output.push_back(selection[word_index * 64 + std::countr_zero(word)]);
+    }
+}
+
+}
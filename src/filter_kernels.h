@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace shdb
+{
+
+/// Bit i % 64 of word i / 64 is set when value i matches, bits past the last value are zero
+using SelectionBitmap = std::vector<uint64_t>;
+
+enum class CompareOperation
+{
+    eq,
+    ne,
+    lt,
+    le,
+    gt,
+    ge,
+};
+
+/// Instruction set used by kernels, the best one supported by CPU is chosen on first use
+enum class KernelSet
+{
+    scalar,
+    avx2,
+    avx512,
+};
+
+/// Scalar comparison, kernels give the same results
+template <CompareOperation operation, class T>
+bool compareValues(const T & lhs, const T & rhs)
+{
+    if constexpr (operation == CompareOperation::eq)
+        return lhs == rhs;
+    else if constexpr (operation == CompareOperation::ne)
+        return lhs != rhs;
+    else if constexpr (operation == CompareOperation::lt)
+        return lhs < rhs;
+    else if constexpr (operation == CompareOperation::le)
+        return lhs <= rhs;
+    else if constexpr (operation == CompareOperation::gt)
+        return lhs > rhs;
+    else
+        return lhs >= rhs;
+}
+
+KernelSet getKernelSet();
+
+bool isKernelSetSupported(KernelSet kernel_set);
+
+/// Forces instruction set, throws if CPU does not support it
+void setKernelSet(KernelSet kernel_set);
+
+inline size_t getBitmapWordCount(size_t size)
+{
+    return (size + 63) / 64;
+}
+
+/// Compares every value with constant, bitmap must have room for size bits.
+/// Booleans are stored one per byte as 0 or 1.
+void compareWithConstant(CompareOperation operation, const int64_t * values, size_t size, int64_t constant, uint64_t * bitmap);
+void compareWithConstant(CompareOperation operation, const uint64_t * values, size_t size, uint64_t constant, uint64_t * bitmap);
+void compareWithConstant(CompareOperation operation, const uint8_t * values, size_t size, uint8_t constant, uint64_t * bitmap);
+
+/// Compares values at the same positions of two arrays
+void compareColumns(CompareOperation operation, const int64_t * lhs, const int64_t * rhs, size_t size, uint64_t * bitmap);
+void compareColumns(CompareOperation operation, const uint64_t * lhs, const uint64_t * rhs, size_t size, uint64_t * bitmap);
+void compareColumns(CompareOperation operation, const uint8_t * lhs, const uint8_t * rhs, size_t size, uint64_t * bitmap);
+
+/// Operation that gives the same result with operands swapped
+CompareOperation swapOperands(CompareOperation operation);
+
+void andBitmaps(uint64_t * lhs, const uint64_t * rhs, size_t size);
+
+void orBitmaps(uint64_t * lhs, const uint64_t * rhs, size_t size);
+
+void notBitmap(uint64_t * bitmap, size_t size);
+
+/// Keeps k-th set bit of bitmap only if bit k of values is set
+void depositBitmap(uint64_t * bitmap, const uint64_t * values, size_t size);
+
+/// Sets bits of nonzero bytes
+void bitmapFromBooleans(const uint8_t * values, size_t size, uint64_t * bitmap);
+
+/// Appends selection[i] for every set bit i
+void selectFromBitmap(const uint64_t * bitmap, const std::vector<uint32_t> & selection, std::vector<uint32_t> & output);
+
+}
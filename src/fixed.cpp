@@ -5,78 +5,124 @@
 
 #include "marshal.h"
 #include "row.h"
+#include "slot_bitmap.h"
 #include "table.h"
 
 namespace shdb
 {
 
-class FixedPage : public ITablePage
+/// Page starts with slot occupancy bitmap, fixed size row slots follow
+class FixedPage
 {
 public:
-    FixedPage(std::shared_ptr<Frame> frame, std::shared_ptr<Marshal> marshal) : frame(std::move(frame)), marshal(std::move(marshal)) { }
+    FixedPage(const FrameView & frame, const Marshal & marshal, RowIndex row_capacity)
+        : frame(frame), marshal(marshal), row_capacity(row_capacity), slots(frame, row_capacity)
+    {
+    }
 
-    RowIndex getRowCount() override { return getRowCapacity(); }
+    RowIndex getRowCount() const { return row_capacity; }
 
-    Row getRow(RowIndex index) override
+    Row getRow(RowIndex index) const
     {
-        auto * row_data = frame->getData() + index * getRowSpace();
-        if (static_cast<bool>(row_data[0]))
-            return marshal->deserializeRow(row_data + 1);
+        if (slots.isOccupied(index))
+            return marshal.deserializeRow(getRowData(index));
 
         return Row();
     }
 
-    void deleteRow(RowIndex index) override
+    RowView getRowView(RowIndex index) const
     {
-        auto * row_data = getRowData(index);
-        *reinterpret_cast<bool *>(row_data) = false;
+        if (slots.isOccupied(index))
+            return RowView(getRowData(index), &marshal);
+
+        return RowView();
     }
 
-    std::pair<bool, RowIndex> insertRow(const Row & row) override
+    void deleteRow(RowIndex index)
     {
-        if (auto [found, row_index] = findRowSlot(); found)
-        {
-            auto * row_data = getRowData(row_index);
-            *reinterpret_cast<bool *>(row_data) = true;
-            marshal->serializeRow(row_data + 1, row);
-            return {true, row_index};
-        }
-        return {false, -1};
+        if (slots.isOccupied(index))
+            slots.release(index);
     }
 
-private:
-    size_t getRowSpace() { return 1 + marshal->getFixedRowSpace(); }
+    size_t getFreeSpace() const { return (row_capacity - slots.getLiveCount()) * marshal.getFixedRowSpace(); }
 
-    uint8_t * getRowData(RowIndex index) { return frame->getData() + index * getRowSpace(); }
+    RowIndex findNextRow(RowIndex from) const { return slots.findNextOccupied(from); }
 
-    RowIndex getRowCapacity() { return PageSize / getRowSpace(); }
+    std::pair<bool, RowIndex> insertRow(const Row & row)
+    {
+        if (slots.getLiveCount() == row_capacity)
+            return {false, -1};
+
+        auto row_index = slots.findFree();
+        slots.occupy(row_index);
+        marshal.serializeRow(getMutableRowData(row_index), row);
+        return {true, row_index};
+    }
 
-    std::pair<bool, RowIndex> findRowSlot()
+    static RowIndex getRowCapacity(const Marshal & marshal)
     {
-        for (RowIndex index = 0; index < getRowCapacity(); ++index)
-        {
-            auto * row_data = getRowData(index);
-            if (!static_cast<bool>(row_data[0]))
-                return {true, index};
-        }
-        return {false, -1};
+        auto row_space = marshal.getFixedRowSpace();
+        RowIndex capacity = PageSize / row_space;
+        while (capacity > 0 && SlotBitmap::getHeaderSize(capacity) + capacity * row_space > PageSize)
+            --capacity;
+        return capacity;
     }
 
-    std::shared_ptr<Frame> frame;
-    std::shared_ptr<Marshal> marshal;
+private:
+    const uint8_t * getRowData(RowIndex index) const
+    {
+        return frame.getData() + SlotBitmap::getHeaderSize(row_capacity) + index * marshal.getFixedRowSpace();
+    }
+
+    uint8_t * getMutableRowData(RowIndex index)
+    {
+        return frame.getMutableData() + SlotBitmap::getHeaderSize(row_capacity) + index * marshal.getFixedRowSpace();
+    }
+
+    const FrameView & frame;
+    const Marshal & marshal;
+    RowIndex row_capacity;
+    SlotBitmap slots;
 };
 
-class FixedPageProvider : public IPageProvider
+class FixedPageProvider : public ITablePageProvider
 {
 public:
-    explicit FixedPageProvider(std::shared_ptr<Marshal> marshal) : marshal(marshal) { }
+    explicit FixedPageProvider(std::shared_ptr<Marshal> marshal_)
+        : marshal(std::move(marshal_)), row_capacity(FixedPage::getRowCapacity(*marshal))
+    {
+    }
+
+    RowIndex getRowCount(const FrameView & frame) const override { return FixedPage(frame, *marshal, row_capacity).getRowCount(); }
+
+    Row getRow(const FrameView & frame, RowIndex index) const override { return FixedPage(frame, *marshal, row_capacity).getRow(index); }
+
+    RowView getRowView(const FrameView & frame, RowIndex index) const override
+    {
+        return FixedPage(frame, *marshal, row_capacity).getRowView(index);
+    }
+
+    void deleteRow(const FrameView & frame, RowIndex index) const override { FixedPage(frame, *marshal, row_capacity).deleteRow(index); }
+
+    std::pair<bool, RowIndex> insertRow(const FrameView & frame, const Row & row) const override
+    {
+        return FixedPage(frame, *marshal, row_capacity).insertRow(row);
+    }
+
+    RowIndex findNextRow(const FrameView & frame, RowIndex from) const override
+    {
+        return FixedPage(frame, *marshal, row_capacity).findNextRow(from);
+    }
+
+    size_t getFreeSpace(const FrameView & frame) const override { return FixedPage(frame, *marshal, row_capacity).getFreeSpace(); }
 
-    std::shared_ptr<IPage> getPage(std::shared_ptr<Frame> frame) override { return std::make_shared<FixedPage>(std::move(frame), marshal); }
+    size_t getRowSpace(const Row &) const override { return marshal->getFixedRowSpace(); }
 
     std::shared_ptr<Marshal> marshal;
+    RowIndex row_capacity;
 };
 
-std::shared_ptr<IPageProvider> createFixedPageProvider(std::shared_ptr<Schema> schema)
+std::shared_ptr<ITablePageProvider> createFixedPageProvider(std::shared_ptr<Schema> schema)
 {
     auto marshal = std::make_shared<Marshal>(std::move(schema));
     return std::make_shared<FixedPageProvider>(std::move(marshal));
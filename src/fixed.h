@@ -6,6 +6,6 @@
 namespace shdb
 {
 
-std::shared_ptr<IPageProvider> createFixedPageProvider(std::shared_ptr<Schema> schema);
+std::shared_ptr<ITablePageProvider> createFixedPageProvider(std::shared_ptr<Schema> schema);
 
 }
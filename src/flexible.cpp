@@ -1,144 +1,230 @@
 #include "flexible.h"
+#include <algorithm>
 #include <cstring>
+#include <vector>
 #include "marshal.h"
 
 namespace shdb
 {
 
-class FlexiblePage : public ITablePage
+/// Slotted page: header with (offset, length) slot entries grows from page start, rows grow from page end.
+/// Offsets are relative to page start, so page can be read into any frame. Deleted slots keep their
+/// index with zero offset and are reused by later inserts.
+class FlexiblePage
 {
 public:
-    FlexiblePage(std::shared_ptr<Frame> frame, std::shared_ptr<Marshal> marshal) : frame(std::move(frame)), marshal(std::move(marshal)) {
+    FlexiblePage(const FrameView & frame, const Marshal & marshal) : frame(frame), marshal(marshal) {
     }
 
-    RowIndex getRowCount() {
-        int id = -1;
-        for (auto& [idx, _] : readHeader())
-        {
-            if (idx >= id) {
-                id = idx;
-            }
+    RowIndex getRowCount() const {
+        return getHeader().slot_count;
+    }
+
+    Row getRow(RowIndex index) const
+    {
+        if (index >= getRowCount()) {
+            return Row();
         }
-        ++id;
-        return id;
+        auto slot = getSlot(index);
+        if (slot.offset == 0) {
+            return Row();
+        }
+        return marshal.deserializeRow(frame.getData() + slot.offset);
     }
 
-    Row getRow(RowIndex index)
+    RowView getRowView(RowIndex index) const
     {
-        for (auto& [idx, row] : readHeader()) {
-            if ((int)idx == index) {
-                return row;
-            }
+        if (index >= getRowCount()) {
+            return RowView();
+        }
+        auto slot = getSlot(index);
+        if (slot.offset == 0) {
+            return RowView();
         }
-        return Row();
+        return RowView(frame.getData() + slot.offset, &marshal);
     }
 
     void deleteRow(RowIndex index)
     {
-        std::vector<std::pair<uint8_t, Row>> new_header;
+        auto header = getHeader();
+        if (index >= header.slot_count || getSlot(index).offset == 0) {
+            return;
+        }
 
-        for (auto& [idx, row] : readHeader()) {
-            if ((int)idx != index) {
-                new_header.emplace_back(idx, row);
-            }
+        header.used_bytes -= getSlot(index).length;
+        setSlot(index, Slot{});
+
+        /// Trailing empty slots are dropped so their header space can hold rows again
+        while (header.slot_count > 0 && getSlot(header.slot_count - 1).offset == 0) {
+            --header.slot_count;
         }
-        write_header(new_header);
+        if (header.slot_count == 0) {
+            header.data_begin = PageSize;
+        }
+        setHeader(header);
     }
 
     std::pair<bool, RowIndex> insertRow(const Row & row)
     {
-        auto header = readHeader();
-        int id = -1;
-        for (auto& [idx, _] : header)
-        {
-            if (idx >= id) {
-                id = idx;
-            }
+        auto header = getHeader();
+        size_t row_space = marshal.getRowSpace(row);
+
+        RowIndex index = findFreeSlot(header);
+        size_t slots_end = sizeof(Header) + (std::max<RowIndex>(index + 1, header.slot_count)) * sizeof(Slot);
+        if (slots_end + header.used_bytes + row_space > PageSize) {
+            return {false, -1};
         }
-        ++id;
 
-        header.emplace_back(id, row);
+        /// Free space exists but is fragmented between rows, move rows together at page end
+        if (slots_end + row_space > header.data_begin) {
+            compact(header);
+        }
+
+        header.data_begin -= row_space;
+        header.used_bytes += row_space;
+        header.slot_count = std::max<RowIndex>(index + 1, header.slot_count);
+        marshal.serializeRow(frame.getMutableData() + header.data_begin, row);
+        setSlot(index, Slot{header.data_begin, static_cast<uint16_t>(row_space)});
+        setHeader(header);
+        return {true, index};
+    }
 
-        if (getSize(header) <= PageSize - 10) {
-            //        if (header.size() == 1) {
-            write_header(header);
-            return {true, id};
+    RowIndex findNextRow(RowIndex from) const
+    {
+        RowIndex slot_count = getRowCount();
+        for (RowIndex index = std::max<RowIndex>(from, 0); index < slot_count; ++index) {
+            if (getSlot(index).offset != 0) {
+                return index;
+            }
         }
+        return slot_count;
+    }
 
-        return {false, -1};
+    size_t getFreeSpace() const
+    {
+        auto header = getHeader();
+        return PageSize - sizeof(Header) - header.slot_count * sizeof(Slot) - header.used_bytes;
+    }
+
+    static size_t getRowSpace(const Marshal & marshal, const Row & row)
+    {
+        return sizeof(Slot) + marshal.getRowSpace(row);
     }
 
 private:
+    struct Header
+    {
+        uint16_t slot_count;
+        uint16_t data_begin;
+        uint16_t used_bytes;
+        uint16_t reserved;
+    };
 
-    std::vector <std::pair<uint8_t, Row>> readHeader()
+    struct Slot
     {
-        uint8_t * data = this->frame->getData();
-
-        std::vector <std::pair<uint8_t, Row>> header;
-        uint32_t strings_cnt;
-        memcpy(&strings_cnt, data, sizeof(strings_cnt));
-        uint8_t * mem = data + sizeof(strings_cnt);
-        for (int i = 0; i < strings_cnt; ++i)
-        {
-            uint8_t rowIndex;
-            memcpy(&rowIndex, mem, sizeof(rowIndex));
-            mem += sizeof(rowIndex);
-            uint8_t * addr;
-            memcpy(&addr, mem, sizeof(addr));
-            mem += sizeof(addr);
-            header.emplace_back(rowIndex, this->marshal->deserializeRow(addr));
+        uint16_t offset = 0;
+        uint16_t length = 0;
+    };
+
+    Header getHeader() const {
+        Header header;
+        memcpy(&header, frame.getData(), sizeof(header));
+        /// Zeroed fresh page has no rows, its data area ends at page end
+        if (header.slot_count == 0 && header.data_begin == 0) {
+            header.data_begin = PageSize;
         }
         return header;
     }
 
-    int getSize(std::vector <std::pair<uint8_t, Row>> header) {
-        int ans = sizeof(uint32_t) + header.size() * (sizeof(uint8_t) + sizeof(uint8_t*));
-        for (auto [idx, row] : header) {
-            ans += marshal->getRowSpace(row);
-        }
-        return ans;
+    void setHeader(Header header) {
+        memcpy(frame.getMutableData(), &header, sizeof(header));
     }
 
-    void write_header(std::vector <std::pair<uint8_t, Row>> header) {
-        uint8_t * data = this->frame->getData();
+    Slot getSlot(RowIndex index) const {
+        Slot slot;
+        memcpy(&slot, frame.getData() + sizeof(Header) + index * sizeof(Slot), sizeof(slot));
+        return slot;
+    }
+
+    void setSlot(RowIndex index, Slot slot) {
+        memcpy(frame.getMutableData() + sizeof(Header) + index * sizeof(Slot), &slot, sizeof(slot));
+    }
+
+    RowIndex findFreeSlot(const Header & header) const {
+        for (RowIndex index = 0; index < header.slot_count; ++index) {
+            if (getSlot(index).offset == 0) {
+                return index;
+            }
+        }
+        return header.slot_count;
+    }
 
-        uint32_t strings_cnt = header.size();
-        uint8_t* mem = data + sizeof(strings_cnt);
-        uint8_t* buf_addr = data + PageSize;
+    void compact(Header & header) {
+        std::vector<std::pair<Slot, RowIndex>> slots;
+        for (RowIndex index = 0; index < header.slot_count; ++index) {
+            if (auto slot = getSlot(index); slot.offset != 0) {
+                slots.emplace_back(slot, index);
+            }
+        }
 
-        memcpy(data, &strings_cnt, sizeof(strings_cnt));
+        /// Rows closest to page end move first, so every row only moves towards page end over already moved ones
+        std::sort(slots.begin(), slots.end(), [](const auto & lhs, const auto & rhs) { return lhs.first.offset > rhs.first.offset; });
 
-        for (int i = 0; i < strings_cnt; ++i)
-        {
-            uint8_t rowIndex = header[i].first;
-            buf_addr -= marshal->getRowSpace(header[i].second);
-            marshal->serializeRow(buf_addr, header[i].second);
-            memcpy(mem, &rowIndex, sizeof(rowIndex));
-            assert(mem + sizeof(rowIndex) < this->frame->getData() + PageSize);
-            assert(buf_addr + marshal->getRowSpace(header[i].second) <= this->frame->getData() + PageSize);
-            mem += sizeof(rowIndex);
-            memcpy(mem, &buf_addr, sizeof(buf_addr));
-            mem += sizeof(buf_addr);
+        uint8_t * data = frame.getMutableData();
+        uint16_t data_begin = PageSize;
+        for (auto & [slot, index] : slots) {
+            data_begin -= slot.length;
+            memmove(data + data_begin, data + slot.offset, slot.length);
+            setSlot(index, Slot{data_begin, slot.length});
         }
+        header.data_begin = data_begin;
     }
 
-    std::shared_ptr<Frame> frame;
-    std::shared_ptr<Marshal> marshal;
+    const FrameView & frame;
+    const Marshal & marshal;
 };
 
-class FlexiblePageProvider : public IPageProvider
+class FlexiblePageProvider : public ITablePageProvider
 {
 public:
     explicit FlexiblePageProvider(std::shared_ptr<Marshal> marshal) : marshal(marshal) { }
 
-    std::shared_ptr<IPage> getPage(std::shared_ptr<Frame> frame) override {
-        return std::make_shared<FlexiblePage>(std::move(frame), marshal);
+    RowIndex getRowCount(const FrameView & frame) const override {
+        return FlexiblePage(frame, *marshal).getRowCount();
+    }
+
+    Row getRow(const FrameView & frame, RowIndex index) const override {
+        return FlexiblePage(frame, *marshal).getRow(index);
+    }
+
+    RowView getRowView(const FrameView & frame, RowIndex index) const override {
+        return FlexiblePage(frame, *marshal).getRowView(index);
+    }
+
+    void deleteRow(const FrameView & frame, RowIndex index) const override {
+        FlexiblePage(frame, *marshal).deleteRow(index);
+    }
+
+    std::pair<bool, RowIndex> insertRow(const FrameView & frame, const Row & row) const override {
+        return FlexiblePage(frame, *marshal).insertRow(row);
+    }
+
+    RowIndex findNextRow(const FrameView & frame, RowIndex from) const override {
+        return FlexiblePage(frame, *marshal).findNextRow(from);
+    }
+
+    size_t getFreeSpace(const FrameView & frame) const override {
+        return FlexiblePage(frame, *marshal).getFreeSpace();
+    }
+
+    size_t getRowSpace(const Row & row) const override {
+        return FlexiblePage::getRowSpace(*marshal, row);
     }
 
     std::shared_ptr<Marshal> marshal;
 };
 
-std::shared_ptr<IPageProvider> createFlexiblePageProvider(std::shared_ptr<Schema> schema)
+std::shared_ptr<ITablePageProvider> createFlexiblePageProvider(std::shared_ptr<Schema> schema)
 {
     auto marshal = std::make_shared<Marshal>(std::move(schema));
     return std::make_shared<FlexiblePageProvider>(std::move(marshal));
@@ -6,6 +6,6 @@
 namespace shdb
 {
 
-std::shared_ptr<IPageProvider> createFlexiblePageProvider(std::shared_ptr<Schema> schema);
+std::shared_ptr<ITablePageProvider> createFlexiblePageProvider(std::shared_ptr<Schema> schema);
 
 }
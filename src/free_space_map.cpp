@@ -0,0 +1,208 @@
+#include "free_space_map.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+namespace shdb
+{
+
+namespace
+{
+
+/// File is opened with O_DIRECT, so I/O goes through page aligned buffer
+using AlignedPage = std::unique_ptr<uint8_t, decltype(&std::free)>;
+
+AlignedPage allocateAlignedPage()
+{
+    return AlignedPage(static_cast<uint8_t *>(std::aligned_alloc(PageSize, PageSize)), &std::free);
+}
+
+/// First page of map file, bucket pages follow it
+struct Header
+{
+    static constexpr uint64_t Magic = 0x3170616d65657266; /// "freemap1"
+
+    uint64_t magic = Magic;
+    uint64_t page_count = 0;
+};
+
+}
+
+FreeSpaceMap::FreeSpaceMap(std::shared_ptr<File> file_) : file(std::move(file_))
+{
+}
+
+FreeSpaceMap::~FreeSpaceMap() noexcept
+{
+    /// Errors are reported by explicit flush when store closes. Header is written last,
+    /// so a map that failed to write here describes fewer pages and the table reads the rest on next open.
+    try
+    {
+        flush();
+    }
+    catch (...)
+    {
+    }
+}
+
+PageIndex FreeSpaceMap::getPageCount()
+{
+    load();
+    return page_count;
+}
+
+uint8_t FreeSpaceMap::toBucket(size_t free_space)
+{
+    return static_cast<uint8_t>(std::min<size_t>(free_space / BucketSize, 255));
+}
+
+PageIndex FreeSpaceMap::findPage(size_t space)
+{
+    load();
+
+    /// Smallest bucket that may have enough room, best fit keeps emptier pages for larger rows
+    for (size_t bucket = std::max<size_t>(toBucket(space), 1); bucket < heads.size(); ++bucket)
+        if (heads[bucket] != InvalidPageIndex)
+            return heads[bucket];
+
+    return InvalidPageIndex;
+}
+
+void FreeSpaceMap::update(PageIndex page_index, size_t free_space)
+{
+    load();
+
+    auto bucket = toBucket(free_space);
+    if (page_index >= page_count)
+    {
+        page_count = page_index + 1;
+        header_dirty = true;
+    }
+    if (static_cast<size_t>(page_index) < buckets.size() && buckets[page_index] == bucket)
+        return;
+
+    if (static_cast<size_t>(page_index) >= buckets.size())
+    {
+        size_t size = (page_index / PageSize + 1) * PageSize;
+        buckets.resize(size, 0);
+        next.resize(size, InvalidPageIndex);
+        previous.resize(size, InvalidPageIndex);
+        dirty_map_pages.resize(size / PageSize, false);
+    }
+
+    unlink(page_index);
+    buckets[page_index] = bucket;
+    link(page_index, bucket);
+    dirty_map_pages[page_index / PageSize] = true;
+}
+
+void FreeSpaceMap::flush()
+{
+    AlignedPage page(nullptr, &std::free);
+    for (PageIndex map_page_index = 0; map_page_index < static_cast<PageIndex>(dirty_map_pages.size()); ++map_page_index)
+    {
+        if (!dirty_map_pages[map_page_index])
+            continue;
+
+        if (!page)
+            page = allocateAlignedPage();
+
+        while (file->getPageCount() <= map_page_index + 1)
+            file->allocPage();
+
+        std::copy_n(buckets.begin() + map_page_index * PageSize, PageSize, page.get());
+        file->writePage(page.get(), map_page_index + 1);
+        dirty_map_pages[map_page_index] = false;
+    }
+
+    if (!header_dirty)
+        return;
+
+    if (!page)
+        page = allocateAlignedPage();
+    if (file->getPageCount() == 0)
+        file->allocPage();
+
+    std::fill_n(page.get(), PageSize, 0);
+    Header header{.page_count = static_cast<uint64_t>(page_count)};
+    std::memcpy(page.get(), &header, sizeof(header));
+    file->writePage(page.get(), 0);
+    header_dirty = false;
+}
+
+void FreeSpaceMap::load()
+{
+    if (loaded)
+        return;
+
+    loaded = true;
+    heads.assign(256, InvalidPageIndex);
+    if (file->getPageCount() == 0)
+        return;
+
+    auto page = allocateAlignedPage();
+    file->readPage(page.get(), 0);
+    Header header;
+    std::memcpy(&header, page.get(), sizeof(header));
+
+    /// Unknown header is treated as missing map, table rebuilds it and the next flush overwrites the file
+    PageIndex map_page_count = file->getPageCount() - 1;
+    if (header.magic != Header::Magic || header.page_count > static_cast<uint64_t>(map_page_count) * PageSize)
+    {
+        header_dirty = true;
+        return;
+    }
+
+    page_count = static_cast<PageIndex>(header.page_count);
+    buckets.assign(map_page_count * PageSize, 0);
+    next.assign(buckets.size(), InvalidPageIndex);
+    previous.assign(buckets.size(), InvalidPageIndex);
+    dirty_map_pages.assign(map_page_count, false);
+
+    for (PageIndex map_page_index = 0; map_page_index < map_page_count; ++map_page_index)
+    {
+        file->readPage(page.get(), map_page_index + 1);
+        std::copy_n(page.get(), PageSize, buckets.begin() + map_page_index * PageSize);
+    }
+
+    /// Buckets past the header were written by a flush that did not finish, they are rebuilt from table pages
+    std::fill(buckets.begin() + page_count, buckets.end(), 0);
+
+    /// Linking in reverse order leaves pages closer to the start of the table at list heads
+    for (PageIndex page_index = page_count - 1; page_index >= 0; --page_index)
+        link(page_index, buckets[page_index]);
+}
+
+void FreeSpaceMap::link(PageIndex page_index, uint8_t bucket)
+{
+    if (bucket == 0)
+        return;
+
+    next[page_index] = heads[bucket];
+    previous[page_index] = InvalidPageIndex;
+    if (heads[bucket] != InvalidPageIndex)
+        previous[heads[bucket]] = page_index;
+    heads[bucket] = page_index;
+}
+
+void FreeSpaceMap::unlink(PageIndex page_index)
+{
+    auto bucket = buckets[page_index];
+    if (bucket == 0)
+        return;
+
+    if (previous[page_index] != InvalidPageIndex)
+        next[previous[page_index]] = next[page_index];
+    else
+        heads[bucket] = next[page_index];
+
+    if (next[page_index] != InvalidPageIndex)
+        previous[next[page_index]] = previous[page_index];
+
+    next[page_index] = InvalidPageIndex;
+    previous[page_index] = InvalidPageIndex;
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "file.h"
+#include "page.h"
+
+namespace shdb
+{
+
+/// Coarse free space of every table page, persisted in a side file with one bucket byte per page.
+/// Pages with free space are kept in per bucket lists, so finding a page with room takes constant time.
+/// Map is only a hint and bypasses buffer pool, changed map pages are written back on flush.
+/// Destruction flushes too but ignores errors, a lost write only makes the table rebuild part of the map.
+/// Header page records how many table pages the persisted buckets describe, pages past it are rebuilt by the table.
+/// One map is shared by all handles of a table.
+class FreeSpaceMap
+{
+public:
+    explicit FreeSpaceMap(std::shared_ptr<File> file);
+
+    ~FreeSpaceMap() noexcept;
+
+    FreeSpaceMap(const FreeSpaceMap &) = delete;
+    FreeSpaceMap & operator=(const FreeSpaceMap &) = delete;
+
+    static constexpr size_t BucketSize = PageSize / 256;
+
+    /// Returns page whose bucket covers space free bytes, or InvalidPageIndex if there is none.
+    /// Buckets are coarse, so row may still not fit, caller then lowers the page with update.
+    PageIndex findPage(size_t space);
+
+    void update(PageIndex page_index, size_t free_space);
+
+    /// Writes changed bucket pages, then header, so header never covers buckets that were not written
+    void flush();
+
+    /// Number of leading table pages whose free space is recorded, zero if map file is missing or not recognized
+    PageIndex getPageCount();
+
+    static uint8_t toBucket(size_t free_space);
+
+private:
+    void load();
+
+    void link(PageIndex page_index, uint8_t bucket);
+
+    void unlink(PageIndex page_index);
+
+    std::shared_ptr<File> file;
+
+    /// Built lazily on first use, tables opened only for reading never pay for it
+    bool loaded = false;
+    PageIndex page_count = 0;
+    bool header_dirty = false;
+    std::vector<uint8_t> buckets;
+    std::vector<bool> dirty_map_pages;
+    std::vector<PageIndex> heads;
+    std::vector<PageIndex> next;
+    std::vector<PageIndex> previous;
+};
+
+}
@@ -13,11 +13,9 @@ public:
 
     PageIndex getPageCount() override { return file->getPageCount(); }
 
-    std::shared_ptr<IPage> getPage(PageIndex page_index) override
-    {
-        auto frame = buffer_pool->getPage(file, page_index);
-        return page_provider->getPage(std::move(frame));
-    }
+    Frame getPage(PageIndex page_index) override { return buffer_pool->getPage(file, page_index); }
+
+    const std::shared_ptr<IPageProvider> & getPageProvider() const override { return page_provider; }
 
     PageIndex allocatePage() override
     {
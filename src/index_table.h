@@ -17,7 +17,10 @@ public:
 
     virtual PageIndex getPageCount() = 0;
 
-    virtual std::shared_ptr<IPage> getPage(PageIndex page_index) = 0;
+    /// Pins page, index structures interpret its bytes with their page provider
+    virtual Frame getPage(PageIndex page_index) = 0;
+
+    virtual const std::shared_ptr<IPageProvider> & getPageProvider() const = 0;
 
     virtual PageIndex allocatePage() = 0;
 };
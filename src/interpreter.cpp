@@ -1,5 +1,8 @@
 #include "interpreter.h"
 
+#include <thread>
+#include <unordered_set>
+
 #include "accessors.h"
 #include "ast.h"
 #include "ast_visitor.h"
@@ -12,13 +15,228 @@
 namespace shdb
 {
 
-Interpreter::Interpreter(std::shared_ptr<Database> db_) : db(std::move(db_))
+/// Resolved SELECT query, executors of every execution are created from it
+struct SelectPlan
+{
+    struct Source
+    {
+        std::shared_ptr<ITable> table;
+        std::shared_ptr<Schema> schema;
+    };
+
+    std::vector<Source> from;
+    /// Pushed down WHERE and columns of the only table that are read
+    std::optional<ColumnPredicate> predicate;
+    std::optional<std::vector<size_t>> columns;
+    /// Output of table scans and joins
+    std::shared_ptr<Schema> input_schema;
+    /// WHERE has parameters, predicate, filter and empty input are planned for every execution from bound WHERE
+    bool where_bound = false;
+    /// WHERE folded to false
+    bool empty_input = false;
+    ExpressionPtr filter;
+    bool aggregated = false;
+    GroupByKeys keys;
+    GroupByExpressions group_by_expressions;
+    ExpressionPtr having;
+    SortExpressions sort_expressions;
+    Expressions projection;
+};
+
+namespace
+{
+
+/// Condition comparing a column with a literal is evaluated by table scan, possibly on encoded values.
+/// Only comparisons that filter would evaluate the same way are pushed down.
+std::optional<ColumnPredicate> buildColumnPredicate(const ASTPtr & where, const Schema & schema)
+{
+    if (where->type != ASTType::binaryOperator)
+        return std::nullopt;
+
+    const auto & binary_operator = static_cast<const ASTBinaryOperator &>(*where);
+    auto lhs = binary_operator.getLHS();
+    auto rhs = binary_operator.getRHS();
+    bool swapped = lhs->type == ASTType::literal;
+    if (swapped)
+        std::swap(lhs, rhs);
+    if (lhs->type != ASTType::identifier || rhs->type != ASTType::literal)
+        return std::nullopt;
+
+    ColumnPredicate predicate;
+    switch (binary_operator.operator_code)
+    {
+        case BinaryOperatorCode::eq:
+            predicate.comparison = ColumnPredicate::Comparison::eq;
+            break;
+        case BinaryOperatorCode::ne:
+            predicate.comparison = ColumnPredicate::Comparison::ne;
+            break;
+        case BinaryOperatorCode::lt:
+            predicate.comparison = swapped ? ColumnPredicate::Comparison::gt : ColumnPredicate::Comparison::lt;
+            break;
+        case BinaryOperatorCode::le:
+            predicate.comparison = swapped ? ColumnPredicate::Comparison::ge : ColumnPredicate::Comparison::le;
+            break;
+        case BinaryOperatorCode::gt:
+            predicate.comparison = swapped ? ColumnPredicate::Comparison::lt : ColumnPredicate::Comparison::gt;
+            break;
+        case BinaryOperatorCode::ge:
+            predicate.comparison = swapped ? ColumnPredicate::Comparison::le : ColumnPredicate::Comparison::ge;
+            break;
+        default:
+            return std::nullopt;
+    }
+
+    const auto & name = static_cast<const ASTIdentifier &>(*lhs).name;
+    const auto & literal = static_cast<const ASTLiteral &>(*rhs);
+    for (size_t index = 0; index < schema.size(); ++index)
+    {
+        if (schema[index].name != name)
+            continue;
+
+        predicate.column = index;
+        auto type = schema[index].type;
+        if (type == Type::int64 && literal.literal_type == ASTLiteralType::number)
+        {
+            predicate.value = literal.integer_value;
+            return predicate;
+        }
+        if (type == Type::uint64 && literal.literal_type == ASTLiteralType::unsigned_number)
+        {
+            predicate.value = literal.unsigned_value;
+            return predicate;
+        }
+        bool is_equality
+            = predicate.comparison == ColumnPredicate::Comparison::eq || predicate.comparison == ColumnPredicate::Comparison::ne;
+        if ((type == Type::varchar || type == Type::string) && literal.literal_type == ASTLiteralType::string && is_equality)
+        {
+            predicate.value = literal.string_value;
+            return predicate;
+        }
+        return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+/// Scans of FROM tables joined together and filtered by WHERE
+ExecutorPtr createInputExecutor(const SelectPlan & plan, TableSlice slice)
+{
+    ExecutorPtr input;
+    if (plan.from.empty()) {
+        input = createReadFromRowsExecutor({Row()}, std::shared_ptr<Schema>());
+    } else {
+        const auto & source = plan.from.front();
+        input = createReadFromTableExecutor(source.table, source.schema, plan.predicate, plan.columns, slice);
+        for (size_t i = 1; i < plan.from.size(); ++i) {
+            input = createJoinExecutor(std::move(input), createReadFromTableExecutor(plan.from[i].table, plan.from[i].schema));
+        }
+    }
+
+    /// Folded predicate rejects every row, executors read lazily so tables are not scanned
+    if (plan.empty_input)
+        input = createReadFromRowsExecutor({}, input->getOutputSchema());
+
+    if (plan.filter)
+        input = createFilterExecutor(std::move(input), plan.filter);
+    return input;
+}
+
+/// Literal value of WHERE folded to constant
+std::optional<bool> getConstantCondition(const ASTPtr & where)
+{
+    if (where == nullptr || where->type != ASTType::literal)
+        return std::nullopt;
+    const auto & literal = static_cast<const ASTLiteral &>(*where);
+    if (literal.literal_type != ASTLiteralType::boolean)
+        return std::nullopt;
+    return literal.boolean_value;
+}
+
+/// WHERE of the only table is pushed down to its scan if it compares a column with a literal
+void planPushedDownWhere(SelectPlan & plan, const ASTPtr & where)
+{
+    auto constant_where = getConstantCondition(where);
+    plan.empty_input = constant_where == false;
+    if (plan.from.size() == 1 && where != nullptr && !constant_where.has_value())
+        plan.predicate = buildColumnPredicate(where, *plan.from.front().schema);
+}
+
+/// WHERE that is neither pushed down nor constant is evaluated on input of plan
+void planFilter(SelectPlan & plan, const ASTPtr & where)
+{
+    if (where != nullptr && !plan.predicate && !getConstantCondition(where).has_value())
+        plan.filter = buildExpression(where, std::make_shared<SchemaAccessor>(plan.input_schema));
+}
+
+/// Columns of table read by any stage of query except pushed down predicate
+std::vector<size_t> collectReadColumns(const ASTSelectQueryPtr & select_query_ptr, const ASTPtr & where, const Schema & schema)
+{
+    ASTs expressions = select_query_ptr->getProjectionList().getChildren();
+    expressions.push_back(where);
+    for (const auto & ast : select_query_ptr->getGroupByList().getChildren())
+        expressions.push_back(ast);
+    expressions.push_back(select_query_ptr->getHaving());
+    if (select_query_ptr->getOrder() != nullptr)
+        for (const auto & ast : select_query_ptr->getOrder()->getChildren())
+            expressions.push_back(std::static_pointer_cast<const ASTOrder>(ast)->getExpr());
+
+    auto identifiers = collectIdentifiers(expressions);
+    std::vector<size_t> columns;
+    for (size_t i = 0; i < schema.size(); ++i)
+        if (identifiers.contains(schema[i].name))
+            columns.push_back(i);
+    return columns;
+}
+
+/// Subexpressions computed by aggregation, group keys and aggregate function calls, are replaced with its output columns
+ASTPtr replaceAggregatedExpressions(const ASTPtr & ast, const std::unordered_set<std::string> & aggregated_columns)
+{
+    if (ast->type != ASTType::identifier && aggregated_columns.contains(ast->getName()))
+        return newIdentifier(ast->getName());
+
+    switch (ast->type)
+    {
+        case ASTType::binaryOperator: {
+            const auto & binary_operator = static_cast<const ASTBinaryOperator &>(*ast);
+            auto lhs = replaceAggregatedExpressions(binary_operator.getLHS(), aggregated_columns);
+            auto rhs = replaceAggregatedExpressions(binary_operator.getRHS(), aggregated_columns);
+            if (lhs == binary_operator.getLHS() && rhs == binary_operator.getRHS())
+                return ast;
+            return newBinaryOperator(binary_operator.operator_code, std::move(lhs), std::move(rhs));
+        }
+        case ASTType::unaryOperator: {
+            const auto & unary_operator = static_cast<const ASTUnaryOperator &>(*ast);
+            auto operand = replaceAggregatedExpressions(unary_operator.getOperand(), aggregated_columns);
+            if (operand == unary_operator.getOperand())
+                return ast;
+            return newUnaryOperator(unary_operator.operator_code, std::move(operand));
+        }
+        default:
+            return ast;
+    }
+}
+
+}
+
+Interpreter::Interpreter(std::shared_ptr<Database> db_, size_t plan_cache_capacity) : db(std::move(db_)), plan_cache(plan_cache_capacity)
 {
     registerAggregateFunctions(aggregate_function_factory);
 }
 
 RowSet Interpreter::execute(const std::string & query)
 {
+    auto statement = prepare(query);
+    if (statement->getParameterCount() != 0)
+        throw std::runtime_error("Query has parameters, it must be prepared");
+    return execute(statement, Row());
+}
+
+PreparedStatementPtr Interpreter::prepare(const std::string & query)
+{
+    auto normalized_query = normalizeQuery(query);
+    if (auto statement = plan_cache.find(normalized_query))
+        return statement;
+
     Lexer lexer(query.c_str(), query.c_str() + query.size());
     ASTPtr result;
     std::string error;
@@ -27,6 +245,39 @@ RowSet Interpreter::execute(const std::string & query)
     if (!result || !error.empty())
         throw std::runtime_error("Bad input: " + error);
 
+    auto statement = std::make_shared<const PreparedStatement>(std::move(result));
+    plan_cache.insert(normalized_query, statement);
+    return statement;
+}
+
+RowSet Interpreter::execute(const PreparedStatementPtr & statement, const Row & parameters)
+{
+    /// Plan is kept for SELECT with parameters only in WHERE, bound WHERE is folded and planned for every execution.
+    /// Other queries with parameters are planned from the bound query.
+    const auto & query = statement->getQuery();
+    bool cached_plan = statement->getParameterCount() == 0 ? parameters.empty() : statement->hasParametersOnlyInWhere();
+    if (cached_plan && query->type == ASTType::selectQuery) {
+        /// Tables may be created and dropped by other interpreters of the same database, so version is kept by database
+        auto catalog_version = db ? db->getCatalogVersion() : 0;
+        auto plan = statement->getPlan(catalog_version);
+        if (!plan) {
+            plan = buildSelectPlan(std::static_pointer_cast<ASTSelectQuery>(query));
+            statement->setPlan(plan, catalog_version);
+        }
+        if (plan->where_bound) {
+            auto bound_plan = std::make_shared<SelectPlan>(*plan);
+            auto where = statement->bindWhere(parameters);
+            planPushedDownWhere(*bound_plan, where);
+            planFilter(*bound_plan, where);
+            plan = std::move(bound_plan);
+        }
+        return rexecute(createSelectExecutor(*plan));
+    }
+    return executeQuery(statement->bind(parameters));
+}
+
+RowSet Interpreter::executeQuery(const ASTPtr & result)
+{
     switch (result->type)
     {
         case ASTType::selectQuery:
@@ -40,8 +291,11 @@ RowSet Interpreter::execute(const std::string & query)
         case ASTType::dropQuery:
             executeDrop(std::static_pointer_cast<ASTDropQuery>(result));
             break;
+        case ASTType::copyQuery:
+            executeCopy(std::static_pointer_cast<ASTCopyQuery>(result));
+            break;
         default:
-            throw std::runtime_error("Invalid AST. Expected SELECT, INSERT, CREATE or DROP query");
+            throw std::runtime_error("Invalid AST. Expected SELECT, INSERT, CREATE, DROP or COPY query");
     }
 
     return RowSet{};
@@ -49,93 +303,230 @@ RowSet Interpreter::execute(const std::string & query)
 
 RowSet Interpreter::executeSelect(const ASTSelectQueryPtr & select_query_ptr)
 {
+    return rexecute(buildSelectExecutor(select_query_ptr));
+}
 
-    std::unique_ptr<IExecutor> executor;
-    if (select_query_ptr->from.empty()) {
-        executor = createReadFromRowsExecutor({Row()}, std::shared_ptr<Schema>());
-    } else {
-        auto table_name = select_query_ptr->from[0];
+ExecutorPtr Interpreter::buildSelectExecutor(const ASTSelectQueryPtr & select_query_ptr)
+{
+    return createSelectExecutor(*buildSelectPlan(select_query_ptr));
+}
+
+std::shared_ptr<const SelectPlan> Interpreter::buildSelectPlan(const ASTSelectQueryPtr & select_query_ptr)
+{
+    auto plan = std::make_shared<SelectPlan>();
+    auto where = select_query_ptr->getWhere();
+    plan->where_bound = where != nullptr && countParameters(where) != 0;
+
+    /// Aggregation runs after WHERE, expressions of later stages read its output
+    ASTs aggregated_expressions;
+    if (select_query_ptr->getProjection() != nullptr) {
+        aggregated_expressions = select_query_ptr->getProjectionList().getChildren();
+    }
+    aggregated_expressions.push_back(select_query_ptr->getHaving());
+    if (select_query_ptr->getOrder() != nullptr) {
+        for (const auto& ast : select_query_ptr->getOrder()->getChildren()) {
+            aggregated_expressions.push_back(std::static_pointer_cast<const ASTOrder>(ast)->getExpr());
+        }
+    }
+    auto aggregate_functions = collectAggregateFunctions(aggregated_expressions, aggregate_function_factory);
+    plan->aggregated = select_query_ptr->hasGroupBy() || !aggregate_functions.empty();
+
+    for (const auto & table_name : select_query_ptr->from) {
         auto table = db->getTable(table_name);
-        auto schema = db->findTableSchema(table_name);
-        executor = createReadFromTableExecutor(table, schema);
+        plan->from.push_back(SelectPlan::Source{std::move(table), db->findTableSchema(table_name)});
+    }
+    if (!plan->where_bound)
+        planPushedDownWhere(*plan, where);
+    /// Without SELECT * scan decodes only columns that later stages read, pushed down predicate reads table itself.
+    /// Bound WHERE may or may not be pushed down, so its columns are always read.
+    if (plan->from.size() == 1 && select_query_ptr->getProjection() != nullptr)
+        plan->columns = collectReadColumns(select_query_ptr, plan->predicate ? nullptr : where, *plan->from.front().schema);
+
+    /// Executors are only created to know schemas of stages, they read nothing until asked
+    plan->input_schema = createInputExecutor(*plan, TableSlice{})->getOutputSchema();
+    if (!plan->where_bound)
+        planFilter(*plan, where);
+    auto schema = plan->input_schema;
+
+    std::unordered_set<std::string> aggregated_columns;
+    if (plan->aggregated) {
+        SchemaAccessorPtr input_accessor;
+        if (schema) {
+            input_accessor = std::make_shared<SchemaAccessor>(schema);
+        }
+
+        for (const auto& ast : select_query_ptr->getGroupByList().getChildren()) {
+            plan->keys.push_back(GroupByKey{buildExpression(ast, input_accessor), ast->getName()});
+            aggregated_columns.insert(plan->keys.back().expression_column_name);
+        }
 
-        for (size_t i = 1; i < select_query_ptr->from.size(); ++i) {
-            auto table_name1 = select_query_ptr->from[i];
-            auto table1 = db->getTable(table_name1);
-            auto schema1 = db->findTableSchema(table_name1);
-            executor = createJoinExecutor(std::move(executor), createReadFromTableExecutor(table1, schema1));
+        for (const auto& ast : aggregate_functions) {
+            const auto & function = static_cast<const ASTFunction &>(*ast);
+            if (function.getArguments() == nullptr) {
+                throw std::runtime_error("Aggregate function " + function.name + " does not accept *");
+            }
+            GroupByExpression expression;
+            expression.arguments = buildExpressions(function.getArgumentsList().getChildren(), input_accessor);
+            Types argument_types;
+            for (const auto & argument : expression.arguments) {
+                argument_types.push_back(argument->getResultType());
+            }
+            expression.aggregate_function = aggregate_function_factory.getAggregateFunctionOrThrow(function.name, argument_types);
+            expression.aggregate_function_column_name = ast->getName();
+            aggregated_columns.insert(expression.aggregate_function_column_name);
+            plan->group_by_expressions.push_back(std::move(expression));
         }
+        schema = createGroupByExecutor(createReadFromRowsExecutor({}, schema), plan->keys, plan->group_by_expressions, 1)
+                     ->getOutputSchema();
     }
+    auto after_aggregation = [&](const ASTPtr & ast) { return plan->aggregated ? replaceAggregatedExpressions(ast, aggregated_columns) : ast; };
 
-    if (select_query_ptr->getWhere() != nullptr) {
-        auto schema = executor->getOutputSchema();
-        executor = createFilterExecutor(
-            std::move(executor), buildExpression(select_query_ptr->getWhere(), std::make_shared<SchemaAccessor>(schema)));
+    if (select_query_ptr->getHaving() != nullptr) {
+        if (!plan->aggregated) {
+            throw std::runtime_error("HAVING requires GROUP BY or aggregate functions");
+        }
+        plan->having = buildExpression(after_aggregation(select_query_ptr->getHaving()), std::make_shared<SchemaAccessor>(schema));
     }
 
     if (select_query_ptr->getOrder() != nullptr) {
-        SortExpressions sort_exprs;
-        auto schema = executor->getOutputSchema();
         for (const auto& ast : select_query_ptr->getOrder()->getChildren()) {
             const auto ast_order = std::static_pointer_cast<const ASTOrder>(ast);
             SortExpression expr;
             expr.desc = ast_order->desc;
-            expr.expression = buildExpression(ast_order->getExpr(), std::make_shared<SchemaAccessor>(schema));
-            sort_exprs.push_back(expr);
+            expr.expression = buildExpression(after_aggregation(ast_order->getExpr()), std::make_shared<SchemaAccessor>(schema));
+            plan->sort_expressions.push_back(expr);
         }
-        executor = createSortExecutor(std::move(executor), sort_exprs);
     }
 
     std::vector<ASTPtr> proj;
     SchemaAccessorPtr schemaAccessor;
-    if (!select_query_ptr->from.empty()) {
-        schemaAccessor.reset(new SchemaAccessor(executor->getOutputSchema()));
+    if (schema) {
+        schemaAccessor.reset(new SchemaAccessor(schema));
     }
     if (select_query_ptr->getProjection() != nullptr) {
-        proj = select_query_ptr->getProjectionList().getChildren();
+        for (const auto& ast : select_query_ptr->getProjectionList().getChildren()) {
+            proj.push_back(after_aggregation(ast));
+        }
     } else {
-        for (const auto& item : *executor->getOutputSchema()) {
+        for (const auto& item : *schema) {
             proj.push_back(newIdentifier(item.name));
         }
     }
+    plan->projection = buildExpressions(proj, schemaAccessor);
+    return plan;
+}
 
-    auto expressions = buildExpressions(proj, schemaAccessor);
-    executor = createExpressionsExecutor(std::move(executor), expressions);
+ExecutorPtr Interpreter::createSelectExecutor(const SelectPlan & plan)
+{
+    /// Aggregation of a single table gives every thread its own slice of pages, scanned and filtered by the thread itself
+    size_t slice_count = 1;
+    if (plan.aggregated && plan.from.size() == 1 && !plan.empty_input) {
+        slice_count = max_threads != 0 ? max_threads : std::max(1U, std::thread::hardware_concurrency());
+    }
 
-    return rexecute(std::move(executor));
+    auto executor = createInputExecutor(plan, TableSlice{0, slice_count});
+    if (plan.aggregated) {
+        if (slice_count > 1) {
+            std::vector<ExecutorPtr> inputs;
+            inputs.push_back(std::move(executor));
+            for (size_t i = 1; i < slice_count; ++i) {
+                inputs.push_back(createInputExecutor(plan, TableSlice{i, slice_count}));
+            }
+            executor = createGroupByExecutor(std::move(inputs), plan.keys, plan.group_by_expressions);
+        } else {
+            executor = createGroupByExecutor(std::move(executor), plan.keys, plan.group_by_expressions, max_threads);
+        }
+    }
+    if (plan.having) {
+        executor = createFilterExecutor(std::move(executor), plan.having);
+    }
+    if (!plan.sort_expressions.empty()) {
+        executor = createSortExecutor(std::move(executor), plan.sort_expressions);
+    }
+    return createExpressionsExecutor(std::move(executor), plan.projection);
 }
 
 void Interpreter::executeInsert(const std::shared_ptr<ASTInsertQuery> & insert_query)
 {
-    auto proj = insert_query->getValuesList().getChildren();
+    const auto & table_name = insert_query->table;
+    auto table_schema = db->findTableSchema(table_name);
+    if (!table_schema || !db->checkTableExists(table_name))
+        throw std::runtime_error("Table " + table_name + " does not exist");
 
-    auto expressions = buildExpressions(proj, std::shared_ptr<SchemaAccessor>{});
-    auto readFromRowsExecutor = createReadFromRowsExecutor({Row()}, std::shared_ptr<Schema>());
-    auto expressionsExecutor = createExpressionsExecutor(std::move(readFromRowsExecutor), expressions);
+    std::vector<Type> types;
+    auto check_types = [&](const std::vector<Type> & row_types)
+    {
+        if (row_types.size() != table_schema->size())
+            throw std::runtime_error("invalid row schema!");
+        for (size_t i = 0; i < row_types.size(); ++i)
+            if (row_types[i] != (*table_schema)[i].type)
+                throw std::runtime_error("invalid row schema!");
+    };
 
-    auto mySchema = expressionsExecutor->getOutputSchema();
+    /// Rows are collected before table is touched, so select reading the same table does not see inserted rows
+    Rows rows;
+    if (insert_query->getSelect()) {
+        auto executor = buildSelectExecutor(std::static_pointer_cast<ASTSelectQuery>(insert_query->getSelect()));
+        auto select_schema = executor->getOutputSchema();
+        for (const auto & column : *select_schema)
+            types.push_back(column.type);
+        check_types(types);
 
-    std::string table_name = insert_query->table;
-    Row row = rexecute(std::move(expressionsExecutor)).getRows()[0];
+        ColumnBatch batch;
+        while (executor->nextBatch(batch))
+            for (auto row : batch.getSelection())
+                rows.push_back(batch.getRow(row));
+    } else {
+        /// Every tuple must have types of the first one, only they are checked against table schema
+        for (const auto & values : insert_query->getRowsList().getChildren()) {
+            auto expressions = buildExpressions(values->getChildren(), std::shared_ptr<SchemaAccessor>{});
+            std::vector<Type> row_types;
+            for (const auto & expression : expressions)
+                row_types.push_back(expression->getResultType());
+            if (rows.empty()) {
+                check_types(row_types);
+                types = std::move(row_types);
+            } else if (row_types != types) {
+                throw std::runtime_error("invalid row schema!");
+            }
 
-    assert(db->checkTableExists(table_name));
-    auto tableSchema = db->findTableSchema(table_name);
-    for (size_t i = 0; i < row.size(); ++i) {
-        if((*mySchema)[i].type != (*tableSchema)[i].type) {
-            throw std::runtime_error("invalid row schema!");
+            Row row;
+            row.reserve(expressions.size());
+            for (const auto & expression : expressions)
+                row.push_back(expression->evaluate(Row()));
+            rows.push_back(std::move(row));
         }
     }
-    db->getTable(table_name)->insertRow(row);
+
+    db->getTable(table_name)->insertRows(rows);
 }
 
 void Interpreter::executeCreate(const ASTCreateQueryPtr & create_query)
 {
-    db->createTable(create_query->table, create_query->schema);
+    plan_cache.clear();
+    db->createTable(create_query->table, create_query->schema, create_query->layout);
 }
 
 void Interpreter::executeDrop(const ASTDropQueryPtr & drop_query)
 {
+    plan_cache.clear();
     db->dropTable(drop_query->table);
 }
 
+void Interpreter::executeCopy(const ASTCopyQueryPtr & copy_query)
+{
+    CopyOptions options;
+    options.header = copy_query->header;
+    if (copy_query->delimiter.empty())
+        options.delimiter = getDefaultDelimiter(copy_query->path);
+    else if (copy_query->delimiter == "\\t")
+        options.delimiter = '\t';
+    else if (copy_query->delimiter.size() == 1)
+        options.delimiter = copy_query->delimiter[0];
+    else
+        throw std::runtime_error("Delimiter must be a single character");
+
+    db->copyFromFile(copy_query->table, copy_query->path, options);
+}
+
 }
@@ -3,6 +3,8 @@
 #include "aggregate_function.h"
 #include "ast.h"
 #include "database.h"
+#include "executor.h"
+#include "plan_cache.h"
 #include "rowset.h"
 
 namespace shdb
@@ -11,18 +13,38 @@ namespace shdb
 class Interpreter
 {
 public:
-    explicit Interpreter(std::shared_ptr<Database> db_);
+    static constexpr size_t DefaultPlanCacheCapacity = 256;
 
+    explicit Interpreter(std::shared_ptr<Database> db_, size_t plan_cache_capacity = DefaultPlanCacheCapacity);
+
+    /// Parsed query is taken from plan cache if the same text was executed recently
     RowSet execute(const std::string & query);
 
+    /// Parses query once, its ? placeholders are bound to parameters on every execution
+    PreparedStatementPtr prepare(const std::string & query);
+
+    RowSet execute(const PreparedStatementPtr & statement, const Row & parameters);
+
+    size_t getPlanCacheSize() const { return plan_cache.size(); }
+
+    /// Threads of parallel query stages, hardware concurrency if zero
+    void setMaxThreads(size_t threads) { max_threads = threads; }
+
 private:
+    RowSet executeQuery(const ASTPtr & query);
     RowSet executeSelect(const ASTSelectQueryPtr & select_query);
+    ExecutorPtr buildSelectExecutor(const ASTSelectQueryPtr & select_query);
+    std::shared_ptr<const SelectPlan> buildSelectPlan(const ASTSelectQueryPtr & select_query);
+    ExecutorPtr createSelectExecutor(const SelectPlan & plan);
     void executeInsert(const ASTInsertQueryPtr & insert_query);
     void executeCreate(const ASTCreateQueryPtr & create_query);
     void executeDrop(const ASTDropQueryPtr & drop_query);
+    void executeCopy(const ASTCopyQueryPtr & copy_query);
 
     std::shared_ptr<Database> db;
     AggregateFunctionFactory aggregate_function_factory;
+    PlanCache plan_cache;
+    size_t max_threads = 0;
 };
 
 }
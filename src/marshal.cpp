@@ -17,7 +17,7 @@ void serializeValue(const T & value, uint8_t *& data)
 }
 
 template <class T>
-T deserializeValue(uint8_t *& data)
+T deserializeValue(const uint8_t *& data)
 {
     T result{};
     memcpy(&result, data, sizeof(result));
@@ -36,33 +36,40 @@ size_t Marshal::calculateFixedRowSpace(uint64_t nulls) const
         nulls >>= 1;
         if (null)
             continue;
-        switch (column.type)
-        {
-            case Type::boolean: {
-                result += sizeof(uint8_t);
-                break;
-            }
-            case Type::uint64: {
-                result += sizeof(uint64_t);
-                break;
-            }
-            case Type::int64: {
-                result += sizeof(int64_t);
-                break;
-            }
-            case Type::varchar: {
-                result += column.length;
-                break;
-            }
-            case Type::string: {
-                result += sizeof(size_t) + sizeof(uint8_t*);
-                break;
-            }
-            default: {
-                assert(0);
-            }
-        }
+        result += getColumnSpace(column);
+    }
+    return result;
+}
+
+size_t Marshal::getColumnSpace(const ColumnSchema & column) const
+{
+    switch (column.type)
+    {
+        case Type::boolean:
+            return sizeof(uint8_t);
+        case Type::uint64:
+            return sizeof(uint64_t);
+        case Type::int64:
+            return sizeof(int64_t);
+        case Type::varchar:
+            return column.length;
+        case Type::string:
+            return sizeof(size_t) + sizeof(size_t);
+        default:
+            assert(0);
     }
+    return 0;
+}
+
+size_t Marshal::getColumnOffset(uint64_t nulls, size_t index) const
+{
+    if (nulls == 0)
+        return column_offsets[index];
+
+    size_t result = sizeof(uint64_t);
+    for (size_t column_index = 0; column_index < index; ++column_index)
+        if (!(nulls & (1UL << column_index)))
+            result += getColumnSpace((*schema)[column_index]);
     return result;
 }
 
@@ -78,6 +85,13 @@ uint64_t Marshal::getNulls(const Row & row) const
 Marshal::Marshal(std::shared_ptr<Schema> schema) : schema(std::move(schema)), fixed_row_space(calculateFixedRowSpace(0))
 {
     assert(Marshal::schema->size() <= sizeof(uint64_t) * 8);
+
+    size_t offset = sizeof(uint64_t);
+    for (const auto & column : *Marshal::schema)
+    {
+        column_offsets.push_back(offset);
+        offset += getColumnSpace(column);
+    }
 }
 
 size_t Marshal::getFixedRowSpace() const
@@ -150,7 +164,8 @@ void Marshal::serializeRow(uint8_t * data, const Row & row) const
                 const auto & str = std::get<std::string>(row[index]);
                 auto length = str.length();
                 serializeValue(length, data);
-                serializeValue(string_buffer, data);
+                /// Offset from row start, so serialized row does not depend on the address it was written at
+                serializeValue(static_cast<size_t>(string_buffer - start), data);
                 ::memcpy(string_buffer, str.c_str(), length);
                 string_buffer += length;
                 break;
@@ -162,7 +177,7 @@ void Marshal::serializeRow(uint8_t * data, const Row & row) const
     assert(static_cast<size_t>(string_buffer - start) <= getRowSpace(row));
 }
 
-Row Marshal::deserializeRow(uint8_t * data) const
+Row Marshal::deserializeRow(const uint8_t * data) const
 {
     auto * start = data;
     auto nulls = deserializeValue<uint64_t>(data);
@@ -192,16 +207,16 @@ Row Marshal::deserializeRow(uint8_t * data) const
                 break;
             }
             case Type::varchar: {
-                auto length = strnlen(reinterpret_cast<char *>(data), (*schema)[index].length);
-                auto str = std::string(reinterpret_cast<char *>(data), length);
+                auto length = strnlen(reinterpret_cast<const char *>(data), (*schema)[index].length);
+                auto str = std::string(reinterpret_cast<const char *>(data), length);
                 row.emplace_back(std::move(str));
                 data += (*schema)[index].length;
                 break;
             }
             case Type::string: {
                 auto length = deserializeValue<size_t>(data);
-                auto *raw_str = deserializeValue<uint8_t*>(data);
-                std::string s(reinterpret_cast<char *>(raw_str), length);
+                auto offset = deserializeValue<size_t>(data);
+                std::string s(reinterpret_cast<const char *>(start + offset), length);
                 //                int rsp = getRowSpace(row);
                 //                assert(static_cast<size_t>(raw_str + length - start) <= getRowSpace(row));
                 row.emplace_back(std::move(s));
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "row.h"
 #include "schema.h"
@@ -19,15 +20,25 @@ public:
 
     void serializeRow(uint8_t * data, const Row & row) const;
 
-    Row deserializeRow(uint8_t * data) const;
+    Row deserializeRow(const uint8_t * data) const;
+
+    /// Offset of non null column value from serialized row start
+    size_t getColumnOffset(uint64_t nulls, size_t index) const;
+
+    const Schema & getSchema() const { return *schema; }
 
 private:
     size_t calculateFixedRowSpace(uint64_t nulls) const;
 
+    size_t getColumnSpace(const ColumnSchema & column) const;
+
     uint64_t getNulls(const Row & row) const;
 
     std::shared_ptr<Schema> schema;
     size_t fixed_row_space;
+
+    /// Column offsets of rows without nulls, the common case needs no layout walk
+    std::vector<size_t> column_offsets;
 };
 
 }
@@ -14,11 +14,6 @@ constexpr int32_t InvalidPageIndex = -1;
 
 using PageId = std::pair<int32_t, PageIndex>;
 
-class IPage
-{
-public:
-    virtual ~IPage() = default;
-};
 }
 
 namespace std
@@ -30,7 +25,14 @@ class hash<shdb::PageId>
 public:
     size_t operator()(const shdb::PageId & page_id) const
     {
-        return std::hash<int32_t>()(page_id.first) ^ std::hash<int32_t>()(page_id.second);
+        /// Finalizer of MurmurHash3, every bit of fd and page index affects low bits used by open addressing tables
+        uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(page_id.first)) << 32) | static_cast<uint32_t>(page_id.second);
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return key;
     }
 };
 
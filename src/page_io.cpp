@@ -0,0 +1,361 @@
+#include "page_io.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace shdb
+{
+
+void IPageIO::execute(std::span<const PageIORequest> requests)
+{
+    assert(getInFlightCount() == 0);
+    try
+    {
+        submit(requests);
+
+        std::vector<uint64_t> completed;
+        reap(completed, requests.size());
+    }
+    catch (...)
+    {
+        cancel();
+        throw;
+    }
+}
+
+namespace
+{
+
+class SyncPageIO : public IPageIO
+{
+public:
+    PageIOBackend getBackend() const override { return PageIOBackend::sync; }
+
+    void submit(std::span<const PageIORequest> requests) override
+    {
+        for (const auto & request : requests)
+        {
+            if (request.write)
+                request.file->writePage(request.data, request.page_index);
+            else
+                request.file->readPage(request.data, request.page_index);
+            completed_tags.push_back(request.tag);
+        }
+    }
+
+    void reap(std::vector<uint64_t> & completed, size_t min_completions) override
+    {
+        assert(min_completions <= completed_tags.size());
+        (void)(min_completions);
+        completed.insert(completed.end(), completed_tags.begin(), completed_tags.end());
+        completed_tags.clear();
+    }
+
+    size_t getInFlightCount() const override { return completed_tags.size(); }
+
+    void cancel() override { completed_tags.clear(); }
+
+private:
+    std::vector<uint64_t> completed_tags;
+};
+
+int ioUringSetup(unsigned entries, io_uring_params * params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int ioUringRegister(int ring_fd, unsigned opcode, const void * arg, unsigned nr_args)
+{
+    return static_cast<int>(syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+[[noreturn]] void throwIOError(const char * message)
+{
+    throw std::runtime_error(std::string(message) + ": " + std::strerror(errno));
+}
+
+/** io_uring backend implemented on top of raw system calls.
+  * Frame pool arena is registered as a fixed buffer, so kernel does not map pages on each request.
+  */
+class IOUringPageIO : public IPageIO
+{
+public:
+    static constexpr unsigned QueueDepth = 64;
+
+    IOUringPageIO(int ring_fd_, const io_uring_params & params, uint8_t * arena, size_t arena_size) : ring_fd(ring_fd_)
+    {
+        sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap)
+            sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+        sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+        if (sq_ring == MAP_FAILED)
+            fail("Unable to map io_uring submission queue");
+
+        if (single_mmap)
+            cq_ring = sq_ring;
+        else
+        {
+            cq_ring = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+            if (cq_ring == MAP_FAILED)
+                fail("Unable to map io_uring completion queue");
+        }
+
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe *>(
+            mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED)
+            fail("Unable to map io_uring submission entries");
+
+        auto * sq = static_cast<uint8_t *>(sq_ring);
+        sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        sq_entries = params.sq_entries;
+
+        auto * cq = static_cast<uint8_t *>(cq_ring);
+        cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        cq_entries = params.cq_entries;
+
+        /// Registration may fail due to locked memory limits, plain reads and writes are used then
+        iovec arena_iovec{arena, arena_size};
+        fixed_buffers = arena && ioUringRegister(ring_fd, IORING_REGISTER_BUFFERS, &arena_iovec, 1) == 0;
+    }
+
+    ~IOUringPageIO() override { release(); }
+
+    PageIOBackend getBackend() const override { return PageIOBackend::io_uring; }
+
+    void submit(std::span<const PageIORequest> requests) override
+    {
+        for (const auto & request : requests)
+        {
+            if (in_flight + pending == cq_entries)
+                reapCompletions(1);
+
+            unsigned tail = *sq_tail;
+            if (tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) == sq_entries)
+            {
+                enter(0);
+                tail = *sq_tail;
+            }
+
+            unsigned index = tail & sq_mask;
+            auto & sqe = sqes[index];
+            memset(&sqe, 0, sizeof(sqe));
+            if (fixed_buffers)
+                sqe.opcode = request.write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+            else
+                sqe.opcode = request.write ? IORING_OP_WRITE : IORING_OP_READ;
+            sqe.fd = request.file->getFd();
+            sqe.addr = reinterpret_cast<uint64_t>(request.data);
+            sqe.len = PageSize;
+            sqe.off = static_cast<uint64_t>(request.page_index) * PageSize;
+            sqe.buf_index = 0;
+            sqe.user_data = request.tag;
+            sq_array[index] = index;
+
+            __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+            ++pending;
+        }
+
+        enter(0);
+    }
+
+    void reap(std::vector<uint64_t> & completed, size_t min_completions) override
+    {
+        assert(min_completions <= in_flight + pending + completed_tags.size());
+        if (completed_tags.size() < min_completions)
+            reapCompletions(min_completions - completed_tags.size());
+
+        completed.insert(completed.end(), completed_tags.begin(), completed_tags.end());
+        completed_tags.clear();
+    }
+
+    size_t getInFlightCount() const override { return in_flight + pending + completed_tags.size(); }
+
+    void cancel() override
+    {
+        /// Kernel consumes submission queue only inside io_uring_enter, so entries it has not seen can be taken back
+        __atomic_store_n(sq_tail, __atomic_load_n(sq_head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+        pending = 0;
+
+        /// Started requests may still write into frame buffers, they have to complete before buffers are reused
+        while (in_flight > 0)
+        {
+            unsigned head = *cq_head;
+            unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+            for (; head != tail && in_flight > 0; ++head)
+                --in_flight;
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+
+            if (in_flight > 0 && ioUringEnter(ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR && errno != EAGAIN
+                && errno != EBUSY)
+                break;
+        }
+
+        in_flight = 0;
+        completed_tags.clear();
+    }
+
+private:
+    void enter(unsigned min_complete)
+    {
+        unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+        while (true)
+        {
+            int submitted = ioUringEnter(ring_fd, pending, min_complete, flags);
+            if (submitted >= 0)
+            {
+                pending -= submitted;
+                in_flight += submitted;
+                return;
+            }
+            if (errno == EBUSY)
+            {
+                /// Kernel refuses submissions while completions it could not post wait in overflow list.
+                /// Reaping frees completion queue, entering with GETEVENTS moves overflowed completions into it.
+                min_complete -= std::min(min_complete, drainCompletions());
+                flags |= IORING_ENTER_GETEVENTS;
+                continue;
+            }
+            if (errno != EINTR && errno != EAGAIN)
+                throwIOError("Unable to perform I/O");
+        }
+    }
+
+    /// Moves completions posted by kernel into completed_tags, returns how many were moved
+    unsigned drainCompletions()
+    {
+        unsigned drained = 0;
+        unsigned head = *cq_head;
+        unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head)
+        {
+            const auto & cqe = cqes[head & cq_mask];
+            if (cqe.res != static_cast<int32_t>(PageSize))
+            {
+                __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+                --in_flight;
+                errno = cqe.res < 0 ? -cqe.res : EIO;
+                throwIOError("Unable to perform I/O");
+            }
+            completed_tags.push_back(cqe.user_data);
+            --in_flight;
+            ++drained;
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        return drained;
+    }
+
+    /// Completions may also be drained inside enter, so progress is counted by completed_tags
+    void reapCompletions(size_t min_completions)
+    {
+        size_t target = completed_tags.size() + min_completions;
+        while (true)
+        {
+            drainCompletions();
+            if (completed_tags.size() >= target)
+                return;
+
+            enter(static_cast<unsigned>(target - completed_tags.size()));
+        }
+    }
+
+    [[noreturn]] void fail(const char * message)
+    {
+        int error = errno;
+        release();
+        errno = error;
+        throwIOError(message);
+    }
+
+    void release()
+    {
+        if (sqes && sqes != MAP_FAILED)
+            munmap(sqes, sqes_size);
+        if (cq_ring && cq_ring != MAP_FAILED && cq_ring != sq_ring)
+            munmap(cq_ring, cq_ring_size);
+        if (sq_ring && sq_ring != MAP_FAILED)
+            munmap(sq_ring, sq_ring_size);
+        if (ring_fd >= 0)
+            close(ring_fd);
+        sqes = nullptr;
+        cq_ring = sq_ring = nullptr;
+        ring_fd = -1;
+    }
+
+    int ring_fd = -1;
+    bool fixed_buffers = false;
+
+    void * sq_ring = nullptr;
+    size_t sq_ring_size = 0;
+    void * cq_ring = nullptr;
+    size_t cq_ring_size = 0;
+    io_uring_sqe * sqes = nullptr;
+    size_t sqes_size = 0;
+
+    unsigned * sq_head = nullptr;
+    unsigned * sq_tail = nullptr;
+    unsigned * sq_array = nullptr;
+    unsigned sq_mask = 0;
+    unsigned sq_entries = 0;
+
+    unsigned * cq_head = nullptr;
+    unsigned * cq_tail = nullptr;
+    io_uring_cqe * cqes = nullptr;
+    unsigned cq_mask = 0;
+    unsigned cq_entries = 0;
+
+    /// Requests placed into submission queue but not consumed by kernel yet
+    size_t pending = 0;
+    size_t in_flight = 0;
+    std::vector<uint64_t> completed_tags;
+};
+
+}
+
+std::unique_ptr<IPageIO> createPageIO(PageIOBackend backend, uint8_t * arena, size_t arena_size)
+{
+    if (backend == PageIOBackend::io_uring)
+    {
+        io_uring_params params{};
+        int ring_fd = ioUringSetup(IOUringPageIO::QueueDepth, &params);
+        if (ring_fd >= 0)
+        {
+            /// Rings that can not be mapped, for example under memory limits, are closed by constructor
+            try
+            {
+                return std::make_unique<IOUringPageIO>(ring_fd, params, arena, arena_size);
+            }
+            catch (const std::runtime_error &)
+            {
+            }
+        }
+    }
+
+    return std::make_unique<SyncPageIO>();
+}
+
+}
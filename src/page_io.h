@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "file.h"
+#include "page.h"
+
+namespace shdb
+{
+
+enum class PageIOBackend
+{
+    sync,
+    io_uring,
+};
+
+struct PageIORequest
+{
+    const File * file = nullptr;
+    PageIndex page_index = 0;
+    uint8_t * data = nullptr;
+    bool write = false;
+
+    /// Returned back on request completion
+    uint64_t tag = 0;
+};
+
+/** Page I/O backend used by frame pool.
+  * Requests are submitted in batches and complete asynchronously,
+  * data buffers must stay valid until request completion is reaped.
+  */
+class IPageIO
+{
+public:
+    virtual ~IPageIO() = default;
+
+    virtual PageIOBackend getBackend() const = 0;
+
+    /// Start reads and writes for requests
+    virtual void submit(std::span<const PageIORequest> requests) = 0;
+
+    /// Wait until at least min_completions requests complete, tags of completed requests are appended to completed
+    virtual void reap(std::vector<uint64_t> & completed, size_t min_completions) = 0;
+
+    /// Number of submitted requests that are not reaped yet
+    virtual size_t getInFlightCount() const = 0;
+
+    /// Drop submitted requests after a failure, waits for requests that already started. Leaves nothing in flight.
+    virtual void cancel() = 0;
+
+    /// Submit requests and wait for all of them
+    void execute(std::span<const PageIORequest> requests);
+};
+
+/** Creates page I/O backend. Buffers registered for io_uring are taken from [arena, arena + arena_size).
+  * If io_uring is unavailable or its ring can not be set up synchronous backend is returned.
+  */
+std::unique_ptr<IPageIO> createPageIO(PageIOBackend backend, uint8_t * arena, size_t arena_size);
+
+}
@@ -3,19 +3,49 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <utility>
+
+#include "bufferpool.h"
 
 namespace shdb
 {
 
-class IPage;
-class Frame;
-
 class IPageProvider
 {
 public:
     virtual ~IPageProvider() = default;
+};
+
+/// Move-only pinned page. T is a lightweight view over frame bytes constructed in place,
+/// so taking a page costs neither allocation nor reference counting.
+template <class T>
+class PageGuard
+{
+public:
+    PageGuard() = default;
+
+    template <class... Args>
+    explicit PageGuard(Frame frame_, Args &&... args) : frame(std::move(frame_)), page(frame.getView(), std::forward<Args>(args)...)
+    {
+    }
+
+    PageGuard(PageGuard && other) noexcept = default;
+
+    PageGuard & operator=(PageGuard && other) noexcept = default;
+
+    T * operator->() { return &page; }
+
+    const T * operator->() const { return &page; }
+
+    T & operator*() { return page; }
+
+    const T & operator*() const { return page; }
+
+    const Frame & getFrame() const { return frame; }
 
-    virtual std::shared_ptr<IPage> getPage(std::shared_ptr<Frame> frame) = 0;
+private:
+    Frame frame;
+    T page;
 };
 
 }
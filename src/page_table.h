@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace shdb
+{
+
+/// Fixed capacity open addressing hash table with linear probing, used to map pages to frames.
+/// All memory is allocated in constructor, deletions shift following entries back instead of leaving tombstones.
+template <class Key, class Value, class Hash = std::hash<Key>>
+class PageTable
+{
+public:
+    explicit PageTable(size_t max_size) : max_size(max_size)
+    {
+        size_t capacity = 8;
+        while (capacity < 2 * max_size)
+            capacity *= 2;
+        entries.resize(capacity);
+        mask = capacity - 1;
+    }
+
+    Value * find(const Key & key)
+    {
+        auto position = lookup(key);
+        return entries[position].used ? &entries[position].value : nullptr;
+    }
+
+    const Value * find(const Key & key) const
+    {
+        auto position = lookup(key);
+        return entries[position].used ? &entries[position].value : nullptr;
+    }
+
+    bool contains(const Key & key) const { return find(key) != nullptr; }
+
+    void insertOrAssign(const Key & key, Value value)
+    {
+        auto position = lookup(key);
+        auto & entry = entries[position];
+        if (!entry.used)
+        {
+            assert(count < max_size);
+            entry.used = true;
+            entry.key = key;
+            ++count;
+        }
+        entry.value = std::move(value);
+    }
+
+    bool erase(const Key & key)
+    {
+        auto position = lookup(key);
+        if (!entries[position].used)
+            return false;
+
+        /// Move back entries of the probe chain that would become unreachable behind the hole
+        auto hole = position;
+        for (auto next = (hole + 1) & mask; entries[next].used; next = (next + 1) & mask)
+        {
+            auto home = Hash()(entries[next].key) & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask))
+            {
+                entries[hole] = std::move(entries[next]);
+                hole = next;
+            }
+        }
+        entries[hole].used = false;
+        --count;
+        return true;
+    }
+
+    size_t size() const { return count; }
+
+private:
+    struct Entry
+    {
+        Key key{};
+        Value value{};
+        bool used = false;
+    };
+
+    size_t lookup(const Key & key) const
+    {
+        auto position = Hash()(key) & mask;
+        while (entries[position].used && !(entries[position].key == key))
+            position = (position + 1) & mask;
+        return position;
+    }
+
+    std::vector<Entry> entries;
+    size_t mask = 0;
+    size_t max_size = 0;
+    size_t count = 0;
+};
+
+}
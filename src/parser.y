@@ -31,6 +31,11 @@
 %token ORDER_BY "ORDER BY"
 %token DESC "DESC"
 %token GROUP_BY "GROUP BY"
+%token HAVING "HAVING"
+%token LAYOUT "LAYOUT"
+%token COPY "COPY"
+%token DELIMITER "DELIMITER"
+%token HEADER "HEADER"
 %token LPAR "("
 %token RPAR ")"
 %token COMMA ","
@@ -53,21 +58,29 @@
 %token LAND "AND"
 %token LOR "OR"
 %token LNOT "!"
+%token PARAMETER "?"
 
 %token <std::string> NAME
 %token <int> NUM
+%token <std::string> QUOTED_STRING
 
 %type <std::shared_ptr<IAST>> command
+%type <std::shared_ptr<IAST>> select_query
+%type <std::shared_ptr<ASTList>> value_rows
 %type <Schema> schemaParams
 %type <ColumnSchema> schemaParam
 %type <std::shared_ptr<IAST>> expr
 %type <std::shared_ptr<ASTList>> exprs
 %type <std::vector<std::string>> names
 %type <std::shared_ptr<IAST>> where_expr
+%type <std::shared_ptr<ASTList>> group_by_expr
+%type <std::shared_ptr<IAST>> having_expr
 %type <std::vector<std::string>> from_expr
 %type <std::shared_ptr<ASTList>> order_by_expr
 %type <std::shared_ptr<IAST>> order_expr
 %type <std::shared_ptr<ASTList>> order_exprs
+%type <std::string> copy_delimiter
+%type <bool> copy_header
 
 %left "=" "<>" "<" "<=" ">" ">="
 %left "+" "-"
@@ -83,9 +96,23 @@ input: command { result = $1; }
 
 command:
     "CREATE TABLE" NAME "(" schemaParams ")" { $$ = newCreateQuery($2, $4); }
+    | "CREATE TABLE" NAME "(" schemaParams ")" "LAYOUT" NAME { $$ = newCreateQuery($2, $4, parseTableLayout($7)); }
     | "DROP TABLE" NAME { $$ = newDropQuery($2); }
-    | "SELECT" exprs from_expr where_expr order_by_expr {{ $$ = newSelectQuery($2, $3, $4, nullptr, nullptr, $5); }}
-    | "INSERT" NAME "VALUES" "(" exprs ")" {{ $$ = newInsertQuery($2, $5); }}
+    | select_query { $$ = $1; }
+    | "INSERT" NAME "VALUES" value_rows {{ $$ = newInsertQuery($2, $4); }}
+    | "INSERT" NAME select_query {{ $$ = newInsertSelectQuery($2, $3); }}
+    | "COPY" NAME "FROM" QUOTED_STRING copy_delimiter copy_header {{ $$ = newCopyQuery($2, $4, $5, $6); }}
+
+select_query: "SELECT" exprs from_expr where_expr group_by_expr having_expr order_by_expr {{ $$ = newSelectQuery($2, $3, $4, $5, $6, $7); }}
+
+value_rows: "(" exprs ")" {{ $$ = newList($2); }}
+    | value_rows "," "(" exprs ")" {{ $1->append($4); $$ = std::move($1); }}
+
+copy_delimiter: {{ $$ = std::string(); }}
+    | "DELIMITER" QUOTED_STRING {{ $$ = $2; }}
+
+copy_header: {{ $$ = false; }}
+    | "HEADER" {{ $$ = true; }}
 
 from_expr: {{ $$ = {}; }}
     | "FROM" names {{ $$ = $2; }}
@@ -93,6 +120,12 @@ from_expr: {{ $$ = {}; }}
 where_expr: {{ $$ = nullptr; }}
     | "WHERE" expr {{ $$ = $2; }}
 
+group_by_expr: {{ $$ = newList(); }}
+    | "GROUP BY" exprs {{ if (!$2) YYERROR; $$ = $2; }}
+
+having_expr: {{ $$ = nullptr; }}
+    | "HAVING" expr {{ $$ = $2; }}
+
 order_by_expr: {{ $$ = nullptr; }}
     | "ORDER BY" order_exprs {{ $$ = $2; }}
 
@@ -108,6 +141,8 @@ order_exprs: order_expr {{ $$ = newList($1); }}
 expr: NUM {{ $$ = newNumberLiteral($1); }}
     | "\"" NAME "\"" {{ $$ = newStringLiteral($2); }}
     | NAME {{ $$ = newIdentifier($1); }}
+    | "?" {{ $$ = newParameter(); }}
+    | NAME "(" exprs ")" {{ $$ = newFunction($1, $3); }}
     | "(" expr ")" { $$ = $2; }
     | expr "=" expr {{ $$ = newBinaryOperator(BinaryOperatorCode::eq, $1, $3); }}
     | expr "<>" expr {{ $$ = newBinaryOperator(BinaryOperatorCode::ne, $1, $3); }}
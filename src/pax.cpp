@@ -0,0 +1,483 @@
+#include "pax.h"
+
+#include <cassert>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "column_encoding.h"
+#include "row.h"
+#include "slot_bitmap.h"
+#include "table.h"
+
+namespace shdb
+{
+
+namespace
+{
+
+/// Bitmap is sized for the most rows a page may hold, actual capacity depends on column encodings
+constexpr RowIndex MaxRowCapacity = 1024;
+
+struct PaxHeader
+{
+    uint32_t row_capacity = 0;
+    uint32_t reserved = 0;
+};
+
+constexpr size_t PaxHeaderOffset = sizeof(uint64_t) * (1 + (MaxRowCapacity + 63) / 64);
+
+constexpr size_t MinipagesOffset = PaxHeaderOffset + sizeof(PaxHeader);
+
+/// Null mask of a row is packed like a column value, a bit per column
+constexpr size_t MaxColumnCount = 64;
+
+size_t getColumnWidth(const ColumnSchema & column)
+{
+    switch (column.type)
+    {
+        case Type::boolean:
+            return sizeof(uint8_t);
+        case Type::uint64:
+            return sizeof(uint64_t);
+        case Type::int64:
+            return sizeof(int64_t);
+        case Type::varchar:
+            return column.length;
+        case Type::string:
+            break;
+    }
+    throw std::runtime_error("Columnar layout does not support string columns");
+}
+
+bool hasValueOfType(Type type, const Value & value)
+{
+    switch (type)
+    {
+        case Type::boolean:
+            return std::holds_alternative<bool>(value);
+        case Type::uint64:
+            return std::holds_alternative<uint64_t>(value);
+        case Type::int64:
+            return std::holds_alternative<int64_t>(value);
+        case Type::varchar:
+        case Type::string:
+            return std::holds_alternative<std::string>(value);
+    }
+    return false;
+}
+
+uint64_t getNulls(const Row & row)
+{
+    uint64_t nulls = 0;
+    for (size_t index = 0; index < row.size(); ++index)
+        if (std::holds_alternative<Null>(row[index]))
+            nulls |= uint64_t(1) << index;
+    return nulls;
+}
+
+}
+
+/// Page starts with slot occupancy bitmap and minipage headers of every column and of null masks.
+/// Minipages follow, each keeps values of one column for all slots in the encoding chosen from page data:
+/// integers and booleans are bit-packed offsets from page minimum, varchars are dictionary codes or plain values.
+/// Values that do not fit current encodings make page encode its rows again, capacity shrinks or grows with it.
+class PaxPage
+{
+public:
+    PaxPage(const FrameView & frame, const ColumnarLayout & layout)
+        : frame(frame), layout(layout), schema(*layout.schema)
+    {
+    }
+
+    RowIndex getRowCount() const { return static_cast<RowIndex>(readPaxHeader().row_capacity); }
+
+    RowView getRowView(RowIndex index) const
+    {
+        if (index < getRowCount() && getSlots().isOccupied(index))
+            return RowView(frame.getData(), &layout, index);
+
+        return RowView();
+    }
+
+    void deleteRow(RowIndex index)
+    {
+        if (index < getRowCount() && getSlots().isOccupied(index))
+            getSlots().release(index);
+    }
+
+    RowIndex findNextRow(RowIndex from) const { return getSlots().findNextOccupied(from); }
+
+    RowIndex getFreeRowCount() const { return getRowCount() - getSlots().getLiveCount(); }
+
+    std::pair<bool, RowIndex> insertRow(const Row & row)
+    {
+        auto row_capacity = getRowCount();
+        RowIndex row_index = row_capacity;
+        if (getSlots().getLiveCount() < row_capacity)
+            row_index = getSlots().findFree();
+        else if (row_capacity != 0)
+            return {false, -1};
+
+        if (row_index < row_capacity && fits(row))
+        {
+            writeRow(row_index, row);
+        }
+        else
+        {
+            auto rows = collectRows();
+            rows.emplace_back(row_index, row);
+            if (!encode(rows, 0))
+                return {false, -1};
+        }
+        getSlots().occupy(row_index);
+
+        /// Filled page is encoded again from its data, it may take more rows with better fitting encodings
+        if (getSlots().getLiveCount() == getRowCount() && getRowCount() < MaxRowCapacity)
+            encode(collectRows(), getRowCount() + std::max<RowIndex>(1, getRowCount() / 16));
+
+        return {true, row_index};
+    }
+
+    /// Evaluates predicate on encoded values, false if it can not be done for such predicate
+    bool filterRows(const ColumnPredicate & predicate, std::vector<RowIndex> & rows) const
+    {
+        const auto & column = schema[predicate.column];
+        if (column.type == Type::string || !hasValueOfType(column.type, predicate.value))
+            return false;
+
+        const auto * data = frame.getData();
+        auto nulls_header = getMinipageHeader(schema.size());
+        bool has_nulls = nulls_header.base != 0 || nulls_header.bit_width != 0;
+        auto header = getMinipageHeader(predicate.column);
+
+        auto filter = [&](auto && accepts_row)
+        {
+            auto row_capacity = getRowCount();
+            for (auto row_index = findNextRow(0); row_index < row_capacity; row_index = findNextRow(row_index + 1))
+            {
+                if (has_nulls && (readKey(data, nulls_header, row_index) >> predicate.column) & 1)
+                {
+                    if (predicate.comparison == ColumnPredicate::Comparison::ne)
+                        rows.push_back(row_index);
+                    continue;
+                }
+                if (accepts_row(row_index))
+                    rows.push_back(row_index);
+            }
+        };
+
+        if (column.type == Type::varchar)
+        {
+            const auto & constant = std::get<std::string>(predicate.value);
+            if (header.encoding == ColumnEncoding::plain)
+            {
+                filter([&](RowIndex row_index)
+                       { return predicate.accepts(readString(data, header, column.length, row_index) <=> std::string_view(constant)); });
+                return true;
+            }
+
+            /// Predicate is evaluated once per dictionary value, rows only look their codes up
+            std::vector<uint8_t> accepted_codes(header.dictionary_capacity);
+            for (uint64_t code = 0; code < header.dictionary_size; ++code)
+                accepted_codes[code] = predicate.accepts(readDictionaryValue(data, header, column.length, code) <=> std::string_view(constant));
+            filter([&](RowIndex row_index) { return accepted_codes[readCode(data, header, row_index)] != 0; });
+            return true;
+        }
+
+        /// Constant is moved into frame of reference of the page, packed offsets are compared directly
+        auto key = toKey(column.type, predicate.value);
+        uint64_t max_offset = header.bit_width == 64 ? ~uint64_t(0) : (uint64_t(1) << header.bit_width) - 1;
+        if (key < header.base || key - header.base > max_offset)
+        {
+            bool accepted = predicate.accepts(key < header.base ? std::strong_ordering::greater : std::strong_ordering::less);
+            filter([&](RowIndex) { return accepted; });
+            return true;
+        }
+
+        auto offset = key - header.base;
+        const auto * packed = data + header.offset;
+        filter([&](RowIndex row_index) { return predicate.accepts(readBits(packed, row_index, header.bit_width) <=> offset); });
+        return true;
+    }
+
+private:
+    using IndexedRows = std::vector<std::pair<RowIndex, Row>>;
+
+    /// Capacity changes when page is encoded again, so bitmap view is taken for every access
+    SlotBitmap getSlots() const { return SlotBitmap(frame, getRowCount()); }
+
+    PaxHeader readPaxHeader() const
+    {
+        PaxHeader header;
+        memcpy(&header, frame.getData() + PaxHeaderOffset, sizeof(header));
+        return header;
+    }
+
+    MinipageHeader getMinipageHeader(size_t index) const
+    {
+        return readMinipageHeader(frame.getData() + MinipagesOffset + index * sizeof(MinipageHeader));
+    }
+
+    void setMinipageHeader(size_t index, const MinipageHeader & header)
+    {
+        writeMinipageHeader(frame.getMutableData() + MinipagesOffset + index * sizeof(MinipageHeader), header);
+    }
+
+    IndexedRows collectRows() const
+    {
+        IndexedRows rows;
+        auto row_capacity = getRowCount();
+        for (auto row_index = findNextRow(0); row_index < row_capacity; row_index = findNextRow(row_index + 1))
+            rows.emplace_back(row_index, getRowView(row_index).materialize());
+        return rows;
+    }
+
+    static bool fitsKey(const MinipageHeader & header, uint64_t key)
+    {
+        if (key < header.base)
+            return false;
+        return header.bit_width == 64 || ((key - header.base) >> header.bit_width) == 0;
+    }
+
+    std::optional<uint64_t> findDictionaryCode(const MinipageHeader & header, size_t length, const std::string & value) const
+    {
+        for (uint64_t code = 0; code < header.dictionary_size; ++code)
+            if (readDictionaryValue(frame.getData(), header, length, code) == value)
+                return code;
+        return std::nullopt;
+    }
+
+    bool fits(const Row & row) const
+    {
+        if (!fitsKey(getMinipageHeader(schema.size()), getNulls(row)))
+            return false;
+
+        for (size_t index = 0; index < schema.size(); ++index)
+        {
+            if (std::holds_alternative<Null>(row[index]))
+                continue;
+
+            auto header = getMinipageHeader(index);
+            const auto & column = schema[index];
+            if (column.type != Type::varchar)
+            {
+                if (!fitsKey(header, toKey(column.type, row[index])))
+                    return false;
+            }
+            else if (header.encoding == ColumnEncoding::dictionary && header.dictionary_size == header.dictionary_capacity)
+            {
+                if (!findDictionaryCode(header, column.length, std::get<std::string>(row[index])))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    /// Row must fit current encodings
+    void writeRow(RowIndex row_index, const Row & row)
+    {
+        auto * data = frame.getMutableData();
+        auto nulls_header = getMinipageHeader(schema.size());
+        writeBits(data + nulls_header.offset, row_index, nulls_header.bit_width, getNulls(row) - nulls_header.base);
+
+        for (size_t index = 0; index < schema.size(); ++index)
+        {
+            if (std::holds_alternative<Null>(row[index]))
+                continue;
+
+            auto header = getMinipageHeader(index);
+            const auto & column = schema[index];
+            if (column.type != Type::varchar)
+            {
+                writeBits(data + header.offset, row_index, header.bit_width, toKey(column.type, row[index]) - header.base);
+                continue;
+            }
+
+            const auto & value = std::get<std::string>(row[index]);
+            uint8_t * value_data = nullptr;
+            if (header.encoding == ColumnEncoding::plain)
+            {
+                value_data = data + header.offset + row_index * column.length;
+            }
+            else
+            {
+                auto code = findDictionaryCode(header, column.length, value);
+                if (!code)
+                {
+                    code = header.dictionary_size++;
+                    setMinipageHeader(index, header);
+                    value_data = data + header.base + *code * column.length;
+                }
+                writeBits(data + header.offset, row_index, header.bit_width, *code);
+            }
+
+            if (value_data)
+            {
+                memcpy(value_data, value.data(), value.size());
+                memset(value_data + value.size(), 0, column.length - value.size());
+            }
+        }
+    }
+
+    /// Chooses encodings for rows and rewrites page with them.
+    /// Fails leaving page intact if it would hold fewer than min_capacity rows or would lose some of the rows.
+    bool encode(const IndexedRows & rows, RowIndex min_capacity)
+    {
+        for (const auto & [row_index, row] : rows)
+            min_capacity = std::max(min_capacity, row_index + 1);
+
+        std::vector<MinipageHeader> headers(schema.size() + 1);
+        size_t fixed_space = MinipagesOffset + headers.size() * sizeof(MinipageHeader);
+        size_t row_bits = 0;
+
+        for (size_t index = 0; index <= schema.size(); ++index)
+        {
+            auto & header = headers[index];
+            bool is_nulls = index == schema.size();
+            if (!is_nulls && schema[index].type == Type::varchar)
+            {
+                std::unordered_set<std::string_view> distinct;
+                size_t count = 0;
+                for (const auto & [row_index, row] : rows)
+                {
+                    if (std::holds_alternative<Null>(row[index]))
+                        continue;
+                    distinct.insert(std::get<std::string>(row[index]));
+                    ++count;
+                }
+
+                /// Dictionary keeps room for as many new values as there are now
+                size_t length = schema[index].length;
+                size_t dictionary_capacity = std::max<size_t>(2 * distinct.size(), 1);
+                if (distinct.size() * 2 <= count + 1 && dictionary_capacity <= UINT16_MAX && dictionary_capacity * length <= PageSize / 4)
+                {
+                    header.encoding = ColumnEncoding::dictionary;
+                    header.dictionary_capacity = static_cast<uint16_t>(dictionary_capacity);
+                    header.bit_width = getBitWidth(dictionary_capacity - 1);
+                    fixed_space += dictionary_capacity * length;
+                    row_bits += header.bit_width;
+                }
+                else
+                {
+                    header.encoding = ColumnEncoding::plain;
+                    row_bits += length * 8;
+                }
+                continue;
+            }
+
+            std::optional<uint64_t> min_key;
+            uint64_t max_key = 0;
+            for (const auto & [row_index, row] : rows)
+            {
+                if (!is_nulls && std::holds_alternative<Null>(row[index]))
+                    continue;
+                auto key = is_nulls ? getNulls(row) : toKey(schema[index].type, row[index]);
+                min_key = min_key ? std::min(*min_key, key) : key;
+                max_key = std::max(max_key, key);
+            }
+            header.encoding = ColumnEncoding::frame_of_reference;
+            header.base = min_key.value_or(0);
+            header.bit_width = getBitWidth(max_key - header.base);
+            row_bits += header.bit_width;
+        }
+
+        /// Every packed minipage may take a word of padding
+        size_t padding = headers.size() * sizeof(uint64_t);
+        if (fixed_space + padding > PageSize)
+            return false;
+        RowIndex row_capacity = MaxRowCapacity;
+        if (row_bits != 0)
+            row_capacity = static_cast<RowIndex>(std::min<size_t>(MaxRowCapacity, (PageSize - fixed_space - padding) * 8 / row_bits));
+        if (row_capacity < min_capacity)
+            return false;
+
+        size_t offset = MinipagesOffset + headers.size() * sizeof(MinipageHeader);
+        for (size_t index = 0; index < headers.size(); ++index)
+        {
+            auto & header = headers[index];
+            if (header.encoding == ColumnEncoding::dictionary)
+            {
+                header.base = offset;
+                offset += header.dictionary_capacity * schema[index].length;
+            }
+            header.offset = static_cast<uint32_t>(offset);
+            if (header.encoding == ColumnEncoding::plain)
+                offset += row_capacity * schema[index].length;
+            else
+                offset += getPackedSize(row_capacity, header.bit_width);
+        }
+        assert(offset <= PageSize);
+
+        auto * data = frame.getMutableData();
+        memset(data + PaxHeaderOffset, 0, PageSize - PaxHeaderOffset);
+        PaxHeader pax_header{static_cast<uint32_t>(row_capacity), 0};
+        memcpy(data + PaxHeaderOffset, &pax_header, sizeof(pax_header));
+        for (size_t index = 0; index < headers.size(); ++index)
+            setMinipageHeader(index, headers[index]);
+
+        for (const auto & [row_index, row] : rows)
+            writeRow(row_index, row);
+
+        return true;
+    }
+
+    const FrameView & frame;
+    const ColumnarLayout & layout;
+    const Schema & schema;
+};
+
+class PaxPageProvider : public ITablePageProvider
+{
+public:
+    explicit PaxPageProvider(std::shared_ptr<Schema> schema)
+    {
+        if (schema->size() > MaxColumnCount)
+            throw std::runtime_error("Columnar layout supports at most " + std::to_string(MaxColumnCount) + " columns");
+
+        /// Free space is accounted in rows of full width, so free space map works with rows not bytes
+        row_space = sizeof(uint64_t);
+        for (const auto & column : *schema)
+            row_space += getColumnWidth(column);
+
+        layout.schema = std::move(schema);
+        layout.minipages_offset = MinipagesOffset;
+    }
+
+    RowIndex getRowCount(const FrameView & frame) const override { return PaxPage(frame, layout).getRowCount(); }
+
+    Row getRow(const FrameView & frame, RowIndex index) const override { return getRowView(frame, index).materialize(); }
+
+    RowView getRowView(const FrameView & frame, RowIndex index) const override { return PaxPage(frame, layout).getRowView(index); }
+
+    void deleteRow(const FrameView & frame, RowIndex index) const override { PaxPage(frame, layout).deleteRow(index); }
+
+    std::pair<bool, RowIndex> insertRow(const FrameView & frame, const Row & row) const override
+    {
+        return PaxPage(frame, layout).insertRow(row);
+    }
+
+    RowIndex findNextRow(const FrameView & frame, RowIndex from) const override { return PaxPage(frame, layout).findNextRow(from); }
+
+    size_t getFreeSpace(const FrameView & frame) const override { return PaxPage(frame, layout).getFreeRowCount() * row_space; }
+
+    size_t getRowSpace(const Row &) const override { return row_space; }
+
+    void filterRows(const FrameView & frame, const ColumnPredicate & predicate, std::vector<RowIndex> & rows) const override
+    {
+        if (!PaxPage(frame, layout).filterRows(predicate, rows))
+            ITablePageProvider::filterRows(frame, predicate, rows);
+    }
+
+private:
+    ColumnarLayout layout;
+    size_t row_space = 0;
+};
+
+std::shared_ptr<ITablePageProvider> createPaxPageProvider(std::shared_ptr<Schema> schema)
+{
+    return std::make_shared<PaxPageProvider>(std::move(schema));
+}
+
+}
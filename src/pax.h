@@ -0,0 +1,13 @@
+#pragma once
+
+#include "schema.h"
+#include "table.h"
+
+namespace shdb
+{
+
+/// Columnar page format, every page keeps a minipage per column.
+/// Supports fixed width columns only.
+std::shared_ptr<ITablePageProvider> createPaxPageProvider(std::shared_ptr<Schema> schema);
+
+}
@@ -0,0 +1,257 @@
+#include "plan_cache.h"
+
+#include <cctype>
+
+#include "ast_visitor.h"
+
+namespace shdb
+{
+
+namespace
+{
+
+class ParameterCounter : public ASTVisitor<ParameterCounter>
+{
+public:
+    void visitImpl(const ASTPtr & node)
+    {
+        if (node->type == ASTType::parameter)
+            ++count;
+    }
+
+    size_t count = 0;
+};
+
+class ParameterBinder
+{
+public:
+    explicit ParameterBinder(const Row & parameters_) : parameters(parameters_) { }
+
+    /// Children are bound in order they are stored, which is the order parameters are counted in
+    ASTPtr bind(const ASTPtr & node)
+    {
+        if (!node)
+            return node;
+
+        switch (node->type)
+        {
+            case ASTType::parameter:
+                return bindParameter();
+            case ASTType::binaryOperator: {
+                const auto & binary_operator = static_cast<const ASTBinaryOperator &>(*node);
+                auto lhs = bind(binary_operator.getLHS());
+                auto rhs = bind(binary_operator.getRHS());
+                if (lhs == binary_operator.getLHS() && rhs == binary_operator.getRHS())
+                    return node;
+                return newBinaryOperator(binary_operator.operator_code, std::move(lhs), std::move(rhs));
+            }
+            case ASTType::unaryOperator: {
+                const auto & unary_operator = static_cast<const ASTUnaryOperator &>(*node);
+                auto operand = bind(unary_operator.getOperand());
+                if (operand == unary_operator.getOperand())
+                    return node;
+                return newUnaryOperator(unary_operator.operator_code, std::move(operand));
+            }
+            case ASTType::list:
+                return bindList(std::static_pointer_cast<ASTList>(node));
+            case ASTType::function: {
+                const auto & function = static_cast<const ASTFunction &>(*node);
+                auto arguments = bindList(std::static_pointer_cast<ASTList>(function.getArguments()));
+                if (arguments == function.getArguments())
+                    return node;
+                return newFunction(function.name, std::move(arguments));
+            }
+            case ASTType::order: {
+                const auto & order = static_cast<const ASTOrder &>(*node);
+                auto expr = bind(order.getExpr());
+                if (expr == order.getExpr())
+                    return node;
+                return newOrder(std::move(expr), order.desc);
+            }
+            case ASTType::selectQuery: {
+                const auto & select_query = static_cast<const ASTSelectQuery &>(*node);
+                auto projection = bindList(std::static_pointer_cast<ASTList>(select_query.getProjection()));
+                auto where = bind(select_query.getWhere());
+                auto group_by = bindList(std::static_pointer_cast<ASTList>(select_query.getGroupBy()));
+                auto having = bind(select_query.getHaving());
+                auto order = bindList(std::static_pointer_cast<ASTList>(select_query.getOrder()));
+                if (projection == select_query.getProjection() && where == select_query.getWhere() && group_by == select_query.getGroupBy()
+                    && having == select_query.getHaving() && order == select_query.getOrder())
+                    return node;
+                return newSelectQuery(projection, select_query.from, where, group_by, having, order);
+            }
+            case ASTType::insertQuery: {
+                auto insert_query = std::static_pointer_cast<ASTInsertQuery>(node);
+                if (insert_query->getSelect())
+                {
+                    auto select = bind(insert_query->getSelect());
+                    if (select == insert_query->getSelect())
+                        return node;
+                    return newInsertSelectQuery(insert_query->table, std::move(select));
+                }
+                auto rows = bindList(std::static_pointer_cast<ASTList>(insert_query->getRows()));
+                if (rows == insert_query->getRows())
+                    return node;
+                return newInsertQuery(insert_query->table, std::move(rows));
+            }
+            default:
+                return node;
+        }
+    }
+
+private:
+    ASTListPtr bindList(const ASTListPtr & list)
+    {
+        if (!list)
+            return list;
+
+        ASTs children;
+        bool changed = false;
+        for (const auto & child : list->getChildren())
+        {
+            children.push_back(bind(child));
+            changed |= children.back() != child;
+        }
+        if (!changed)
+            return list;
+        return std::make_shared<ASTList>(std::move(children));
+    }
+
+    ASTPtr bindParameter()
+    {
+        if (next_parameter == parameters.size())
+            throw std::runtime_error("Not enough query parameters");
+
+        const auto & value = parameters[next_parameter++];
+        if (const auto * number = std::get_if<int64_t>(&value))
+            return newNumberLiteral(*number);
+        if (const auto * number = std::get_if<uint64_t>(&value))
+            return newUnsignedNumberLiteral(*number);
+        if (const auto * boolean = std::get_if<bool>(&value))
+            return newBooleanLiteral(*boolean);
+        if (const auto * string = std::get_if<std::string>(&value))
+            return newStringLiteral(*string);
+        throw std::runtime_error("Query parameter must not be null");
+    }
+
+    const Row & parameters;
+    size_t next_parameter = 0;
+};
+
+}
+
+PreparedStatement::PreparedStatement(ASTPtr query_) : query(foldConstants(query_))
+{
+    parameter_count = countParameters(query);
+    if (parameter_count != 0 && query->type == ASTType::selectQuery)
+        parameters_only_in_where = countParameters(static_cast<const ASTSelectQuery &>(*query).getWhere()) == parameter_count;
+}
+
+ASTPtr PreparedStatement::bind(const Row & parameters) const
+{
+    checkParameterCount(parameters);
+    if (parameter_count == 0)
+        return query;
+    /// Nodes shared with query are already folded and left as they are, only copied nodes are changed
+    return foldConstants(ParameterBinder(parameters).bind(query));
+}
+
+ASTPtr PreparedStatement::bindWhere(const Row & parameters) const
+{
+    if (!parameters_only_in_where)
+        throw std::runtime_error("Query has parameters outside of WHERE");
+    checkParameterCount(parameters);
+    return foldConstants(ParameterBinder(parameters).bind(static_cast<const ASTSelectQuery &>(*query).getWhere()));
+}
+
+void PreparedStatement::checkParameterCount(const Row & parameters) const
+{
+    if (parameters.size() != parameter_count)
+        throw std::runtime_error(
+            "Query expects " + std::to_string(parameter_count) + " parameters, " + std::to_string(parameters.size()) + " given");
+}
+
+std::shared_ptr<const SelectPlan> PreparedStatement::getPlan(uint64_t catalog_version) const
+{
+    return plan_catalog_version == catalog_version ? plan : nullptr;
+}
+
+void PreparedStatement::setPlan(std::shared_ptr<const SelectPlan> plan_, uint64_t catalog_version) const
+{
+    plan = std::move(plan_);
+    plan_catalog_version = catalog_version;
+}
+
+size_t countParameters(const ASTPtr & ast)
+{
+    if (!ast)
+        return 0;
+    ParameterCounter counter;
+    counter.visit(ast);
+    return counter.count;
+}
+
+std::string normalizeQuery(const std::string & query)
+{
+    std::string result;
+    result.reserve(query.size());
+    char quote = 0;
+    for (auto c : query)
+    {
+        if (quote == 0 && std::isspace(static_cast<unsigned char>(c)))
+        {
+            if (!result.empty() && result.back() != ' ')
+                result.push_back(' ');
+            continue;
+        }
+        if (c == '"' || c == '\'')
+            quote = quote == 0 ? c : (quote == c ? 0 : quote);
+        result.push_back(c);
+    }
+    if (!result.empty() && result.back() == ' ')
+        result.pop_back();
+    return result;
+}
+
+PlanCache::PlanCache(size_t capacity_) : capacity(capacity_)
+{
+}
+
+PreparedStatementPtr PlanCache::find(const std::string & normalized_query)
+{
+    auto it = positions.find(normalized_query);
+    if (it == positions.end())
+        return nullptr;
+
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->second;
+}
+
+void PlanCache::insert(const std::string & normalized_query, PreparedStatementPtr statement)
+{
+    if (capacity == 0)
+        return;
+
+    if (auto it = positions.find(normalized_query); it != positions.end())
+    {
+        it->second->second = std::move(statement);
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+
+    if (entries.size() == capacity)
+    {
+        positions.erase(entries.back().first);
+        entries.pop_back();
+    }
+    entries.emplace_front(normalized_query, std::move(statement));
+    positions.emplace(normalized_query, entries.begin());
+}
+
+void PlanCache::clear()
+{
+    entries.clear();
+    positions.clear();
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "ast.h"
+#include "row.h"
+
+namespace shdb
+{
+
+struct SelectPlan;
+
+/// Parsed query with ? placeholders, executed many times with different parameters without parsing.
+/// Folded AST is kept. SELECT with parameters only in WHERE keeps its plan like SELECT without parameters, bound WHERE
+/// is folded and pushed down to table scans for every execution. Other queries with parameters are planned for every
+/// execution from the bound query. Executors are single use pipelines and are created from plan for every execution.
+class PreparedStatement
+{
+public:
+    explicit PreparedStatement(ASTPtr query);
+
+    size_t getParameterCount() const { return parameter_count; }
+
+    /// Query with placeholders replaced by literals, only nodes on paths to placeholders are copied.
+    /// Parameters may be values of any column type, null is not allowed.
+    ASTPtr bind(const Row & parameters) const;
+
+    /// Every placeholder of query is in WHERE of SELECT
+    bool hasParametersOnlyInWhere() const { return parameters_only_in_where; }
+
+    /// Folded WHERE with placeholders replaced by literals, query must have parameters only in WHERE
+    ASTPtr bindWhere(const Row & parameters) const;
+
+    const ASTPtr & getQuery() const { return query; }
+
+    /// Plan built when catalog had the given version, null if there is none
+    std::shared_ptr<const SelectPlan> getPlan(uint64_t catalog_version) const;
+
+    void setPlan(std::shared_ptr<const SelectPlan> plan, uint64_t catalog_version) const;
+
+private:
+    void checkParameterCount(const Row & parameters) const;
+
+    ASTPtr query;
+    size_t parameter_count = 0;
+    bool parameters_only_in_where = false;
+    mutable std::shared_ptr<const SelectPlan> plan;
+    mutable uint64_t plan_catalog_version = 0;
+};
+
+using PreparedStatementPtr = std::shared_ptr<const PreparedStatement>;
+
+/// Number of ? placeholders in tree
+size_t countParameters(const ASTPtr & ast);
+
+/// Query text with whitespace outside of quotes collapsed, so formatting does not affect plan cache hits
+std::string normalizeQuery(const std::string & query);
+
+/// Least recently used prepared statements by normalized query text
+class PlanCache
+{
+public:
+    explicit PlanCache(size_t capacity);
+
+    PreparedStatementPtr find(const std::string & normalized_query);
+
+    void insert(const std::string & normalized_query, PreparedStatementPtr statement);
+
+    /// Called when tables are created or dropped
+    void clear();
+
+    size_t size() const { return entries.size(); }
+
+private:
+    using Entries = std::list<std::pair<std::string, PreparedStatementPtr>>;
+
+    size_t capacity;
+    Entries entries;
+    std::unordered_map<std::string, Entries::iterator> positions;
+};
+
+}
@@ -0,0 +1,138 @@
+#include "row_view.h"
+
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace shdb
+{
+
+namespace
+{
+
+template <class T>
+T readValue(const uint8_t * data)
+{
+    T result{};
+    memcpy(&result, data, sizeof(result));
+    return result;
+}
+
+}
+
+RowView::RowView(const uint8_t * data, const Marshal * marshal) : data(data), marshal(marshal), nulls(readValue<uint64_t>(data))
+{
+}
+
+RowView::RowView(const uint8_t * page_data, const ColumnarLayout * layout, RowIndex row_index)
+    : data(page_data)
+    , layout(layout)
+    , row_index(row_index)
+    , nulls(getColumnKey(layout->schema->size()))
+{
+}
+
+MinipageHeader RowView::getMinipageHeader(size_t index) const
+{
+    return readMinipageHeader(data + layout->minipages_offset + index * sizeof(MinipageHeader));
+}
+
+uint64_t RowView::getColumnKey(size_t index) const
+{
+    return readKey(data, getMinipageHeader(index), row_index);
+}
+
+const Schema & RowView::getSchema() const
+{
+    return layout ? *layout->schema : marshal->getSchema();
+}
+
+size_t RowView::size() const
+{
+    return getSchema().size();
+}
+
+bool RowView::isNull(size_t index) const
+{
+    return nulls & (1UL << index);
+}
+
+const uint8_t * RowView::getColumnData(size_t index) const
+{
+    assert(!isNull(index));
+    return data + marshal->getColumnOffset(nulls, index);
+}
+
+bool RowView::getBool(size_t index) const
+{
+    if (layout)
+        return getColumnKey(index);
+    return static_cast<bool>(readValue<uint8_t>(getColumnData(index)));
+}
+
+uint64_t RowView::getUInt64(size_t index) const
+{
+    if (layout)
+        return getColumnKey(index);
+    return readValue<uint64_t>(getColumnData(index));
+}
+
+int64_t RowView::getInt64(size_t index) const
+{
+    if (layout)
+        return keyToInt64(getColumnKey(index));
+    return readValue<int64_t>(getColumnData(index));
+}
+
+std::string_view RowView::getString(size_t index) const
+{
+    const auto & column = getSchema()[index];
+    if (layout)
+        return readString(data, getMinipageHeader(index), column.length, row_index);
+
+    const auto * column_data = getColumnData(index);
+    if (column.type == Type::varchar)
+        return std::string_view(reinterpret_cast<const char *>(column_data), strnlen(reinterpret_cast<const char *>(column_data), column.length));
+
+    auto length = readValue<size_t>(column_data);
+    auto offset = readValue<size_t>(column_data + sizeof(size_t));
+    return std::string_view(reinterpret_cast<const char *>(data + offset), length);
+}
+
+Value RowView::getValue(size_t index) const
+{
+    if (isNull(index))
+        return Null{};
+
+    switch (getSchema()[index].type)
+    {
+        case Type::boolean:
+            return getBool(index);
+        case Type::uint64:
+            return getUInt64(index);
+        case Type::int64:
+            return getInt64(index);
+        case Type::varchar:
+        case Type::string:
+            return std::string(getString(index));
+    }
+    throw std::runtime_error("Unknown column type");
+}
+
+Row RowView::materialize() const
+{
+    if (empty())
+        return Row();
+
+    if (layout)
+    {
+        Row row;
+        row.reserve(size());
+        for (size_t index = 0; index < size(); ++index)
+            row.push_back(getValue(index));
+        return row;
+    }
+    return marshal->deserializeRow(data);
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string_view>
+
+#include "column_encoding.h"
+#include "marshal.h"
+#include "row.h"
+
+namespace shdb
+{
+
+/// Rows stored column by column, every page describes its column minipages in its header.
+/// Header of column c is at minipages_offset + c * sizeof(MinipageHeader), null masks are described after the last column.
+struct ColumnarLayout
+{
+    std::shared_ptr<Schema> schema;
+    size_t minipages_offset = 0;
+};
+
+/// Serialized row read in place from page bytes, columns are decoded on access.
+/// View does not pin anything, it is valid while page it was taken from stays pinned.
+class RowView
+{
+public:
+    RowView() = default;
+
+    RowView(const uint8_t * data, const Marshal * marshal);
+
+    /// Row of a columnar page, only columns that are accessed are read
+    RowView(const uint8_t * page_data, const ColumnarLayout * layout, RowIndex row_index);
+
+    bool empty() const { return data == nullptr; }
+
+    size_t size() const;
+
+    bool isNull(size_t index) const;
+
+    bool getBool(size_t index) const;
+
+    uint64_t getUInt64(size_t index) const;
+
+    int64_t getInt64(size_t index) const;
+
+    /// Works for both varchar and string columns, points into page bytes
+    std::string_view getString(size_t index) const;
+
+    /// Decodes single column, Null for null values
+    Value getValue(size_t index) const;
+
+    Row materialize() const;
+
+private:
+    const Schema & getSchema() const;
+
+    const uint8_t * getColumnData(size_t index) const;
+
+    MinipageHeader getMinipageHeader(size_t index) const;
+
+    uint64_t getColumnKey(size_t index) const;
+
+    const uint8_t * data = nullptr;
+    const Marshal * marshal = nullptr;
+    const ColumnarLayout * layout = nullptr;
+    RowIndex row_index = 0;
+    uint64_t nulls = 0;
+};
+
+}
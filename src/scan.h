@@ -10,13 +10,17 @@ class ScanIterator
 public:
     ScanIterator(std::shared_ptr<ITable> table, PageIndex page_index, RowIndex row_index): table(table), row_index(row_index), page_index(page_index)
     {
+        seekRow();
     }
 
     RowId getRowId() const { return RowId{page_index, row_index}; }
 
-    Row getRow() { return table->getRow(getRowId()); }
+    Row getRow() { return batch.getRow(position); }
 
-    Row operator*() { return table->getRow(getRowId()); }
+    Row operator*() { return batch.getRow(position); }
+
+    /// Valid until iterator moves to another page
+    const RowView & getRowView() const { return batch.getRowView(position); }
 
     bool operator==(const ScanIterator & other) const
     {
@@ -29,18 +33,38 @@ public:
     }
 
     ScanIterator & operator++() {
-        auto page = table->getPage(page_index);
-        if (row_index == page->getRowCount()) {
-            ++page_index;
-            row_index = 0;
-        } else {
-            ++row_index;
-        }
+        ++row_index;
+        seekRow();
         return *this;
     }
 
 private:
+    /// Moves to the first present row at or after current position, empty slots and pages are skipped.
+    /// Every page is read into a batch once, so buffer pool is accessed once per page rather than per row.
+    void seekRow() {
+        for (; page_index < table->getPageCount(); ++page_index, row_index = 0, position = 0) {
+            if (batch.getPageIndex() != page_index) {
+                /// Previous page is unpinned first, so scan works with a single frame pool
+                batch = PageBatch();
+                batch = table->readPage(page_index);
+                position = 0;
+            }
+            while (position < batch.size() && batch.getRowId(position).row_index < row_index) {
+                ++position;
+            }
+            if (position < batch.size()) {
+                row_index = batch.getRowId(position).row_index;
+                return;
+            }
+        }
+        batch = PageBatch();
+        position = 0;
+        row_index = 0;
+    }
+
     std::shared_ptr<ITable> table;
+    PageBatch batch;
+    size_t position = 0;
     RowIndex row_index;
     PageIndex page_index;
 };
@@ -1,5 +1,7 @@
 #include "schema.h"
 
+#include <stdexcept>
+
 namespace shdb
 {
 
@@ -73,4 +75,27 @@ std::ostream & operator<<(std::ostream & stream, const Schema & schema)
     return stream;
 }
 
+std::string toString(TableLayout layout)
+{
+    switch (layout)
+    {
+        case TableLayout::row:
+            return "row";
+        case TableLayout::pax:
+            return "pax";
+    }
+
+    return {};
+}
+
+TableLayout parseTableLayout(const std::string & name)
+{
+    if (name == "row")
+        return TableLayout::row;
+    if (name == "pax")
+        return TableLayout::pax;
+
+    throw std::runtime_error("Unknown table layout " + name);
+}
+
 }
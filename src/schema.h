@@ -61,4 +61,16 @@ static SchemePtr createSchema(std::vector<ColumnSchema> && column_schemas)
 std::string toString(const Schema & schema);
 
 std::ostream & operator<<(std::ostream & stream, const Schema & schema);
+
+/// Page format of a table, chosen at creation time
+enum class TableLayout
+{
+    row,
+    pax,
+};
+
+std::string toString(TableLayout layout);
+
+/// Throws for unknown layout names
+TableLayout parseTableLayout(const std::string & name);
 }
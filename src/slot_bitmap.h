@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+#include "bufferpool.h"
+#include "row.h"
+
+namespace shdb
+{
+
+/// Page header of live slot count followed by slot occupancy bitmap, both stored as 64 bit words.
+/// Free slots and occupied rows are found from bitmap words without touching row bytes.
+class SlotBitmap
+{
+public:
+    SlotBitmap(const FrameView & frame, RowIndex capacity) : frame(frame), capacity(capacity) { }
+
+    static size_t getHeaderSize(RowIndex capacity) { return sizeof(uint64_t) * (1 + getWordCount(capacity)); }
+
+    RowIndex getLiveCount() const { return static_cast<RowIndex>(getWords()[0]); }
+
+    bool isOccupied(RowIndex index) const { return (getWords()[1 + index / 64] >> (index % 64)) & 1; }
+
+    /// Index of first occupied slot at or after from, capacity if there is none
+    RowIndex findNextOccupied(RowIndex from) const
+    {
+        if (getLiveCount() == 0)
+            return capacity;
+
+        const auto * words = getWords();
+        for (RowIndex word_index = from / 64; word_index < getWordCount(capacity); ++word_index)
+        {
+            auto word = words[1 + word_index];
+            if (word_index == from / 64)
+                word &= ~uint64_t(0) << (from % 64);
+            if (word != 0)
+                return std::min<RowIndex>(word_index * 64 + std::countr_zero(word), capacity);
+        }
+        return capacity;
+    }
+
+    /// Lowest free slot, there must be one
+    RowIndex findFree() const
+    {
+        const auto * words = getWords();
+        for (RowIndex word_index = 0;; ++word_index)
+            if (auto word = ~words[1 + word_index]; word != 0)
+                return word_index * 64 + std::countr_zero(word);
+    }
+
+    void occupy(RowIndex index)
+    {
+        auto * words = getMutableWords();
+        words[0] += 1;
+        words[1 + index / 64] |= uint64_t(1) << (index % 64);
+    }
+
+    void release(RowIndex index)
+    {
+        auto * words = getMutableWords();
+        words[0] -= 1;
+        words[1 + index / 64] &= ~(uint64_t(1) << (index % 64));
+    }
+
+private:
+    static RowIndex getWordCount(RowIndex capacity) { return (capacity + 63) / 64; }
+
+    const uint64_t * getWords() const { return reinterpret_cast<const uint64_t *>(frame.getData()); }
+
+    uint64_t * getMutableWords() { return reinterpret_cast<uint64_t *>(frame.getMutableData()); }
+
+    const FrameView & frame;
+    RowIndex capacity;
+};
+
+}
@@ -10,7 +10,10 @@ std::string toString(const Statistics & statistics)
     std::stringstream stream;
     stream << "{page_read: " << statistics.page_read << ", "
            << "page_written: " << statistics.page_written << ", "
-           << "page_accessed: " << statistics.page_accessed << "}";
+           << "page_accessed: " << statistics.page_accessed << ", "
+           << "page_flushed: " << statistics.page_flushed << ", "
+           << "page_prefetched: " << statistics.page_prefetched << ", "
+           << "readahead_hit: " << statistics.readahead_hit << "}";
     return stream.str();
 }
 
@@ -11,6 +11,9 @@ struct Statistics
     uint64_t page_read = 0;
     uint64_t page_written = 0;
     uint64_t page_accessed = 0;
+    uint64_t page_flushed = 0;
+    uint64_t page_prefetched = 0;
+    uint64_t readahead_hit = 0;
 };
 
 std::string toString(const Statistics & statistics);
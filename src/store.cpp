@@ -13,19 +13,56 @@ void throwTableAlreadyExistsError(const std::string & table_name)
     throw std::runtime_error("Table with name " + table_name + " already exists");
 }
 
+/// Free space map of a table is stored next to it with this extension, so table names with it would clobber other maps
+const std::filesystem::path free_space_map_extension = ".fsm";
+
+bool isReservedTableName(const std::filesystem::path & table_name)
+{
+    return table_name.extension() == free_space_map_extension;
+}
+
+void checkTableName(const std::filesystem::path & table_name)
+{
+    if (isReservedTableName(table_name))
+        throw std::runtime_error("Table name " + table_name.string() + " is reserved, table names can not end with .fsm");
+}
+
+}
+
+Store::Store(
+    const std::filesystem::path & path, FrameIndex frame_count, std::shared_ptr<Statistics> statistics, BufferPoolOptions buffer_pool_options)
+    : path(path)
+{
+    buffer_pool = std::make_shared<BufferPool>(std::move(statistics), frame_count, buffer_pool_options);
+}
+
+Store::~Store()
+{
+    try
+    {
+        flush();
+    }
+    catch (...)
+    {
+    }
 }
 
-Store::Store(const std::filesystem::path & path, FrameIndex frame_count, std::shared_ptr<Statistics> statistics) : path(path)
+void Store::flush()
 {
-    buffer_pool = std::make_shared<BufferPool>(std::move(statistics), frame_count);
+    for (auto & [table_name, open_free_space_map] : open_free_space_maps)
+        if (auto free_space_map = open_free_space_map.lock())
+            free_space_map->flush();
 }
 
 void Store::createTable(const std::filesystem::path & table_name)
 {
+    checkTableName(table_name);
     if (checkTableExists(table_name))
         throwTableAlreadyExistsError(table_name);
 
-    auto file = std::make_unique<File>(path / table_name, true /*create*/);
+    open_free_space_maps.erase(table_name);
+    std::filesystem::remove(getFreeSpaceMapPath(table_name));
+    auto file = openFile(table_name, true /*create*/);
 }
 
 void Store::createIndexTable(const std::filesystem::path & table_name)
@@ -33,28 +70,31 @@ void Store::createIndexTable(const std::filesystem::path & table_name)
     if (checkTableExists(table_name))
         throwTableAlreadyExistsError(table_name);
 
-    auto file = std::make_unique<File>(path / table_name, true);
+    auto file = openFile(table_name, true /*create*/);
 }
 
-std::shared_ptr<ITable> Store::openTable(const std::filesystem::path & table_name, std::shared_ptr<IPageProvider> provider)
+std::shared_ptr<ITable> Store::openTable(const std::filesystem::path & table_name, std::shared_ptr<ITablePageProvider> provider)
 {
-    auto file = std::make_unique<File>(path / table_name, false /*create*/);
-    return shdb::createTable(buffer_pool, std::move(file), std::move(provider));
+    auto file = openFile(table_name, false /*create*/);
+    return shdb::createTable(buffer_pool, std::move(file), openFreeSpaceMap(table_name), std::move(provider));
 }
 
 std::shared_ptr<IIndexTable> Store::openIndexTable(const std::filesystem::path & table_name, std::shared_ptr<IPageProvider> provider)
 {
-    auto file = std::make_unique<File>(path / table_name, false /*create*/);
+    auto file = openFile(table_name, false /*create*/);
     return shdb::createIndexTable(buffer_pool, std::move(file), std::move(provider));
 }
 
-std::shared_ptr<ITable> Store::createAndOpenTable(const std::filesystem::path & table_name, std::shared_ptr<IPageProvider> provider)
+std::shared_ptr<ITable> Store::createAndOpenTable(const std::filesystem::path & table_name, std::shared_ptr<ITablePageProvider> provider)
 {
+    checkTableName(table_name);
     if (checkTableExists(table_name))
         throwTableAlreadyExistsError(table_name);
 
-    auto file = std::make_unique<File>(path / table_name, true /*create*/);
-    return shdb::createTable(buffer_pool, std::move(file), std::move(provider));
+    open_free_space_maps.erase(table_name);
+    std::filesystem::remove(getFreeSpaceMapPath(table_name));
+    auto file = openFile(table_name, true /*create*/);
+    return shdb::createTable(buffer_pool, std::move(file), openFreeSpaceMap(table_name), std::move(provider));
 }
 
 std::shared_ptr<IIndexTable>
@@ -63,11 +103,11 @@ Store::createAndOpenIndexTable(const std::filesystem::path & table_name, std::sh
     if (checkTableExists(table_name))
         throwTableAlreadyExistsError(table_name);
 
-    auto file = std::make_unique<File>(path / table_name, true /*create*/);
+    auto file = openFile(table_name, true /*create*/);
     return shdb::createIndexTable(buffer_pool, std::move(file), std::move(provider));
 }
 
-std::shared_ptr<ITable> Store::createOrOpenTable(const std::filesystem::path & table_name, std::shared_ptr<IPageProvider> provider)
+std::shared_ptr<ITable> Store::createOrOpenTable(const std::filesystem::path & table_name, std::shared_ptr<ITablePageProvider> provider)
 {
     if (checkTableExists(table_name))
         return openTable(table_name, provider);
@@ -86,14 +126,61 @@ Store::createOrOpenIndexTable(const std::filesystem::path & table_name, std::sha
 
 bool Store::checkTableExists(const std::filesystem::path & table_name)
 {
-    return std::filesystem::exists(path / table_name);
+    return !isReservedTableName(table_name) && std::filesystem::exists(path / table_name);
+}
+
+std::vector<std::string> Store::getTableNames() const
+{
+    std::vector<std::string> table_names;
+    for (const auto & entry : std::filesystem::directory_iterator(path))
+        if (entry.is_regular_file() && !isReservedTableName(entry.path().filename()))
+            table_names.push_back(entry.path().filename().string());
+    return table_names;
 }
 
 bool Store::removeTable(const std::filesystem::path & table_name)
 {
+    checkTableName(table_name);
+
+    /// Handles still open keep the removed file, table created with the same name gets a new one
+    open_files.erase(table_name);
+    open_free_space_maps.erase(table_name);
+    std::filesystem::remove(getFreeSpaceMapPath(table_name));
     return std::filesystem::remove(path / table_name);
 }
 
+std::shared_ptr<File> Store::openFile(const std::filesystem::path & table_name, bool create)
+{
+    checkTableName(table_name);
+    auto & open_file = open_files[table_name];
+    if (auto file = open_file.lock())
+        return file;
+
+    auto file = std::make_shared<File>(path / table_name, create);
+    open_file = file;
+    return file;
+}
+
+std::shared_ptr<FreeSpaceMap> Store::openFreeSpaceMap(const std::filesystem::path & table_name)
+{
+    auto & open_free_space_map = open_free_space_maps[table_name];
+    if (auto free_space_map = open_free_space_map.lock())
+        return free_space_map;
+
+    auto free_space_map_path = getFreeSpaceMapPath(table_name);
+    auto free_space_map = std::make_shared<FreeSpaceMap>(
+        std::make_shared<File>(free_space_map_path, !std::filesystem::exists(free_space_map_path) /*create*/));
+    open_free_space_map = free_space_map;
+    return free_space_map;
+}
+
+std::filesystem::path Store::getFreeSpaceMapPath(const std::filesystem::path & table_name) const
+{
+    auto free_space_map_path = path / table_name;
+    free_space_map_path += free_space_map_extension;
+    return free_space_map_path;
+}
+
 bool Store::removeTableIfExists(const std::filesystem::path & table_name)
 {
     if (checkTableExists(table_name))
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <filesystem>
+#include <unordered_map>
+#include <vector>
 
 #include "bufferpool.h"
 #include "index_table.h"
@@ -14,33 +16,60 @@ namespace shdb
 class Store
 {
 public:
-    Store(const std::filesystem::path & path, FrameIndex frame_count, std::shared_ptr<Statistics> statistics);
+    Store(
+        const std::filesystem::path & path,
+        FrameIndex frame_count,
+        std::shared_ptr<Statistics> statistics,
+        BufferPoolOptions buffer_pool_options = {});
+
+    /// Flushes free space maps of open tables, errors are ignored, call flush first to see them
+    ~Store();
+
+    Store(const Store &) = delete;
+    Store & operator=(const Store &) = delete;
 
     void createTable(const std::filesystem::path & table_name);
 
     void createIndexTable(const std::filesystem::path & table_name);
 
-    std::shared_ptr<ITable> openTable(const std::filesystem::path & table_name, std::shared_ptr<IPageProvider> provider);
+    std::shared_ptr<ITable> openTable(const std::filesystem::path & table_name, std::shared_ptr<ITablePageProvider> provider);
 
     std::shared_ptr<IIndexTable> openIndexTable(const std::filesystem::path & table_name, std::shared_ptr<IPageProvider> provider);
 
-    std::shared_ptr<ITable> createAndOpenTable(const std::filesystem::path & table_name, std::shared_ptr<IPageProvider> provider);
+    std::shared_ptr<ITable> createAndOpenTable(const std::filesystem::path & table_name, std::shared_ptr<ITablePageProvider> provider);
 
     std::shared_ptr<IIndexTable> createAndOpenIndexTable(const std::filesystem::path & table_name, std::shared_ptr<IPageProvider> provider);
 
-    std::shared_ptr<ITable> createOrOpenTable(const std::filesystem::path & table_name, std::shared_ptr<IPageProvider> provider);
+    std::shared_ptr<ITable> createOrOpenTable(const std::filesystem::path & table_name, std::shared_ptr<ITablePageProvider> provider);
 
     std::shared_ptr<IIndexTable> createOrOpenIndexTable(const std::filesystem::path & table_name, std::shared_ptr<IPageProvider> provider);
 
     bool checkTableExists(const std::filesystem::path & table_name);
 
+    /// Names of tables and index tables in store directory, in no particular order
+    std::vector<std::string> getTableNames() const;
+
     bool removeTable(const std::filesystem::path & table_name);
 
     bool removeTableIfExists(const std::filesystem::path & table_name);
 
+    /// Writes back free space maps of open tables. Table pages are written back by buffer pool.
+    void flush();
+
 private:
+    /// Table files are shared by all handles of a table, buffer pool identifies pages by file descriptor
+    /// and pages written through one handle must be visible to the others
+    std::shared_ptr<File> openFile(const std::filesystem::path & table_name, bool create);
+
+    /// Free space map is shared by all handles of a table in the same way, so every handle sees space freed by others
+    std::shared_ptr<FreeSpaceMap> openFreeSpaceMap(const std::filesystem::path & table_name);
+
+    std::filesystem::path getFreeSpaceMapPath(const std::filesystem::path & table_name) const;
+
     std::shared_ptr<BufferPool> buffer_pool;
     std::filesystem::path path;
+    std::unordered_map<std::string, std::weak_ptr<File>> open_files;
+    std::unordered_map<std::string, std::weak_ptr<FreeSpaceMap>> open_free_space_maps;
 };
 
 }
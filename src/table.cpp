@@ -1,30 +1,130 @@
 #include "table.h"
 
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
 namespace shdb
 {
 
+bool ColumnPredicate::accepts(std::strong_ordering order) const
+{
+    switch (comparison)
+    {
+        case Comparison::eq:
+            return order == 0;
+        case Comparison::ne:
+            return order != 0;
+        case Comparison::lt:
+            return order < 0;
+        case Comparison::le:
+            return order <= 0;
+        case Comparison::gt:
+            return order > 0;
+        case Comparison::ge:
+            return order >= 0;
+    }
+    return false;
+}
+
+bool ColumnPredicate::matches(const RowView & row_view) const
+{
+    if (row_view.isNull(column))
+        return comparison == Comparison::ne;
+
+    return std::visit(
+        Overloaded{
+            [&](const Null &) { return comparison == Comparison::ne; },
+            [&](bool constant) { return accepts(row_view.getBool(column) <=> constant); },
+            [&](uint64_t constant) { return accepts(row_view.getUInt64(column) <=> constant); },
+            [&](int64_t constant) { return accepts(row_view.getInt64(column) <=> constant); },
+            [&](const std::string & constant) { return accepts(row_view.getString(column) <=> std::string_view(constant)); }},
+        value);
+}
+
+void ITablePageProvider::filterRows(const FrameView & frame, const ColumnPredicate & predicate, std::vector<RowIndex> & rows) const
+{
+    auto row_count = getRowCount(frame);
+    for (auto row_index = findNextRow(frame, 0); row_index < row_count; row_index = findNextRow(frame, row_index + 1))
+        if (predicate.matches(getRowView(frame, row_index)))
+            rows.push_back(row_index);
+}
+
+PageBatch::PageBatch(PageIndex page_index, TablePageGuard page_) : page(std::move(page_)), page_index(page_index)
+{
+    auto row_count = page->getRowCount();
+    for (auto row_index = page->findNextRow(0); row_index < row_count; row_index = page->findNextRow(row_index + 1))
+    {
+        row_indices.push_back(row_index);
+        row_views.push_back(page->getRowView(row_index));
+    }
+}
+
+PageBatch::PageBatch(PageIndex page_index, TablePageGuard page_, const ColumnPredicate & predicate)
+    : page(std::move(page_)), page_index(page_index)
+{
+    page->filterRows(predicate, row_indices);
+    row_views.reserve(row_indices.size());
+    for (auto row_index : row_indices)
+        row_views.push_back(page->getRowView(row_index));
+}
+
 class ImplementedTable : public ITable
 {
+    /// Table file is opened with O_DIRECT, so appended pages are written from page aligned buffer
+    using AlignedPages = std::unique_ptr<uint8_t, decltype(&std::free)>;
+
 public:
-    ImplementedTable(std::shared_ptr<BufferPool> buffer_pool, std::shared_ptr<File> file, std::shared_ptr<IPageProvider> page_provider)
-        : buffer_pool(std::move(buffer_pool)), file(std::move(file)), page_provider(std::move(page_provider))
+    ImplementedTable(
+        std::shared_ptr<BufferPool> buffer_pool_,
+        std::shared_ptr<File> file_,
+        std::shared_ptr<FreeSpaceMap> free_space_map_,
+        std::shared_ptr<ITablePageProvider> page_provider_)
+        : buffer_pool(std::move(buffer_pool_))
+        , file(std::move(file_))
+        , page_provider(std::move(page_provider_))
+        , free_space_map(std::move(free_space_map_))
     {
     }
 
     RowId insertRow(const Row & row) override
     {
-        while (true)
+        TablePageGuard page;
+        auto row_id = insertIntoPageWithSpace(row, page);
+        free_space_map->update(row_id.page_index, page->getFreeSpace());
+        return row_id;
+    }
+
+    std::vector<RowId> insertRows(const Rows & rows) override
+    {
+        std::vector<RowId> row_ids;
+        row_ids.reserve(rows.size());
+
+        TablePageGuard page;
+        PageIndex page_index = InvalidPageIndex;
+        for (const auto & row : rows)
         {
-            if (current_page_index == getPageCount())
-                current_page_index = file->allocPage();
+            if (page_index != InvalidPageIndex)
+            {
+                auto [inserted, row_index] = page->insertRow(row);
+                if (inserted)
+                {
+                    row_ids.push_back(RowId{page_index, row_index});
+                    continue;
+                }
 
-            auto page = getPage(current_page_index);
-            auto [inserted, row_index] = page->insertRow(row);
-            if (inserted)
-                return RowId{current_page_index, row_index};
+                free_space_map->update(page_index, page->getFreeSpace());
+                page = TablePageGuard();
+            }
 
-            ++current_page_index;
+            row_ids.push_back(insertIntoPageWithSpace(row, page));
+            page_index = row_ids.back().page_index;
         }
+
+        if (page_index != InvalidPageIndex)
+            free_space_map->update(page_index, page->getFreeSpace());
+        return row_ids;
     }
 
     Row getRow(RowId row_id) override
@@ -36,29 +136,114 @@ public:
 
     void deleteRow(RowId row_id) override
     {
+        checkFreeSpaceMap();
         auto page = getPage(row_id.page_index);
         page->deleteRow(row_id.row_index);
+        free_space_map->update(row_id.page_index, page->getFreeSpace());
+    }
+
+    PageBatch readPage(PageIndex page_index) override { return PageBatch(page_index, getPage(page_index)); }
+
+    PageBatch readPage(PageIndex page_index, const ColumnPredicate & predicate) override
+    {
+        return PageBatch(page_index, getPage(page_index), predicate);
+    }
+
+    void readPages(PageIndex from, PageIndex to, const std::function<void(const PageBatch &)> & callback) override
+    {
+        to = std::min(to, getPageCount());
+        for (PageIndex page_index = from; page_index < to; ++page_index)
+            callback(readPage(page_index));
+    }
+
+    const ITablePageProvider & getPageProvider() const override { return *page_provider; }
+
+    void appendPages(const uint8_t * pages, size_t page_count) override
+    {
+        if (page_count == 0)
+            return;
+
+        checkFreeSpaceMap();
+        static constexpr size_t MaxWritePages = 256;
+        auto buffer = AlignedPages(
+            static_cast<uint8_t *>(std::aligned_alloc(PageSize, PageSize * std::min(page_count, MaxWritePages))), &std::free);
+
+        auto first_page_index = file->allocPages(page_count);
+        for (size_t written = 0; written < page_count;)
+        {
+            auto count = std::min(page_count - written, MaxWritePages);
+            memcpy(buffer.get(), pages + written * PageSize, count * PageSize);
+            file->writePages(buffer.get(), first_page_index + written, count);
+            for (size_t index = 0; index < count; ++index)
+            {
+                auto frame = FrameView(nullptr, 0, buffer.get() + index * PageSize);
+                free_space_map->update(first_page_index + written + index, page_provider->getFreeSpace(frame));
+            }
+            written += count;
+        }
     }
 
     PageIndex getPageCount() override { return file->getPageCount(); }
 
-    std::shared_ptr<ITablePage> getPage(PageIndex page_index) override
+    TablePageGuard getPage(PageIndex page_index) override
     {
-        auto frame = buffer_pool->getPage(file, page_index);
-        return std::static_pointer_cast<ITablePage>(page_provider->getPage(std::move(frame)));
+        return TablePageGuard(buffer_pool->getPage(file, page_index), page_provider.get());
     }
 
 private:
+    /// Pages the persisted map does not describe, because it is missing or was not flushed before exit, are read once.
+    /// Map must describe every page before it is updated, otherwise pages in between would be skipped.
+    void checkFreeSpaceMap()
+    {
+        for (PageIndex page_index = free_space_map->getPageCount(); page_index < getPageCount(); ++page_index)
+            free_space_map->update(page_index, getPage(page_index)->getFreeSpace());
+    }
+
+    /// Inserts row into page free space map points to, page is left pinned and its map entry is not updated
+    RowId insertIntoPageWithSpace(const Row & row, TablePageGuard & page)
+    {
+        auto space = page_provider->getRowSpace(row);
+        while (true)
+        {
+            auto page_index = findPageWithSpace(space);
+            bool allocated = page_index == InvalidPageIndex;
+            if (allocated)
+                page_index = file->allocPage();
+
+            page = getPage(page_index);
+            auto [inserted, row_index] = page->insertRow(row);
+            if (inserted)
+                return RowId{page_index, row_index};
+
+            if (allocated)
+                throw std::runtime_error("Row does not fit into an empty page");
+
+            /// Map overestimated free space, move page below the bucket such rows are looked up from
+            auto lookup_bucket = std::max<size_t>(FreeSpaceMap::toBucket(space), 1);
+            free_space_map->update(page_index, std::min(page->getFreeSpace(), lookup_bucket * FreeSpaceMap::BucketSize - 1));
+            page = TablePageGuard();
+        }
+    }
+
+    PageIndex findPageWithSpace(size_t space)
+    {
+        checkFreeSpaceMap();
+        return free_space_map->findPage(space);
+    }
+
     std::shared_ptr<BufferPool> buffer_pool;
     std::shared_ptr<File> file;
-    std::shared_ptr<IPageProvider> page_provider;
-    PageIndex current_page_index = 0;
+    std::shared_ptr<ITablePageProvider> page_provider;
+    std::shared_ptr<FreeSpaceMap> free_space_map;
 };
 
-std::shared_ptr<ITable>
-createTable(std::shared_ptr<BufferPool> buffer_pool, std::shared_ptr<File> file, std::shared_ptr<IPageProvider> page_provider)
+std::shared_ptr<ITable> createTable(
+    std::shared_ptr<BufferPool> buffer_pool,
+    std::shared_ptr<File> file,
+    std::shared_ptr<FreeSpaceMap> free_space_map,
+    std::shared_ptr<ITablePageProvider> page_provider)
 {
-    return std::make_shared<ImplementedTable>(std::move(buffer_pool), std::move(file), std::move(page_provider));
+    return std::make_shared<ImplementedTable>(std::move(buffer_pool), std::move(file), std::move(free_space_map), std::move(page_provider));
 }
 
 }
@@ -1,25 +1,130 @@
 #pragma once
 
+#include <compare>
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "bufferpool.h"
+#include "free_space_map.h"
 #include "page_provider.h"
 #include "row.h"
+#include "row_view.h"
 
 namespace shdb
 {
 
-class ITablePage : public IPage
+/// Comparison of a column with a constant, pushed down to table scans.
+/// Null values satisfy inequality only, like comparison of values does.
+struct ColumnPredicate
+{
+    enum class Comparison
+    {
+        eq,
+        ne,
+        lt,
+        le,
+        gt,
+        ge,
+    };
+
+    size_t column = 0;
+    Comparison comparison = Comparison::eq;
+    Value value;
+
+    bool accepts(std::strong_ordering order) const;
+
+    bool matches(const RowView & row_view) const;
+};
+
+/// Page format of a table, interprets bytes of pinned frames
+class ITablePageProvider : public IPageProvider
 {
 public:
-    virtual RowIndex getRowCount() = 0;
+    virtual RowIndex getRowCount(const FrameView & frame) const = 0;
 
-    virtual Row getRow(RowIndex index) = 0;
+    virtual Row getRow(const FrameView & frame, RowIndex index) const = 0;
 
-    virtual void deleteRow(RowIndex index) = 0;
+    /// Row read in place, empty for missing rows
+    virtual RowView getRowView(const FrameView & frame, RowIndex index) const = 0;
 
-    virtual std::pair<bool, RowIndex> insertRow(const Row & row) = 0;
+    /// Modifying methods mark underlying frame dirty
+    virtual void deleteRow(const FrameView & frame, RowIndex index) const = 0;
+
+    virtual std::pair<bool, RowIndex> insertRow(const FrameView & frame, const Row & row) const = 0;
+
+    /// Index of first present row at or after from, getRowCount if there is none
+    virtual RowIndex findNextRow(const FrameView & frame, RowIndex from) const = 0;
+
+    /// Bytes still available for new rows on page
+    virtual size_t getFreeSpace(const FrameView & frame) const = 0;
+
+    /// Bytes of free space inserting row consumes
+    virtual size_t getRowSpace(const Row & row) const = 0;
+
+    /// Appends present rows matching predicate, formats may override it to compare encoded values
+    virtual void filterRows(const FrameView & frame, const ColumnPredicate & predicate, std::vector<RowIndex> & rows) const;
+};
+
+class TablePage
+{
+public:
+    TablePage() = default;
+
+    TablePage(FrameView frame, const ITablePageProvider * provider) : frame(frame), provider(provider) { }
+
+    RowIndex getRowCount() const { return provider->getRowCount(frame); }
+
+    Row getRow(RowIndex index) const { return provider->getRow(frame, index); }
+
+    RowView getRowView(RowIndex index) const { return provider->getRowView(frame, index); }
+
+    void deleteRow(RowIndex index) { provider->deleteRow(frame, index); }
+
+    std::pair<bool, RowIndex> insertRow(const Row & row) { return provider->insertRow(frame, row); }
+
+    RowIndex findNextRow(RowIndex from) const { return provider->findNextRow(frame, from); }
+
+    size_t getFreeSpace() const { return provider->getFreeSpace(frame); }
+
+    void filterRows(const ColumnPredicate & predicate, std::vector<RowIndex> & rows) const { provider->filterRows(frame, predicate, rows); }
+
+private:
+    FrameView frame;
+    const ITablePageProvider * provider = nullptr;
+};
+
+using TablePageGuard = PageGuard<TablePage>;
+
+/// Present rows of a single page, collected with one buffer pool access.
+/// Page stays pinned while batch is alive, so its row views remain valid.
+class PageBatch
+{
+public:
+    PageBatch() = default;
+
+    PageBatch(PageIndex page_index, TablePageGuard page);
+
+    /// Only rows matching predicate are collected
+    PageBatch(PageIndex page_index, TablePageGuard page, const ColumnPredicate & predicate);
+
+    PageIndex getPageIndex() const { return page_index; }
+
+    size_t size() const { return row_indices.size(); }
+
+    bool empty() const { return row_indices.empty(); }
+
+    RowId getRowId(size_t index) const { return RowId{page_index, row_indices[index]}; }
+
+    const RowView & getRowView(size_t index) const { return row_views[index]; }
+
+    Row getRow(size_t index) const { return row_views[index].materialize(); }
+
+private:
+    TablePageGuard page;
+    PageIndex page_index = InvalidPageIndex;
+    std::vector<RowIndex> row_indices;
+    std::vector<RowView> row_views;
 };
 
 class ITable
@@ -29,16 +134,36 @@ public:
 
     virtual PageIndex getPageCount() = 0;
 
-    virtual std::shared_ptr<ITablePage> getPage(PageIndex page_index) = 0;
+    virtual TablePageGuard getPage(PageIndex page_index) = 0;
 
     virtual RowId insertRow(const Row & row) = 0;
 
+    /// Keeps page pinned while consecutive rows fit into it, free space map is looked up and updated once per page
+    virtual std::vector<RowId> insertRows(const Rows & rows) = 0;
+
     virtual Row getRow(RowId row_id) = 0;
 
     virtual void deleteRow(RowId row_id) = 0;
+
+    /// Pins page once and collects all of its present rows
+    virtual PageBatch readPage(PageIndex page_index) = 0;
+
+    virtual PageBatch readPage(PageIndex page_index, const ColumnPredicate & predicate) = 0;
+
+    /// Calls callback with batch of every page in [from, to), one page is pinned at a time
+    virtual void readPages(PageIndex from, PageIndex to, const std::function<void(const PageBatch &)> & callback) = 0;
+
+    /// Format pages appended with appendPages must be built with
+    virtual const ITablePageProvider & getPageProvider() const = 0;
+
+    /// Writes pages built in memory to the end of table file with large sequential writes, bypassing buffer pool
+    virtual void appendPages(const uint8_t * pages, size_t page_count) = 0;
 };
 
-std::shared_ptr<ITable>
-createTable(std::shared_ptr<BufferPool> buffer_pool, std::shared_ptr<File> file, std::shared_ptr<IPageProvider> provider);
+std::shared_ptr<ITable> createTable(
+    std::shared_ptr<BufferPool> buffer_pool,
+    std::shared_ptr<File> file,
+    std::shared_ptr<FreeSpaceMap> free_space_map,
+    std::shared_ptr<ITablePageProvider> provider);
 
 }
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "db.h"
+#include "fixed.h"
+#include "store.h"
+
+namespace
+{
+
+auto fixed_schema = std::make_shared<shdb::Schema>(shdb::Schema{
+    {"id", shdb::Type::uint64}, {"name", shdb::Type::varchar, 1024}, {"age", shdb::Type::uint64}, {"graduated", shdb::Type::boolean}});
+
+auto flexible_schema = std::make_shared<shdb::Schema>(
+    shdb::Schema{{"id", shdb::Type::uint64}, {"name", shdb::Type::string}, {"age", shdb::Type::uint64}, {"graduated", shdb::Type::boolean}});
+
+shdb::Row makeRow(uint64_t row_count)
+{
+    std::stringstream stream;
+    stream << "clone" << row_count;
+    return shdb::Row{row_count, stream.str(), 20UL + row_count % 10, row_count % 10 > 5};
+}
+
+void testReuseAfterDelete(std::shared_ptr<shdb::Schema> schema, bool lose_map = false)
+{
+    shdb::PageIndex page_count = 8;
+    std::vector<shdb::RowId> middle_page_rows;
+
+    {
+        auto db = shdb::connect("./mydb", 4);
+        if (db->checkTableExists("test_table"))
+            db->dropTable("test_table");
+        db->createTable("test_table", schema);
+        auto table = db->getTable("test_table", schema);
+
+        uint64_t row_count = 0;
+        while (table->getPageCount() < page_count)
+        {
+            auto row_id = table->insertRow(makeRow(row_count++));
+            if (row_id.page_index == page_count / 2)
+                middle_page_rows.push_back(row_id);
+        }
+
+        for (auto row_id : middle_page_rows)
+            table->deleteRow(row_id);
+    }
+
+    /// Map is only a hint, missing or truncated map is rebuilt from table pages
+    if (lose_map)
+        std::filesystem::resize_file("./mydb/test_table.fsm", 0);
+
+    /// Map is persisted, so freed page is found after reopen without scanning the table
+    auto db = shdb::connect("./mydb", 4);
+    auto table = db->getTable("test_table", schema);
+    auto page_read = db->getStatistics()->page_read;
+    size_t inserted = 0;
+    size_t reused = 0;
+    while (table->getPageCount() == page_count)
+    {
+        reused += table->insertRow(makeRow(inserted)).page_index == page_count / 2;
+        ++inserted;
+    }
+
+    /// Without reuse only the rest of the last page would be filled before the table grows
+    ASSERT_GE(reused, middle_page_rows.size());
+    ASSERT_GT(inserted, middle_page_rows.size());
+    ASSERT_LE(db->getStatistics()->page_read - page_read, 2 * inserted + (lose_map ? page_count : 0));
+}
+
+}
+
+TEST(BufferPool, FreeSpaceMapFixed)
+{
+    testReuseAfterDelete(fixed_schema);
+}
+
+TEST(BufferPool, FreeSpaceMapFlexible)
+{
+    testReuseAfterDelete(flexible_schema);
+}
+
+TEST(BufferPool, FreeSpaceMapRebuild)
+{
+    testReuseAfterDelete(fixed_schema, true /*lose_map*/);
+}
+
+TEST(BufferPool, FreeSpaceMapSharedByHandles)
+{
+    std::filesystem::create_directories("./mydb");
+    shdb::Store store("./mydb", 4, std::make_shared<shdb::Statistics>());
+    store.removeTableIfExists("store_table");
+    auto provider = shdb::createFixedPageProvider(fixed_schema);
+    auto writer = store.createAndOpenTable("store_table", provider);
+
+    std::vector<shdb::RowId> first_page_rows;
+    uint64_t row_count = 0;
+    while (writer->getPageCount() < 4)
+    {
+        auto row_id = writer->insertRow(makeRow(row_count++));
+        if (row_id.page_index == 0)
+            first_page_rows.push_back(row_id);
+    }
+
+    /// Space freed through one handle is found by inserts through another
+    auto deleter = store.openTable("store_table", provider);
+    for (auto row_id : first_page_rows)
+        deleter->deleteRow(row_id);
+
+    size_t reused = 0;
+    while (writer->getPageCount() == 4)
+        reused += writer->insertRow(makeRow(row_count++)).page_index == 0;
+    ASSERT_GE(reused, first_page_rows.size());
+}
+
+TEST(BufferPool, FreeSpaceMapNameReserved)
+{
+    std::filesystem::create_directories("./mydb");
+    shdb::Store store("./mydb", 4, std::make_shared<shdb::Statistics>());
+    store.removeTableIfExists("store_table");
+    auto provider = shdb::createFixedPageProvider(fixed_schema);
+    auto table = store.createAndOpenTable("store_table", provider);
+    table->insertRow(makeRow(0));
+    store.flush();
+
+    /// Map of store_table is not a table and can not be replaced by one
+    ASSERT_FALSE(store.checkTableExists("store_table.fsm"));
+    ASSERT_THROW(store.createAndOpenTable("store_table.fsm", provider), std::runtime_error);
+    ASSERT_THROW(store.removeTable("store_table.fsm"), std::runtime_error);
+    ASSERT_TRUE(std::filesystem::file_size("./mydb/store_table.fsm") > 0);
+
+    auto table_names = store.getTableNames();
+    ASSERT_NE(std::find(table_names.begin(), table_names.end(), "store_table"), table_names.end());
+    ASSERT_EQ(std::find(table_names.begin(), table_names.end(), "store_table.fsm"), table_names.end());
+}
@@ -0,0 +1,97 @@
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "db.h"
+#include "fixed.h"
+
+namespace
+{
+
+auto small_schema = std::make_shared<shdb::Schema>(shdb::Schema{{"id", shdb::Type::uint64}, {"graduated", shdb::Type::boolean}});
+
+auto fixed_schema = std::make_shared<shdb::Schema>(shdb::Schema{
+    {"id", shdb::Type::uint64}, {"name", shdb::Type::varchar, 1024}, {"age", shdb::Type::uint64}, {"graduated", shdb::Type::boolean}});
+
+shdb::Row makeRow(uint64_t row_count)
+{
+    std::stringstream stream;
+    stream << "clone" << row_count;
+    return shdb::Row{row_count, stream.str(), 20UL + row_count % 10, row_count % 10 > 5};
+}
+
+}
+
+TEST(BufferPool, FixedPageSlots)
+{
+    auto provider = shdb::createFixedPageProvider(small_schema);
+    auto frame_memory = std::make_unique<uint8_t[]>(shdb::PageSize);
+    auto frame = shdb::FrameView(nullptr, 0, frame_memory.get());
+
+    shdb::RowIndex capacity = provider->getRowCount(frame);
+    ASSERT_GT(capacity, 128);
+    ASSERT_EQ(provider->findNextRow(frame, 0), capacity);
+
+    for (shdb::RowIndex index = 0; index < capacity; ++index)
+    {
+        auto [inserted, row_index] = provider->insertRow(frame, shdb::Row{uint64_t(index), index % 2 == 0});
+        ASSERT_TRUE(inserted);
+        ASSERT_EQ(row_index, index);
+    }
+    ASSERT_FALSE(provider->insertRow(frame, shdb::Row{uint64_t(0), false}).first);
+    ASSERT_EQ(provider->getFreeSpace(frame), 0);
+
+    /// Deleted slots spanning several bitmap words are reused lowest first
+    for (shdb::RowIndex index : {3, 70, capacity - 1})
+        provider->deleteRow(frame, index);
+    ASSERT_TRUE(provider->getRow(frame, 70).empty());
+    ASSERT_EQ(provider->findNextRow(frame, 3), 4);
+    ASSERT_EQ(provider->findNextRow(frame, 70), 71);
+    ASSERT_EQ(provider->findNextRow(frame, capacity - 1), capacity);
+    ASSERT_EQ(provider->getFreeSpace(frame), 3 * provider->getRowSpace(shdb::Row{uint64_t(0), false}));
+
+    for (shdb::RowIndex index : {3, 70, capacity - 1})
+    {
+        auto [inserted, row_index] = provider->insertRow(frame, shdb::Row{uint64_t(1000), true});
+        ASSERT_TRUE(inserted);
+        ASSERT_EQ(row_index, index);
+        ASSERT_EQ(provider->getRow(frame, row_index), (shdb::Row{uint64_t(1000), true}));
+    }
+}
+
+TEST(BufferPool, ScanSkipsEmptySlots)
+{
+    auto db = shdb::connect("./mydb", 8);
+    if (db->checkTableExists("test_table"))
+        db->dropTable("test_table");
+    db->createTable("test_table", fixed_schema);
+    auto table = db->getTable("test_table", fixed_schema);
+
+    std::vector<std::pair<shdb::RowId, shdb::Row>> rows;
+    for (uint64_t row_count = 0; table->getPageCount() < 6; ++row_count)
+        rows.emplace_back(table->insertRow(makeRow(row_count)), makeRow(row_count));
+
+    /// Empty whole pages and every other row elsewhere
+    std::vector<std::pair<shdb::RowId, shdb::Row>> expected;
+    for (size_t index = 0; index < rows.size(); ++index)
+    {
+        auto & [row_id, row] = rows[index];
+        if (row_id.page_index == 1 || row_id.page_index == 3 || index % 2 == 0)
+            table->deleteRow(row_id);
+        else
+            expected.push_back(rows[index]);
+    }
+
+    size_t index = 0;
+    auto scan = shdb::Scan(table);
+    for (auto it = scan.begin(), end = scan.end(); it != end; ++it)
+    {
+        auto row = it.getRow();
+        ASSERT_FALSE(row.empty());
+        ASSERT_LT(index, expected.size());
+        ASSERT_EQ(it.getRowId(), expected[index].first);
+        ASSERT_EQ(row, expected[index].second);
+        ++index;
+    }
+    ASSERT_EQ(index, expected.size());
+}
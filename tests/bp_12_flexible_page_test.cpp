@@ -0,0 +1,89 @@
+#include <map>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "db.h"
+#include "flexible.h"
+
+namespace
+{
+
+auto flexible_schema = std::make_shared<shdb::Schema>(shdb::Schema{{"name", shdb::Type::string}});
+
+shdb::Row makeRow(uint64_t id, size_t length)
+{
+    if (length == 0)
+        return shdb::Row{shdb::Null{}};
+    return shdb::Row{std::string(length, static_cast<char>('a' + id % 26))};
+}
+
+void validatePage(
+    const std::shared_ptr<shdb::ITablePageProvider> & provider, const shdb::FrameView & frame, const std::map<shdb::RowIndex, shdb::Row> & rows)
+{
+    for (shdb::RowIndex index = 0; index < provider->getRowCount(frame); ++index)
+    {
+        auto it = rows.find(index);
+        if (it == rows.end())
+            ASSERT_TRUE(provider->getRow(frame, index).empty());
+        else
+            ASSERT_EQ(provider->getRow(frame, index), it->second);
+    }
+}
+
+}
+
+TEST(BufferPool, FlexiblePageSlots)
+{
+    auto provider = shdb::createFlexiblePageProvider(flexible_schema);
+    auto frame_memory = std::make_unique<uint8_t[]>(shdb::PageSize);
+    auto frame = shdb::FrameView(nullptr, 0, frame_memory.get());
+
+    /// Mostly null rows, more than a byte worth of row indices fits into page
+    std::map<shdb::RowIndex, shdb::Row> rows;
+    for (uint64_t id = 0;; ++id)
+    {
+        auto row = makeRow(id, id % 8 == 0 ? 1 + id % 5 : 0);
+        auto [inserted, row_index] = provider->insertRow(frame, row);
+        if (!inserted)
+            break;
+        ASSERT_EQ(row_index, static_cast<shdb::RowIndex>(id));
+        rows.emplace(row_index, row);
+    }
+    ASSERT_GT(rows.size(), 256);
+    ASSERT_LT(provider->getFreeSpace(frame), provider->getRowSpace(makeRow(0, 5)));
+    validatePage(provider, frame, rows);
+
+    /// Every other row is deleted, free space is fragmented into small holes
+    for (auto it = rows.begin(); it != rows.end();)
+    {
+        if (it->first % 2 == 0)
+        {
+            provider->deleteRow(frame, it->first);
+            it = rows.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    ASSERT_EQ(provider->findNextRow(frame, 0), 1);
+    ASSERT_EQ(provider->findNextRow(frame, 2), 3);
+    validatePage(provider, frame, rows);
+
+    /// Row larger than any hole takes the first free slot after page is compacted
+    auto large_row = makeRow(1000, 300);
+    auto [inserted, row_index] = provider->insertRow(frame, large_row);
+    ASSERT_TRUE(inserted);
+    ASSERT_EQ(row_index, 0);
+    rows.emplace(row_index, large_row);
+    validatePage(provider, frame, rows);
+
+    /// Deleting every row leaves a page that takes a row of nearly page size
+    for (auto & [index, row] : rows)
+        provider->deleteRow(frame, index);
+    ASSERT_EQ(provider->getRowCount(frame), 0);
+    auto huge_row = makeRow(2000, shdb::PageSize - 64);
+    ASSERT_TRUE(provider->insertRow(frame, huge_row).first);
+    ASSERT_EQ(provider->getRow(frame, 0), huge_row);
+}
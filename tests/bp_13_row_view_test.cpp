@@ -0,0 +1,95 @@
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "db.h"
+#include "fixed.h"
+#include "flexible.h"
+
+namespace
+{
+
+auto fixed_schema = std::make_shared<shdb::Schema>(shdb::Schema{
+    {"id", shdb::Type::uint64}, {"name", shdb::Type::varchar, 32}, {"delta", shdb::Type::int64}, {"graduated", shdb::Type::boolean}});
+
+auto flexible_schema = std::make_shared<shdb::Schema>(shdb::Schema{
+    {"id", shdb::Type::uint64},
+    {"name", shdb::Type::varchar, 32},
+    {"delta", shdb::Type::int64},
+    {"graduated", shdb::Type::boolean},
+    {"description", shdb::Type::string}});
+
+shdb::Row makeRow(const std::shared_ptr<shdb::Schema> & schema, uint64_t row_count)
+{
+    std::stringstream stream;
+    stream << "clone" << row_count;
+    auto row = shdb::Row{row_count, stream.str(), -static_cast<int64_t>(row_count), row_count % 10 > 5};
+    if (schema->size() > row.size())
+        row.push_back(row_count % 3 == 0 ? shdb::Value(shdb::Null{}) : shdb::Value(std::string(row_count % 50, 'x')));
+    return row;
+}
+
+void checkRowView(const shdb::RowView & row_view, const shdb::Row & row)
+{
+    ASSERT_FALSE(row_view.empty());
+    ASSERT_EQ(row_view.size(), row.size());
+    for (size_t index = 0; index < row.size(); ++index)
+    {
+        std::visit(
+            shdb::Overloaded{
+                [&](const shdb::Null &) { ASSERT_TRUE(row_view.isNull(index)); },
+                [&](bool value) { ASSERT_EQ(row_view.getBool(index), value); },
+                [&](uint64_t value) { ASSERT_EQ(row_view.getUInt64(index), value); },
+                [&](int64_t value) { ASSERT_EQ(row_view.getInt64(index), value); },
+                [&](const std::string & value) { ASSERT_EQ(row_view.getString(index), value); }},
+            row[index]);
+        ASSERT_EQ(row_view.getValue(index), row[index]);
+    }
+    ASSERT_EQ(row_view.materialize(), row);
+}
+
+}
+
+TEST(BufferPool, RowViewPages)
+{
+    for (const auto & [schema, provider] : {
+             std::make_pair(fixed_schema, shdb::createFixedPageProvider(fixed_schema)),
+             std::make_pair(flexible_schema, shdb::createFlexiblePageProvider(flexible_schema))})
+    {
+        auto frame_memory = std::make_unique<uint8_t[]>(shdb::PageSize);
+        auto frame = shdb::FrameView(nullptr, 0, frame_memory.get());
+
+        std::vector<shdb::Row> rows;
+        for (uint64_t row_count = 0; provider->insertRow(frame, makeRow(schema, row_count)).first; ++row_count)
+            rows.push_back(makeRow(schema, row_count));
+
+        provider->deleteRow(frame, 1);
+        ASSERT_TRUE(provider->getRowView(frame, 1).empty());
+        for (shdb::RowIndex index = 0; index < static_cast<shdb::RowIndex>(rows.size()); ++index)
+            if (index != 1)
+                checkRowView(provider->getRowView(frame, index), rows[index]);
+    }
+}
+
+TEST(BufferPool, RowViewScan)
+{
+    auto db = shdb::connect("./mydb", 4);
+    if (db->checkTableExists("test_table"))
+        db->dropTable("test_table");
+    db->createTable("test_table", flexible_schema);
+    auto table = db->getTable("test_table", flexible_schema);
+
+    uint64_t row_count = 0;
+    while (table->getPageCount() < 8)
+        table->insertRow(makeRow(flexible_schema, row_count++));
+
+    /// Free space map may place rows out of insertion order, so rows are matched by id
+    uint64_t scanned = 0;
+    auto scan = shdb::Scan(table);
+    for (auto it = scan.begin(), end = scan.end(); it != end; ++it, ++scanned)
+    {
+        auto row_view = it.getRowView();
+        checkRowView(row_view, makeRow(flexible_schema, row_view.getUInt64(0)));
+    }
+    ASSERT_EQ(scanned, row_count);
+}
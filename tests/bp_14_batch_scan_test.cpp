@@ -0,0 +1,91 @@
+#include <set>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "db.h"
+
+namespace
+{
+
+auto fixed_schema = std::make_shared<shdb::Schema>(shdb::Schema{
+    {"id", shdb::Type::uint64}, {"name", shdb::Type::varchar, 128}, {"age", shdb::Type::uint64}, {"graduated", shdb::Type::boolean}});
+
+shdb::Row makeRow(uint64_t row_count)
+{
+    std::stringstream stream;
+    stream << "clone" << row_count;
+    return shdb::Row{row_count, stream.str(), 20UL + row_count % 10, row_count % 10 > 5};
+}
+
+}
+
+TEST(BufferPool, BatchScanPageAccesses)
+{
+    auto db = shdb::connect("./mydb", 8);
+    if (db->checkTableExists("test_table"))
+        db->dropTable("test_table");
+    db->createTable("test_table", fixed_schema);
+    auto table = db->getTable("test_table", fixed_schema);
+
+    uint64_t row_count = 0;
+    while (table->getPageCount() < 10)
+        table->insertRow(makeRow(row_count++));
+    auto page_count = table->getPageCount();
+
+    /// Scan pins every page once instead of once per row
+    auto page_accessed = db->getStatistics()->page_accessed;
+    uint64_t scanned = 0;
+    auto scan = shdb::Scan(table);
+    for (auto it = scan.begin(), end = scan.end(); it != end; ++it, ++scanned)
+    {
+        auto row = it.getRow();
+        ASSERT_EQ(row, makeRow(std::get<uint64_t>(row[0])));
+    }
+    ASSERT_EQ(scanned, row_count);
+    ASSERT_LE(db->getStatistics()->page_accessed - page_accessed, page_count + 1);
+}
+
+TEST(BufferPool, BatchScanPageRange)
+{
+    auto db = shdb::connect("./mydb", 4);
+    if (db->checkTableExists("test_table"))
+        db->dropTable("test_table");
+    db->createTable("test_table", fixed_schema);
+    auto table = db->getTable("test_table", fixed_schema);
+
+    std::vector<shdb::RowId> row_ids;
+    for (uint64_t row_count = 0; table->getPageCount() < 6; ++row_count)
+        row_ids.push_back(table->insertRow(makeRow(row_count)));
+
+    std::set<uint64_t> expected;
+    for (size_t index = 0; index < row_ids.size(); ++index)
+    {
+        if (index % 3 == 0)
+            table->deleteRow(row_ids[index]);
+        else if (row_ids[index].page_index >= 2 && row_ids[index].page_index < 5)
+            expected.insert(index);
+    }
+
+    {
+        auto batch = table->readPage(2);
+        ASSERT_EQ(batch.getPageIndex(), 2);
+        ASSERT_FALSE(batch.empty());
+    }
+
+    std::set<uint64_t> read;
+    shdb::PageIndex expected_page_index = 2;
+    table->readPages(2, 5, [&](const shdb::PageBatch & page_batch)
+    {
+        ASSERT_EQ(page_batch.getPageIndex(), expected_page_index++);
+        for (size_t index = 0; index < page_batch.size(); ++index)
+        {
+            auto id = page_batch.getRowView(index).getUInt64(0);
+            ASSERT_EQ(page_batch.getRowId(index), row_ids[id]);
+            ASSERT_EQ(page_batch.getRow(index), makeRow(id));
+            read.insert(id);
+        }
+    });
+    ASSERT_EQ(expected_page_index, 5);
+    ASSERT_EQ(read, expected);
+}
@@ -0,0 +1,129 @@
+#include <map>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "db.h"
+#include "interpreter.h"
+#include "pax.h"
+
+namespace
+{
+
+auto pax_schema = std::make_shared<shdb::Schema>(shdb::Schema{
+    {"id", shdb::Type::uint64}, {"name", shdb::Type::varchar, 32}, {"delta", shdb::Type::int64}, {"graduated", shdb::Type::boolean}});
+
+shdb::Row makeRow(uint64_t row_count)
+{
+    std::stringstream stream;
+    stream << "clone" << row_count;
+    auto delta = row_count % 4 == 0 ? shdb::Value(shdb::Null{}) : shdb::Value(-static_cast<int64_t>(row_count));
+    return shdb::Row{row_count, stream.str(), delta, row_count % 10 > 5};
+}
+
+}
+
+TEST(BufferPool, PaxPageColumns)
+{
+    auto provider = shdb::createPaxPageProvider(pax_schema);
+    auto frame_memory = std::make_unique<uint8_t[]>(shdb::PageSize);
+    auto frame = shdb::FrameView(nullptr, 0, frame_memory.get());
+
+    std::map<shdb::RowIndex, shdb::Row> rows;
+    for (uint64_t row_count = 0;; ++row_count)
+    {
+        auto [inserted, row_index] = provider->insertRow(frame, makeRow(row_count));
+        if (!inserted)
+            break;
+        ASSERT_EQ(row_index, static_cast<shdb::RowIndex>(row_count));
+        rows.emplace(row_index, makeRow(row_count));
+    }
+    ASSERT_GT(rows.size(), 64);
+
+    provider->deleteRow(frame, 5);
+    rows.erase(5);
+    ASSERT_TRUE(provider->getRowView(frame, 5).empty());
+    ASSERT_EQ(provider->findNextRow(frame, 5), 6);
+
+    for (const auto & [row_index, row] : rows)
+    {
+        auto row_view = provider->getRowView(frame, row_index);
+        ASSERT_EQ(row_view.getUInt64(0), std::get<uint64_t>(row[0]));
+        ASSERT_EQ(row_view.getString(1), std::get<std::string>(row[1]));
+        ASSERT_EQ(row_view.isNull(2), std::holds_alternative<shdb::Null>(row[2]));
+        ASSERT_EQ(row_view.materialize(), row);
+        ASSERT_EQ(provider->getRow(frame, row_index), row);
+    }
+
+    auto [inserted, row_index] = provider->insertRow(frame, makeRow(7));
+    ASSERT_TRUE(inserted);
+    ASSERT_EQ(row_index, 5);
+    ASSERT_EQ(provider->getRow(frame, 5), makeRow(7));
+}
+
+TEST(BufferPool, PaxTable)
+{
+    auto db = shdb::connect("./mydb", 4);
+    if (db->checkTableExists("test_table"))
+        db->dropTable("test_table");
+
+    auto string_schema = std::make_shared<shdb::Schema>(shdb::Schema{{"name", shdb::Type::string}});
+    ASSERT_THROW(db->createTable("test_table", string_schema, shdb::TableLayout::pax), std::runtime_error);
+    ASSERT_FALSE(db->checkTableExists("test_table"));
+
+    /// Null mask has a bit per column
+    auto wide_schema = std::make_shared<shdb::Schema>();
+    for (size_t index = 0; index < 65; ++index)
+        wide_schema->push_back({"c" + std::to_string(index), shdb::Type::int64});
+    ASSERT_THROW(db->createTable("test_table", wide_schema, shdb::TableLayout::pax), std::runtime_error);
+    ASSERT_FALSE(db->checkTableExists("test_table"));
+
+    wide_schema->pop_back();
+    shdb::Row wide_row(wide_schema->size(), int64_t(1));
+    wide_row.back() = shdb::Null{};
+    {
+        auto table = db->createTable("test_table", wide_schema, shdb::TableLayout::pax);
+        auto row_id = table->insertRow(wide_row);
+        ASSERT_EQ(table->getRow(row_id), wide_row);
+    }
+    db->dropTable("test_table");
+
+    uint64_t row_count = 0;
+    {
+        auto table = db->createTable("test_table", pax_schema, shdb::TableLayout::pax);
+        while (table->getPageCount() < 5)
+            table->insertRow(makeRow(row_count++));
+    }
+
+    /// Layout is taken from catalog when table is opened again
+    auto table = db->getTable("test_table");
+    uint64_t scanned = 0;
+    auto scan = shdb::Scan(table);
+    for (auto it = scan.begin(), end = scan.end(); it != end; ++it, ++scanned)
+    {
+        const auto & row_view = it.getRowView();
+        ASSERT_EQ(row_view.materialize(), makeRow(row_view.getUInt64(0)));
+    }
+    ASSERT_EQ(scanned, row_count);
+}
+
+TEST(SQL, PaxLayout)
+{
+    auto db = shdb::connect("./mydb", 4);
+    if (db->checkTableExists("test_table"))
+        db->dropTable("test_table");
+
+    auto interpreter = shdb::Interpreter(db);
+    interpreter.execute("CREATE TABLE test_table (id int64, age int64, girl boolean) LAYOUT pax");
+    interpreter.execute("INSERT test_table VALUES (0, 20, 1>0)");
+    interpreter.execute("INSERT test_table VALUES (1, 21, 1<0)");
+    interpreter.execute("INSERT test_table VALUES (2, 19, 1>0)");
+
+    auto result = interpreter.execute("SELECT id FROM test_table WHERE age <= 20");
+    ASSERT_EQ(result.getRows().size(), 2);
+    for (const auto & row : result.getRows())
+        ASSERT_TRUE(row == shdb::Row{int64_t(0)} || row == shdb::Row{int64_t(2)});
+
+    ASSERT_THROW(interpreter.execute("CREATE TABLE other_table (id int64) LAYOUT columns"), std::runtime_error);
+    interpreter.execute("DROP TABLE test_table");
+}
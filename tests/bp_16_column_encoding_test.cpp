@@ -0,0 +1,173 @@
+#include <map>
+#include <random>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "column_encoding.h"
+#include "db.h"
+#include "interpreter.h"
+#include "pax.h"
+
+namespace
+{
+
+auto pax_schema = std::make_shared<shdb::Schema>(shdb::Schema{
+    {"id", shdb::Type::uint64}, {"city", shdb::Type::varchar, 32}, {"delta", shdb::Type::int64}, {"graduated", shdb::Type::boolean}});
+
+const std::vector<std::string> cities = {"Amsterdam", "Berlin", "Copenhagen", "Dublin", "Edinburgh"};
+
+shdb::Row makeRow(uint64_t id)
+{
+    auto delta = id % 7 == 0 ? shdb::Value(shdb::Null{}) : shdb::Value(static_cast<int64_t>(id % 100) - 50);
+    return shdb::Row{id, cities[id % cities.size()], delta, id % 3 == 0};
+}
+
+std::map<shdb::RowIndex, shdb::Row> fillPage(const std::shared_ptr<shdb::ITablePageProvider> & provider, const shdb::FrameView & frame)
+{
+    std::map<shdb::RowIndex, shdb::Row> rows;
+    for (uint64_t id = 0;; ++id)
+    {
+        auto [inserted, row_index] = provider->insertRow(frame, makeRow(id));
+        if (!inserted)
+            break;
+        rows.emplace(row_index, makeRow(id));
+    }
+    return rows;
+}
+
+void validatePage(
+    const std::shared_ptr<shdb::ITablePageProvider> & provider, const shdb::FrameView & frame, const std::map<shdb::RowIndex, shdb::Row> & rows)
+{
+    size_t present = 0;
+    for (auto index = provider->findNextRow(frame, 0); index < provider->getRowCount(frame); index = provider->findNextRow(frame, index + 1))
+    {
+        auto it = rows.find(index);
+        ASSERT_NE(it, rows.end());
+        ASSERT_EQ(provider->getRow(frame, index), it->second);
+        ++present;
+    }
+    ASSERT_EQ(present, rows.size());
+}
+
+}
+
+TEST(BufferPool, PackedBits)
+{
+    std::vector<uint8_t> data(shdb::getPackedSize(100, 64));
+    std::mt19937_64 generator(42);
+    for (uint8_t bit_width : {0, 1, 3, 13, 31, 63, 64})
+    {
+        std::fill(data.begin(), data.end(), 0xff);
+        std::vector<uint64_t> values;
+        for (size_t index = 0; index < 100; ++index)
+        {
+            auto value = bit_width == 64 ? generator() : generator() & ((uint64_t(1) << bit_width) - 1);
+            shdb::writeBits(data.data(), index, bit_width, value);
+            values.push_back(value);
+        }
+        for (size_t index = 0; index < 100; ++index)
+            ASSERT_EQ(shdb::readBits(data.data(), index, bit_width), values[index]);
+    }
+    ASSERT_LT(shdb::toKey(shdb::Type::int64, int64_t(-5)), shdb::toKey(shdb::Type::int64, int64_t(3)));
+    ASSERT_EQ(shdb::keyToInt64(shdb::toKey(shdb::Type::int64, int64_t(-5))), -5);
+}
+
+TEST(BufferPool, EncodedPaxPage)
+{
+    auto provider = shdb::createPaxPageProvider(pax_schema);
+    auto frame_memory = std::make_unique<uint8_t[]>(shdb::PageSize);
+    auto frame = shdb::FrameView(nullptr, 0, frame_memory.get());
+
+    /// Full width rows take 57 bytes, encoded ones take a few bytes
+    auto rows = fillPage(provider, frame);
+    ASSERT_GT(rows.size(), 3 * shdb::PageSize / 57);
+    validatePage(provider, frame, rows);
+
+    /// Values out of page ranges and new dictionary values make page encode its rows again,
+    /// page refuses row if its present rows would not fit with wider encodings
+    auto wide_row = shdb::Row{uint64_t(1) << 40, std::string("Florence"), int64_t(-1000000), shdb::Value(shdb::Null{})};
+    provider->deleteRow(frame, 1);
+    rows.erase(1);
+    ASSERT_FALSE(provider->insertRow(frame, wide_row).first);
+    validatePage(provider, frame, rows);
+
+    auto row_count = static_cast<shdb::RowIndex>(rows.size());
+    for (auto it = rows.begin(); it != rows.end();)
+    {
+        if (it->first == 1 || it->first >= row_count / 4)
+        {
+            provider->deleteRow(frame, it->first);
+            it = rows.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    auto [inserted, row_index] = provider->insertRow(frame, wide_row);
+    ASSERT_TRUE(inserted);
+    ASSERT_EQ(row_index, 1);
+    rows.emplace(row_index, wide_row);
+    validatePage(provider, frame, rows);
+}
+
+TEST(BufferPool, EncodedPredicates)
+{
+    auto provider = shdb::createPaxPageProvider(pax_schema);
+    auto frame_memory = std::make_unique<uint8_t[]>(shdb::PageSize);
+    auto frame = shdb::FrameView(nullptr, 0, frame_memory.get());
+    auto rows = fillPage(provider, frame);
+    for (auto it = rows.begin(); it != rows.end(); ++it)
+        if (it->first % 5 == 0)
+            provider->deleteRow(frame, it->first);
+
+    using Comparison = shdb::ColumnPredicate::Comparison;
+    std::vector<shdb::ColumnPredicate> predicates = {
+        {0, Comparison::lt, uint64_t(30)},
+        {0, Comparison::ge, uint64_t(1) << 50},
+        {1, Comparison::eq, std::string("Berlin")},
+        {1, Comparison::ne, std::string("Berlin")},
+        {1, Comparison::eq, std::string("Paris")},
+        {2, Comparison::le, int64_t(-10)},
+        {2, Comparison::gt, int64_t(-100)},
+        {2, Comparison::ne, int64_t(0)},
+        {3, Comparison::eq, true},
+    };
+    for (const auto & predicate : predicates)
+    {
+        std::vector<shdb::RowIndex> expected;
+        for (auto index = provider->findNextRow(frame, 0); index < provider->getRowCount(frame);
+             index = provider->findNextRow(frame, index + 1))
+            if (predicate.matches(provider->getRowView(frame, index)))
+                expected.push_back(index);
+
+        std::vector<shdb::RowIndex> filtered;
+        provider->filterRows(frame, predicate, filtered);
+        ASSERT_EQ(filtered, expected);
+    }
+}
+
+TEST(SQL, PushedDownFilter)
+{
+    auto db = shdb::connect("./mydb", 1);
+    auto interpreter = shdb::Interpreter(db);
+    for (const auto * layout : {"row", "pax"})
+    {
+        if (db->checkTableExists("test_table"))
+            db->dropTable("test_table");
+        interpreter.execute(std::string("CREATE TABLE test_table (id int64, age int64) LAYOUT ") + layout);
+        for (int id = 0; id < 500; ++id)
+        {
+            std::stringstream stream;
+            stream << "INSERT test_table VALUES (" << id << ", " << 20 + id % 10 << ")";
+            interpreter.execute(stream.str());
+        }
+
+        ASSERT_EQ(interpreter.execute("SELECT id FROM test_table WHERE age = 25").getRows().size(), 50);
+        ASSERT_EQ(interpreter.execute("SELECT id FROM test_table WHERE 23 > age").getRows().size(), 150);
+        ASSERT_EQ(interpreter.execute("SELECT id FROM test_table WHERE id >= 450").getRows().size(), 50);
+        ASSERT_EQ(interpreter.execute("SELECT id FROM test_table WHERE (age > 21) AND (age < 23)").getRows().size(), 50);
+    }
+    interpreter.execute("DROP TABLE test_table");
+}
@@ -0,0 +1,209 @@
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "db.h"
+#include "interpreter.h"
+
+namespace
+{
+
+auto fixed_schema = std::make_shared<shdb::Schema>(shdb::Schema{
+    {"id", shdb::Type::uint64}, {"name", shdb::Type::varchar, 32}, {"delta", shdb::Type::int64}, {"graduated", shdb::Type::boolean}});
+
+auto flexible_schema = std::make_shared<shdb::Schema>(shdb::Schema{{"id", shdb::Type::uint64}, {"description", shdb::Type::string}});
+
+shdb::Row makeRow(uint64_t id)
+{
+    auto name = id % 10 == 0 ? std::string("clone, \"the\" ") + std::to_string(id) : "clone" + std::to_string(id);
+    auto delta = id % 7 == 0 ? shdb::Value(shdb::Null{}) : shdb::Value(static_cast<int64_t>(id % 1000) - 500);
+    return shdb::Row{id, name, delta, id % 3 == 0};
+}
+
+std::string toCsv(const shdb::Row & row)
+{
+    std::stringstream stream;
+    stream << std::get<uint64_t>(row[0]) << ",";
+    auto name = std::get<std::string>(row[1]);
+    if (name.find(',') != std::string::npos)
+    {
+        stream << '"';
+        for (auto c : name)
+            stream << (c == '"' ? "\"\"" : std::string(1, c));
+        stream << '"';
+    }
+    else
+    {
+        stream << name;
+    }
+    stream << ",";
+    if (!std::holds_alternative<shdb::Null>(row[2]))
+        stream << std::get<int64_t>(row[2]);
+    stream << "," << (std::get<bool>(row[3]) ? "true" : "f");
+    return stream.str();
+}
+
+}
+
+TEST(BufferPool, BulkLoadCsv)
+{
+    auto db = shdb::connect("./mydb", 8);
+    if (db->checkTableExists("test_table"))
+        db->dropTable("test_table");
+    db->createTable("test_table", fixed_schema);
+    auto table = db->getTable("test_table", fixed_schema);
+
+    constexpr uint64_t row_count = 100000;
+    {
+        std::ofstream output("./bulk_load.csv");
+        for (uint64_t id = 0; id < row_count; ++id)
+            output << toCsv(makeRow(id)) << (id % 2 == 0 ? "\n" : "\r\n");
+    }
+
+    auto loaded = shdb::copyFromFile(*table, *fixed_schema, "./bulk_load.csv", {.delimiter = ',', .threads = 4});
+    ASSERT_EQ(loaded, row_count);
+
+    std::vector<bool> seen(row_count);
+    auto scan = shdb::Scan(table);
+    for (auto it = scan.begin(), end = scan.end(); it != end; ++it)
+    {
+        auto row = it.getRow();
+        auto id = std::get<uint64_t>(row[0]);
+        ASSERT_FALSE(seen[id]);
+        seen[id] = true;
+        ASSERT_EQ(row, makeRow(id));
+    }
+    ASSERT_EQ(std::count(seen.begin(), seen.end(), true), row_count);
+
+    /// Appended pages are known to free space map, inserts fill their free slots
+    auto page_count = table->getPageCount();
+    table->insertRow(makeRow(row_count));
+    ASSERT_EQ(table->getPageCount(), page_count);
+    ASSERT_EQ(table->getRow(table->insertRow(makeRow(row_count + 1))), makeRow(row_count + 1));
+
+    {
+        std::ofstream output("./bulk_load.csv");
+        output << "1,name,abc,true\n";
+    }
+    ASSERT_THROW(shdb::copyFromFile(*table, *fixed_schema, "./bulk_load.csv"), std::runtime_error);
+    std::filesystem::remove("./bulk_load.csv");
+}
+
+TEST(BufferPool, BulkLoadQuotesInsideFields)
+{
+    auto db = shdb::connect("./mydb", 8);
+    if (db->checkTableExists("test_table"))
+        db->dropTable("test_table");
+    db->createTable("test_table", flexible_schema);
+    auto table = db->getTable("test_table", flexible_schema);
+
+    /// Quote inside unquoted field is an ordinary character, chunk boundaries must still skip line breaks of quoted fields
+    constexpr uint64_t row_count = 20000;
+    auto description = [](uint64_t id)
+    {
+        if (id % 4 == 2)
+            return "multi\nline " + std::to_string(id);
+        return id % 4 == 1 ? "O\"Brien " + std::to_string(id) : "plain " + std::to_string(id);
+    };
+    {
+        std::ofstream output("./bulk_load.csv");
+        for (uint64_t id = 0; id < row_count; ++id)
+        {
+            auto value = description(id);
+            output << id << "," << (id % 4 == 2 ? "\"" + value + "\"" : value) << "\n";
+        }
+    }
+
+    ASSERT_EQ(shdb::copyFromFile(*table, *flexible_schema, "./bulk_load.csv", {.threads = 4}), row_count);
+    size_t loaded = 0;
+    for (auto row : shdb::Scan(table))
+    {
+        if (row.empty())
+            continue;
+        ASSERT_EQ(std::get<std::string>(row[1]), description(std::get<uint64_t>(row[0])));
+        ++loaded;
+    }
+    ASSERT_EQ(loaded, row_count);
+    std::filesystem::remove("./bulk_load.csv");
+}
+
+TEST(BufferPool, BulkLoadPartialOnError)
+{
+    auto db = shdb::connect("./mydb", 8);
+    if (db->checkTableExists("test_table"))
+        db->dropTable("test_table");
+    db->createTable("test_table", fixed_schema);
+    auto table = db->getTable("test_table", fixed_schema);
+
+    /// Single thread parses 4MiB per round, invalid record is far beyond the first round
+    constexpr uint64_t row_count = 250000;
+    {
+        std::ofstream output("./bulk_load.csv");
+        for (uint64_t id = 0; id < row_count; ++id)
+            output << toCsv(makeRow(id)) << "\n";
+        output << "1,name,abc,true\n";
+    }
+
+    std::string message;
+    try
+    {
+        shdb::copyFromFile(*table, *fixed_schema, "./bulk_load.csv", {.threads = 1});
+    }
+    catch (const std::runtime_error & error)
+    {
+        message = error.what();
+    }
+    ASSERT_NE(message.find("rows were loaded before the error"), std::string::npos) << message;
+
+    /// Rounds appended before the failing one stay in table and hold complete rows
+    uint64_t loaded = 0;
+    for (auto row : shdb::Scan(table))
+    {
+        if (row.empty())
+            continue;
+        ASSERT_EQ(row, makeRow(loaded));
+        ++loaded;
+    }
+    ASSERT_GT(loaded, 0);
+    ASSERT_LT(loaded, row_count);
+    ASSERT_NE(message.find(std::to_string(loaded) + " rows were loaded"), std::string::npos) << message;
+    std::filesystem::remove("./bulk_load.csv");
+}
+
+TEST(SQL, CopyFromTsv)
+{
+    auto db = shdb::connect("./mydb", 1);
+    if (db->checkTableExists("test_table"))
+        db->dropTable("test_table");
+
+    {
+        std::ofstream output("./bulk_load.tsv");
+        output << "id\tdescription\n";
+        output << "1\tfirst\n";
+        output << "2\t\"multi\nline\"\n";
+        output << "3\t\n";
+        output << "4\t\"\"";
+    }
+
+    auto interpreter = shdb::Interpreter(db);
+    interpreter.execute("CREATE TABLE test_table (id uint64, description string)");
+    interpreter.execute("COPY test_table FROM './bulk_load.tsv' HEADER");
+
+    std::map<uint64_t, shdb::Value> expected = {
+        {1, std::string("first")}, {2, std::string("multi\nline")}, {3, shdb::Null{}}, {4, std::string()}};
+    std::map<uint64_t, shdb::Value> loaded;
+    auto table = db->getTable("test_table", flexible_schema);
+    auto scan = shdb::Scan(table);
+    for (auto it = scan.begin(), end = scan.end(); it != end; ++it)
+    {
+        auto row = it.getRow();
+        loaded.emplace(std::get<uint64_t>(row[0]), row[1]);
+    }
+    ASSERT_EQ(loaded, expected);
+
+    ASSERT_THROW(interpreter.execute("COPY test_table FROM './missing.csv'"), std::runtime_error);
+    std::filesystem::remove("./bulk_load.tsv");
+    interpreter.execute("DROP TABLE test_table");
+}
@@ -0,0 +1,122 @@
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "db.h"
+
+namespace
+{
+
+auto fixed_schema = std::make_shared<shdb::Schema>(shdb::Schema{
+    {"id", shdb::Type::uint64}, {"name", shdb::Type::varchar, 32}, {"delta", shdb::Type::int64}, {"graduated", shdb::Type::boolean}});
+
+auto flexible_schema = std::make_shared<shdb::Schema>(shdb::Schema{{"id", shdb::Type::uint64}, {"description", shdb::Type::string}});
+
+std::shared_ptr<shdb::Schema> makeWideSchema(size_t column_count)
+{
+    auto schema = std::make_shared<shdb::Schema>();
+    for (size_t index = 0; index < column_count; ++index)
+        schema->push_back(shdb::ColumnSchema{"column_" + std::to_string(index), index % 2 ? shdb::Type::int64 : shdb::Type::varchar, 16});
+    return schema;
+}
+
+void dropIfExists(const std::shared_ptr<shdb::Database> & db, const std::string & name)
+{
+    if (db->checkTableExists(name))
+        db->dropTable(name);
+}
+
+}
+
+TEST(BufferPool, CatalogCache)
+{
+    auto wide_schema = makeWideSchema(60);
+    {
+        auto db = shdb::connect("./mydb", 4);
+        for (const auto * name : {"test_table", "test_pax", "test_wide"})
+            dropIfExists(db, name);
+
+        auto catalog_size = std::filesystem::file_size("./mydb/__catalog");
+        db->createTable("test_table", flexible_schema);
+        db->createTable("test_pax", fixed_schema, shdb::TableLayout::pax);
+        db->createTable("test_wide", wide_schema);
+
+        /// Column definitions are a few dozen bytes each
+        ASSERT_LE(std::filesystem::file_size("./mydb/__catalog") - catalog_size, 2 * shdb::PageSize);
+        ASSERT_EQ(*db->findTableSchema("test_wide"), *wide_schema);
+    }
+
+    /// Catalog is loaded once on connect, opening tables does not read it again
+    auto db = shdb::connect("./mydb", 4);
+    auto page_accessed = db->getStatistics()->page_accessed;
+    auto table = db->getTable("test_pax");
+    ASSERT_EQ(db->getStatistics()->page_accessed, page_accessed);
+
+    table->insertRow(shdb::Row{uint64_t(1), std::string("Ann"), int64_t(-1), true});
+    ASSERT_EQ(db->getTable("test_pax")->getRow(shdb::RowId{0, 0}), (shdb::Row{uint64_t(1), std::string("Ann"), int64_t(-1), true}));
+    ASSERT_EQ(*db->findTableSchema("test_table"), *flexible_schema);
+    ASSERT_EQ(*db->findTableSchema("test_pax"), *fixed_schema);
+    ASSERT_EQ(*db->findTableSchema("test_wide"), *wide_schema);
+
+    /// Creating existing table fails without touching its schema
+    ASSERT_THROW(db->createTable("test_pax", flexible_schema), std::runtime_error);
+    ASSERT_EQ(*db->findTableSchema("test_pax"), *fixed_schema);
+
+    /// Recreated table gets its new schema, dropped table is forgotten after reconnect too
+    db->dropTable("test_table");
+    db->createTable("test_table", fixed_schema);
+    db->dropTable("test_wide");
+    ASSERT_EQ(db->findTableSchema("test_wide"), nullptr);
+    ASSERT_THROW(db->getTable("test_wide"), std::runtime_error);
+
+    /// Pages are written back once nothing holds the buffer pool
+    table.reset();
+    db.reset();
+    db = shdb::connect("./mydb", 4);
+    ASSERT_EQ(*db->findTableSchema("test_table"), *fixed_schema);
+    ASSERT_EQ(db->findTableSchema("test_wide"), nullptr);
+    ASSERT_EQ(db->getTable("test_pax")->getRow(shdb::RowId{0, 0}), (shdb::Row{uint64_t(1), std::string("Ann"), int64_t(-1), true}));
+}
+
+TEST(BufferPool, CatalogSuffixedNames)
+{
+    auto db = shdb::connect("./mydb", 4);
+    dropIfExists(db, "test_suffixed");
+    dropIfExists(db, "test_suffixed_schema");
+
+    /// Tables named like schema tables of old versions are ordinary tables
+    db->createTable("test_suffixed", flexible_schema);
+    db->createTable("test_suffixed_schema", fixed_schema);
+    db->dropTable("test_suffixed");
+    ASSERT_TRUE(db->checkTableExists("test_suffixed_schema"));
+    ASSERT_EQ(*db->findTableSchema("test_suffixed_schema"), *fixed_schema);
+    db->dropTable("test_suffixed_schema");
+}
+
+TEST(BufferPool, CatalogLegacyFormat)
+{
+    const std::filesystem::path path = "./mylegacydb";
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path);
+    for (const auto * name : {"test_table", "test_table_schema"})
+        std::ofstream(path / name).put('\0');
+
+    /// Directory of a version without system catalog is rejected instead of opening with no tables
+    try
+    {
+        shdb::connect(path, 4);
+        FAIL() << "Legacy database was opened";
+    }
+    catch (const std::runtime_error & error)
+    {
+        ASSERT_TRUE(std::string(error.what()).starts_with("Unsupported database format"));
+    }
+    ASSERT_FALSE(std::filesystem::exists(path / "__catalog"));
+
+    /// Schema table without its relation is an ordinary table
+    std::filesystem::remove(path / "test_table");
+    shdb::connect(path, 4);
+    ASSERT_TRUE(std::filesystem::exists(path / "__catalog"));
+    std::filesystem::remove_all(path);
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include "db.h"
+
+namespace
+{
+
+auto fixed_schema = std::make_shared<shdb::Schema>(shdb::Schema{{"id", shdb::Type::uint64}, {"delta", shdb::Type::int64}});
+
+auto other_schema = std::make_shared<shdb::Schema>(shdb::Schema{{"id", shdb::Type::uint64}, {"name", shdb::Type::varchar, 16}});
+
+}
+
+TEST(BufferPool, TableHandleCache)
+{
+    auto db = shdb::connect("./mydb", 4);
+    if (db->checkTableExists("test_table"))
+        db->dropTable("test_table");
+
+    /// Handles are opened once and reused by later statements
+    auto table = db->createTable("test_table", fixed_schema);
+    ASSERT_EQ(db->getTable("test_table"), table);
+    ASSERT_EQ(db->getTable("test_table", fixed_schema), table);
+
+    /// Free space map of the handle is kept, row of every statement goes to the same page
+    for (uint64_t id = 0; id < 10; ++id)
+        ASSERT_EQ(db->getTable("test_table")->insertRow(shdb::Row{id, -static_cast<int64_t>(id)}).page_index, 0);
+    ASSERT_EQ(table->getPageCount(), 1);
+
+    /// Explicit schema that differs from the cached one gets its own handle
+    auto other_table = db->getTable("test_table", other_schema);
+    ASSERT_NE(other_table, table);
+    ASSERT_EQ(db->getTable("test_table", other_schema), other_table);
+    ASSERT_EQ(db->getTable("test_table", fixed_schema)->getRow(shdb::RowId{0, 3}), (shdb::Row{uint64_t(3), int64_t(-3)}));
+
+    /// Dropped table handle is forgotten, table created with the same name starts empty
+    auto cached = db->getTable("test_table");
+    db->dropTable("test_table");
+    ASSERT_THROW(db->getTable("test_table"), std::runtime_error);
+    auto recreated = db->createTable("test_table", fixed_schema);
+    ASSERT_NE(recreated, cached);
+    ASSERT_EQ(db->getTable("test_table"), recreated);
+    ASSERT_EQ(recreated->getPageCount(), 0);
+    db->dropTable("test_table");
+}
+
+TEST(BufferPool, IndexHandleCache)
+{
+    auto db = shdb::connect("./mydb", 4);
+    auto key_schema = std::make_shared<shdb::Schema>(shdb::Schema{{"id", shdb::Type::uint64}});
+    if (db->findTableSchema("test_index"))
+        db->dropIndex("test_index");
+
+    auto index = db->createIndex("test_index", key_schema, "btree");
+    ASSERT_EQ(db->getIndex("test_index"), index);
+    index->insert(shdb::Row{uint64_t(42)}, shdb::RowId{1, 2});
+
+    auto row_id = db->getIndex("test_index")->lookupUniqueKey(shdb::Row{uint64_t(42)});
+    ASSERT_TRUE(row_id.has_value());
+    ASSERT_EQ(row_id->page_index, 1);
+    ASSERT_EQ(row_id->row_index, 2);
+
+    db->dropIndex("test_index");
+    ASSERT_THROW(db->getIndex("test_index"), std::runtime_error);
+}
@@ -0,0 +1,111 @@
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "db.h"
+
+namespace
+{
+
+auto fixed_schema = std::make_shared<shdb::Schema>(shdb::Schema{
+    {"id", shdb::Type::uint64}, {"name", shdb::Type::varchar, 1024}, {"age", shdb::Type::uint64}, {"graduated", shdb::Type::boolean}});
+
+std::shared_ptr<shdb::Database> createDatabase(int frame_count)
+{
+    auto db = shdb::connect("./mydb", frame_count);
+    if (db->checkTableExists("test_table"))
+        db->dropTable("test_table");
+    db->createTable("test_table", fixed_schema);
+    return db;
+}
+
+}
+
+TEST(BufferPool, DirtyPages)
+{
+    shdb::PageIndex pool_size = 5;
+    auto db = createDatabase(pool_size);
+    auto table = db->getTable("test_table", fixed_schema);
+
+    shdb::PageIndex page_count = 0;
+    uint64_t row_count = 0;
+
+    while (page_count < 4 * pool_size)
+    {
+        std::stringstream stream;
+        stream << "clone" << row_count;
+        auto row = shdb::Row{row_count, stream.str(), 20UL + row_count % 10, row_count % 10 > 5};
+        auto row_id = table->insertRow(row);
+        page_count = std::max(page_count, row_id.page_index + 1);
+        ++row_count;
+    }
+
+    auto statistics = db->getStatistics();
+    auto start_page_written = statistics->page_written;
+    auto start_page_read = statistics->page_read;
+
+    for (int round = 0; round < 3; ++round)
+    {
+        uint64_t scanned_rows = 0;
+        for (auto row : shdb::Scan(table))
+            if (!row.empty())
+                ++scanned_rows;
+        ASSERT_EQ(scanned_rows, row_count);
+    }
+
+    auto page_read = statistics->page_read - start_page_read;
+    auto page_written = statistics->page_written - start_page_written;
+    std::cout << "Read only scans required " << page_read << " page reads and " << page_written << " page writes" << std::endl;
+
+    ASSERT_GE(page_read, static_cast<uint64_t>(page_count));
+    /// Only pages dirtied by inserts and still resident in pool may be written back
+    ASSERT_LE(page_written, static_cast<uint64_t>(pool_size));
+}
+
+TEST(BufferPool, BackgroundFlusher)
+{
+    /// Flusher is on by default
+    shdb::PageIndex pool_size = 16;
+    auto options = shdb::BufferPoolOptions{.flusher_clean_frames_target = pool_size};
+    auto db = shdb::connect("./mydb", pool_size, options);
+    if (db->checkTableExists("test_table"))
+        db->dropTable("test_table");
+    db->createTable("test_table", fixed_schema);
+    auto table = db->getTable("test_table", fixed_schema);
+
+    std::vector<shdb::Row> rows;
+    shdb::PageIndex page_count = 0;
+    uint64_t row_count = 0;
+
+    while (page_count < 4 * pool_size)
+    {
+        std::stringstream stream;
+        stream << "clone" << row_count;
+        auto row = shdb::Row{row_count, stream.str(), 20UL + row_count % 10, row_count % 10 > 5};
+        auto row_id = table->insertRow(row);
+        rows.push_back(std::move(row));
+        page_count = std::max(page_count, row_id.page_index + 1);
+        ++row_count;
+    }
+
+    auto statistics = db->getStatistics();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (statistics->page_flushed == 0 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::cout << "Statistics after inserts " << shdb::toString(*statistics) << std::endl;
+    ASSERT_GT(statistics->page_flushed, 0);
+
+    size_t index = 0;
+    for (auto row : shdb::Scan(table))
+    {
+        if (!row.empty())
+        {
+            ASSERT_EQ(row, rows[index]);
+            ++index;
+        }
+    }
+    ASSERT_EQ(index, rows.size());
+}
@@ -0,0 +1,101 @@
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "db.h"
+#include "page_io.h"
+
+namespace
+{
+
+auto fixed_schema = std::make_shared<shdb::Schema>(shdb::Schema{
+    {"id", shdb::Type::uint64}, {"name", shdb::Type::varchar, 1024}, {"age", shdb::Type::uint64}, {"graduated", shdb::Type::boolean}});
+
+shdb::Row makeRow(uint64_t row_count)
+{
+    std::stringstream stream;
+    stream << "clone" << row_count;
+    return shdb::Row{row_count, stream.str(), 20UL + row_count % 10, row_count % 10 > 5};
+}
+
+uint64_t validateTable(std::shared_ptr<shdb::ITable> table)
+{
+    uint64_t row_count = 0;
+    for (auto row : shdb::Scan(table))
+    {
+        if (!row.empty())
+        {
+            EXPECT_EQ(row, makeRow(row_count));
+            ++row_count;
+        }
+    }
+    return row_count;
+}
+
+}
+
+TEST(BufferPool, IOUring)
+{
+    shdb::PageIndex pool_size = 5;
+    auto options = shdb::BufferPoolOptions{.page_io_backend = shdb::PageIOBackend::io_uring};
+    uint64_t row_count = 0;
+
+    {
+        auto db = shdb::connect("./mydb", pool_size, options);
+        if (db->checkTableExists("test_table"))
+            db->dropTable("test_table");
+        db->createTable("test_table", fixed_schema);
+        auto table = db->getTable("test_table", fixed_schema);
+
+        shdb::PageIndex page_count = 0;
+        while (page_count < 4 * pool_size)
+        {
+            auto row_id = table->insertRow(makeRow(row_count));
+            page_count = std::max(page_count, row_id.page_index + 1);
+            ++row_count;
+        }
+
+        ASSERT_EQ(validateTable(table), row_count);
+        std::cout << "Statistics " << shdb::toString(*db->getStatistics()) << std::endl;
+    }
+
+    std::cout << "Validating with synchronous backend" << std::endl;
+    auto db = shdb::connect("./mydb", pool_size);
+    ASSERT_EQ(validateTable(db->getTable("test_table")), row_count);
+}
+
+TEST(BufferPool, IOUringFailure)
+{
+    auto page_io = shdb::createPageIO(shdb::PageIOBackend::io_uring, nullptr, 0);
+    if (page_io->getBackend() != shdb::PageIOBackend::io_uring)
+        GTEST_SKIP() << "io_uring is unavailable";
+
+    std::filesystem::create_directories("./mydb");
+    std::filesystem::remove("./mydb/page_io_test");
+    auto file = std::make_shared<shdb::File>("./mydb/page_io_test", true);
+    file->allocPage();
+
+    auto * buffer = static_cast<uint8_t *>(std::aligned_alloc(shdb::PageSize, 2 * shdb::PageSize));
+    /// Read past the end of file completes short, failed batch must not leave requests in flight
+    shdb::PageIORequest requests[] = {{file.get(), 0, buffer, false, 0}, {file.get(), 8, buffer + shdb::PageSize, false, 1}};
+    try
+    {
+        page_io->execute(requests);
+        FAIL() << "Read past the end of file succeeded";
+    }
+    catch (const std::runtime_error & error)
+    {
+        std::cout << "Expected failure: " << error.what() << std::endl;
+    }
+    ASSERT_EQ(page_io->getInFlightCount(), 0);
+
+    page_io->execute({requests, 1});
+    ASSERT_EQ(page_io->getInFlightCount(), 0);
+
+    std::free(buffer);
+    file.reset();
+    std::filesystem::remove("./mydb/page_io_test");
+}
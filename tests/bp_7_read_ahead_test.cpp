@@ -0,0 +1,194 @@
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "bufferpool.h"
+#include "db.h"
+#include "executor.h"
+
+namespace
+{
+
+auto fixed_schema = std::make_shared<shdb::Schema>(shdb::Schema{
+    {"id", shdb::Type::uint64}, {"name", shdb::Type::varchar, 1024}, {"age", shdb::Type::uint64}, {"graduated", shdb::Type::boolean}});
+
+shdb::Row makeRow(uint64_t row_count)
+{
+    std::stringstream stream;
+    stream << "clone" << row_count;
+    return shdb::Row{row_count, stream.str(), 20UL + row_count % 10, row_count % 10 > 5};
+}
+
+uint64_t validateTable(std::shared_ptr<shdb::ITable> table)
+{
+    uint64_t row_count = 0;
+    for (auto row : shdb::Scan(table))
+    {
+        if (!row.empty())
+        {
+            EXPECT_EQ(row, makeRow(row_count));
+            ++row_count;
+        }
+    }
+    return row_count;
+}
+
+uint64_t prepareTable(shdb::PageIndex page_count)
+{
+    auto db = shdb::connect("./mydb", 16);
+    if (db->checkTableExists("test_table"))
+        db->dropTable("test_table");
+    db->createTable("test_table", fixed_schema);
+    auto table = db->getTable("test_table", fixed_schema);
+
+    uint64_t row_count = 0;
+    while (table->getPageCount() < page_count)
+        table->insertRow(makeRow(row_count++));
+    return row_count;
+}
+
+}
+
+TEST(BufferPool, ReadAhead)
+{
+    shdb::PageIndex pool_size = 16;
+    auto row_count = prepareTable(8 * pool_size);
+
+    {
+        auto db = shdb::connect("./mydb", pool_size, shdb::BufferPoolOptions{.max_read_ahead_pages = 0});
+        ASSERT_EQ(validateTable(db->getTable("test_table")), row_count);
+        std::cout << "Statistics without read-ahead " << shdb::toString(*db->getStatistics()) << std::endl;
+        ASSERT_EQ(db->getStatistics()->page_prefetched, 0);
+        ASSERT_EQ(db->getStatistics()->readahead_hit, 0);
+    }
+
+    auto db = shdb::connect("./mydb", pool_size);
+    ASSERT_EQ(validateTable(db->getTable("test_table")), row_count);
+    auto statistics = db->getStatistics();
+    std::cout << "Statistics with read-ahead " << shdb::toString(*statistics) << std::endl;
+
+    /// Nearly every page of a cold sequential scan should come from read-ahead
+    ASSERT_GT(statistics->page_prefetched, 6 * pool_size);
+    ASSERT_GT(statistics->readahead_hit, 6 * pool_size);
+    ASSERT_LE(statistics->readahead_hit, statistics->page_prefetched);
+}
+
+TEST(BufferPool, SlicedReadAhead)
+{
+    shdb::PageIndex pool_size = 64;
+    size_t slice_count = 4;
+    prepareTable(8 * pool_size);
+
+    /// Slices of a parallel scan interleave their misses, each of them is still detected as sequential
+    auto db = shdb::connect("./mydb", pool_size);
+    auto table = db->getTable("test_table");
+    std::vector<shdb::ExecutorPtr> slices;
+    for (size_t index = 0; index < slice_count; ++index)
+        slices.push_back(shdb::createReadFromTableExecutor(table, fixed_schema, std::nullopt, std::nullopt, shdb::TableSlice{index, slice_count}));
+
+    uint64_t row_count = 0;
+    for (bool finished = false; !finished;)
+    {
+        finished = true;
+        for (auto & slice : slices)
+        {
+            if (auto row = slice->next())
+            {
+                ++row_count;
+                finished = false;
+            }
+        }
+    }
+    auto statistics = db->getStatistics();
+    std::cout << "Statistics of sliced scan " << shdb::toString(*statistics) << std::endl;
+
+    ASSERT_GT(row_count, 0);
+    ASSERT_GT(statistics->page_prefetched, 6 * pool_size);
+    ASSERT_GT(statistics->readahead_hit, 6 * pool_size);
+    ASSERT_LE(statistics->readahead_hit, statistics->page_prefetched);
+}
+
+TEST(BufferPool, ConcurrentReadAhead)
+{
+    shdb::PageIndex pool_size = 16;
+    auto row_count = prepareTable(8 * pool_size);
+
+    /// Scans share pages being prefetched by each other, none of them may see a frame before its read completes
+    auto db = shdb::connect("./mydb", pool_size);
+    std::vector<std::shared_ptr<shdb::ITable>> tables;
+    for (size_t index = 0; index < 4; ++index)
+        tables.push_back(db->getTable("test_table"));
+
+    std::vector<uint64_t> row_counts(tables.size());
+    std::vector<std::thread> threads;
+    for (size_t index = 0; index < tables.size(); ++index)
+        threads.emplace_back([&, index] { row_counts[index] = validateTable(tables[index]); });
+    for (auto & thread : threads)
+        thread.join();
+
+    for (auto count : row_counts)
+        ASSERT_EQ(count, row_count);
+}
+
+TEST(BufferPool, ReadAheadFailure)
+{
+    if (shdb::createPageIO(shdb::PageIOBackend::io_uring, nullptr, 0)->getBackend() != shdb::PageIOBackend::io_uring)
+        GTEST_SKIP() << "io_uring is unavailable";
+
+    shdb::PageIndex pool_size = 16;
+    std::filesystem::create_directories("./mydb");
+    auto create_file = [&](const std::string & path)
+    {
+        std::filesystem::remove(path);
+        auto file = std::make_shared<shdb::File>(path, true);
+        file->allocPages(pool_size);
+        auto * buffer = static_cast<uint8_t *>(std::aligned_alloc(shdb::PageSize, shdb::PageSize));
+        for (shdb::PageIndex page_index = 0; page_index < pool_size; ++page_index)
+        {
+            std::fill_n(buffer, shdb::PageSize, static_cast<uint8_t>(page_index + 1));
+            file->writePage(buffer, page_index);
+        }
+        std::free(buffer);
+        return file;
+    };
+    auto file = create_file("./mydb/read_ahead_test");
+    auto other_file = create_file("./mydb/read_ahead_other_test");
+
+    /// Reads past the end of shrunk file complete short and fail
+    std::filesystem::resize_file("./mydb/read_ahead_test", 2 * shdb::PageSize);
+    auto options = shdb::BufferPoolOptions{.page_io_backend = shdb::PageIOBackend::io_uring, .max_read_ahead_pages = 4};
+    shdb::BufferPool pool(std::make_shared<shdb::Statistics>(), pool_size, options);
+
+    /// Sequential miss starts read-ahead of missing pages, its failure is not reported to the reader
+    {
+        auto first = pool.getPage(file, 0);
+        auto second = pool.getPage(file, 1);
+        ASSERT_EQ(first.getData()[0], 1);
+        ASSERT_EQ(second.getData()[0], 2);
+    }
+
+    /// Failed pages are not left mapped to frames holding other pages
+    for (size_t attempt = 0; attempt < 2; ++attempt)
+    {
+        ASSERT_THROW(pool.getPage(file, 2), std::runtime_error);
+        ASSERT_THROW(pool.getPage(file, 3), std::runtime_error);
+    }
+
+    /// Failures leak no pins, every frame can be pinned at once
+    std::vector<shdb::Frame> pinned;
+    for (shdb::PageIndex page_index = 0; page_index < pool_size; ++page_index)
+    {
+        pinned.push_back(pool.getPage(other_file, page_index));
+        ASSERT_EQ(pinned.back().getData()[0], page_index + 1);
+    }
+    pinned.clear();
+
+    file.reset();
+    other_file.reset();
+    std::filesystem::remove("./mydb/read_ahead_test");
+    std::filesystem::remove("./mydb/read_ahead_other_test");
+}
@@ -0,0 +1,141 @@
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "cache.h"
+#include "db.h"
+
+namespace
+{
+
+auto fixed_schema = std::make_shared<shdb::Schema>(shdb::Schema{
+    {"id", shdb::Type::uint64}, {"name", shdb::Type::varchar, 1024}, {"age", shdb::Type::uint64}, {"graduated", shdb::Type::boolean}});
+
+shdb::Row makeRow(uint64_t row_count)
+{
+    std::stringstream stream;
+    stream << "clone" << row_count;
+    return shdb::Row{row_count, stream.str(), 20UL + row_count % 10, row_count % 10 > 5};
+}
+
+void prepareTable(const std::string & name, shdb::PageIndex page_count)
+{
+    auto db = shdb::connect("./mydb", 16);
+    if (db->checkTableExists(name))
+        db->dropTable(name);
+    db->createTable(name, fixed_schema);
+    auto table = db->getTable(name, fixed_schema);
+
+    uint64_t row_count = 0;
+    while (table->getPageCount() < page_count)
+        table->insertRow(makeRow(row_count++));
+}
+
+/// Runs a full scan of the large table with a point lookup into the hot table after every scanned page,
+/// returns fraction of lookups served from the pool while the scan was running
+double measureHotHitRatio(shdb::CachePolicy policy, shdb::PageIndex pool_size, shdb::PageIndex hot_page_count)
+{
+    auto db = shdb::connect("./mydb", pool_size, shdb::BufferPoolOptions{.cache_policy = policy});
+    auto statistics = db->getStatistics();
+    auto hot_table = db->getTable("hot_table");
+    auto scan_table = db->getTable("scan_table");
+
+    shdb::PageIndex next_hot_page = 0;
+    auto lookup = [&]
+    {
+        auto row = hot_table->getRow(shdb::RowId{next_hot_page, 0});
+        EXPECT_FALSE(row.empty());
+        /// Step is coprime with hot page count, so every hot page is visited and consecutive lookups are not sequential
+        next_hot_page = (next_hot_page + 7) % hot_page_count;
+    };
+
+    for (shdb::PageIndex warmup = 0; warmup < 8 * hot_page_count; ++warmup)
+        lookup();
+
+    size_t lookups = 0;
+    uint64_t misses = 0;
+    scan_table->readPages(0, scan_table->getPageCount(), [&](const shdb::PageBatch &)
+    {
+        auto page_read = statistics->page_read;
+        lookup();
+        misses += statistics->page_read - page_read;
+        ++lookups;
+    });
+
+    std::cout << "Hot set hit ratio " << 1.0 - static_cast<double>(misses) / lookups << " with statistics "
+              << shdb::toString(*statistics) << std::endl;
+    return 1.0 - static_cast<double>(misses) / lookups;
+}
+
+}
+
+TEST(BufferPool, ScanResistance)
+{
+    /// Hot set takes most of the pool, Clock lets scanned pages push hot pages out before they are referenced again
+    shdb::PageIndex pool_size = 32;
+    shdb::PageIndex hot_page_count = 18;
+    prepareTable("hot_table", hot_page_count);
+    prepareTable("scan_table", 16 * pool_size);
+
+    std::cout << "Clock" << std::endl;
+    auto clock_hit_ratio = measureHotHitRatio(shdb::CachePolicy::clock, pool_size, hot_page_count);
+    ASSERT_LT(clock_hit_ratio, 0.5);
+
+    std::cout << "2Q" << std::endl;
+    ASSERT_GT(measureHotHitRatio(shdb::CachePolicy::two_queue, pool_size, hot_page_count), 0.85);
+
+    std::cout << "ARC" << std::endl;
+    ASSERT_GT(measureHotHitRatio(shdb::CachePolicy::arc, pool_size, hot_page_count), 0.85);
+}
+
+TEST(BufferPool, PoliciesKeepData)
+{
+    shdb::PageIndex pool_size = 5;
+    for (auto policy : {shdb::CachePolicy::clock, shdb::CachePolicy::two_queue, shdb::CachePolicy::arc})
+    {
+        auto db = shdb::connect("./mydb", pool_size, shdb::BufferPoolOptions{.cache_policy = policy});
+        if (db->checkTableExists("test_table"))
+            db->dropTable("test_table");
+        db->createTable("test_table", fixed_schema);
+        auto table = db->getTable("test_table", fixed_schema);
+
+        std::vector<std::pair<shdb::RowId, shdb::Row>> rows;
+        for (uint64_t row_count = 0; table->getPageCount() < 4 * pool_size; ++row_count)
+            rows.emplace_back(table->insertRow(makeRow(row_count)), makeRow(row_count));
+
+        for (auto & [row_id, row] : rows)
+            ASSERT_EQ(table->getRow(row_id), row);
+
+        size_t index = 0;
+        for (auto row : shdb::Scan(table))
+        {
+            if (!row.empty())
+            {
+                ASSERT_EQ(row, rows[index++].second);
+            }
+        }
+        ASSERT_EQ(index, rows.size());
+    }
+}
+
+TEST(BufferPool, PoliciesErase)
+{
+    for (auto policy : {shdb::CachePolicy::clock, shdb::CachePolicy::two_queue, shdb::CachePolicy::arc})
+    {
+        auto cache = shdb::createCache<shdb::PageId, int>(policy, {0, 1, 2, 3});
+        std::map<int, shdb::PageId> frame_to_page;
+        for (shdb::PageIndex page_index = 0; page_index < 6; ++page_index)
+            frame_to_page[cache->put({0, page_index})] = {0, page_index};
+
+        /// Erased page frees its frame for the next put, even if it was locked
+        ASSERT_EQ(cache->find(frame_to_page[2]), std::make_pair(true, 2));
+        cache->lock(frame_to_page[2]);
+        cache->erase(frame_to_page[2]);
+        ASSERT_FALSE(cache->contains(frame_to_page[2]));
+        ASSERT_EQ(cache->getUnlockedCount(), 4u);
+        ASSERT_EQ(cache->put({1, 0}), 2);
+        ASSERT_TRUE(cache->contains({1, 0}));
+    }
+}
@@ -0,0 +1,59 @@
+#include <map>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "cache.h"
+#include "page.h"
+
+TEST(BufferPool, PageTable)
+{
+    size_t max_size = 100;
+    shdb::PageTable<shdb::PageId, int> table(max_size);
+    std::map<shdb::PageId, int> expected;
+    std::mt19937 generator(42);
+
+    for (int step = 0; step < 100000; ++step)
+    {
+        auto key = shdb::PageId{3 + generator() % 4, generator() % 64};
+        if (generator() % 2 == 0 && expected.size() < max_size)
+        {
+            table.insertOrAssign(key, step);
+            expected[key] = step;
+        }
+        else
+        {
+            ASSERT_EQ(table.erase(key), expected.erase(key) == 1);
+        }
+
+        ASSERT_EQ(table.size(), expected.size());
+        auto probe = shdb::PageId{3 + generator() % 4, generator() % 64};
+        auto * value = table.find(probe);
+        if (auto it = expected.find(probe); it != expected.end())
+        {
+            ASSERT_NE(value, nullptr);
+            ASSERT_EQ(*value, it->second);
+        }
+        else
+        {
+            ASSERT_EQ(value, nullptr);
+        }
+    }
+}
+
+TEST(BufferPool, UnpinnedPagesStayResident)
+{
+    std::vector<int> frames{0, 1, 2, 3};
+    for (auto policy : {shdb::CachePolicy::clock, shdb::CachePolicy::two_queue, shdb::CachePolicy::arc})
+    {
+        auto cache = shdb::createCache<shdb::PageId, int>(policy, frames);
+        auto key = shdb::PageId{5, 7};
+        auto frame_index = cache->put(key);
+        cache->lock(key);
+        cache->unlock(key);
+
+        auto [found, found_index] = cache->find(key);
+        ASSERT_TRUE(found);
+        ASSERT_EQ(found_index, frame_index);
+    }
+}
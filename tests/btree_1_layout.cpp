@@ -31,18 +31,19 @@ public:
         : key_schema(std::move(key_schema_))
         , key_marshal(std::make_shared<shdb::Marshal>(key_schema))
         , frame_memory(std::make_unique<uint8_t[]>(shdb::PageSize))
-        , frame(std::make_shared<shdb::Frame>(nullptr, 0, frame_memory.get()))
         , max_keys_size(calculateMaxKeySize(key_marshal->getFixedRowSpace()))
-        , btree_page(std::make_shared<shdb::BTreePage>(frame, key_marshal, key_marshal->getFixedRowSpace(), max_keys_size))
     {
-        btree_page->setPageType(PageType);
+        getBTreePage()->setPageType(PageType);
     }
 
     size_t getMaxKeysSize() const { return max_keys_size; }
 
-    const std::shared_ptr<shdb::BTreePage> & getBTreePage() const { return btree_page; }
-
-    std::shared_ptr<shdb::BTreePage> & getBTreePage() { return btree_page; }
+    /// Frame without a pool views holder memory directly and pins nothing
+    shdb::BTreePagePtr getBTreePage()
+    {
+        return shdb::BTreePagePtr(
+            shdb::Frame(nullptr, 0, frame_memory.get()), key_marshal.get(), key_marshal->getFixedRowSpace(), max_keys_size);
+    }
 
 private:
     static size_t calculateMaxKeySize(size_t key_size)
@@ -56,9 +57,7 @@ private:
     std::shared_ptr<shdb::Schema> key_schema;
     std::shared_ptr<shdb::Marshal> key_marshal;
     std::unique_ptr<uint8_t[]> frame_memory;
-    std::shared_ptr<shdb::Frame> frame;
     size_t max_keys_size = 0;
-    std::shared_ptr<shdb::BTreePage> btree_page;
 };
 
 }
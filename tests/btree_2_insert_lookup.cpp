@@ -46,13 +46,13 @@ void validateBTree(shdb::BTree & btree, const std::vector<std::pair<shdb::Row, s
     while (!current_page->isLeafPage())
     {
         ASSERT_TRUE(current_page->isInternalPage());
-        shdb::BTreeInternalPage internal_page(current_page);
+        shdb::BTreeInternalPage internal_page(std::move(current_page));
         current_page = index_table.getPage(internal_page.getValue(0));
     }
 
     std::vector<std::pair<shdb::Row, shdb::RowId>> entries;
 
-    shdb::BTreeLeafPage leaf_page(current_page);
+    shdb::BTreeLeafPage leaf_page(std::move(current_page));
     size_t entry_offset = 0;
 
     while (true)
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <string>
+#include <tuple>
+
+#include <gtest/gtest.h>
+
+#include "accessors.h"
+#include "ast.h"
+#include "column_batch.h"
+#include "db.h"
+#include "executor.h"
+#include "expression.h"
+#include "interpreter.h"
+
+namespace
+{
+
+constexpr int64_t row_count = 5000;
+
+void populate(shdb::Interpreter & interpreter)
+{
+    interpreter.execute("DROP TABLE test_table");
+    interpreter.execute("CREATE TABLE test_table (id int64, age int64, name string)");
+
+    std::string query = "INSERT test_table VALUES ";
+    for (int64_t id = 0; id < row_count; ++id) {
+        if (id != 0)
+            query += ", ";
+        query += "(" + std::to_string(id) + ", " + std::to_string(id % 100) + ", \"name" + std::to_string(id % 7) + "\")";
+    }
+    interpreter.execute(query);
+}
+
+shdb::Rows collectBatches(shdb::IExecutor & executor, size_t & batch_count)
+{
+    shdb::Rows rows;
+    shdb::ColumnBatch batch;
+    while (executor.nextBatch(batch)) {
+        EXPECT_FALSE(batch.empty());
+        EXPECT_LE(batch.getRowCount(), shdb::ColumnBatch::DefaultSize * 2);
+        ++batch_count;
+        for (auto row : batch.getSelection())
+            rows.push_back(batch.getRow(row));
+    }
+    return rows;
+}
+
+shdb::Rows collectRows(shdb::IExecutor & executor)
+{
+    shdb::Rows rows;
+    std::optional<shdb::Row> row;
+    while ((row = executor.next()).has_value())
+        rows.push_back(std::move(*row));
+    return rows;
+}
+
+}
+
+TEST(Batch, ColumnBatch)
+{
+    auto schema = std::make_shared<shdb::Schema>(shdb::Schema{{"id", shdb::Type::int64}, {"name", shdb::Type::string}});
+    shdb::ColumnBatch batch(schema);
+    batch.appendRow({int64_t(2), std::string("b")});
+    batch.appendRow({shdb::Null{}, std::string("a")});
+    batch.appendRow({int64_t(1), shdb::Null{}});
+    ASSERT_EQ(batch.size(), 3);
+    ASSERT_EQ(batch.getColumn(0).getInt64s(), (std::vector<int64_t>{2, 0, 1}));
+    ASSERT_TRUE(batch.getColumn(0).isNull(1));
+    ASSERT_FALSE(batch.getColumn(1).isNull(1));
+    ASSERT_EQ(batch.getRow(2), (shdb::Row{int64_t(1), shdb::Null{}}));
+
+    /// Null is ordered first, like Value
+    ASSERT_LT(batch.getColumn(0).compare(1, batch.getColumn(0), 2), 0);
+    ASSERT_GT(batch.getColumn(0).compare(0, batch.getColumn(0), 2), 0);
+
+    batch.setSelection({0, 2});
+    shdb::ColumnBatch copy(schema);
+    copy.appendSelected(batch);
+    ASSERT_EQ(copy.size(), 2);
+    ASSERT_EQ(copy.getRow(0), (shdb::Row{int64_t(2), std::string("b")}));
+    ASSERT_EQ(copy.getRow(1), (shdb::Row{int64_t(1), shdb::Null{}}));
+
+    batch.reset(schema);
+    ASSERT_TRUE(batch.empty());
+    ASSERT_EQ(batch.getRowCount(), 0);
+}
+
+TEST(Batch, ScanFilterProjection)
+{
+    auto db = shdb::connect("./mydb", 16);
+    auto interpreter = shdb::Interpreter(db);
+    populate(interpreter);
+
+    auto make_executor = [&]() {
+        auto schema = db->findTableSchema("test_table");
+        auto accessor = std::make_shared<shdb::SchemaAccessor>(schema);
+        auto executor = shdb::createReadFromTableExecutor(db->getTable("test_table"), schema, std::nullopt);
+        auto predicate = shdb::newBinaryOperator(
+            shdb::BinaryOperatorCode::lt, shdb::newIdentifier("age"), shdb::newNumberLiteral(10));
+        executor = shdb::createFilterExecutor(std::move(executor), shdb::buildExpression(predicate, accessor));
+        shdb::ASTs projection{
+            shdb::newIdentifier("name"),
+            shdb::newBinaryOperator(shdb::BinaryOperatorCode::mul, shdb::newIdentifier("id"), shdb::newNumberLiteral(2))};
+        return shdb::createExpressionsExecutor(std::move(executor), shdb::buildExpressions(projection, accessor));
+    };
+
+    /// Row at a time and batch paths return the same rows in the same order
+    size_t batch_count = 0;
+    auto batch_executor = make_executor();
+    auto row_executor = make_executor();
+    auto batch_rows = collectBatches(*batch_executor, batch_count);
+    ASSERT_EQ(batch_rows, collectRows(*row_executor));
+    ASSERT_EQ(batch_rows.size(), row_count / 10);
+    ASSERT_GT(batch_count, 0);
+
+    auto rows = interpreter.execute("SELECT id FROM test_table WHERE (age < 10) AND (id >= 100)").getRows();
+    ASSERT_EQ(rows.size(), row_count / 10 - 10);
+    for (const auto & row : rows) {
+        auto id = std::get<int64_t>(row[0]);
+        ASSERT_TRUE(id >= 100 && id % 100 < 10);
+    }
+}
+
+TEST(Batch, SortAcrossBatches)
+{
+    auto db = shdb::connect("./mydb", 16);
+    auto interpreter = shdb::Interpreter(db);
+    populate(interpreter);
+
+    auto rows = interpreter.execute("SELECT id, age FROM test_table ORDER BY age DESC, id").getRows();
+    ASSERT_EQ(rows.size(), row_count);
+    for (size_t i = 1; i < rows.size(); ++i) {
+        auto previous = std::make_pair(-std::get<int64_t>(rows[i - 1][1]), std::get<int64_t>(rows[i - 1][0]));
+        auto current = std::make_pair(-std::get<int64_t>(rows[i][1]), std::get<int64_t>(rows[i][0]));
+        ASSERT_LT(previous, current);
+    }
+    ASSERT_EQ(rows.front(), (shdb::Row{int64_t(99), int64_t(99)}));
+    ASSERT_EQ(rows.back(), (shdb::Row{row_count - 100, int64_t(0)}));
+}
+
+TEST(Batch, JoinWithDuplicateKeys)
+{
+    auto db = shdb::connect("./mydb", 16);
+    auto interpreter = shdb::Interpreter(db);
+    interpreter.execute("DROP TABLE left_table");
+    interpreter.execute("DROP TABLE right_table");
+    interpreter.execute("CREATE TABLE left_table (key int64, left_value string)");
+    interpreter.execute("CREATE TABLE right_table (key int64, right_value string)");
+    interpreter.execute("INSERT left_table VALUES (1, \"a\"), (1, \"b\"), (2, \"c\"), (3, \"d\")");
+    interpreter.execute("INSERT right_table VALUES (1, \"x\"), (2, \"y\"), (2, \"z\"), (4, \"w\")");
+
+    auto rows = interpreter.execute("SELECT left_value, right_value FROM left_table, right_table").getRows();
+    std::sort(rows.begin(), rows.end(), [](const shdb::Row & lhs, const shdb::Row & rhs) {
+        return std::make_pair(std::get<std::string>(lhs[0]), std::get<std::string>(lhs[1]))
+            < std::make_pair(std::get<std::string>(rhs[0]), std::get<std::string>(rhs[1]));
+    });
+    ASSERT_EQ(
+        rows,
+        (std::vector<shdb::Row>{
+            {std::string("a"), std::string("x")},
+            {std::string("b"), std::string("x")},
+            {std::string("c"), std::string("y")},
+            {std::string("c"), std::string("z")}}));
+}
+
+TEST(Batch, LogicalOperatorsShortCircuit)
+{
+    auto db = shdb::connect("./mydb", 16);
+    auto interpreter = shdb::Interpreter(db);
+    populate(interpreter);
+
+    /// Right side divides by id, it must not run for the id = 0 row left side already decided
+    auto make_predicate = [](shdb::BinaryOperatorCode code, shdb::BinaryOperatorCode guard) {
+        return shdb::newBinaryOperator(
+            code,
+            shdb::newBinaryOperator(guard, shdb::newIdentifier("id"), shdb::newNumberLiteral(0)),
+            shdb::newBinaryOperator(
+                shdb::BinaryOperatorCode::gt,
+                shdb::newBinaryOperator(shdb::BinaryOperatorCode::div, shdb::newNumberLiteral(100), shdb::newIdentifier("id")),
+                shdb::newNumberLiteral(5)));
+    };
+    auto schema = db->findTableSchema("test_table");
+    auto accessor = std::make_shared<shdb::SchemaAccessor>(schema);
+    for (auto [code, guard, expected] :
+         {std::tuple{shdb::BinaryOperatorCode::land, shdb::BinaryOperatorCode::ne, int64_t(16)},
+          std::tuple{shdb::BinaryOperatorCode::lor, shdb::BinaryOperatorCode::eq, int64_t(17)}}) {
+        auto predicate = make_predicate(code, guard);
+        auto executor = shdb::createReadFromTableExecutor(db->getTable("test_table"), schema, std::nullopt);
+        executor = shdb::createFilterExecutor(std::move(executor), shdb::buildInterpretedExpression(predicate, accessor));
+        size_t batch_count = 0;
+        ASSERT_EQ(collectBatches(*executor, batch_count).size(), expected);
+
+        shdb::ColumnBatch batch(schema);
+        batch.appendRow({int64_t(0), int64_t(0), std::string()});
+        batch.appendRow({int64_t(50), int64_t(0), std::string()});
+        batch.appendRow({int64_t(4), int64_t(0), std::string()});
+        shdb::ColumnVector output(shdb::Type::boolean);
+        shdb::buildInterpretedExpression(predicate, accessor)->evaluate(batch, output);
+        ASSERT_EQ(output.getBooleans(), (std::vector<uint8_t>{code == shdb::BinaryOperatorCode::lor, 0, 1}));
+    }
+
+    auto rows = interpreter.execute("SELECT id FROM test_table WHERE (id <> 0) AND (100 / id > 5)").getRows();
+    ASSERT_EQ(rows.size(), 16);
+    rows = interpreter.execute("SELECT id FROM test_table WHERE (id = 0) OR (100 / id > 5)").getRows();
+    ASSERT_EQ(rows.size(), 17);
+}
+
+TEST(Batch, ScanReadsOnlyListedColumns)
+{
+    auto db = shdb::connect("./mydb", 16);
+    auto interpreter = shdb::Interpreter(db);
+    populate(interpreter);
+
+    auto schema = db->findTableSchema("test_table");
+    auto make_executor = [&]() {
+        return shdb::createReadFromTableExecutor(db->getTable("test_table"), schema, std::nullopt, std::vector<size_t>{2, 0});
+    };
+    auto executor = make_executor();
+    ASSERT_EQ(*executor->getOutputSchema(), (shdb::Schema{{"name", shdb::Type::string}, {"id", shdb::Type::int64}}));
+    size_t batch_count = 0;
+    auto batch_rows = collectBatches(*executor, batch_count);
+    ASSERT_EQ(batch_rows.size(), row_count);
+    ASSERT_EQ(batch_rows[9], (shdb::Row{std::string("name2"), int64_t(9)}));
+    auto row_executor = make_executor();
+    ASSERT_EQ(collectRows(*row_executor), batch_rows);
+
+    /// Every stage resolves its columns in pruned scan output
+    auto rows = interpreter
+                    .execute("SELECT name, sum(id) FROM test_table WHERE age < 3 GROUP BY name HAVING sum(id) > 0 ORDER BY name")
+                    .getRows();
+    ASSERT_EQ(rows.size(), 7);
+    ASSERT_EQ(rows[0][0], shdb::Value(std::string("name0")));
+    rows = interpreter.execute("SELECT 1 FROM test_table WHERE id < 10").getRows();
+    ASSERT_EQ(rows, shdb::Rows(10, shdb::Row{int64_t(1)}));
+}
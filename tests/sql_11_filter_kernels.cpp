@@ -0,0 +1,213 @@
+#include <limits>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "db.h"
+#include "filter_kernels.h"
+#include "interpreter.h"
+
+namespace
+{
+
+const std::vector<shdb::KernelSet> kernel_sets{shdb::KernelSet::scalar, shdb::KernelSet::avx2, shdb::KernelSet::avx512};
+
+const std::vector<shdb::CompareOperation> operations{
+    shdb::CompareOperation::eq,
+    shdb::CompareOperation::ne,
+    shdb::CompareOperation::lt,
+    shdb::CompareOperation::le,
+    shdb::CompareOperation::gt,
+    shdb::CompareOperation::ge};
+
+template <class T>
+bool compareReference(shdb::CompareOperation operation, T lhs, T rhs)
+{
+    switch (operation)
+    {
+        case shdb::CompareOperation::eq:
+            return lhs == rhs;
+        case shdb::CompareOperation::ne:
+            return lhs != rhs;
+        case shdb::CompareOperation::lt:
+            return lhs < rhs;
+        case shdb::CompareOperation::le:
+            return lhs <= rhs;
+        case shdb::CompareOperation::gt:
+            return lhs > rhs;
+        case shdb::CompareOperation::ge:
+            return lhs >= rhs;
+    }
+    return false;
+}
+
+bool getBit(const shdb::SelectionBitmap & bitmap, size_t index)
+{
+    return (bitmap[index / 64] >> (index % 64)) & 1;
+}
+
+/// Values are taken from a small pool, so equal values and extremes of the type are frequent
+template <class T>
+std::vector<T> generateValues(size_t size, std::mt19937_64 & generator)
+{
+    std::vector<T> pool{0, 1, 2, std::numeric_limits<T>::max(), std::numeric_limits<T>::min(), static_cast<T>(std::numeric_limits<T>::max() / 2 + 1)};
+    if constexpr (std::is_same_v<T, uint8_t>)
+        pool = {0, 1};
+    std::vector<T> values(size);
+    for (auto & value : values)
+        value = pool[generator() % pool.size()];
+    return values;
+}
+
+template <class T>
+void checkKernels()
+{
+    std::mt19937_64 generator(42);
+    for (size_t size : {0, 1, 31, 63, 64, 65, 127, 1000})
+    {
+        auto lhs = generateValues<T>(size, generator);
+        auto rhs = generateValues<T>(size, generator);
+        auto constant = generateValues<T>(1, generator)[0];
+
+        for (auto operation : operations)
+        {
+            shdb::SelectionBitmap with_constant(shdb::getBitmapWordCount(size), ~uint64_t(0));
+            shdb::SelectionBitmap with_column(shdb::getBitmapWordCount(size), ~uint64_t(0));
+            shdb::compareWithConstant(operation, lhs.data(), size, constant, with_constant.data());
+            shdb::compareColumns(operation, lhs.data(), rhs.data(), size, with_column.data());
+
+            for (size_t index = 0; index < size; ++index)
+            {
+                ASSERT_EQ(getBit(with_constant, index), compareReference(operation, lhs[index], constant));
+                ASSERT_EQ(getBit(with_column, index), compareReference(operation, lhs[index], rhs[index]));
+            }
+            if (size % 64 != 0)
+            {
+                ASSERT_EQ(with_constant.back() >> (size % 64), 0);
+                ASSERT_EQ(with_column.back() >> (size % 64), 0);
+            }
+        }
+    }
+}
+
+void populate(shdb::Interpreter & interpreter)
+{
+    interpreter.execute("DROP TABLE test_table");
+    interpreter.execute("CREATE TABLE test_table (a int64, b int64)");
+    std::string query = "INSERT test_table VALUES ";
+    for (int64_t a = 0; a < 3000; ++a)
+    {
+        if (a != 0)
+            query += ", ";
+        query += "(" + std::to_string(a) + ", " + std::to_string((a * 7) % 13) + ")";
+    }
+    interpreter.execute(query);
+}
+
+size_t countRows(shdb::Interpreter & interpreter, const std::string & where)
+{
+    return interpreter.execute("SELECT a FROM test_table WHERE " + where).getRows().size();
+}
+
+}
+
+TEST(FilterKernels, Compare)
+{
+    auto default_kernel_set = shdb::getKernelSet();
+    for (auto kernel_set : kernel_sets)
+    {
+        if (!shdb::isKernelSetSupported(kernel_set))
+            continue;
+        shdb::setKernelSet(kernel_set);
+        checkKernels<int64_t>();
+        checkKernels<uint64_t>();
+        checkKernels<uint8_t>();
+    }
+    shdb::setKernelSet(default_kernel_set);
+}
+
+TEST(FilterKernels, Bitmaps)
+{
+    shdb::SelectionBitmap lhs{0b1100, 0};
+    shdb::SelectionBitmap rhs{0b1010, 1};
+    shdb::andBitmaps(lhs.data(), rhs.data(), 70);
+    ASSERT_EQ(lhs, (shdb::SelectionBitmap{0b1000, 0}));
+    shdb::orBitmaps(lhs.data(), rhs.data(), 70);
+    ASSERT_EQ(lhs, (shdb::SelectionBitmap{0b1010, 1}));
+    shdb::notBitmap(lhs.data(), 70);
+    ASSERT_EQ(lhs, (shdb::SelectionBitmap{~uint64_t(0b1010), 0b111110}));
+
+    std::vector<uint32_t> selection(70);
+    for (size_t index = 0; index < selection.size(); ++index)
+        selection[index] = index * 2;
+    std::vector<uint32_t> selected;
+    shdb::selectFromBitmap(rhs.data(), selection, selected);
+    ASSERT_EQ(selected, (std::vector<uint32_t>{2, 6, 128}));
+
+    /// Second of three set bits is dropped
+    shdb::SelectionBitmap values{0b101};
+    shdb::depositBitmap(rhs.data(), values.data(), 70);
+    ASSERT_EQ(rhs, (shdb::SelectionBitmap{0b10, 1}));
+}
+
+TEST(FilterKernels, Where)
+{
+    auto db = shdb::connect("./mydb", 16);
+    auto interpreter = shdb::Interpreter(db);
+    populate(interpreter);
+
+    auto default_kernel_set = shdb::getKernelSet();
+    for (auto kernel_set : kernel_sets)
+    {
+        if (!shdb::isKernelSetSupported(kernel_set))
+            continue;
+        shdb::setKernelSet(kernel_set);
+        ASSERT_EQ(countRows(interpreter, "a < 10"), 10);
+        ASSERT_EQ(countRows(interpreter, "10 > a"), 10);
+        ASSERT_EQ(countRows(interpreter, "(a < 100) AND (b = 3)"), 8);
+        ASSERT_EQ(countRows(interpreter, "(a >= 2990) OR (a = 5)"), 11);
+        ASSERT_EQ(countRows(interpreter, "!(a < 2990)"), 10);
+        ASSERT_EQ(countRows(interpreter, "a < b"), 6);
+        ASSERT_EQ(countRows(interpreter, "(a + 1 = b) AND (a < 13)"), 1);
+        ASSERT_EQ(countRows(interpreter, "((b < 3) AND (b > 1)) AND !(a > 13)"), 1);
+    }
+    shdb::setKernelSet(default_kernel_set);
+}
+
+TEST(FilterKernels, KernelSetsAgree)
+{
+    /// Odd size leaves a partial last word after the vector loops
+    constexpr size_t size = (1 << 16) + 37;
+    std::vector<int64_t> values(size);
+    std::vector<int64_t> other(size);
+    std::mt19937_64 generator(42);
+    for (size_t index = 0; index < size; ++index)
+    {
+        values[index] = static_cast<int64_t>(generator() % 100) - 50;
+        other[index] = static_cast<int64_t>(generator() % 100) - 50;
+    }
+
+    auto default_kernel_set = shdb::getKernelSet();
+    for (auto operation : operations)
+    {
+        shdb::setKernelSet(shdb::KernelSet::scalar);
+        shdb::SelectionBitmap expected_constant(shdb::getBitmapWordCount(size));
+        shdb::SelectionBitmap expected_column(shdb::getBitmapWordCount(size));
+        shdb::compareWithConstant(operation, values.data(), size, 0, expected_constant.data());
+        shdb::compareColumns(operation, values.data(), other.data(), size, expected_column.data());
+
+        for (auto kernel_set : kernel_sets)
+        {
+            if (!shdb::isKernelSetSupported(kernel_set))
+                continue;
+            shdb::setKernelSet(kernel_set);
+            shdb::SelectionBitmap with_constant(shdb::getBitmapWordCount(size));
+            shdb::SelectionBitmap with_column(shdb::getBitmapWordCount(size));
+            shdb::compareWithConstant(operation, values.data(), size, 0, with_constant.data());
+            shdb::compareColumns(operation, values.data(), other.data(), size, with_column.data());
+            ASSERT_EQ(with_constant, expected_constant) << static_cast<int>(kernel_set);
+            ASSERT_EQ(with_column, expected_column) << static_cast<int>(kernel_set);
+        }
+    }
+    shdb::setKernelSet(default_kernel_set);
+}
@@ -0,0 +1,182 @@
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "expression.h"
+#include "lexer.h"
+#include "parser.hpp"
+
+namespace
+{
+
+auto schema = std::make_shared<shdb::Schema>(shdb::Schema{
+    {"a", shdb::Type::int64}, {"b", shdb::Type::int64}, {"c", shdb::Type::uint64}, {"s", shdb::Type::string}, {"f", shdb::Type::boolean}});
+
+shdb::ASTPtr parseExpression(const std::string & expression)
+{
+    std::string query = "SELECT " + expression;
+    shdb::Lexer lexer(query.c_str(), query.c_str() + query.size());
+    shdb::ASTPtr result;
+    std::string error;
+    shdb::Parser parser(lexer, result, error);
+    parser.parse();
+    if (!result || !error.empty())
+        throw std::runtime_error("Bad input: " + error);
+    return std::static_pointer_cast<shdb::ASTSelectQuery>(result)->getProjectionList().getChildren().front();
+}
+
+shdb::Rows generateRows(size_t count, bool with_nulls)
+{
+    std::mt19937_64 generator(42);
+    shdb::Rows rows;
+    for (size_t index = 0; index < count; ++index)
+    {
+        shdb::Row row{
+            static_cast<int64_t>(generator() % 20),
+            static_cast<int64_t>(generator() % 20) - 10,
+            static_cast<uint64_t>(generator() % 3),
+            std::string(generator() % 2 ? "x" : "abc"),
+            static_cast<bool>(generator() % 2)};
+        if (with_nulls && generator() % 4 == 0)
+            row[generator() % row.size()] = shdb::Null{};
+        rows.push_back(std::move(row));
+    }
+    return rows;
+}
+
+shdb::ColumnBatch makeBatch(const shdb::Rows & rows)
+{
+    shdb::ColumnBatch batch(schema);
+    for (const auto & row : rows)
+        batch.appendRow(row);
+    return batch;
+}
+
+/// Value of expression, or nullopt if evaluation throws
+std::optional<shdb::Value> tryEvaluate(shdb::IExpression & expression, const shdb::Row & row)
+{
+    try
+    {
+        return expression.evaluate(row);
+    }
+    catch (const std::exception &)
+    {
+        return std::nullopt;
+    }
+}
+
+const std::vector<std::string> expressions{
+    "(a - 30) * 2 <= b * 3 * 4",
+    "a + b * 2 - -a / 3",
+    "(a < b) AND !(a = 3)",
+    "(a > 10) OR (s = \"x\")",
+    "(a = 1) OR (a = 2)",
+    "c = c",
+    "c <> c",
+    "f = (a < 5)",
+    "s = \"abc\"",
+    "\"abc\" <> s",
+    "a = s",
+    "a = a",
+    "7 > a",
+    "(a <> 0) AND (100 / a > 5)",
+    "(a = 0) OR (100 / a > 5)",
+};
+
+}
+
+TEST(CompiledExpression, SameResultsAsInterpreted)
+{
+    auto accessor = std::make_shared<shdb::SchemaAccessor>(schema);
+    for (bool with_nulls : {false, true})
+    {
+        auto rows = generateRows(500, with_nulls);
+        auto batch = makeBatch(rows);
+        for (const auto & text : expressions)
+        {
+            auto ast = parseExpression(text);
+            auto compiled = shdb::buildExpression(ast, accessor);
+            auto interpreted = shdb::buildInterpretedExpression(ast, accessor);
+            ASSERT_EQ(compiled->getResultType(), interpreted->getResultType()) << text;
+
+            for (const auto & row : rows)
+                ASSERT_EQ(tryEvaluate(*compiled, row), tryEvaluate(*interpreted, row)) << text;
+
+            if (with_nulls)
+                continue;
+            shdb::ColumnVector compiled_output(compiled->getResultType());
+            shdb::ColumnVector interpreted_output(interpreted->getResultType());
+            compiled->evaluate(batch, compiled_output);
+            interpreted->evaluate(batch, interpreted_output);
+            ASSERT_EQ(compiled_output.size(), rows.size()) << text;
+            for (size_t row = 0; row < rows.size(); ++row)
+                ASSERT_EQ(compiled_output.getValue(row), interpreted_output.getValue(row)) << text;
+
+            if (compiled->getResultType() != shdb::Type::boolean)
+                continue;
+            shdb::SelectionBitmap compiled_bitmap;
+            shdb::SelectionBitmap interpreted_bitmap;
+            compiled->evaluateFilter(batch, compiled_bitmap);
+            interpreted->evaluateFilter(batch, interpreted_bitmap);
+            ASSERT_EQ(compiled_bitmap, interpreted_bitmap) << text;
+        }
+    }
+}
+
+TEST(CompiledExpression, NullEquality)
+{
+    auto accessor = std::make_shared<shdb::SchemaAccessor>(schema);
+    auto equal = shdb::buildExpression(parseExpression("a = b"), accessor);
+    shdb::Rows rows{
+        {shdb::Null{}, shdb::Null{}, uint64_t(0), std::string(), true},
+        {shdb::Null{}, int64_t(1), uint64_t(0), std::string(), true},
+        {int64_t(1), int64_t(1), uint64_t(0), std::string(), true}};
+    ASSERT_EQ(equal->evaluate(rows[0]), shdb::Value(true));
+    ASSERT_EQ(equal->evaluate(rows[1]), shdb::Value(false));
+    ASSERT_EQ(equal->evaluate(rows[2]), shdb::Value(true));
+
+    shdb::ColumnVector output(shdb::Type::boolean);
+    equal->evaluate(makeBatch(rows), output);
+    ASSERT_EQ(output.getBooleans(), (std::vector<uint8_t>{1, 0, 1}));
+
+    ASSERT_ANY_THROW(shdb::buildExpression(parseExpression("a + 1"), accessor)->evaluate(rows[0]));
+}
+
+TEST(CompiledExpression, SparseSelection)
+{
+    auto accessor = std::make_shared<shdb::SchemaAccessor>(schema);
+    auto rows = generateRows(2000, false);
+    auto batch = makeBatch(rows);
+
+    /// Columns of batch with a sparse selection are gathered, not read in place
+    std::vector<uint32_t> selection;
+    for (uint32_t row = 0; row < rows.size(); row += 3)
+        selection.push_back(row);
+    batch.setSelection(selection);
+
+    for (const auto & text : {"(50 - a) * 2 <= b * 3 * 4", "((a - b) * (a + b) > 10) AND !(s = \"x\")", "(a < 10) OR (c = 2)", "a < b"})
+    {
+        auto ast = parseExpression(text);
+        for (bool compile : {false, true})
+        {
+            auto expression = compile ? shdb::buildExpression(ast, accessor) : shdb::buildInterpretedExpression(ast, accessor);
+
+            shdb::ColumnVector output(shdb::Type::boolean);
+            expression->evaluate(batch, output);
+            shdb::SelectionBitmap bitmap;
+            expression->evaluateFilter(batch, bitmap);
+            ASSERT_EQ(output.size(), selection.size()) << text;
+
+            size_t matches = 0;
+            for (size_t index = 0; index < selection.size(); ++index)
+            {
+                auto expected = std::get<bool>(expression->evaluate(rows[selection[index]]));
+                ASSERT_EQ(output.getValue(index), shdb::Value(expected)) << text;
+                ASSERT_EQ(static_cast<bool>(bitmap[index / 64] >> (index % 64) & 1), expected) << text;
+                matches += expected;
+            }
+            ASSERT_GT(matches, 0) << text;
+            ASSERT_LT(matches, selection.size()) << text;
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "ast_visitor.h"
+#include "db.h"
+#include "interpreter.h"
+#include "lexer.h"
+#include "parser.hpp"
+
+namespace
+{
+
+shdb::ASTPtr parseQuery(const std::string & query)
+{
+    shdb::Lexer lexer(query.c_str(), query.c_str() + query.size());
+    shdb::ASTPtr result;
+    std::string error;
+    shdb::Parser parser(lexer, result, error);
+    parser.parse();
+    if (!result || !error.empty())
+        throw std::runtime_error("Bad input: " + error);
+    return result;
+}
+
+std::string fold(const std::string & expression)
+{
+    auto query = parseQuery("SELECT " + expression);
+    auto folded = shdb::foldConstants(query);
+    return shdb::toString(*std::static_pointer_cast<shdb::ASTSelectQuery>(folded)->getProjectionList().getChildren().front());
+}
+
+std::string parseAndPrint(const std::string & expression)
+{
+    auto query = parseQuery("SELECT " + expression);
+    return shdb::toString(*std::static_pointer_cast<shdb::ASTSelectQuery>(query)->getProjectionList().getChildren().front());
+}
+
+void populate(shdb::Interpreter & interpreter)
+{
+    interpreter.execute("DROP TABLE test_table");
+    interpreter.execute("CREATE TABLE test_table (id int64, age int64, name string, adult boolean)");
+    interpreter.execute("INSERT test_table VALUES (0, 20, \"Ann\", 1 > 0), (1, 12, \"Bob\", 1 > 2), (2, 19, \"Sara\", !(1 = 2))");
+}
+
+}
+
+TEST(ConstantFolding, Rewrite)
+{
+    ASSERT_EQ(fold("1 + 2 * 3"), "7");
+    ASSERT_EQ(fold("-(2 - 5)"), "3");
+    ASSERT_EQ(fold("7 / 2"), "3");
+    ASSERT_EQ(fold("1 < 2"), "true");
+    ASSERT_EQ(fold("\"a\" = \"a\""), "true");
+    ASSERT_EQ(fold("\"a\" = 1"), "false");
+    ASSERT_EQ(fold("!(1 = 1)"), "false");
+    ASSERT_EQ(fold("x > 2 * 5"), parseAndPrint("x > 10"));
+    ASSERT_EQ(fold("(1 = 1) AND (x > 2 * 5)"), parseAndPrint("x > 10"));
+    ASSERT_EQ(fold("(x > 1) AND (1 = 2)"), "false");
+    ASSERT_EQ(fold("(1 = 2) OR (x > 1)"), parseAndPrint("x > 1"));
+    ASSERT_EQ(fold("(x > 1) OR !(1 = 2)"), "true");
+    ASSERT_EQ(fold("!!(x > 1)"), parseAndPrint("x > 1"));
+
+    /// Errors and operands that are not boolean are left to evaluation
+    ASSERT_EQ(fold("x / 0"), parseAndPrint("x / 0"));
+    ASSERT_EQ(fold("1 / 0"), parseAndPrint("1 / 0"));
+    ASSERT_EQ(fold("\"a\" < \"b\""), parseAndPrint("\"a\" < \"b\""));
+    ASSERT_EQ(fold("!!x"), parseAndPrint("!!x"));
+    ASSERT_EQ(fold("x AND (1 = 1)"), "(x) AND (true)");
+}
+
+TEST(ConstantFolding, Queries)
+{
+    auto db = shdb::connect("./mydb", 16);
+    auto interpreter = shdb::Interpreter(db);
+    populate(interpreter);
+
+    ASSERT_EQ(
+        interpreter.execute("SELECT id, adult FROM test_table").getRows(),
+        (std::vector<shdb::Row>{{int64_t(0), true}, {int64_t(1), false}, {int64_t(2), true}}));
+    ASSERT_EQ(
+        interpreter.execute("SELECT id FROM test_table WHERE (1 = 1) AND (age > 2 * 9)").getRows(),
+        (std::vector<shdb::Row>{{int64_t(0)}, {int64_t(2)}}));
+    ASSERT_EQ(interpreter.execute("SELECT id FROM test_table WHERE (1 < 2) OR (age > 100)").getRows().size(), 3);
+    ASSERT_EQ(interpreter.execute("SELECT 2 * 3, !(1 > 2)").getRows(), (std::vector<shdb::Row>{{int64_t(6), true}}));
+
+    /// Always-false predicate does not read the table
+    auto page_accessed = db->getStatistics()->page_accessed;
+    ASSERT_TRUE(interpreter.execute("SELECT id FROM test_table WHERE (age > 10) AND (1 = 2)").getRows().empty());
+    ASSERT_TRUE(interpreter.execute("SELECT * FROM test_table, test_table WHERE 2 * 2 = 5").getRows().empty());
+    ASSERT_EQ(db->getStatistics()->page_accessed, page_accessed);
+    ASSERT_ANY_THROW(interpreter.execute("SELECT id FROM missing_table WHERE 1 = 2"));
+
+    /// Placeholders are kept, query is folded again after parameters are bound
+    auto select = interpreter.prepare("SELECT id FROM test_table WHERE ((age > ?) AND (1 = 2)) OR (id = ? + 1)");
+    ASSERT_EQ(select->getParameterCount(), 2);
+    ASSERT_EQ(interpreter.execute(select, {int64_t(0), int64_t(0)}).getRows(), (std::vector<shdb::Row>{{int64_t(1)}}));
+    ASSERT_EQ(interpreter.execute(select, {int64_t(0), int64_t(1)}).getRows(), (std::vector<shdb::Row>{{int64_t(2)}}));
+
+    auto by_parameter = interpreter.prepare("SELECT id FROM test_table WHERE (? = 1) AND (age < 15)");
+    ASSERT_EQ(interpreter.execute(by_parameter, {int64_t(1)}).getRows(), (std::vector<shdb::Row>{{int64_t(1)}}));
+    page_accessed = db->getStatistics()->page_accessed;
+    ASSERT_TRUE(interpreter.execute(by_parameter, {int64_t(2)}).getRows().empty());
+    ASSERT_EQ(db->getStatistics()->page_accessed, page_accessed);
+    ASSERT_EQ(interpreter.execute(by_parameter, {int64_t(1)}).getRows().size(), 1);
+}
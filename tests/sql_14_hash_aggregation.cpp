@@ -0,0 +1,313 @@
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <unordered_map>
+
+#include <gtest/gtest.h>
+
+#include "aggregation_table.h"
+#include "db.h"
+#include "executor.h"
+#include "interpreter.h"
+
+namespace
+{
+
+shdb::AggregateFunctionFactory createFactory()
+{
+    shdb::AggregateFunctionFactory factory;
+    shdb::registerAggregateFunctions(factory);
+    return factory;
+}
+
+struct Input
+{
+    std::vector<shdb::ColumnVector> keys;
+    std::vector<shdb::ColumnVector> arguments;
+    size_t size = 0;
+};
+
+/// Key of row i is (i % group_count, "k" or null), aggregates take i
+std::vector<Input> generateInput(size_t row_count, int64_t group_count)
+{
+    std::vector<Input> inputs;
+    for (size_t begin = 0; begin < row_count; begin += shdb::ColumnBatch::DefaultSize)
+    {
+        auto & input = inputs.emplace_back();
+        input.size = std::min(shdb::ColumnBatch::DefaultSize, row_count - begin);
+        input.keys = {shdb::ColumnVector(shdb::Type::int64), shdb::ColumnVector(shdb::Type::string)};
+        input.arguments = {shdb::ColumnVector(shdb::Type::int64)};
+        for (size_t row = begin; row < begin + input.size; ++row)
+        {
+            input.keys[0].append(static_cast<int64_t>(row) % group_count);
+            if (row % 2)
+                input.keys[1].appendNull();
+            else
+                input.keys[1].append(std::string("k"));
+            input.arguments[0].append(static_cast<int64_t>(row));
+        }
+    }
+    return inputs;
+}
+
+void aggregate(shdb::AggregationTable & table, const std::vector<shdb::AggregateFunctionPtr> & functions, const std::vector<Input> & inputs)
+{
+    std::vector<shdb::AggregateDataPtr> places;
+    for (const auto & input : inputs)
+    {
+        places.resize(input.size);
+        table.findGroups(input.keys, input.size, places.data());
+        for (size_t index = 0; index < functions.size(); ++index)
+            functions[index]->addBatch(places.data(), table.getStateOffset(index), input.arguments, input.size);
+    }
+}
+}
+
+TEST(HashAggregation, Table)
+{
+    auto factory = createFactory();
+    std::vector<shdb::AggregateFunctionPtr> functions{
+        factory.getAggregateFunctionOrThrow("sum", {shdb::Type::int64}), factory.getAggregateFunctionOrThrow("min", {shdb::Type::int64})};
+    shdb::AggregationTable table({shdb::Type::int64, shdb::Type::string}, functions);
+
+    constexpr size_t row_count = 100000;
+    constexpr int64_t group_count = 1001;
+    aggregate(table, functions, generateInput(row_count, group_count));
+
+    std::unordered_map<shdb::Row, std::pair<int64_t, int64_t>> expected;
+    for (size_t row = 0; row < row_count; ++row)
+    {
+        shdb::Row key{static_cast<int64_t>(row) % group_count, row % 2 ? shdb::Value(shdb::Null{}) : shdb::Value(std::string("k"))};
+        auto [it, inserted] = expected.emplace(key, std::make_pair(int64_t(0), static_cast<int64_t>(row)));
+        it->second.first += static_cast<int64_t>(row);
+    }
+    ASSERT_EQ(table.getGroupCount(), expected.size());
+
+    auto schema = std::make_shared<shdb::Schema>(
+        shdb::Schema{{"key", shdb::Type::int64}, {"name", shdb::Type::string}, {"sum", shdb::Type::int64}, {"min", shdb::Type::int64}});
+    shdb::ColumnBatch batch(schema);
+    table.getResults(0, table.getGroupCount(), batch);
+    batch.addRows(table.getGroupCount());
+    for (size_t group = 0; group < batch.getRowCount(); ++group)
+    {
+        auto row = batch.getRow(group);
+        auto it = expected.find(shdb::Row{row[0], row[1]});
+        ASSERT_NE(it, expected.end());
+        ASSERT_EQ(row[2], shdb::Value(it->second.first));
+        ASSERT_EQ(row[3], shdb::Value(it->second.second));
+    }
+
+    /// Groups are numbered in order of first appearance
+    ASSERT_EQ(batch.getRow(0)[0], shdb::Value(int64_t(0)));
+    ASSERT_EQ(batch.getRow(0)[1], shdb::Value(std::string("k")));
+    ASSERT_EQ(batch.getRow(1)[0], shdb::Value(int64_t(1)));
+    ASSERT_EQ(batch.getRow(1)[1], shdb::Value(shdb::Null{}));
+}
+
+TEST(HashAggregation, Merge)
+{
+    auto factory = createFactory();
+    std::vector<shdb::AggregateFunctionPtr> functions{
+        factory.getAggregateFunctionOrThrow("sum", {shdb::Type::int64}),
+        factory.getAggregateFunctionOrThrow("min", {shdb::Type::int64}),
+        factory.getAggregateFunctionOrThrow("avg", {shdb::Type::int64})};
+    auto inputs = generateInput(20000, 501);
+
+    shdb::AggregationTable whole({shdb::Type::int64, shdb::Type::string}, functions);
+    aggregate(whole, functions, inputs);
+
+    /// Halves of input are aggregated separately, one of them into partitions.
+    /// Every key is in the first half, so merged groups keep the order of the whole input.
+    std::vector<Input> first(inputs.begin(), inputs.begin() + inputs.size() / 2);
+    std::vector<Input> second(inputs.begin() + inputs.size() / 2, inputs.end());
+    shdb::AggregationTable merged({shdb::Type::int64, shdb::Type::string}, functions);
+    aggregate(merged, functions, first);
+    shdb::PartitionedAggregationTable partitioned({shdb::Type::int64, shdb::Type::string}, functions);
+    std::vector<shdb::AggregateDataPtr> places;
+    for (const auto & input : second)
+    {
+        places.resize(input.size);
+        partitioned.findGroups(input.keys, input.size, places.data());
+        for (size_t index = 0; index < functions.size(); ++index)
+            functions[index]->addBatch(places.data(), partitioned.getStateOffset(index), input.arguments, input.size);
+    }
+    ASSERT_EQ(partitioned.getGroupCount(), whole.getGroupCount());
+    for (size_t index = 0; index < shdb::PartitionedAggregationTable::PartitionCount; ++index)
+        merged.merge(partitioned.getPartition(index));
+
+    auto schema = std::make_shared<shdb::Schema>(shdb::Schema{
+        {"key", shdb::Type::int64}, {"name", shdb::Type::string}, {"sum", shdb::Type::int64}, {"min", shdb::Type::int64}, {"avg", shdb::Type::int64}});
+    shdb::ColumnBatch expected(schema);
+    whole.getResults(0, whole.getGroupCount(), expected);
+    expected.addRows(whole.getGroupCount());
+    shdb::ColumnBatch result(schema);
+    merged.getResults(0, merged.getGroupCount(), result);
+    result.addRows(merged.getGroupCount());
+    ASSERT_EQ(result.getRowCount(), expected.getRowCount());
+    for (size_t row = 0; row < result.getRowCount(); ++row)
+        ASSERT_EQ(result.getRow(row), expected.getRow(row));
+}
+
+TEST(HashAggregation, AvgDoesNotOverflow)
+{
+    auto factory = createFactory();
+    for (auto type : {shdb::Type::int64, shdb::Type::uint64})
+    {
+        auto function = factory.getAggregateFunctionOrThrow("avg", {type});
+        auto value = type == shdb::Type::int64 ? shdb::Value(std::numeric_limits<int64_t>::max() - 1)
+                                               : shdb::Value(std::numeric_limits<uint64_t>::max() - 1);
+        alignas(std::max_align_t) char lhs[64];
+        alignas(std::max_align_t) char rhs[64];
+        ASSERT_LE(function->getStateSize(), sizeof(lhs));
+        function->create(lhs);
+        function->create(rhs);
+
+        /// Sum of three values is far out of range of the argument type, merged state too
+        for (size_t row = 0; row < 3; ++row)
+            function->add(lhs, {value});
+        function->add(rhs, {value});
+        function->merge(lhs, rhs);
+        ASSERT_EQ(function->getResult(lhs), value);
+        function->destroy(lhs);
+        function->destroy(rhs);
+    }
+}
+
+TEST(HashAggregation, Parallel)
+{
+    auto factory = createFactory();
+    auto schema = std::make_shared<shdb::Schema>(shdb::Schema{{"key", shdb::Type::int64}, {"value", shdb::Type::int64}});
+    auto accessor = std::make_shared<shdb::SchemaAccessor>(schema);
+    shdb::Rows rows;
+    for (int64_t row = 0; row < 50000; ++row)
+        rows.push_back({row % 7919, row});
+
+    auto run = [&](size_t threads)
+    {
+        shdb::GroupByKeys keys{{shdb::buildExpression(shdb::newIdentifier("key"), accessor), "key"}};
+        shdb::GroupByExpressions expressions;
+        for (const auto * name : {"sum", "max"})
+            expressions.push_back(
+                {factory.getAggregateFunctionOrThrow(name, {shdb::Type::int64}),
+                 {shdb::buildExpression(shdb::newIdentifier("value"), accessor)},
+                 std::string(name) + "(value)"});
+        auto executor = shdb::createGroupByExecutor(shdb::createReadFromRowsExecutor(rows, schema), keys, expressions, threads);
+        auto result = shdb::rexecute(std::move(executor)).getRows();
+        std::sort(result.begin(), result.end(), [](const auto & lhs, const auto & rhs) { return std::get<int64_t>(lhs[0]) < std::get<int64_t>(rhs[0]); });
+        return result;
+    };
+
+    auto expected = run(1);
+    ASSERT_EQ(expected.size(), 7919);
+    ASSERT_EQ(expected[5], (shdb::Row{int64_t(5), int64_t(5 + 7924 + 15843 + 23762 + 31681 + 39600 + 47519), int64_t(47519)}));
+    for (size_t threads : {2, 4, 16})
+        ASSERT_EQ(run(threads), expected);
+}
+
+TEST(HashAggregation, Queries)
+{
+    auto db = shdb::connect("./mydb", 16);
+    auto interpreter = shdb::Interpreter(db);
+    interpreter.execute("DROP TABLE test_table");
+    interpreter.execute("CREATE TABLE test_table (id int64, age int64, name string)");
+
+    /// Without GROUP BY empty input gives one group, aggregates of no values are null
+    ASSERT_EQ(
+        interpreter.execute("SELECT sum(age), min(age), avg(age) FROM test_table").getRows(),
+        (std::vector<shdb::Row>{{shdb::Null{}, shdb::Null{}, shdb::Null{}}}));
+    ASSERT_TRUE(interpreter.execute("SELECT name, sum(age) FROM test_table GROUP BY name").getRows().empty());
+
+    interpreter.execute("INSERT test_table VALUES (1, 30, \"Ann\"), (2, -10, \"Bob\"), (3, 11, \"Ann\"), (4, -5, \"Bob\")");
+    ASSERT_EQ(
+        interpreter.execute("SELECT sum(age), max(id), sum(age) * 2 FROM test_table").getRows(),
+        (std::vector<shdb::Row>{{int64_t(26), int64_t(4), int64_t(52)}}));
+    ASSERT_EQ(
+        interpreter.execute("SELECT name, avg(age), -min(age) FROM test_table GROUP BY name ORDER BY name DESC").getRows(),
+        (std::vector<shdb::Row>{{std::string("Bob"), int64_t(-7), int64_t(10)}, {std::string("Ann"), int64_t(20), int64_t(-11)}}));
+    ASSERT_EQ(
+        interpreter.execute("SELECT name FROM test_table WHERE id > 1 GROUP BY name HAVING (sum(id) > 5) AND (max(age) < 20)").getRows(),
+        (std::vector<shdb::Row>{{std::string("Bob")}}));
+    for (size_t threads : {1, 4})
+    {
+        interpreter.setMaxThreads(threads);
+        ASSERT_EQ(
+            interpreter.execute("SELECT name, sum(age) FROM test_table GROUP BY name ORDER BY name").getRows(),
+            (std::vector<shdb::Row>{{std::string("Ann"), int64_t(41)}, {std::string("Bob"), int64_t(-15)}}));
+    }
+
+    ASSERT_ANY_THROW(interpreter.execute("SELECT sum(name) FROM test_table"));
+    ASSERT_ANY_THROW(interpreter.execute("SELECT sum(age, id) FROM test_table"));
+    ASSERT_ANY_THROW(interpreter.execute("SELECT sum(sum(age)) FROM test_table"));
+    ASSERT_ANY_THROW(interpreter.execute("SELECT id FROM test_table GROUP BY name"));
+    ASSERT_ANY_THROW(interpreter.execute("SELECT id FROM test_table HAVING id > 1"));
+}
+
+TEST(HashAggregation, TableSlices)
+{
+    auto db = shdb::connect("./mydb", 64);
+    auto interpreter = shdb::Interpreter(db);
+    interpreter.execute("DROP TABLE test_table");
+    interpreter.execute("CREATE TABLE test_table (id int64, age int64, name string)");
+
+    constexpr int64_t row_count = 40000;
+    std::string query = "INSERT test_table VALUES ";
+    for (int64_t id = 0; id < row_count; ++id)
+    {
+        if (id != 0)
+            query += ", ";
+        query += "(" + std::to_string(id) + ", " + std::to_string(id % 100) + ", \"name" + std::to_string(id % 7) + "\")";
+    }
+    interpreter.execute(query);
+
+    /// Every page is read by exactly one slice, whatever the number of threads
+    std::vector<shdb::Row> expected;
+    for (size_t threads : {1, 3, 8})
+    {
+        interpreter.setMaxThreads(threads);
+        ASSERT_EQ(
+            interpreter.execute("SELECT min(id), max(id), sum(id) FROM test_table").getRows(),
+            (std::vector<shdb::Row>{{int64_t(0), row_count - 1, row_count * (row_count - 1) / 2}}));
+        ASSERT_EQ(
+            interpreter.execute("SELECT sum(age) FROM test_table WHERE (age < 50) AND (id >= 100)").getRows(),
+            (std::vector<shdb::Row>{{int64_t(399 * 1225)}}));
+        auto rows = interpreter.execute("SELECT name, sum(id) FROM test_table WHERE age < 50 GROUP BY name ORDER BY name").getRows();
+        ASSERT_EQ(rows.size(), 7);
+        if (expected.empty())
+            expected = rows;
+        ASSERT_EQ(rows, expected);
+    }
+}
+
+TEST(HashAggregation, ManyGroups)
+{
+    auto factory = createFactory();
+    std::vector<shdb::AggregateFunctionPtr> functions{
+        factory.getAggregateFunctionOrThrow("sum", {shdb::Type::int64}), factory.getAggregateFunctionOrThrow("max", {shdb::Type::int64})};
+    auto schema = std::make_shared<shdb::Schema>(
+        shdb::Schema{{"key", shdb::Type::int64}, {"name", shdb::Type::string}, {"sum", shdb::Type::int64}, {"max", shdb::Type::int64}});
+
+    constexpr size_t row_count = 200000;
+    /// Even group count makes null key column repeat with the first key, so there are group_count groups.
+    /// Group per row makes the table grow many times while groups are added.
+    for (int64_t group_count : {int64_t(16), int64_t(row_count)})
+    {
+        shdb::AggregationTable table({shdb::Type::int64, shdb::Type::string}, functions);
+        aggregate(table, functions, generateInput(row_count, group_count));
+        ASSERT_EQ(table.getGroupCount(), static_cast<size_t>(group_count));
+
+        shdb::ColumnBatch batch(schema);
+        table.getResults(0, table.getGroupCount(), batch);
+        batch.addRows(table.getGroupCount());
+        for (size_t group = 0; group < batch.getRowCount(); ++group)
+        {
+            /// Rows of key k are k, k + group_count, ..., groups are numbered in order of first appearance
+            auto key = static_cast<int64_t>(group);
+            auto rows_in_group = (static_cast<int64_t>(row_count) - key + group_count - 1) / group_count;
+            auto max = key + (rows_in_group - 1) * group_count;
+            auto row = batch.getRow(group);
+            ASSERT_EQ(row[0], shdb::Value(key));
+            ASSERT_EQ(row[2], shdb::Value((key + max) * rows_in_group / 2));
+            ASSERT_EQ(row[3], shdb::Value(max));
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "db.h"
+#include "interpreter.h"
+
+namespace
+{
+
+auto fixed_schema = std::make_shared<shdb::Schema>(shdb::Schema{{"id", shdb::Type::int64}, {"age", shdb::Type::int64}, {"girl", shdb::Type::boolean}});
+
+shdb::Row makeRow(int64_t id)
+{
+    return shdb::Row{id, 18 + id % 10, id % 2 == 0};
+}
+
+std::vector<shdb::Row> sorted(std::vector<shdb::Row> rows)
+{
+    std::sort(rows.begin(), rows.end(), [](const auto & lhs, const auto & rhs) { return std::get<int64_t>(lhs[0]) < std::get<int64_t>(rhs[0]); });
+    return rows;
+}
+
+}
+
+TEST(SQL, InsertRowsBatch)
+{
+    auto db = shdb::connect("./mydb", 4);
+    if (db->checkTableExists("test_table"))
+        db->dropTable("test_table");
+    db->createTable("test_table", fixed_schema);
+    auto table = db->getTable("test_table", fixed_schema);
+
+    shdb::Rows rows;
+    for (int64_t id = 0; id < 10000; ++id)
+        rows.push_back(makeRow(id));
+
+    /// Every page is pinned once for all rows it takes
+    auto page_accessed = db->getStatistics()->page_accessed;
+    auto row_ids = table->insertRows(rows);
+    ASSERT_EQ(row_ids.size(), rows.size());
+    ASSERT_GT(table->getPageCount(), 1);
+    ASSERT_LE(db->getStatistics()->page_accessed - page_accessed, 2 * table->getPageCount());
+    for (size_t index = 0; index < rows.size(); index += 97)
+        ASSERT_EQ(table->getRow(row_ids[index]), rows[index]);
+
+    /// Last page is known to free space map, so single insert does not grow the table
+    auto page_count = table->getPageCount();
+    table->insertRow(makeRow(-1));
+    ASSERT_EQ(table->getPageCount(), page_count);
+}
+
+TEST(SQL, InsertMany)
+{
+    auto db = shdb::connect("./mydb", 1);
+    auto interpreter = shdb::Interpreter(db);
+    interpreter.execute("DROP TABLE test_table");
+    interpreter.execute("CREATE TABLE test_table (id int64, age int64, girl boolean)");
+
+    std::stringstream query;
+    query << "INSERT test_table VALUES ";
+    std::vector<shdb::Row> expected;
+    for (int64_t id = 0; id < 1000; ++id)
+    {
+        query << (id == 0 ? "" : ", ") << "(" << id << ", 18+" << id % 10 << ", " << (id % 2 == 0 ? "1>0" : "1<0") << ")";
+        expected.push_back(makeRow(id));
+    }
+    interpreter.execute(query.str());
+    ASSERT_EQ(sorted(interpreter.execute("SELECT * FROM test_table").getRows()), expected);
+
+    /// Whole statement is rejected if any tuple does not match
+    ASSERT_ANY_THROW(interpreter.execute("INSERT test_table VALUES (5000, 20, 1>0), (5001, 1>0, 20)"));
+    ASSERT_ANY_THROW(interpreter.execute("INSERT test_table VALUES (5000, 20)"));
+    ASSERT_EQ(interpreter.execute("SELECT * FROM test_table").getRows().size(), expected.size());
+
+    /// Select reading the same table sees only rows that were present before the statement
+    interpreter.execute("INSERT test_table SELECT id+1000, age, girl FROM test_table WHERE id < 10");
+    for (int64_t id = 1000; id < 1010; ++id)
+        expected.push_back(shdb::Row{id, 18 + (id - 1000) % 10, id % 2 == 0});
+    ASSERT_EQ(sorted(interpreter.execute("SELECT * FROM test_table").getRows()), expected);
+
+    interpreter.execute("INSERT test_table SELECT 2000, 30, 1>0");
+    ASSERT_EQ(interpreter.execute("SELECT * FROM test_table WHERE id = 2000").getRows(), (std::vector<shdb::Row>{{int64_t(2000), int64_t(30), true}}));
+    ASSERT_ANY_THROW(interpreter.execute("INSERT test_table SELECT id FROM test_table"));
+
+    interpreter.execute("DROP TABLE test_table");
+}
@@ -0,0 +1,180 @@
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include "db.h"
+#include "interpreter.h"
+
+namespace
+{
+
+void populate(shdb::Interpreter & interpreter)
+{
+    interpreter.execute("DROP TABLE test_table");
+    interpreter.execute("CREATE TABLE test_table (id int64, age int64, name string)");
+    interpreter.execute("INSERT test_table VALUES (0, 20, \"Ann\"), (1, 21, \"Bob\"), (2, 19, \"Sara\")");
+}
+
+}
+
+TEST(SQL, PreparedStatement)
+{
+    auto db = shdb::connect("./mydb", 1);
+    auto interpreter = shdb::Interpreter(db);
+    populate(interpreter);
+
+    auto insert = interpreter.prepare("INSERT test_table VALUES (?, ? + 1, ?)");
+    ASSERT_EQ(insert->getParameterCount(), 3);
+    for (int64_t id = 3; id < 10; ++id)
+        interpreter.execute(insert, {id, int64_t(17), std::string("Kid")});
+
+    auto select = interpreter.prepare("SELECT name, age FROM test_table WHERE id = ?");
+    ASSERT_EQ(interpreter.execute(select, {int64_t(1)}).getRows(), (std::vector<shdb::Row>{{std::string("Bob"), int64_t(21)}}));
+    ASSERT_EQ(interpreter.execute(select, {int64_t(5)}).getRows(), (std::vector<shdb::Row>{{std::string("Kid"), int64_t(18)}}));
+    ASSERT_TRUE(interpreter.execute(select, {int64_t(100)}).getRows().empty());
+
+    auto select_by_name = interpreter.prepare("SELECT id FROM test_table WHERE (name = ?) AND (id < ?) ORDER BY id");
+    ASSERT_EQ(
+        interpreter.execute(select_by_name, {std::string("Kid"), int64_t(5)}).getRows(),
+        (std::vector<shdb::Row>{{int64_t(3)}, {int64_t(4)}}));
+
+    ASSERT_ANY_THROW(interpreter.execute(select, {}));
+    ASSERT_ANY_THROW(interpreter.execute(select, {int64_t(1), int64_t(2)}));
+    ASSERT_ANY_THROW(interpreter.execute(select, {shdb::Null{}}));
+    ASSERT_ANY_THROW(interpreter.execute("SELECT id FROM test_table WHERE id = ?"));
+
+    /// Statements stay valid after tables are recreated, tables are resolved on every execution
+    populate(interpreter);
+    ASSERT_EQ(interpreter.execute(select, {int64_t(2)}).getRows(), (std::vector<shdb::Row>{{std::string("Sara"), int64_t(19)}}));
+    ASSERT_TRUE(interpreter.execute(select, {int64_t(5)}).getRows().empty());
+}
+
+TEST(SQL, PreparedStatementParameterTypes)
+{
+    auto db = shdb::connect("./mydb", 1);
+    auto interpreter = shdb::Interpreter(db);
+    interpreter.execute("DROP TABLE typed_table");
+    interpreter.execute("CREATE TABLE typed_table (id uint64, graduated boolean, name string)");
+
+    /// Parameters of every column type are bound as literals of that type
+    auto insert = interpreter.prepare("INSERT typed_table VALUES (?, ?, ?)");
+    for (uint64_t id = 0; id < 6; ++id)
+        interpreter.execute(insert, {id, id % 2 == 0, std::string("clone") + std::to_string(id)});
+
+    auto select_by_id = interpreter.prepare("SELECT name, graduated FROM typed_table WHERE id = ?");
+    ASSERT_EQ(
+        interpreter.execute(select_by_id, {uint64_t(3)}).getRows(), (std::vector<shdb::Row>{{std::string("clone3"), false}}));
+
+    auto select_by_flag = interpreter.prepare("SELECT id FROM typed_table WHERE graduated = ?");
+    auto rows = interpreter.execute(select_by_flag, {true}).getRows();
+    std::sort(rows.begin(), rows.end(), [](const auto & lhs, const auto & rhs) { return std::get<uint64_t>(lhs[0]) < std::get<uint64_t>(rhs[0]); });
+    ASSERT_EQ(rows, (std::vector<shdb::Row>{{uint64_t(0)}, {uint64_t(2)}, {uint64_t(4)}}));
+
+    interpreter.execute("DROP TABLE typed_table");
+}
+
+TEST(SQL, PlanCache)
+{
+    auto db = shdb::connect("./mydb", 1);
+    auto interpreter = shdb::Interpreter(db, 2);
+    populate(interpreter);
+
+    /// Table creation invalidates cached plans
+    ASSERT_EQ(interpreter.getPlanCacheSize(), 1);
+
+    auto first = interpreter.prepare("SELECT id FROM test_table WHERE id = 1");
+    ASSERT_EQ(interpreter.prepare("SELECT  id FROM test_table\n WHERE id = 1 "), first);
+    ASSERT_NE(interpreter.prepare("SELECT id FROM test_table WHERE id = 2"), first);
+    ASSERT_EQ(interpreter.getPlanCacheSize(), 2);
+
+    /// Least recently used plan is evicted
+    interpreter.prepare("SELECT id FROM test_table WHERE id = 1");
+    interpreter.prepare("SELECT id FROM test_table WHERE id = 0");
+    ASSERT_EQ(interpreter.prepare("SELECT id FROM test_table WHERE id = 1"), first);
+    ASSERT_EQ(interpreter.getPlanCacheSize(), 2);
+
+    ASSERT_EQ(interpreter.execute("SELECT id FROM test_table WHERE id = 1").getRows(), (std::vector<shdb::Row>{{int64_t(1)}}));
+    ASSERT_EQ(interpreter.execute("SELECT name FROM test_table WHERE name = \"Ann\"").getRows(), (std::vector<shdb::Row>{{std::string("Ann")}}));
+
+    interpreter.execute("DROP TABLE test_table");
+    ASSERT_EQ(interpreter.getPlanCacheSize(), 0);
+}
+
+TEST(SQL, PreparedStatementPlan)
+{
+    auto db = shdb::connect("./mydb", 1);
+    auto interpreter = shdb::Interpreter(db);
+    populate(interpreter);
+
+    /// Plan is built once, every execution reads current rows of tables
+    auto select = interpreter.prepare("SELECT name, max(age) FROM test_table WHERE id > 0 GROUP BY name ORDER BY name");
+    ASSERT_EQ(
+        interpreter.execute(select, {}).getRows(),
+        (std::vector<shdb::Row>{{std::string("Bob"), int64_t(21)}, {std::string("Sara"), int64_t(19)}}));
+    interpreter.execute("INSERT test_table VALUES (3, 30, \"Bob\")");
+    ASSERT_EQ(
+        interpreter.execute(select, {}).getRows(),
+        (std::vector<shdb::Row>{{std::string("Bob"), int64_t(30)}, {std::string("Sara"), int64_t(19)}}));
+
+    /// Table recreated with other columns invalidates plan of statement held outside of plan cache
+    interpreter.execute("DROP TABLE test_table");
+    interpreter.execute("CREATE TABLE test_table (name string, id int64, age int64)");
+    interpreter.execute("INSERT test_table VALUES (\"Kid\", 1, 7)");
+    ASSERT_EQ(interpreter.execute(select, {}).getRows(), (std::vector<shdb::Row>{{std::string("Kid"), int64_t(7)}}));
+    interpreter.execute("DROP TABLE test_table");
+    ASSERT_ANY_THROW(interpreter.execute(select, {}));
+}
+
+TEST(SQL, PreparedStatementPlanSharedCatalog)
+{
+    auto db = shdb::connect("./mydb", 1);
+    auto interpreter = shdb::Interpreter(db);
+    auto other_interpreter = shdb::Interpreter(db);
+    interpreter.execute("DROP TABLE test_table");
+    interpreter.execute("CREATE TABLE test_table (id int64, name string)");
+    interpreter.execute("INSERT test_table VALUES (0, \"old\")");
+    ASSERT_EQ(interpreter.execute("SELECT name FROM test_table").getRows(), (std::vector<shdb::Row>{{std::string("old")}}));
+
+    /// Tables recreated by another interpreter or by database itself invalidate cached plans
+    other_interpreter.execute("DROP TABLE test_table");
+    other_interpreter.execute("CREATE TABLE test_table (id int64, name string)");
+    other_interpreter.execute("INSERT test_table VALUES (1, \"new\"), (2, \"newer\")");
+    auto expected = std::vector<shdb::Row>{{std::string("new")}, {std::string("newer")}};
+    ASSERT_EQ(other_interpreter.execute("SELECT name FROM test_table").getRows(), expected);
+    ASSERT_EQ(interpreter.execute("SELECT name FROM test_table").getRows(), expected);
+
+    db->dropTable("test_table");
+    db->createTable("test_table", std::make_shared<shdb::Schema>(shdb::Schema{{"id", shdb::Type::int64}, {"name", shdb::Type::string}}));
+    ASSERT_TRUE(interpreter.execute("SELECT name FROM test_table").getRows().empty());
+    db->dropTable("test_table");
+    ASSERT_ANY_THROW(interpreter.execute("SELECT name FROM test_table"));
+}
+
+TEST(SQL, PreparedStatementPlanWithParameters)
+{
+    auto db = shdb::connect("./mydb", 1);
+    auto interpreter = shdb::Interpreter(db);
+    populate(interpreter);
+
+    /// Plan is kept, only bound WHERE is planned for every execution: pushed down, filtered or folded to constant
+    auto select = interpreter.prepare("SELECT name FROM test_table WHERE (id = ?) AND (? > 0)");
+    ASSERT_EQ(interpreter.execute(select, {int64_t(1), int64_t(1)}).getRows(), (std::vector<shdb::Row>{{std::string("Bob")}}));
+    ASSERT_TRUE(interpreter.execute(select, {int64_t(1), int64_t(0)}).getRows().empty());
+    ASSERT_EQ(interpreter.execute(select, {int64_t(2), int64_t(5)}).getRows(), (std::vector<shdb::Row>{{std::string("Sara")}}));
+    ASSERT_ANY_THROW(interpreter.execute(select, {int64_t(2)}));
+
+    auto select_by_age = interpreter.prepare("SELECT name FROM test_table WHERE age + ? > 40 ORDER BY name");
+    ASSERT_EQ(
+        interpreter.execute(select_by_age, {int64_t(20)}).getRows(), (std::vector<shdb::Row>{{std::string("Bob")}}));
+    ASSERT_EQ(
+        interpreter.execute(select_by_age, {int64_t(21)}).getRows(),
+        (std::vector<shdb::Row>{{std::string("Ann")}, {std::string("Bob")}}));
+
+    /// Kept plan is rebuilt once table is recreated with other columns
+    auto other_interpreter = shdb::Interpreter(db);
+    other_interpreter.execute("DROP TABLE test_table");
+    other_interpreter.execute("CREATE TABLE test_table (name string, age int64, id int64)");
+    other_interpreter.execute("INSERT test_table VALUES (\"Kid\", 7, 1)");
+    ASSERT_EQ(interpreter.execute(select, {int64_t(1), int64_t(1)}).getRows(), (std::vector<shdb::Row>{{std::string("Kid")}}));
+    interpreter.execute("DROP TABLE test_table");
+}